@@ -35,6 +35,7 @@
 #include "core/io/file_access_encrypted.h"
 #include "core/io/json.h"
 #include "core/io/marshalls.h"
+#include "core/math/batch_math.h"
 #include "core/math/geometry.h"
 #include "core/os/keyboard.h"
 #include "core/os/os.h"
@@ -1623,6 +1624,82 @@ Vector<Vector3> _Geometry::clip_polygon(const Vector<Vector3> &p_points, const P
 	return Geometry::clip_polygon(p_points, p_plane);
 }
 
+AABB _Geometry::get_points_bounds(const PoolVector<Vector3> &p_points) {
+
+	PoolVector<Vector3>::Read r = p_points.read();
+	return BatchMath::get_bounds(r.ptr(), p_points.size());
+}
+
+AABB _Geometry::merge_aabbs(const Array &p_aabbs) {
+
+	int count = p_aabbs.size();
+	Vector<AABB> aabbs;
+	aabbs.resize(count);
+	for (int i = 0; i < count; i++) {
+		ERR_FAIL_COND_V(p_aabbs[i].get_type() != Variant::AABB, AABB());
+		aabbs.write[i] = p_aabbs[i];
+	}
+
+	return BatchMath::merge_aabbs(aabbs.ptr(), count);
+}
+
+PoolVector<real_t> _Geometry::get_plane_distances(const Plane &p_plane, const PoolVector<Vector3> &p_points) {
+
+	PoolVector<real_t> distances;
+	distances.resize(p_points.size());
+
+	PoolVector<Vector3>::Read r = p_points.read();
+	PoolVector<real_t>::Write w = distances.write();
+	BatchMath::get_plane_distances(p_plane, r.ptr(), w.ptr(), p_points.size());
+
+	return distances;
+}
+
+static PoolVector<int> _inside_indices(const uint8_t *p_inside, int p_count, int p_inside_count) {
+
+	PoolVector<int> indices;
+	indices.resize(p_inside_count);
+
+	PoolVector<int>::Write w = indices.write();
+	int idx = 0;
+	for (int i = 0; i < p_count; i++) {
+		if (p_inside[i]) {
+			w[idx++] = i;
+		}
+	}
+
+	return indices;
+}
+
+PoolVector<int> _Geometry::cull_points(const Vector<Plane> &p_planes, const PoolVector<Vector3> &p_points) {
+
+	int count = p_points.size();
+	Vector<uint8_t> inside;
+	inside.resize(count);
+
+	PoolVector<Vector3>::Read r = p_points.read();
+	int inside_count = BatchMath::cull_points(p_planes.ptr(), p_planes.size(), r.ptr(), count, inside.ptrw());
+
+	return _inside_indices(inside.ptr(), count, inside_count);
+}
+
+PoolVector<int> _Geometry::cull_aabbs(const Vector<Plane> &p_planes, const Array &p_aabbs) {
+
+	int count = p_aabbs.size();
+	Vector<AABB> aabbs;
+	aabbs.resize(count);
+	for (int i = 0; i < count; i++) {
+		ERR_FAIL_COND_V(p_aabbs[i].get_type() != Variant::AABB, PoolVector<int>());
+		aabbs.write[i] = p_aabbs[i];
+	}
+
+	Vector<uint8_t> inside;
+	inside.resize(count);
+	int inside_count = BatchMath::cull_aabbs(p_planes.ptr(), p_planes.size(), aabbs.ptr(), count, inside.ptrw());
+
+	return _inside_indices(inside.ptr(), count, inside_count);
+}
+
 Array _Geometry::merge_polygons_2d(const Vector<Vector2> &p_polygon_a, const Vector<Vector2> &p_polygon_b) {
 
 	Vector<Vector<Point2> > polys = Geometry::merge_polygons_2d(p_polygon_a, p_polygon_b);
@@ -1787,6 +1864,12 @@ void _Geometry::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("convex_hull_2d", "points"), &_Geometry::convex_hull_2d);
 	ClassDB::bind_method(D_METHOD("clip_polygon", "points", "plane"), &_Geometry::clip_polygon);
 
+	ClassDB::bind_method(D_METHOD("get_points_bounds", "points"), &_Geometry::get_points_bounds);
+	ClassDB::bind_method(D_METHOD("merge_aabbs", "aabbs"), &_Geometry::merge_aabbs);
+	ClassDB::bind_method(D_METHOD("get_plane_distances", "plane", "points"), &_Geometry::get_plane_distances);
+	ClassDB::bind_method(D_METHOD("cull_points", "planes", "points"), &_Geometry::cull_points);
+	ClassDB::bind_method(D_METHOD("cull_aabbs", "planes", "aabbs"), &_Geometry::cull_aabbs);
+
 	ClassDB::bind_method(D_METHOD("merge_polygons_2d", "polygon_a", "polygon_b"), &_Geometry::merge_polygons_2d);
 	ClassDB::bind_method(D_METHOD("clip_polygons_2d", "polygon_a", "polygon_b"), &_Geometry::clip_polygons_2d);
 	ClassDB::bind_method(D_METHOD("intersect_polygons_2d", "polygon_a", "polygon_b"), &_Geometry::intersect_polygons_2d);
@@ -407,6 +407,12 @@ public:
 	Vector<Point2> convex_hull_2d(const Vector<Point2> &p_points);
 	Vector<Vector3> clip_polygon(const Vector<Vector3> &p_points, const Plane &p_plane);
 
+	AABB get_points_bounds(const PoolVector<Vector3> &p_points);
+	AABB merge_aabbs(const Array &p_aabbs);
+	PoolVector<real_t> get_plane_distances(const Plane &p_plane, const PoolVector<Vector3> &p_points);
+	PoolVector<int> cull_points(const Vector<Plane> &p_planes, const PoolVector<Vector3> &p_points);
+	PoolVector<int> cull_aabbs(const Vector<Plane> &p_planes, const Array &p_aabbs);
+
 	enum PolyBooleanOperation {
 		OPERATION_UNION,
 		OPERATION_DIFFERENCE,
@@ -265,6 +265,7 @@ ClassDB::ClassInfo::ClassInfo() {
 	inherits_ptr = NULL;
 	disabled = false;
 	exposed = false;
+	overrides_call = false;
 }
 
 ClassDB::ClassInfo::~ClassInfo() {
@@ -554,7 +555,7 @@ bool ClassDB::can_instance(const StringName &p_class) {
 	return (!ti->disabled && ti->creation_func != NULL);
 }
 
-void ClassDB::_add_class2(const StringName &p_class, const StringName &p_inherits) {
+void ClassDB::_add_class2(const StringName &p_class, const StringName &p_inherits, bool p_overrides_call) {
 
 	OBJTYPE_WLOCK;
 
@@ -567,6 +568,7 @@ void ClassDB::_add_class2(const StringName &p_class, const StringName &p_inherit
 	ti.name = name;
 	ti.inherits = p_inherits;
 	ti.api = current_api;
+	ti.overrides_call = p_overrides_call;
 
 	if (ti.inherits) {
 
@@ -667,6 +669,14 @@ MethodBind *ClassDB::get_method(StringName p_class, StringName p_name) {
 	return NULL;
 }
 
+bool ClassDB::class_overrides_call(const StringName &p_class) {
+
+	OBJTYPE_RLOCK;
+
+	ClassInfo *type = classes.getptr(p_class);
+	return type && type->overrides_call;
+}
+
 void ClassDB::bind_integer_constant(const StringName &p_class, const StringName &p_enum, const StringName &p_name, int p_constant) {
 
 	OBJTYPE_WLOCK;
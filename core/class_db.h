@@ -31,6 +31,7 @@
 #ifndef CLASS_DB_H
 #define CLASS_DB_H
 
+#include "core/flat_hash_map.h"
 #include "core/method_bind.h"
 #include "core/object.h"
 #include "core/print_string.h"
@@ -114,10 +115,10 @@ public:
 
 		APIType api;
 		ClassInfo *inherits_ptr;
-		HashMap<StringName, MethodBind *> method_map;
-		HashMap<StringName, int> constant_map;
+		FlatHashMap<StringName, MethodBind *> method_map;
+		FlatHashMap<StringName, int> constant_map;
 		HashMap<StringName, List<StringName> > enum_map;
-		HashMap<StringName, MethodInfo> signal_map;
+		FlatHashMap<StringName, MethodInfo> signal_map;
 		List<PropertyInfo> property_list;
 #ifdef DEBUG_METHODS_ENABLED
 		List<StringName> constant_order;
@@ -126,12 +127,13 @@ public:
 		List<MethodInfo> virtual_methods;
 		StringName category;
 #endif
-		HashMap<StringName, PropertySetGet> property_setget;
+		FlatHashMap<StringName, PropertySetGet> property_setget;
 
 		StringName inherits;
 		StringName name;
 		bool disabled;
 		bool exposed;
+		bool overrides_call; // Handles some calls in Object::call(), without a MethodBind.
 		Object *(*creation_func)();
 		ClassInfo();
 		~ClassInfo();
@@ -155,7 +157,12 @@ public:
 
 	static APIType current_api;
 
-	static void _add_class2(const StringName &p_class, const StringName &p_inherits);
+	static void _add_class2(const StringName &p_class, const StringName &p_inherits, bool p_overrides_call);
+
+	// &T::call has the type of the class that declares the call() T ends up with.
+	static bool _overrides_call(Variant (Object::*)(const StringName &, const Variant **, int, Variant::CallError &)) { return false; }
+	template <class T>
+	static bool _overrides_call(Variant (T::*)(const StringName &, const Variant **, int, Variant::CallError &)) { return true; }
 
 	static HashMap<StringName, HashMap<StringName, Variant> > default_values;
 	static Set<StringName> default_values_cached;
@@ -165,7 +172,7 @@ public:
 	template <class T>
 	static void _add_class() {
 
-		_add_class2(T::get_class_static(), T::get_parent_class_static());
+		_add_class2(T::get_class_static(), T::get_parent_class_static(), _overrides_call(&T::call));
 	}
 
 	template <class T>
@@ -340,6 +347,8 @@ public:
 
 	static void get_method_list(StringName p_class, List<MethodInfo> *p_methods, bool p_no_inheritance = false, bool p_exclude_from_properties = false);
 	static MethodBind *get_method(StringName p_class, StringName p_name);
+	// Whether the class overrides Object::call(), so calls can't go straight to its MethodBinds.
+	static bool class_overrides_call(const StringName &p_class);
 
 	static void add_virtual_method(const StringName &p_class, const MethodInfo &p_method, bool p_virtual = true);
 	static void get_virtual_methods(const StringName &p_class, List<MethodInfo> *p_methods, bool p_no_inheritance = false);
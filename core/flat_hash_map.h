@@ -0,0 +1,523 @@
+/*************************************************************************/
+/*  flat_hash_map.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include "core/error_macros.h"
+#include "core/hashfuncs.h"
+#include "core/list.h"
+#include "core/os/memory.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASH_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * A HashMap implementation modeled after SwissTable: open addressing, with
+ * one control byte per slot kept apart from the entries. The control byte of
+ * an occupied slot holds 7 bits of its hash, so lookups compare a whole group
+ * of 16 slots at once (with SSE2 when available) and only touch the keys of
+ * slots whose byte matches.
+ *
+ * Groups are aligned, so a group with an empty slot has never overflowed into
+ * the next one. Erasing from such a group frees the slot outright, tombstones
+ * are only left in full groups and get dropped on the next rehash.
+ *
+ * Entries are stored inplace and move when the table is rehashed: unlike with
+ * HashMap, pointers to keys and values are only valid until the next insertion.
+ * Apart from that the API mirrors HashMap, so either can be used where that
+ * doesn't matter.
+ */
+template <class TKey, class TData, class Hasher = HashMapHasherDefault, class Comparator = HashMapComparatorDefault<TKey> >
+class FlatHashMap {
+
+	enum {
+		GROUP_SIZE = 16,
+		CTRL_EMPTY = 0x80,
+		CTRL_DELETED = 0xFE,
+		// Occupied slots store the low 7 bits of the hash, so their high bit is clear.
+		CTRL_HASH_MASK = 0x7F,
+	};
+
+	uint8_t *ctrl;
+	uint32_t *hashes;
+	TKey *keys;
+	TData *values;
+
+	uint32_t capacity; // Zero, or a power of two multiple of GROUP_SIZE.
+	uint32_t elements;
+	uint32_t growth_left; // Insertions into empty slots left before a rehash is needed.
+
+	static _FORCE_INLINE_ uint32_t _hash(const TKey &p_key) {
+
+		// Default hashers return integers as is, mix them so that both the group
+		// index and the control bits depend on every bit of the key.
+		uint32_t h = Hasher::hash(p_key);
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35;
+		h ^= h >> 16;
+		return h;
+	}
+
+	static _FORCE_INLINE_ uint32_t _max_load(uint32_t p_capacity) {
+		return p_capacity - p_capacity / 8;
+	}
+
+	static _FORCE_INLINE_ uint32_t _first_bit(uint32_t p_mask) {
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctz(p_mask);
+#elif defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, p_mask);
+		return index;
+#else
+		uint32_t index = 0;
+		while (!(p_mask & 1)) {
+			p_mask >>= 1;
+			index++;
+		}
+		return index;
+#endif
+	}
+
+	// Bit i of the result is set if byte i of the group equals p_byte.
+	static _FORCE_INLINE_ uint32_t _match(const uint8_t *p_group, uint8_t p_byte) {
+#ifdef FLAT_HASH_MAP_SSE2
+		__m128i group = _mm_loadu_si128((const __m128i *)p_group);
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)p_byte)));
+#else
+		uint32_t mask = 0;
+		for (int i = 0; i < GROUP_SIZE; i++) {
+			mask |= uint32_t(p_group[i] == p_byte) << i;
+		}
+		return mask;
+#endif
+	}
+
+	// Bit i of the result is set if slot i of the group is empty or deleted.
+	static _FORCE_INLINE_ uint32_t _match_free(const uint8_t *p_group) {
+#ifdef FLAT_HASH_MAP_SSE2
+		return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p_group));
+#else
+		uint32_t mask = 0;
+		for (int i = 0; i < GROUP_SIZE; i++) {
+			mask |= uint32_t(p_group[i] >> 7) << i;
+		}
+		return mask;
+#endif
+	}
+
+	int32_t _find_pos(const TKey &p_key, uint32_t p_hash) const {
+
+		if (unlikely(!capacity))
+			return -1;
+
+		uint32_t group_mask = capacity / GROUP_SIZE - 1;
+		uint32_t group = (p_hash >> 7) & group_mask;
+		uint8_t h2 = p_hash & CTRL_HASH_MASK;
+
+		// Triangular probing visits every group once, and the load limit
+		// guarantees some group has an empty slot.
+		for (uint32_t step = 1;; step++) {
+
+			const uint8_t *group_ctrl = &ctrl[group * GROUP_SIZE];
+
+			uint32_t mask = _match(group_ctrl, h2);
+			while (mask) {
+				uint32_t pos = group * GROUP_SIZE + _first_bit(mask);
+				if (hashes[pos] == p_hash && Comparator::compare(keys[pos], p_key)) {
+					return pos;
+				}
+				mask &= mask - 1;
+			}
+
+			if (_match(group_ctrl, CTRL_EMPTY)) {
+				return -1;
+			}
+
+			group = (group + step) & group_mask;
+		}
+	}
+
+	uint32_t _find_free_pos(uint32_t p_hash) const {
+
+		uint32_t group_mask = capacity / GROUP_SIZE - 1;
+		uint32_t group = (p_hash >> 7) & group_mask;
+
+		for (uint32_t step = 1;; step++) {
+
+			uint32_t mask = _match_free(&ctrl[group * GROUP_SIZE]);
+			if (mask) {
+				return group * GROUP_SIZE + _first_bit(mask);
+			}
+
+			group = (group + step) & group_mask;
+		}
+	}
+
+	// Key must not be in the map and growth_left must be non zero.
+	uint32_t _insert_new(const TKey &p_key, uint32_t p_hash, const TData &p_data) {
+
+		uint32_t pos = _find_free_pos(p_hash);
+		if (ctrl[pos] == CTRL_EMPTY) {
+			growth_left--;
+		}
+
+		ctrl[pos] = p_hash & CTRL_HASH_MASK;
+		hashes[pos] = p_hash;
+		memnew_placement(&keys[pos], TKey(p_key));
+		memnew_placement(&values[pos], TData(p_data));
+		elements++;
+
+		return pos;
+	}
+
+	void _allocate(uint32_t p_capacity) {
+
+		capacity = p_capacity;
+		ctrl = (uint8_t *)memalloc(sizeof(uint8_t) * capacity);
+		hashes = (uint32_t *)memalloc(sizeof(uint32_t) * capacity);
+		keys = (TKey *)memalloc(sizeof(TKey) * capacity);
+		values = (TData *)memalloc(sizeof(TData) * capacity);
+
+		for (uint32_t i = 0; i < capacity; i++) {
+			ctrl[i] = CTRL_EMPTY;
+		}
+
+		elements = 0;
+		growth_left = _max_load(capacity);
+	}
+
+	void _rehash(uint32_t p_capacity) {
+
+		uint8_t *old_ctrl = ctrl;
+		uint32_t *old_hashes = hashes;
+		TKey *old_keys = keys;
+		TData *old_values = values;
+		uint32_t old_capacity = capacity;
+
+		_allocate(p_capacity);
+
+		for (uint32_t i = 0; i < old_capacity; i++) {
+
+			if (old_ctrl[i] & CTRL_EMPTY) {
+				continue;
+			}
+
+			_insert_new(old_keys[i], old_hashes[i], old_values[i]);
+			old_keys[i].~TKey();
+			old_values[i].~TData();
+		}
+
+		if (old_capacity) {
+			memfree(old_ctrl);
+			memfree(old_hashes);
+			memfree(old_keys);
+			memfree(old_values);
+		}
+	}
+
+	void _make_room() {
+
+		if (growth_left) {
+			return;
+		}
+
+		if (!capacity) {
+			_rehash(GROUP_SIZE);
+		} else if (elements >= _max_load(capacity) / 2) {
+			_rehash(capacity * 2);
+		} else {
+			// Mostly tombstones, clean them up without growing.
+			_rehash(capacity);
+		}
+	}
+
+	void _copy_from(const FlatHashMap &p_map) {
+
+		if (!p_map.elements) {
+			return;
+		}
+
+		_allocate(p_map.capacity);
+
+		for (uint32_t i = 0; i < capacity; i++) {
+
+			ctrl[i] = p_map.ctrl[i];
+			if (ctrl[i] & CTRL_EMPTY) {
+				continue;
+			}
+
+			hashes[i] = p_map.hashes[i];
+			memnew_placement(&keys[i], TKey(p_map.keys[i]));
+			memnew_placement(&values[i], TData(p_map.values[i]));
+		}
+
+		elements = p_map.elements;
+		growth_left = p_map.growth_left;
+	}
+
+public:
+	void set(const TKey &p_key, const TData &p_data) {
+
+		uint32_t hash = _hash(p_key);
+		int32_t pos = _find_pos(p_key, hash);
+
+		if (pos >= 0) {
+			values[pos] = p_data;
+			return;
+		}
+
+		_make_room();
+		_insert_new(p_key, hash, p_data);
+	}
+
+	bool has(const TKey &p_key) const {
+
+		return _find_pos(p_key, _hash(p_key)) >= 0;
+	}
+
+	/**
+	 * Get a key from data, return a const reference.
+	 * WARNING: this doesn't check errors, use either getptr and check NULL, or check
+	 * first with has(key)
+	 */
+
+	const TData &get(const TKey &p_key) const {
+
+		const TData *res = getptr(p_key);
+		ERR_FAIL_COND_V(!res, *res);
+		return *res;
+	}
+
+	TData &get(const TKey &p_key) {
+
+		TData *res = getptr(p_key);
+		ERR_FAIL_COND_V(!res, *res);
+		return *res;
+	}
+
+	/**
+	 * Same as get, except it can return NULL when item was not found.
+	 * This is mainly used for speed purposes.
+	 */
+
+	_FORCE_INLINE_ TData *getptr(const TKey &p_key) {
+
+		int32_t pos = _find_pos(p_key, _hash(p_key));
+		return pos >= 0 ? &values[pos] : NULL;
+	}
+
+	_FORCE_INLINE_ const TData *getptr(const TKey &p_key) const {
+
+		int32_t pos = _find_pos(p_key, _hash(p_key));
+		return pos >= 0 ? &values[pos] : NULL;
+	}
+
+	bool erase(const TKey &p_key) {
+
+		int32_t pos = _find_pos(p_key, _hash(p_key));
+		if (pos < 0) {
+			return false;
+		}
+
+		keys[pos].~TKey();
+		values[pos].~TData();
+		elements--;
+
+		if (_match(&ctrl[pos & ~(GROUP_SIZE - 1)], CTRL_EMPTY)) {
+			ctrl[pos] = CTRL_EMPTY;
+			growth_left++;
+		} else {
+			ctrl[pos] = CTRL_DELETED;
+		}
+
+		return true;
+	}
+
+	inline const TData &operator[](const TKey &p_key) const { //constref
+
+		return get(p_key);
+	}
+
+	inline TData &operator[](const TKey &p_key) { //assignment
+
+		uint32_t hash = _hash(p_key);
+		int32_t pos = _find_pos(p_key, hash);
+
+		if (pos < 0) {
+			_make_room();
+			pos = _insert_new(p_key, hash, TData());
+		}
+
+		return values[pos];
+	}
+
+	/**
+	 * Same iteration scheme as HashMap, except p_key must point into this
+	 * map, as returned by a previous call to next():
+	 *
+	 * 	const TKey *k=NULL;
+	 *
+	 * 	while( (k=table.next(k)) ) {
+	 *
+	 * 		print( *k );
+	 * 	}
+	 */
+	const TKey *next(const TKey *p_key) const {
+
+		uint32_t from = 0;
+		if (p_key) {
+			from = p_key - keys + 1;
+			ERR_FAIL_COND_V_MSG(from > capacity, NULL, "Invalid key supplied.");
+		}
+
+		for (uint32_t i = from; i < capacity; i++) {
+			if (!(ctrl[i] & CTRL_EMPTY)) {
+				return &keys[i];
+			}
+		}
+
+		return NULL;
+	}
+
+	inline unsigned int size() const {
+
+		return elements;
+	}
+
+	inline bool empty() const {
+
+		return elements == 0;
+	}
+
+	_FORCE_INLINE_ uint32_t get_capacity() const { return capacity; }
+
+	// Makes room for p_elements without further rehashes.
+	void reserve(uint32_t p_elements) {
+
+		uint32_t new_capacity = MAX(capacity, (uint32_t)GROUP_SIZE);
+		while (_max_load(new_capacity) < p_elements) {
+			new_capacity *= 2;
+		}
+
+		if (new_capacity != capacity) {
+			_rehash(new_capacity);
+		}
+	}
+
+	void clear() {
+
+		if (!capacity) {
+			return;
+		}
+
+		for (uint32_t i = 0; i < capacity; i++) {
+
+			if (ctrl[i] & CTRL_EMPTY) {
+				continue;
+			}
+
+			keys[i].~TKey();
+			values[i].~TData();
+		}
+
+		memfree(ctrl);
+		memfree(hashes);
+		memfree(keys);
+		memfree(values);
+
+		ctrl = NULL;
+		hashes = NULL;
+		keys = NULL;
+		values = NULL;
+		capacity = 0;
+		elements = 0;
+		growth_left = 0;
+	}
+
+	void get_key_list(List<TKey> *p_keys) const {
+
+		for (uint32_t i = 0; i < capacity; i++) {
+			if (!(ctrl[i] & CTRL_EMPTY)) {
+				p_keys->push_back(keys[i]);
+			}
+		}
+	}
+
+	void operator=(const FlatHashMap &p_map) {
+
+		if (&p_map == this) {
+			return;
+		}
+
+		clear();
+		_copy_from(p_map);
+	}
+
+	FlatHashMap(const FlatHashMap &p_map) {
+
+		ctrl = NULL;
+		hashes = NULL;
+		keys = NULL;
+		values = NULL;
+		capacity = 0;
+		elements = 0;
+		growth_left = 0;
+
+		_copy_from(p_map);
+	}
+
+	FlatHashMap() {
+
+		ctrl = NULL;
+		hashes = NULL;
+		keys = NULL;
+		values = NULL;
+		capacity = 0;
+		elements = 0;
+		growth_left = 0;
+	}
+
+	~FlatHashMap() {
+
+		clear();
+	}
+};
+
+#endif // FLAT_HASH_MAP_H
@@ -0,0 +1,441 @@
+/*************************************************************************/
+/*  batch_math.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "batch_math.h"
+
+#if !defined(REAL_T_IS_DOUBLE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define BATCH_MATH_SSE
+#include <emmintrin.h>
+#elif !defined(REAL_T_IS_DOUBLE) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define BATCH_MATH_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(BATCH_MATH_SSE) || defined(BATCH_MATH_NEON)
+#define BATCH_MATH_SIMD
+
+// Four floats (and a lane mask), just enough to write each kernel once for both instruction sets.
+
+#ifdef BATCH_MATH_SSE
+
+typedef __m128 float4;
+typedef __m128 mask4;
+
+static _FORCE_INLINE_ float4 f4_splat(float p_value) { return _mm_set1_ps(p_value); }
+static _FORCE_INLINE_ float4 f4_load(const float *p_src) { return _mm_loadu_ps(p_src); }
+static _FORCE_INLINE_ void f4_store(float *r_dst, float4 p_value) { _mm_storeu_ps(r_dst, p_value); }
+static _FORCE_INLINE_ float4 f4_add(float4 p_a, float4 p_b) { return _mm_add_ps(p_a, p_b); }
+static _FORCE_INLINE_ float4 f4_sub(float4 p_a, float4 p_b) { return _mm_sub_ps(p_a, p_b); }
+static _FORCE_INLINE_ float4 f4_mul(float4 p_a, float4 p_b) { return _mm_mul_ps(p_a, p_b); }
+static _FORCE_INLINE_ float4 f4_min(float4 p_a, float4 p_b) { return _mm_min_ps(p_a, p_b); }
+static _FORCE_INLINE_ float4 f4_max(float4 p_a, float4 p_b) { return _mm_max_ps(p_a, p_b); }
+static _FORCE_INLINE_ mask4 f4_greater(float4 p_a, float4 p_b) { return _mm_cmpgt_ps(p_a, p_b); }
+static _FORCE_INLINE_ mask4 m4_none() { return _mm_setzero_ps(); }
+static _FORCE_INLINE_ mask4 m4_or(mask4 p_a, mask4 p_b) { return _mm_or_ps(p_a, p_b); }
+static _FORCE_INLINE_ int m4_bits(mask4 p_mask) { return _mm_movemask_ps(p_mask); }
+
+// Vector3 arrays are x,y,z interleaved, shuffle four of them to and from one register per axis.
+static _FORCE_INLINE_ void f4_load3(const Vector3 *p_src, float4 &r_x, float4 &r_y, float4 &r_z) {
+
+	const float *src = (const float *)p_src;
+	__m128 a = _mm_loadu_ps(src); // x0 y0 z0 x1
+	__m128 b = _mm_loadu_ps(src + 4); // y1 z1 x2 y2
+	__m128 c = _mm_loadu_ps(src + 8); // z2 x3 y3 z3
+
+	r_x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+	r_y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 2, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	r_z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 1, 0, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static _FORCE_INLINE_ void f4_store3(Vector3 *r_dst, float4 p_x, float4 p_y, float4 p_z) {
+
+	__m128 xy_lo = _mm_unpacklo_ps(p_x, p_y); // x0 y0 x1 y1
+	__m128 xy_hi = _mm_unpackhi_ps(p_x, p_y); // x2 y2 x3 y3
+
+	float *dst = (float *)r_dst;
+	_mm_storeu_ps(dst, _mm_shuffle_ps(xy_lo, _mm_shuffle_ps(p_z, xy_lo, _MM_SHUFFLE(0, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0)));
+	_mm_storeu_ps(dst + 4, _mm_shuffle_ps(_mm_shuffle_ps(xy_lo, p_z, _MM_SHUFFLE(0, 1, 0, 3)), xy_hi, _MM_SHUFFLE(1, 0, 2, 0)));
+	_mm_storeu_ps(dst + 8, _mm_shuffle_ps(_mm_shuffle_ps(p_z, xy_hi, _MM_SHUFFLE(0, 2, 0, 2)), _mm_shuffle_ps(xy_hi, p_z, _MM_SHUFFLE(0, 3, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+#else // BATCH_MATH_NEON
+
+typedef float32x4_t float4;
+typedef uint32x4_t mask4;
+
+static _FORCE_INLINE_ float4 f4_splat(float p_value) { return vdupq_n_f32(p_value); }
+static _FORCE_INLINE_ float4 f4_load(const float *p_src) { return vld1q_f32(p_src); }
+static _FORCE_INLINE_ void f4_store(float *r_dst, float4 p_value) { vst1q_f32(r_dst, p_value); }
+static _FORCE_INLINE_ float4 f4_add(float4 p_a, float4 p_b) { return vaddq_f32(p_a, p_b); }
+static _FORCE_INLINE_ float4 f4_sub(float4 p_a, float4 p_b) { return vsubq_f32(p_a, p_b); }
+static _FORCE_INLINE_ float4 f4_mul(float4 p_a, float4 p_b) { return vmulq_f32(p_a, p_b); }
+static _FORCE_INLINE_ float4 f4_min(float4 p_a, float4 p_b) { return vminq_f32(p_a, p_b); }
+static _FORCE_INLINE_ float4 f4_max(float4 p_a, float4 p_b) { return vmaxq_f32(p_a, p_b); }
+static _FORCE_INLINE_ mask4 f4_greater(float4 p_a, float4 p_b) { return vcgtq_f32(p_a, p_b); }
+static _FORCE_INLINE_ mask4 m4_none() { return vdupq_n_u32(0); }
+static _FORCE_INLINE_ mask4 m4_or(mask4 p_a, mask4 p_b) { return vorrq_u32(p_a, p_b); }
+static _FORCE_INLINE_ int m4_bits(mask4 p_mask) {
+	return (vgetq_lane_u32(p_mask, 0) & 1) | (vgetq_lane_u32(p_mask, 1) & 2) | (vgetq_lane_u32(p_mask, 2) & 4) | (vgetq_lane_u32(p_mask, 3) & 8);
+}
+
+static _FORCE_INLINE_ void f4_load3(const Vector3 *p_src, float4 &r_x, float4 &r_y, float4 &r_z) {
+
+	float32x4x3_t v = vld3q_f32((const float *)p_src);
+	r_x = v.val[0];
+	r_y = v.val[1];
+	r_z = v.val[2];
+}
+
+static _FORCE_INLINE_ void f4_store3(Vector3 *r_dst, float4 p_x, float4 p_y, float4 p_z) {
+
+	float32x4x3_t v;
+	v.val[0] = p_x;
+	v.val[1] = p_y;
+	v.val[2] = p_z;
+	vst3q_f32((float *)r_dst, v);
+}
+
+#endif
+
+static _FORCE_INLINE_ float4 f4_madd(float4 p_a, float4 p_b, float4 p_c) {
+	return f4_add(f4_mul(p_a, p_b), p_c);
+}
+
+#endif // BATCH_MATH_SSE || BATCH_MATH_NEON
+
+void BatchMath::transform_points(const Transform &p_xform, const Vector3 *p_src, Vector3 *r_dst, int p_count) {
+
+	int i = 0;
+
+#ifdef BATCH_MATH_SIMD
+	const Vector3 *rows = p_xform.basis.elements;
+	float4 m00 = f4_splat(rows[0].x), m01 = f4_splat(rows[0].y), m02 = f4_splat(rows[0].z);
+	float4 m10 = f4_splat(rows[1].x), m11 = f4_splat(rows[1].y), m12 = f4_splat(rows[1].z);
+	float4 m20 = f4_splat(rows[2].x), m21 = f4_splat(rows[2].y), m22 = f4_splat(rows[2].z);
+	float4 ox = f4_splat(p_xform.origin.x), oy = f4_splat(p_xform.origin.y), oz = f4_splat(p_xform.origin.z);
+
+	for (; i + 4 <= p_count; i += 4) {
+
+		float4 x, y, z;
+		f4_load3(p_src + i, x, y, z);
+
+		float4 rx = f4_add(f4_madd(z, m02, f4_madd(y, m01, f4_mul(x, m00))), ox);
+		float4 ry = f4_add(f4_madd(z, m12, f4_madd(y, m11, f4_mul(x, m10))), oy);
+		float4 rz = f4_add(f4_madd(z, m22, f4_madd(y, m21, f4_mul(x, m20))), oz);
+
+		f4_store3(r_dst + i, rx, ry, rz);
+	}
+#endif
+
+	for (; i < p_count; i++) {
+		r_dst[i] = p_xform.xform(p_src[i]);
+	}
+}
+
+void BatchMath::transform_vectors(const Basis &p_basis, const Vector3 *p_src, Vector3 *r_dst, int p_count) {
+
+	int i = 0;
+
+#ifdef BATCH_MATH_SIMD
+	const Vector3 *rows = p_basis.elements;
+	float4 m00 = f4_splat(rows[0].x), m01 = f4_splat(rows[0].y), m02 = f4_splat(rows[0].z);
+	float4 m10 = f4_splat(rows[1].x), m11 = f4_splat(rows[1].y), m12 = f4_splat(rows[1].z);
+	float4 m20 = f4_splat(rows[2].x), m21 = f4_splat(rows[2].y), m22 = f4_splat(rows[2].z);
+
+	for (; i + 4 <= p_count; i += 4) {
+
+		float4 x, y, z;
+		f4_load3(p_src + i, x, y, z);
+
+		float4 rx = f4_madd(z, m02, f4_madd(y, m01, f4_mul(x, m00)));
+		float4 ry = f4_madd(z, m12, f4_madd(y, m11, f4_mul(x, m10)));
+		float4 rz = f4_madd(z, m22, f4_madd(y, m21, f4_mul(x, m20)));
+
+		f4_store3(r_dst + i, rx, ry, rz);
+	}
+#endif
+
+	for (; i < p_count; i++) {
+		r_dst[i] = p_basis.xform(p_src[i]);
+	}
+}
+
+AABB BatchMath::get_bounds(const Vector3 *p_points, int p_count) {
+
+	if (p_count <= 0) {
+		return AABB();
+	}
+
+	Vector3 min = p_points[0];
+	Vector3 max = p_points[0];
+	int i = 1;
+
+#ifdef BATCH_MATH_SIMD
+	if (p_count >= 4) {
+
+		float4 min_x, min_y, min_z;
+		f4_load3(p_points, min_x, min_y, min_z);
+		float4 max_x = min_x, max_y = min_y, max_z = min_z;
+
+		for (i = 4; i + 4 <= p_count; i += 4) {
+
+			float4 x, y, z;
+			f4_load3(p_points + i, x, y, z);
+
+			min_x = f4_min(min_x, x);
+			min_y = f4_min(min_y, y);
+			min_z = f4_min(min_z, z);
+			max_x = f4_max(max_x, x);
+			max_y = f4_max(max_y, y);
+			max_z = f4_max(max_z, z);
+		}
+
+		Vector3 lane_min[4];
+		Vector3 lane_max[4];
+		f4_store3(lane_min, min_x, min_y, min_z);
+		f4_store3(lane_max, max_x, max_y, max_z);
+
+		for (int j = 0; j < 4; j++) {
+			min.x = MIN(min.x, lane_min[j].x);
+			min.y = MIN(min.y, lane_min[j].y);
+			min.z = MIN(min.z, lane_min[j].z);
+			max.x = MAX(max.x, lane_max[j].x);
+			max.y = MAX(max.y, lane_max[j].y);
+			max.z = MAX(max.z, lane_max[j].z);
+		}
+	}
+#endif
+
+	for (; i < p_count; i++) {
+
+		const Vector3 &p = p_points[i];
+		min.x = MIN(min.x, p.x);
+		min.y = MIN(min.y, p.y);
+		min.z = MIN(min.z, p.z);
+		max.x = MAX(max.x, p.x);
+		max.y = MAX(max.y, p.y);
+		max.z = MAX(max.z, p.z);
+	}
+
+	return AABB(min, max - min);
+}
+
+AABB BatchMath::merge_aabbs(const AABB *p_aabbs, int p_count) {
+
+	if (p_count <= 0) {
+		return AABB();
+	}
+
+	Vector3 min = p_aabbs[0].position;
+	Vector3 max = p_aabbs[0].position + p_aabbs[0].size;
+	int i = 1;
+
+#ifdef BATCH_MATH_SIMD
+	if (p_count >= 4) {
+
+		float4 min_x = f4_splat(min.x), min_y = f4_splat(min.y), min_z = f4_splat(min.z);
+		float4 max_x = f4_splat(max.x), max_y = f4_splat(max.y), max_z = f4_splat(max.z);
+
+		for (; i + 4 <= p_count; i += 4) {
+
+			Vector3 begins[4];
+			Vector3 ends[4];
+			for (int k = 0; k < 4; k++) {
+				begins[k] = p_aabbs[i + k].position;
+				ends[k] = p_aabbs[i + k].position + p_aabbs[i + k].size;
+			}
+
+			float4 x, y, z;
+			f4_load3(begins, x, y, z);
+			min_x = f4_min(min_x, x);
+			min_y = f4_min(min_y, y);
+			min_z = f4_min(min_z, z);
+
+			f4_load3(ends, x, y, z);
+			max_x = f4_max(max_x, x);
+			max_y = f4_max(max_y, y);
+			max_z = f4_max(max_z, z);
+		}
+
+		Vector3 lane_min[4];
+		Vector3 lane_max[4];
+		f4_store3(lane_min, min_x, min_y, min_z);
+		f4_store3(lane_max, max_x, max_y, max_z);
+
+		for (int j = 0; j < 4; j++) {
+			min.x = MIN(min.x, lane_min[j].x);
+			min.y = MIN(min.y, lane_min[j].y);
+			min.z = MIN(min.z, lane_min[j].z);
+			max.x = MAX(max.x, lane_max[j].x);
+			max.y = MAX(max.y, lane_max[j].y);
+			max.z = MAX(max.z, lane_max[j].z);
+		}
+	}
+#endif
+
+	for (; i < p_count; i++) {
+
+		Vector3 begin = p_aabbs[i].position;
+		Vector3 end = p_aabbs[i].position + p_aabbs[i].size;
+		min.x = MIN(min.x, begin.x);
+		min.y = MIN(min.y, begin.y);
+		min.z = MIN(min.z, begin.z);
+		max.x = MAX(max.x, end.x);
+		max.y = MAX(max.y, end.y);
+		max.z = MAX(max.z, end.z);
+	}
+
+	return AABB(min, max - min);
+}
+
+void BatchMath::get_plane_distances(const Plane &p_plane, const Vector3 *p_points, real_t *r_distances, int p_count) {
+
+	int i = 0;
+
+#ifdef BATCH_MATH_SIMD
+	float4 nx = f4_splat(p_plane.normal.x), ny = f4_splat(p_plane.normal.y), nz = f4_splat(p_plane.normal.z);
+	float4 d = f4_splat(p_plane.d);
+
+	for (; i + 4 <= p_count; i += 4) {
+
+		float4 x, y, z;
+		f4_load3(p_points + i, x, y, z);
+		f4_store(r_distances + i, f4_sub(f4_madd(z, nz, f4_madd(y, ny, f4_mul(x, nx))), d));
+	}
+#endif
+
+	for (; i < p_count; i++) {
+		r_distances[i] = p_plane.distance_to(p_points[i]);
+	}
+}
+
+int BatchMath::cull_points(const Plane *p_planes, int p_plane_count, const Vector3 *p_points, int p_count, uint8_t *r_inside) {
+
+	int inside_count = 0;
+	int i = 0;
+
+#ifdef BATCH_MATH_SIMD
+	for (; i + 4 <= p_count; i += 4) {
+
+		float4 x, y, z;
+		f4_load3(p_points + i, x, y, z);
+
+		mask4 outside = m4_none();
+		for (int j = 0; j < p_plane_count; j++) {
+
+			const Plane &p = p_planes[j];
+			float4 dist = f4_madd(z, f4_splat(p.normal.z), f4_madd(y, f4_splat(p.normal.y), f4_mul(x, f4_splat(p.normal.x))));
+			outside = m4_or(outside, f4_greater(dist, f4_splat(p.d)));
+		}
+
+		int bits = m4_bits(outside);
+		for (int k = 0; k < 4; k++) {
+			bool inside = !(bits & (1 << k));
+			r_inside[i + k] = inside;
+			inside_count += inside;
+		}
+	}
+#endif
+
+	for (; i < p_count; i++) {
+
+		bool inside = true;
+		for (int j = 0; j < p_plane_count; j++) {
+			if (p_planes[j].is_point_over(p_points[i])) {
+				inside = false;
+				break;
+			}
+		}
+		r_inside[i] = inside;
+		inside_count += inside;
+	}
+
+	return inside_count;
+}
+
+int BatchMath::cull_aabbs(const Plane *p_planes, int p_plane_count, const AABB *p_aabbs, int p_count, uint8_t *r_inside) {
+
+	int inside_count = 0;
+	int i = 0;
+
+#ifdef BATCH_MATH_SIMD
+	for (; i + 4 <= p_count; i += 4) {
+
+		// A box is outside a plane when even its corner furthest against the
+		// normal is over it: dot(n, center) - dot(abs(n), half_extents) > d.
+		Vector3 centers[4];
+		Vector3 extents[4];
+		for (int k = 0; k < 4; k++) {
+			extents[k] = p_aabbs[i + k].size * 0.5;
+			centers[k] = p_aabbs[i + k].position + extents[k];
+		}
+
+		float4 cx, cy, cz, hx, hy, hz;
+		f4_load3(centers, cx, cy, cz);
+		f4_load3(extents, hx, hy, hz);
+
+		mask4 outside = m4_none();
+		for (int j = 0; j < p_plane_count; j++) {
+
+			const Plane &p = p_planes[j];
+			float4 dist = f4_madd(cz, f4_splat(p.normal.z), f4_madd(cy, f4_splat(p.normal.y), f4_mul(cx, f4_splat(p.normal.x))));
+			float4 radius = f4_madd(hz, f4_splat(Math::abs(p.normal.z)), f4_madd(hy, f4_splat(Math::abs(p.normal.y)), f4_mul(hx, f4_splat(Math::abs(p.normal.x)))));
+			outside = m4_or(outside, f4_greater(f4_sub(dist, radius), f4_splat(p.d)));
+		}
+
+		int bits = m4_bits(outside);
+		for (int k = 0; k < 4; k++) {
+			bool inside = !(bits & (1 << k));
+			r_inside[i + k] = inside;
+			inside_count += inside;
+		}
+	}
+#endif
+
+	for (; i < p_count; i++) {
+
+		bool inside = p_aabbs[i].intersects_convex_shape(p_planes, p_plane_count);
+		r_inside[i] = inside;
+		inside_count += inside;
+	}
+
+	return inside_count;
+}
+
+const char *BatchMath::get_backend_name() {
+
+#if defined(BATCH_MATH_SSE)
+	return "SSE2";
+#elif defined(BATCH_MATH_NEON)
+	return "NEON";
+#else
+	return "Scalar";
+#endif
+}
@@ -0,0 +1,63 @@
+/*************************************************************************/
+/*  batch_math.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BATCH_MATH_H
+#define BATCH_MATH_H
+
+#include "core/math/aabb.h"
+#include "core/math/plane.h"
+#include "core/math/transform.h"
+
+// Math over arrays of points, boxes and planes.
+// Uses SSE2 or NEON when available (and real_t is float), processing four
+// elements per step, with a scalar fallback computing the same results.
+// Source and destination arrays may be the same.
+
+class BatchMath {
+public:
+	static void transform_points(const Transform &p_xform, const Vector3 *p_src, Vector3 *r_dst, int p_count);
+	static void transform_vectors(const Basis &p_basis, const Vector3 *p_src, Vector3 *r_dst, int p_count);
+
+	// Smallest AABB containing all points, empty AABB if there are none.
+	static AABB get_bounds(const Vector3 *p_points, int p_count);
+	// Same as merging the boxes one by one with AABB::merge(), empty AABB if there are none.
+	static AABB merge_aabbs(const AABB *p_aabbs, int p_count);
+
+	static void get_plane_distances(const Plane &p_plane, const Vector3 *p_points, real_t *r_distances, int p_count);
+
+	// Set r_inside[i] to 1 if the element is inside (or, for boxes, intersects)
+	// the convex volume bounded by the planes, 0 otherwise. Returns how many are.
+	static int cull_points(const Plane *p_planes, int p_plane_count, const Vector3 *p_points, int p_count, uint8_t *r_inside);
+	static int cull_aabbs(const Plane *p_planes, int p_plane_count, const AABB *p_aabbs, int p_count, uint8_t *r_inside);
+
+	static const char *get_backend_name();
+};
+
+#endif // BATCH_MATH_H
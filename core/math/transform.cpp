@@ -30,6 +30,7 @@
 
 #include "transform.h"
 
+#include "core/math/batch_math.h"
 #include "core/math/math_funcs.h"
 #include "core/os/copymem.h"
 #include "core/print_string.h"
@@ -209,6 +210,31 @@ Transform Transform::operator*(const Transform &p_transform) const {
 	return t;
 }
 
+PoolVector<Vector3> Transform::xform(const PoolVector<Vector3> &p_array) const {
+
+	PoolVector<Vector3> array;
+	array.resize(p_array.size());
+
+	PoolVector<Vector3>::Read r = p_array.read();
+	PoolVector<Vector3>::Write w = array.write();
+
+	BatchMath::transform_points(*this, r.ptr(), w.ptr(), p_array.size());
+	return array;
+}
+
+PoolVector<Vector3> Transform::xform_inv(const PoolVector<Vector3> &p_array) const {
+
+	PoolVector<Vector3> array;
+	array.resize(p_array.size());
+
+	PoolVector<Vector3>::Read r = p_array.read();
+	PoolVector<Vector3>::Write w = array.write();
+
+	// xform_inv() is transpose(basis) * (v - origin), which is itself a transform.
+	BatchMath::transform_points(Transform(basis.transposed(), basis.xform_inv(-origin)), r.ptr(), w.ptr(), p_array.size());
+	return array;
+}
+
 Transform::operator String() const {
 
 	return basis.operator String() + " - " + origin.operator String();
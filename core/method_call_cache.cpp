@@ -0,0 +1,217 @@
+/*************************************************************************/
+/*  method_call_cache.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "method_call_cache.h"
+
+#include "core/class_db.h"
+#include "core/object.h"
+#include "core/safe_refcount.h"
+#include "core/script_language.h"
+
+void *MethodCallCache::_add_entry(const void *p_class_key, Variant::Type p_builtin_type, void *p_target) const {
+
+	GLOBAL_LOCK_FUNCTION
+
+	if (entry_count >= MAX_ENTRIES) {
+		return p_target;
+	}
+
+	Entry *entry = memnew(Entry);
+	entry->class_key = p_class_key;
+	entry->builtin_type = p_builtin_type;
+	entry->target = p_target;
+	entry->next = entries;
+
+	// Readers don't lock, the entry must be complete before it's reachable.
+	atomic_release_fence();
+	entries = entry;
+	entry_count++;
+
+	return p_target;
+}
+
+void MethodCallCache::_clear() {
+
+	Entry *entry = entries;
+	while (entry) {
+		Entry *next = entry->next;
+		memdelete(entry);
+		entry = next;
+	}
+
+	entries = NULL;
+	entry_count = 0;
+
+	script_method = NULL;
+	script_method_version = 0;
+}
+
+void MethodCallCache::set_method(const StringName &p_method) {
+
+	if (method == p_method) {
+		return;
+	}
+
+	_clear();
+	method = p_method;
+}
+
+MethodBind *MethodCallCache::get_method_bind(const StringName &p_class) const {
+
+	const void *class_key = p_class.data_unique_pointer();
+
+	Entry *entry = entries;
+	atomic_acquire_fence();
+
+	while (entry) {
+		if (entry->class_key == class_key && entry->builtin_type == Variant::OBJECT) {
+			return (MethodBind *)entry->target;
+		}
+		entry = entry->next;
+	}
+
+	// Megamorphic sites don't look the class up anymore, Object::call() does that.
+	if (_is_full()) {
+		return NULL;
+	}
+
+	// Classes overriding Object::call() may handle the method themselves first.
+	MethodBind *method_bind = ClassDB::class_overrides_call(p_class) ? NULL : ClassDB::get_method(p_class, method);
+	return (MethodBind *)_add_entry(class_key, Variant::OBJECT, method_bind);
+}
+
+bool MethodCallCache::_get_script_method(ScriptInstance *p_instance, const void **r_method) const {
+
+	uint64_t version = p_instance->get_method_version();
+	if (!version) {
+		return false;
+	}
+
+	if (script_method_version == version) {
+		atomic_acquire_fence();
+		const void *cached = script_method;
+		atomic_acquire_fence();
+		if (script_method_version == version) {
+			*r_method = cached;
+			return true;
+		}
+	}
+
+	const void *resolved = p_instance->resolve_method(method);
+
+	// Only one writer at a time, the others just don't cache what they resolved.
+	if (atomic_increment(&script_method_writers) == 1) {
+		script_method_version = 0;
+		atomic_release_fence();
+		script_method = resolved;
+		atomic_release_fence();
+		script_method_version = version;
+	}
+	atomic_decrement(&script_method_writers);
+
+	*r_method = resolved;
+	return true;
+}
+
+Variant MethodCallCache::call(Object *p_object, const Variant **p_args, int p_argcount, Variant::CallError &r_error) const {
+
+	// Scripts get the first chance at handling the call, methods they don't
+	// have fall back to the class like in Object::call().
+	ScriptInstance *script_instance = p_object->get_script_instance();
+	if (script_instance) {
+		const void *script_method;
+		if (!_get_script_method(script_instance, &script_method)) {
+			return p_object->call(method, p_args, p_argcount, r_error);
+		}
+		if (script_method) {
+			return p_object->_call_script_method(script_method, p_args, p_argcount, r_error);
+		}
+	}
+
+	// Methods ClassDB doesn't know about (free()) or classes overriding call()
+	// (GDScript for its static functions, JavaClass) take the regular path.
+	MethodBind *method_bind = get_method_bind(p_object->get_class_name());
+	if (method_bind) {
+		return p_object->_call_method_bind(method_bind, p_args, p_argcount, r_error);
+	}
+
+	return p_object->call(method, p_args, p_argcount, r_error);
+}
+
+bool MethodCallCache::_get_builtin_method(Variant::Type p_type, void **r_target) const {
+
+	Entry *entry = entries;
+	atomic_acquire_fence();
+
+	while (entry) {
+		if (entry->builtin_type == p_type && !entry->class_key) {
+			*r_target = entry->target;
+			return true;
+		}
+		entry = entry->next;
+	}
+
+	if (_is_full()) {
+		return false;
+	}
+
+	*r_target = _add_entry(NULL, p_type, _find_builtin_method(p_type, method));
+	return true;
+}
+
+void MethodCallCache::operator=(const MethodCallCache &p_from) {
+
+	set_method(p_from.method);
+}
+
+MethodCallCache::MethodCallCache(const MethodCallCache &p_from) {
+
+	entries = NULL;
+	entry_count = 0;
+	script_method = NULL;
+	script_method_version = 0;
+	script_method_writers = 0;
+	method = p_from.method;
+}
+
+MethodCallCache::MethodCallCache(const StringName &p_method) {
+
+	entries = NULL;
+	entry_count = 0;
+	script_method = NULL;
+	script_method_version = 0;
+	script_method_writers = 0;
+	method = p_method;
+}
+
+MethodCallCache::~MethodCallCache() {
+
+	_clear();
+}
@@ -0,0 +1,105 @@
+/*************************************************************************/
+/*  method_call_cache.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef METHOD_CALL_CACHE_H
+#define METHOD_CALL_CACHE_H
+
+#include "core/variant.h"
+
+class MethodBind;
+class Object;
+class ScriptInstance;
+
+// Call site cache for dynamic calls by name.
+// It remembers which MethodBind (or builtin function) the method resolved to
+// for the last few receiver classes (or builtin types), so calling it again
+// on one of them skips the ClassDB or builtin method lookup.
+// Lookups don't lock and a cache can be shared by several threads. Sites that
+// see more than MAX_ENTRIES receiver types stop caching new ones, and calls
+// on other types take the regular uncached path without locking.
+// Scripted receivers keep the script method resolved for the last instance
+// called, as long as the instance reports the same method version.
+
+class MethodCallCache {
+
+	enum {
+		MAX_ENTRIES = 4
+	};
+
+	struct Entry {
+		const void *class_key; // Class name of object receivers, NULL for builtin ones.
+		Variant::Type builtin_type;
+		void *target; // MethodBind, or builtin method data. NULL if there is no such method.
+		Entry *next;
+	};
+
+	StringName method;
+	// Filled lazily, even through const references.
+	mutable Entry *volatile entries;
+	mutable volatile uint32_t entry_count;
+
+	mutable const void *volatile script_method;
+	mutable volatile uint64_t script_method_version; // 0 while script_method is being written.
+	mutable volatile uint32_t script_method_writers;
+
+	_FORCE_INLINE_ bool _is_full() const { return entry_count >= MAX_ENTRIES; }
+
+	void *_add_entry(const void *p_class_key, Variant::Type p_builtin_type, void *p_target) const;
+	void _clear();
+
+	// False if the type isn't cached and the cache is full, the call must go through Variant::call_ptr() then.
+	bool _get_builtin_method(Variant::Type p_type, void **r_target) const;
+
+	// False if the script language can't resolve methods, the call must go through Object::call() then.
+	// Otherwise r_method is NULL if the script doesn't have the method.
+	bool _get_script_method(ScriptInstance *p_instance, const void **r_method) const;
+
+	static void *_find_builtin_method(Variant::Type p_type, const StringName &p_method);
+
+public:
+	void set_method(const StringName &p_method);
+	_FORCE_INLINE_ const StringName &get_method() const { return method; }
+
+	// What the method resolves to for an object of class p_class. NULL if no such method, if
+	// the class overrides Object::call(), or if the cache is full, the call must go through it then.
+	MethodBind *get_method_bind(const StringName &p_class) const;
+
+	// Same as Object::call() and Variant::call_ptr(), with the method looked up through the cache.
+	Variant call(Object *p_object, const Variant **p_args, int p_argcount, Variant::CallError &r_error) const;
+	void call_ptr(Variant &p_base, const Variant **p_args, int p_argcount, Variant *r_ret, Variant::CallError &r_error) const;
+
+	void operator=(const MethodCallCache &p_from);
+
+	MethodCallCache(const MethodCallCache &p_from);
+	explicit MethodCallCache(const StringName &p_method = StringName());
+	~MethodCallCache();
+};
+
+#endif // METHOD_CALL_CACHE_H
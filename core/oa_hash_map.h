@@ -78,8 +78,8 @@ private:
 	}
 
 	_FORCE_INLINE_ void _construct(uint32_t p_pos, uint32_t p_hash, const TKey &p_key, const TValue &p_value) {
-		memnew_placement(&keys[p_pos], TKey(p_key));
-		memnew_placement(&values[p_pos], TValue(p_value));
+		keys[p_pos] = p_key;
+		values[p_pos] = p_value;
 		hashes[p_pos] = p_hash;
 
 		num_elements++;
@@ -191,8 +191,8 @@ public:
 			}
 
 			hashes[i] = EMPTY_HASH;
-			values[i].~TValue();
-			keys[i].~TKey();
+			values[i] = TValue();
+			keys[i] = TKey();
 		}
 
 		num_elements = 0;
@@ -263,9 +263,10 @@ public:
 			next_pos = (pos + 1) % capacity;
 		}
 
+		// The arrays hold constructed objects, reset them instead of destroying them twice.
 		hashes[pos] = EMPTY_HASH;
-		values[pos].~TValue();
-		keys[pos].~TKey();
+		values[pos] = TValue();
+		keys[pos] = TKey();
 
 		num_elements--;
 	}
@@ -926,6 +926,22 @@ Variant Object::call(const StringName &p_method, const Variant **p_args, int p_a
 	return ret;
 }
 
+Variant Object::_call_method_bind(MethodBind *p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
+
+	r_error.error = Variant::CallError::CALL_OK;
+
+	OBJ_DEBUG_LOCK
+	return p_method->call(this, p_args, p_argcount, r_error);
+}
+
+Variant Object::_call_script_method(const void *p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
+
+	r_error.error = Variant::CallError::CALL_OK;
+
+	OBJ_DEBUG_LOCK
+	return script_instance->call_resolved(p_method, p_args, p_argcount, r_error);
+}
+
 void Object::notification(int p_notification, bool p_reversed) {
 
 	_notificationv(p_notification, p_reversed);
@@ -1166,28 +1182,36 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 		return ERR_UNAVAILABLE;
 	}
 
+	s->emission_count++;
+
 	List<_ObjectSignalDisconnectData> disconnect_data;
 
 	//copy on write will ensure that disconnecting the signal or even deleting the object will not affect the signal calling.
 	//this happens automatically and will not change the performance of calling.
 	//awesome, isn't it?
-	VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map;
+	//it's only read through const accessors, so it keeps sharing the slots (and the methods they resolved)
+	//until a connection is added or removed.
+	const VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map;
 
 	int ssize = slot_map.size();
+	const VMap<Signal::Target, Signal::Slot>::Pair *slots = slot_map.get_array();
 
 	OBJ_DEBUG_LOCK
 
-	Vector<const Variant *> bind_mem;
+	// Arguments plus binds, grown on the stack only when a connection needs more room.
+	const Variant **bind_args = NULL;
+	int bind_args_size = 0;
 
 	Error err = OK;
 
 	for (int i = 0; i < ssize; i++) {
 
-		const Connection &c = slot_map.getv(i).conn;
+		const Signal::Slot &slot = slots[i].value;
+		const Connection &c = slot.conn;
 
 		Object *target;
 #ifdef DEBUG_ENABLED
-		target = ObjectDB::get_instance(slot_map.getk(i)._id);
+		target = ObjectDB::get_instance(slots[i].key._id);
 		ERR_CONTINUE(!target);
 #else
 		target = c.target;
@@ -1198,24 +1222,27 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 
 		if (c.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount + c.binds.size());
+			argc = p_argcount + c.binds.size();
+			if (argc > bind_args_size) {
+				bind_args = (const Variant **)alloca(sizeof(Variant *) * argc);
+				bind_args_size = argc;
+			}
 
 			for (int j = 0; j < p_argcount; j++) {
-				bind_mem.write[j] = p_args[j];
+				bind_args[j] = p_args[j];
 			}
 			for (int j = 0; j < c.binds.size(); j++) {
-				bind_mem.write[p_argcount + j] = &c.binds[j];
+				bind_args[p_argcount + j] = &c.binds[j];
 			}
 
-			args = (const Variant **)bind_mem.ptr();
-			argc = bind_mem.size();
+			args = bind_args;
 		}
 
 		if (c.flags & CONNECT_DEFERRED) {
 			MessageQueue::get_singleton()->push_call(target->get_instance_id(), c.method, args, argc, true);
 		} else {
 			Variant::CallError ce;
-			target->call(c.method, args, argc, ce);
+			slot.method_cache.call(target, args, argc, ce);
 
 			if (ce.error != Variant::CallError::CALL_OK) {
 #ifdef DEBUG_ENABLED
@@ -1426,6 +1453,12 @@ void Object::get_signals_connected_to_this(List<Connection> *p_connections) cons
 	}
 }
 
+uint64_t Object::get_signal_emission_count(const StringName &p_signal) const {
+
+	const Signal *s = signal_map.getptr(p_signal);
+	return s ? s->emission_count : 0;
+}
+
 Error Object::connect(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method, const Vector<Variant> &p_binds, uint32_t p_flags) {
 
 	ERR_FAIL_NULL_V(p_to_object, ERR_INVALID_PARAMETER);
@@ -1476,6 +1509,7 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 	conn.binds = p_binds;
 	slot.conn = conn;
 	slot.cE = p_to_object->connections.push_back(conn);
+	slot.method_cache.set_method(p_to_method);
 	if (p_flags & CONNECT_REFERENCE_COUNTED) {
 		slot.reference_count = 1;
 	}
@@ -1992,17 +2026,153 @@ void postinitialize_handler(Object *p_object) {
 	p_object->_postinitialize();
 }
 
-HashMap<ObjectID, Object *> ObjectDB::instances;
-ObjectID ObjectDB::instance_counter = 1;
-HashMap<Object *, ObjectID, ObjectDB::ObjectPtrHash> ObjectDB::instance_checks;
+ObjectDB::Slot *ObjectDB::slot_blocks[ObjectDB::OBJECTDB_BLOCK_COUNT];
+volatile uint32_t ObjectDB::slot_max = 0;
+uint32_t ObjectDB::slot_free_list = ObjectDB::OBJECTDB_SLOT_FREE_END;
+uint32_t ObjectDB::slot_count = 0;
+ObjectDB::PointerIndex *volatile ObjectDB::pointer_index = NULL;
+volatile uint32_t ObjectDB::pointer_index_version = 0;
+
+ObjectDB::PointerIndex *ObjectDB::_create_pointer_index(uint32_t p_size) {
+
+	PointerIndex *index = memnew(PointerIndex);
+	index->mask = p_size - 1;
+	index->entries = memnew_arr(uint32_t, p_size);
+	memset(index->entries, 0, sizeof(uint32_t) * p_size);
+	index->retired = NULL;
+	return index;
+}
+
+void ObjectDB::_pointer_index_insert(PointerIndex *p_index, uint32_t p_slot) {
+
+	uint32_t pos = _hash_pointer(_get_slot_object(p_slot)) & p_index->mask;
+	while (p_index->entries[pos]) {
+		pos = (pos + 1) & p_index->mask;
+	}
+	p_index->entries[pos] = p_slot + 1;
+}
+
+void ObjectDB::_pointer_index_remove(PointerIndex *p_index, uint32_t p_slot) {
+
+	uint32_t pos = _hash_pointer(_get_slot_object(p_slot)) & p_index->mask;
+	while (p_index->entries[pos] != p_slot + 1) {
+		ERR_FAIL_COND(p_index->entries[pos] == 0);
+		pos = (pos + 1) & p_index->mask;
+	}
+
+	// Shift back the entries after it, so there's no need for tombstones.
+	uint32_t next = pos;
+	while (true) {
+		next = (next + 1) & p_index->mask;
+		uint32_t entry = p_index->entries[next];
+		if (!entry) {
+			break;
+		}
+		uint32_t home = _hash_pointer(_get_slot_object(entry - 1)) & p_index->mask;
+		bool stays = pos <= next ? (pos < home && home <= next) : (pos < home || home <= next);
+		if (!stays) {
+			p_index->entries[pos] = entry;
+			pos = next;
+		}
+	}
+	p_index->entries[pos] = 0;
+}
+
+bool ObjectDB::instance_validate(Object *p_ptr) {
+
+	if (unlikely(!p_ptr)) {
+		return false;
+	}
+
+	uint32_t hash = _hash_pointer(p_ptr);
+	while (true) {
+
+		uint32_t version = pointer_index_version;
+		atomic_acquire_fence();
+		if (version & 1) {
+			atomic_cpu_pause();
+			continue;
+		}
+
+		bool found = false;
+		const PointerIndex *index = pointer_index;
+		if (index) {
+			uint32_t pos = hash & index->mask;
+			for (uint32_t i = 0; i <= index->mask; i++) {
+				uint32_t entry = index->entries[pos];
+				if (!entry) {
+					break;
+				}
+				if (_get_slot_object(entry - 1) == p_ptr) {
+					found = true;
+					break;
+				}
+				pos = (pos + 1) & index->mask;
+			}
+		}
+
+		atomic_acquire_fence();
+		if (pointer_index_version == version) {
+			return found;
+		}
+	}
+}
+
 ObjectID ObjectDB::add_instance(Object *p_object) {
 
 	ERR_FAIL_COND_V(p_object->get_instance_id() != 0, 0);
 
 	rw_lock->write_lock();
-	ObjectID instance_id = ++instance_counter;
-	instances[instance_id] = p_object;
-	instance_checks[p_object] = instance_id;
+
+	uint32_t slot;
+	if (slot_free_list != OBJECTDB_SLOT_FREE_END) {
+
+		slot = slot_free_list;
+		slot_free_list = slot_blocks[slot >> OBJECTDB_BLOCK_BITS][slot & OBJECTDB_BLOCK_MASK].next_free;
+	} else {
+
+		if (slot_max == OBJECTDB_SLOT_MAX) {
+			rw_lock->write_unlock();
+			ERR_FAIL_V_MSG(0, "Maximum number of object instances exceeded, the object won't be registered.");
+		}
+
+		slot = slot_max;
+		if ((slot & OBJECTDB_BLOCK_MASK) == 0) {
+			Slot *block = memnew_arr(Slot, OBJECTDB_BLOCK_SIZE);
+			memset(block, 0, sizeof(Slot) * OBJECTDB_BLOCK_SIZE);
+			slot_blocks[slot >> OBJECTDB_BLOCK_BITS] = block;
+		}
+		atomic_release_fence(); // Block must be visible before the slot is.
+		slot_max = slot + 1;
+	}
+
+	Slot &s = slot_blocks[slot >> OBJECTDB_BLOCK_BITS][slot & OBJECTDB_BLOCK_MASK];
+	s.generation++;
+	if (s.generation == 0) {
+		s.generation = 1; // 0 means free.
+	}
+	s.object = p_object;
+	atomic_release_fence();
+	s.validator = s.generation;
+
+	ObjectID instance_id = ((ObjectID)s.generation << OBJECTDB_SLOT_BITS) | slot;
+	slot_count++;
+
+	pointer_index_version++;
+	atomic_release_fence();
+	if (slot_count * 2 > pointer_index->mask + 1) {
+		PointerIndex *grown = _create_pointer_index((pointer_index->mask + 1) * 2);
+		for (uint32_t i = 0; i < slot_max; i++) {
+			if (i != slot && _get_slot_object(i)) {
+				_pointer_index_insert(grown, i);
+			}
+		}
+		grown->retired = pointer_index;
+		pointer_index = grown;
+	}
+	_pointer_index_insert(pointer_index, slot);
+	atomic_release_fence();
+	pointer_index_version++;
 
 	rw_lock->write_unlock();
 
@@ -2011,32 +2181,48 @@ ObjectID ObjectDB::add_instance(Object *p_object) {
 
 void ObjectDB::remove_instance(Object *p_object) {
 
+	if (p_object->get_instance_id() == 0) {
+		return; // Never registered, add_instance already failed with an error.
+	}
+
 	rw_lock->write_lock();
 
-	instances.erase(p_object->get_instance_id());
-	instance_checks.erase(p_object);
+	uint32_t slot = p_object->get_instance_id() & OBJECTDB_SLOT_MASK;
+	if (slot >= slot_max) {
+		rw_lock->write_unlock();
+		ERR_FAIL_MSG("Removing an object that is not in the ObjectDB.");
+	}
 
-	rw_lock->write_unlock();
-}
-Object *ObjectDB::get_instance(ObjectID p_instance_id) {
+	Slot &s = slot_blocks[slot >> OBJECTDB_BLOCK_BITS][slot & OBJECTDB_BLOCK_MASK];
+	if (s.object == p_object) {
+		// Removed from the index first, since it finds entries through their objects.
+		pointer_index_version++;
+		atomic_release_fence();
+		_pointer_index_remove(pointer_index, slot);
+		atomic_release_fence();
+		pointer_index_version++;
 
-	rw_lock->read_lock();
-	Object **obj = instances.getptr(p_instance_id);
-	rw_lock->read_unlock();
+		s.validator = 0;
+		atomic_release_fence();
+		s.object = NULL;
+		s.next_free = slot_free_list;
+		slot_free_list = slot;
+		slot_count--;
+	}
 
-	if (!obj)
-		return NULL;
-	return *obj;
+	rw_lock->write_unlock();
 }
 
 void ObjectDB::debug_objects(DebugFunc p_func) {
 
 	rw_lock->read_lock();
 
-	const ObjectID *K = NULL;
-	while ((K = instances.next(K))) {
+	for (uint32_t i = 0; i < slot_max; i++) {
 
-		p_func(instances[*K]);
+		Slot &s = slot_blocks[i >> OBJECTDB_BLOCK_BITS][i & OBJECTDB_BLOCK_MASK];
+		if (s.validator) {
+			p_func(s.object);
+		}
 	}
 
 	rw_lock->read_unlock();
@@ -2048,7 +2234,7 @@ void Object::get_argument_options(const StringName &p_function, int p_idx, List<
 int ObjectDB::get_object_count() {
 
 	rw_lock->read_lock();
-	int count = instances.size();
+	int count = slot_count;
 	rw_lock->read_unlock();
 
 	return count;
@@ -2059,29 +2245,49 @@ RWLock *ObjectDB::rw_lock = NULL;
 void ObjectDB::setup() {
 
 	rw_lock = RWLock::create();
+	pointer_index = _create_pointer_index(1024);
 }
 
 void ObjectDB::cleanup() {
 
 	rw_lock->write_lock();
-	if (instances.size()) {
+	if (slot_count) {
 
 		WARN_PRINT("ObjectDB Instances still exist!");
 		if (OS::get_singleton()->is_stdout_verbose()) {
-			const ObjectID *K = NULL;
-			while ((K = instances.next(K))) {
+			for (uint32_t i = 0; i < slot_max; i++) {
+
+				Slot &s = slot_blocks[i >> OBJECTDB_BLOCK_BITS][i & OBJECTDB_BLOCK_MASK];
+				if (!s.validator) {
+					continue;
+				}
 
+				Object *obj = s.object;
 				String node_name;
-				if (instances[*K]->is_class("Node"))
-					node_name = " - Node name: " + String(instances[*K]->call("get_name"));
-				if (instances[*K]->is_class("Resource"))
-					node_name = " - Resource name: " + String(instances[*K]->call("get_name")) + " Path: " + String(instances[*K]->call("get_path"));
-				print_line("Leaked instance: " + String(instances[*K]->get_class()) + ":" + itos(*K) + node_name);
+				if (obj->is_class("Node"))
+					node_name = " - Node name: " + String(obj->call("get_name"));
+				if (obj->is_class("Resource"))
+					node_name = " - Resource name: " + String(obj->call("get_name")) + " Path: " + String(obj->call("get_path"));
+				print_line("Leaked instance: " + String(obj->get_class()) + ":" + itos(obj->get_instance_id()) + node_name);
 			}
 		}
 	}
-	instances.clear();
-	instance_checks.clear();
+
+	for (uint32_t i = 0; i < slot_max; i += OBJECTDB_BLOCK_SIZE) {
+		memdelete_arr(slot_blocks[i >> OBJECTDB_BLOCK_BITS]);
+		slot_blocks[i >> OBJECTDB_BLOCK_BITS] = NULL;
+	}
+	slot_max = 0;
+	slot_free_list = OBJECTDB_SLOT_FREE_END;
+	slot_count = 0;
+
+	while (pointer_index) {
+		PointerIndex *retired = pointer_index->retired;
+		memdelete_arr(pointer_index->entries);
+		memdelete(pointer_index);
+		pointer_index = retired;
+	}
+
 	rw_lock->write_unlock();
 	memdelete(rw_lock);
 }
@@ -34,6 +34,7 @@
 #include "core/hash_map.h"
 #include "core/list.h"
 #include "core/map.h"
+#include "core/method_call_cache.h"
 #include "core/os/rw_lock.h"
 #include "core/set.h"
 #include "core/variant.h"
@@ -396,6 +397,7 @@ public:                                                        \
                                                                \
 private:
 
+class MethodBind;
 class ScriptInstance;
 typedef uint64_t ObjectID;
 
@@ -460,13 +462,18 @@ private:
 			int reference_count;
 			Connection conn;
 			List<Connection>::Element *cE;
+			MethodCallCache method_cache; // Resolves conn.method on the target.
 			Slot() { reference_count = 0; }
 		};
 
 		MethodInfo user;
 		VMap<Target, Slot> slot_map;
 		int lock;
-		Signal() { lock = 0; }
+		uint64_t emission_count;
+		Signal() {
+			lock = 0;
+			emission_count = 0;
+		}
 	};
 
 	HashMap<StringName, Signal> signal_map;
@@ -505,6 +512,10 @@ private:
 
 	void property_list_changed_notify();
 
+	friend class MethodCallCache;
+	Variant _call_method_bind(MethodBind *p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error);
+	Variant _call_script_method(const void *p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error);
+
 	friend class Reference;
 	uint32_t instance_binding_count;
 	void *_script_instance_bindings[MAX_SCRIPT_INSTANCE_BINDINGS];
@@ -709,6 +720,8 @@ public:
 	void get_all_signal_connections(List<Connection> *p_connections) const;
 	int get_persistent_signal_connection_count() const;
 	void get_signals_connected_to_this(List<Connection> *p_connections) const;
+	// How many emissions of the signal have started, counted while anything is connected to it.
+	uint64_t get_signal_emission_count(const StringName &p_signal) const;
 
 	Error connect(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method, const Vector<Variant> &p_binds = Vector<Variant>(), uint32_t p_flags = 0);
 	void disconnect(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method);
@@ -759,23 +772,59 @@ void postinitialize_handler(Object *p_object);
 
 class ObjectDB {
 
-	struct ObjectPtrHash {
+	// An ObjectID is a slot index, tagged with the generation of the slot in
+	// the upper bits. Resolving one is an index and a compare, with no lock.
+	enum {
+		OBJECTDB_SLOT_BITS = 24,
+		OBJECTDB_SLOT_MAX = 1 << OBJECTDB_SLOT_BITS,
+		OBJECTDB_SLOT_MASK = OBJECTDB_SLOT_MAX - 1,
+		OBJECTDB_BLOCK_BITS = 12,
+		OBJECTDB_BLOCK_SIZE = 1 << OBJECTDB_BLOCK_BITS,
+		OBJECTDB_BLOCK_MASK = OBJECTDB_BLOCK_SIZE - 1,
+		OBJECTDB_BLOCK_COUNT = OBJECTDB_SLOT_MAX >> OBJECTDB_BLOCK_BITS,
+		OBJECTDB_SLOT_FREE_END = 0xFFFFFFFF
+	};
 
-		static _FORCE_INLINE_ uint32_t hash(const Object *p_obj) {
+	struct Slot {
+		volatile uint32_t validator; // Generation while in use, 0 when free.
+		uint32_t generation;
+		uint32_t next_free;
+		Object *volatile object;
+	};
 
-			union {
-				const Object *p;
-				unsigned long i;
-			} u;
-			u.p = p_obj;
-			return HashMapHasherDefault::hash((uint64_t)u.i);
-		}
+	// Blocks are never moved nor freed until cleanup, so readers can index them freely.
+	static Slot *slot_blocks[OBJECTDB_BLOCK_COUNT];
+	static volatile uint32_t slot_max;
+	static uint32_t slot_free_list;
+	static uint32_t slot_count;
+
+	// Open addressing table of the slots in use, hashed by object pointer, so
+	// raw pointers can be validated without reading the (maybe freed) object.
+	// Writers hold the write lock and make the version odd while modifying it.
+	// Readers take no lock, they retry when the version changed.
+	// Tables replaced when growing are kept until cleanup, since readers may
+	// still be probing them. Their sizes add up to less than the current one.
+	struct PointerIndex {
+		uint32_t mask;
+		uint32_t *entries; // Slot + 1, 0 when empty.
+		PointerIndex *retired;
 	};
 
-	static HashMap<ObjectID, Object *> instances;
-	static HashMap<Object *, ObjectID, ObjectPtrHash> instance_checks;
+	static PointerIndex *volatile pointer_index;
+	static volatile uint32_t pointer_index_version;
+
+	_FORCE_INLINE_ static uint32_t _hash_pointer(const Object *p_ptr) {
+
+		return HashMapHasherDefault::hash((uint64_t)(uintptr_t)p_ptr);
+	}
+	_FORCE_INLINE_ static Object *_get_slot_object(uint32_t p_slot) {
+
+		return slot_blocks[p_slot >> OBJECTDB_BLOCK_BITS][p_slot & OBJECTDB_BLOCK_MASK].object;
+	}
+	static PointerIndex *_create_pointer_index(uint32_t p_size);
+	static void _pointer_index_insert(PointerIndex *p_index, uint32_t p_slot);
+	static void _pointer_index_remove(PointerIndex *p_index, uint32_t p_slot);
 
-	static ObjectID instance_counter;
 	friend class Object;
 	friend void unregister_core_types();
 
@@ -789,19 +838,33 @@ class ObjectDB {
 public:
 	typedef void (*DebugFunc)(Object *p_obj);
 
-	static Object *get_instance(ObjectID p_instance_id);
-	static void debug_objects(DebugFunc p_func);
-	static int get_object_count();
+	_FORCE_INLINE_ static Object *get_instance(ObjectID p_instance_id) {
 
-	_FORCE_INLINE_ static bool instance_validate(Object *p_ptr) {
-		rw_lock->read_lock();
+		uint32_t slot = p_instance_id & OBJECTDB_SLOT_MASK;
+		uint64_t generation = p_instance_id >> OBJECTDB_SLOT_BITS;
+		if (unlikely(slot >= slot_max || generation == 0 || generation > 0xFFFFFFFF)) {
+			return NULL;
+		}
+		atomic_acquire_fence();
 
-		bool exists = instance_checks.has(p_ptr);
+		Slot &s = slot_blocks[slot >> OBJECTDB_BLOCK_BITS][slot & OBJECTDB_BLOCK_MASK];
+		if (s.validator != generation) {
+			return NULL;
+		}
+		atomic_acquire_fence();
+		Object *object = s.object;
+		atomic_acquire_fence();
+		if (s.validator != generation) {
+			return NULL; // Freed (and maybe reused) while reading.
+		}
+		return object;
+	}
 
-		rw_lock->read_unlock();
+	static void debug_objects(DebugFunc p_func);
+	static int get_object_count();
 
-		return exists;
-	}
+	// The pointer may be dangling, so it's only hashed and compared, never read through.
+	static bool instance_validate(Object *p_ptr);
 };
 
 //needed by macros
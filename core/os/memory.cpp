@@ -34,6 +34,10 @@
 #include "core/os/copymem.h"
 #include "core/safe_refcount.h"
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+#include "core/os/small_object_allocator.h"
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -73,17 +77,30 @@ uint64_t Memory::alloc_count = 0;
 
 void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_OBJECT_ALLOCATOR_ENABLED)
+	// The size header is also how free_static() finds the size class.
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
 #endif
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+	int size_class = SmallObjectAllocator::get_size_class(p_bytes + PAD_ALIGN);
+	void *mem = size_class >= 0 ? SmallObjectAllocator::alloc(size_class) : malloc(p_bytes + PAD_ALIGN);
+
+	ERR_FAIL_COND_V(!mem, NULL);
+
+	// Small blocks are served from the thread cache, keep them off shared counters.
+	if (size_class < 0) {
+		atomic_increment(&alloc_count);
+	}
+#else
 	void *mem = malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
 
 	ERR_FAIL_COND_V(!mem, NULL);
 
 	atomic_increment(&alloc_count);
+#endif
 
 	if (prepad) {
 		uint64_t *s = (uint64_t *)mem;
@@ -109,7 +126,7 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 
 	uint8_t *mem = (uint8_t *)p_memory;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_OBJECT_ALLOCATOR_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
@@ -128,6 +145,41 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 		}
 #endif
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+		int old_class = SmallObjectAllocator::get_size_class(*s + PAD_ALIGN);
+		int new_class = p_bytes ? SmallObjectAllocator::get_size_class(p_bytes + PAD_ALIGN) : -1;
+
+		if (old_class >= 0 || new_class >= 0) {
+
+			if (old_class == new_class) {
+				*s = p_bytes;
+				return mem + PAD_ALIGN;
+			}
+
+			uint8_t *new_mem = NULL;
+			if (p_bytes) {
+				new_mem = (uint8_t *)(new_class >= 0 ? SmallObjectAllocator::alloc(new_class) : malloc(p_bytes + PAD_ALIGN));
+				ERR_FAIL_COND_V(!new_mem, NULL);
+
+				// Callers like CowData keep their own data in the padding, move it too.
+				copymem(new_mem, mem, PAD_ALIGN + MIN(*s, (uint64_t)p_bytes));
+				*(uint64_t *)new_mem = p_bytes;
+				if (new_class < 0) {
+					atomic_increment(&alloc_count);
+				}
+			}
+
+			if (old_class >= 0) {
+				SmallObjectAllocator::free(mem, old_class);
+			} else {
+				free(mem);
+				atomic_decrement(&alloc_count);
+			}
+
+			return new_mem ? new_mem + PAD_ALIGN : NULL;
+		}
+#endif
+
 		if (p_bytes == 0) {
 			free(mem);
 			return NULL;
@@ -159,6 +211,23 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 
 	uint8_t *mem = (uint8_t *)p_ptr;
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+	mem -= PAD_ALIGN;
+	uint64_t *s = (uint64_t *)mem;
+
+#ifdef DEBUG_ENABLED
+	atomic_sub(&mem_usage, *s);
+#endif
+
+	int size_class = SmallObjectAllocator::get_size_class(*s + PAD_ALIGN);
+	if (size_class >= 0) {
+		SmallObjectAllocator::free(mem, size_class);
+	} else {
+		atomic_decrement(&alloc_count);
+		free(mem);
+	}
+#else
+
 #ifdef DEBUG_ENABLED
 	bool prepad = true;
 #else
@@ -180,6 +249,7 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 
 		free(mem);
 	}
+#endif
 }
 
 uint64_t Memory::get_mem_available() {
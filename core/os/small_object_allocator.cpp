@@ -0,0 +1,304 @@
+/*************************************************************************/
+/*  small_object_allocator.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "small_object_allocator.h"
+
+#include "core/error_macros.h"
+#include "core/os/thread_local.h"
+#include "core/safe_refcount.h"
+
+#include <stdlib.h>
+
+enum {
+	CHUNK_SIZE = 64 * 1024,
+	BATCH_SIZE = 32, // Blocks moved between a thread cache and the shared list at once.
+	CACHE_MAX = BATCH_SIZE * 2
+};
+
+const int8_t SmallObjectAllocator::size_class_table[(MAX_SIZE >> 4) + 1] = {
+	0, 0, 1, 2, 3, 4, 5, 6, 7, // Up to 128 bytes, every 16.
+	8, 8, 9, 9, 10, 10, 11, 11, // Up to 256 bytes, every 32.
+	12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15 // Up to 512 bytes, every 64.
+};
+
+static const uint32_t size_class_sizes[SmallObjectAllocator::SIZE_CLASS_COUNT] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256,
+	320, 384, 448, 512
+};
+
+struct FreeBlock {
+	FreeBlock *next;
+};
+
+// A Mutex can't be used here, creating one allocates memory.
+struct SpinLock {
+	volatile uint32_t value;
+
+	_FORCE_INLINE_ void lock() {
+		while (!atomic_compare_and_swap(&value, 0u, 1u)) {
+			// Only read until it looks free, so waiters don't keep stealing the cache line from the owner.
+			while (value) {
+				atomic_cpu_pause();
+			}
+		}
+	}
+
+	_FORCE_INLINE_ void unlock() {
+		atomic_release_fence();
+		value = 0;
+	}
+};
+
+// Plain data only, so it's usable before (and after) static constructors run.
+struct SharedSizeClass {
+	SpinLock lock;
+	FreeBlock *free_list;
+	uint8_t *chunk_pos;
+	uint8_t *chunk_end;
+	uint64_t reserved;
+	uint64_t shared_free;
+	uint64_t refills;
+	uint64_t flushes;
+};
+
+static SharedSizeClass shared_classes[SmallObjectAllocator::SIZE_CLASS_COUNT];
+static volatile uint64_t reserved_bytes = 0;
+
+struct ThreadCache {
+	FreeBlock *blocks[SmallObjectAllocator::SIZE_CLASS_COUNT];
+	uint32_t count[SmallObjectAllocator::SIZE_CLASS_COUNT];
+};
+
+enum ThreadCacheState {
+	THREAD_CACHE_UNUSED,
+	THREAD_CACHE_ACTIVE,
+	THREAD_CACHE_RELEASED // Thread is exiting, go straight to the shared lists.
+};
+
+#ifdef USE_CUSTOM_THREAD_LOCAL
+// ThreadLocal<T> allocates its per thread value with memnew, which would end
+// up back here. Without native thread locals every thread uses the shared
+// lists directly and this cache stays empty.
+static ThreadCache thread_cache;
+
+static _FORCE_INLINE_ bool _use_thread_cache() {
+	return false;
+}
+#else
+// Plain data only, nothing runs when a thread exits. The cache is given back
+// by thread_exit(), threads not created through Thread::create() keep their
+// blocks until the process ends.
+static _THREAD_LOCAL_(ThreadCache) thread_cache;
+static _THREAD_LOCAL_(ThreadCacheState) thread_cache_state = THREAD_CACHE_UNUSED;
+
+static _FORCE_INLINE_ bool _use_thread_cache() {
+
+	if (likely(thread_cache_state == THREAD_CACHE_ACTIVE)) {
+		return true;
+	}
+
+	if (thread_cache_state == THREAD_CACHE_UNUSED) {
+		thread_cache_state = THREAD_CACHE_ACTIVE;
+		return true;
+	}
+
+	return false;
+}
+#endif
+
+// Shared class lock must be held.
+static FreeBlock *_take_shared_block(int p_size_class) {
+
+	SharedSizeClass &shared = shared_classes[p_size_class];
+
+	if (shared.free_list) {
+		FreeBlock *block = shared.free_list;
+		shared.free_list = block->next;
+		shared.shared_free--;
+		return block;
+	}
+
+	uint32_t size = size_class_sizes[p_size_class];
+	if (shared.chunk_pos + size > shared.chunk_end) {
+		uint8_t *chunk = (uint8_t *)malloc(CHUNK_SIZE);
+		if (!chunk) {
+			return NULL;
+		}
+		atomic_add(&reserved_bytes, (uint64_t)CHUNK_SIZE);
+		shared.chunk_pos = chunk;
+		shared.chunk_end = chunk + CHUNK_SIZE;
+	}
+
+	FreeBlock *block = (FreeBlock *)shared.chunk_pos;
+	shared.chunk_pos += size;
+	shared.reserved++;
+	return block;
+}
+
+static void _refill_thread_cache(int p_size_class) {
+
+	SharedSizeClass &shared = shared_classes[p_size_class];
+	FreeBlock *&blocks = thread_cache.blocks[p_size_class];
+
+	shared.lock.lock();
+	for (int i = 0; i < BATCH_SIZE; i++) {
+		FreeBlock *block = _take_shared_block(p_size_class);
+		if (!block) {
+			break;
+		}
+		block->next = blocks;
+		blocks = block;
+		thread_cache.count[p_size_class]++;
+	}
+	shared.refills++;
+	shared.lock.unlock();
+}
+
+static void _flush_thread_cache(int p_size_class, uint32_t p_count) {
+
+	if (p_count == 0) {
+		return;
+	}
+
+	SharedSizeClass &shared = shared_classes[p_size_class];
+	FreeBlock *&blocks = thread_cache.blocks[p_size_class];
+
+	// Link the batch outside the lock, then splice it in.
+	FreeBlock *first = blocks;
+	FreeBlock *last = first;
+	for (uint32_t i = 1; i < p_count; i++) {
+		last = last->next;
+	}
+	blocks = last->next;
+	thread_cache.count[p_size_class] -= p_count;
+
+	shared.lock.lock();
+	last->next = shared.free_list;
+	shared.free_list = first;
+	shared.shared_free += p_count;
+	shared.flushes++;
+	shared.lock.unlock();
+}
+
+uint32_t SmallObjectAllocator::get_size_class_size(int p_size_class) {
+
+	ERR_FAIL_INDEX_V(p_size_class, SIZE_CLASS_COUNT, 0);
+	return size_class_sizes[p_size_class];
+}
+
+void *SmallObjectAllocator::alloc(int p_size_class) {
+
+	if (unlikely(!_use_thread_cache())) {
+		SharedSizeClass &shared = shared_classes[p_size_class];
+		shared.lock.lock();
+		FreeBlock *block = _take_shared_block(p_size_class);
+		shared.lock.unlock();
+		return block;
+	}
+
+	FreeBlock *block = thread_cache.blocks[p_size_class];
+	if (unlikely(!block)) {
+		_refill_thread_cache(p_size_class);
+		block = thread_cache.blocks[p_size_class];
+		if (!block) {
+			return NULL;
+		}
+	}
+
+	thread_cache.blocks[p_size_class] = block->next;
+	thread_cache.count[p_size_class]--;
+	return block;
+}
+
+void SmallObjectAllocator::free(void *p_ptr, int p_size_class) {
+
+	FreeBlock *block = (FreeBlock *)p_ptr;
+
+	if (unlikely(!_use_thread_cache())) {
+		SharedSizeClass &shared = shared_classes[p_size_class];
+		shared.lock.lock();
+		block->next = shared.free_list;
+		shared.free_list = block;
+		shared.shared_free++;
+		shared.lock.unlock();
+		return;
+	}
+
+	block->next = thread_cache.blocks[p_size_class];
+	thread_cache.blocks[p_size_class] = block;
+	thread_cache.count[p_size_class]++;
+
+	if (unlikely(thread_cache.count[p_size_class] > CACHE_MAX)) {
+		_flush_thread_cache(p_size_class, BATCH_SIZE);
+	}
+}
+
+void SmallObjectAllocator::thread_exit() {
+
+#ifndef USE_CUSTOM_THREAD_LOCAL
+	if (thread_cache_state != THREAD_CACHE_ACTIVE) {
+		thread_cache_state = THREAD_CACHE_RELEASED;
+		return;
+	}
+
+	for (int i = 0; i < SIZE_CLASS_COUNT; i++) {
+		_flush_thread_cache(i, thread_cache.count[i]);
+	}
+	thread_cache_state = THREAD_CACHE_RELEASED;
+#endif
+}
+
+SmallObjectAllocator::SizeClassStats SmallObjectAllocator::get_size_class_stats(int p_size_class) {
+
+	SizeClassStats stats;
+	stats.size = 0;
+	stats.reserved = 0;
+	stats.shared_free = 0;
+	stats.refills = 0;
+	stats.flushes = 0;
+	ERR_FAIL_INDEX_V(p_size_class, SIZE_CLASS_COUNT, stats);
+
+	SharedSizeClass &shared = shared_classes[p_size_class];
+	shared.lock.lock();
+	stats.size = size_class_sizes[p_size_class];
+	stats.reserved = shared.reserved;
+	stats.shared_free = shared.shared_free;
+	stats.refills = shared.refills;
+	stats.flushes = shared.flushes;
+	shared.lock.unlock();
+
+	return stats;
+}
+
+uint64_t SmallObjectAllocator::get_reserved_bytes() {
+
+	return reserved_bytes;
+}
@@ -0,0 +1,81 @@
+/*************************************************************************/
+/*  small_object_allocator.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SMALL_OBJECT_ALLOCATOR_H
+#define SMALL_OBJECT_ALLOCATOR_H
+
+#include "core/typedefs.h"
+
+#include <stddef.h>
+
+// Size-class allocator for small blocks, used by Memory::alloc_static() when
+// built with small_object_allocator=yes.
+// Every thread keeps a cache of free blocks per size class. Caches are refilled
+// from, and flushed to, the shared free lists in batches, so most allocations
+// and frees don't touch any state shared with other threads.
+// Memory is reserved in chunks which are kept for the lifetime of the process.
+
+class SmallObjectAllocator {
+public:
+	enum {
+		SIZE_CLASS_COUNT = 16,
+		MAX_SIZE = 512
+	};
+
+	struct SizeClassStats {
+		uint32_t size;
+		uint64_t reserved; // Blocks carved from chunks.
+		uint64_t shared_free; // Blocks on the shared free list.
+		uint64_t refills;
+		uint64_t flushes;
+	};
+
+	// -1 if the size is too big to be served from a size class.
+	static _FORCE_INLINE_ int get_size_class(size_t p_bytes) {
+		return p_bytes <= MAX_SIZE ? size_class_table[(p_bytes + 15) >> 4] : -1;
+	}
+
+	static uint32_t get_size_class_size(int p_size_class);
+
+	static void *alloc(int p_size_class);
+	static void free(void *p_ptr, int p_size_class);
+
+	// Gives the calling thread's cached blocks back to the shared lists, later
+	// calls from it skip the cache. Registered as a Thread exit callback.
+	static void thread_exit();
+
+	static SizeClassStats get_size_class_stats(int p_size_class);
+	static uint64_t get_reserved_bytes();
+
+private:
+	static const int8_t size_class_table[(MAX_SIZE >> 4) + 1];
+};
+
+#endif // SMALL_OBJECT_ALLOCATOR_H
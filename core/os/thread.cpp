@@ -37,6 +37,9 @@ Error (*Thread::set_name_func)(const String &) = NULL;
 
 Thread::ID Thread::_main_thread_id = 0;
 
+Thread::ExitCallback Thread::exit_callbacks[Thread::MAX_EXIT_CALLBACKS];
+int Thread::exit_callback_count = 0;
+
 Thread::ID Thread::get_caller_id() {
 
 	if (get_thread_id_func)
@@ -59,6 +62,19 @@ void Thread::wait_to_finish(Thread *p_thread) {
 		wait_to_finish_func(p_thread);
 }
 
+void Thread::add_exit_callback(ExitCallback p_callback) {
+
+	ERR_FAIL_COND(exit_callback_count == MAX_EXIT_CALLBACKS);
+	exit_callbacks[exit_callback_count++] = p_callback;
+}
+
+void Thread::thread_exited() {
+
+	for (int i = exit_callback_count - 1; i >= 0; i--) {
+		exit_callbacks[i]();
+	}
+}
+
 Error Thread::set_name(const String &p_name) {
 
 	if (set_name_func)
@@ -53,6 +53,8 @@ public:
 
 	typedef uint64_t ID;
 
+	typedef void (*ExitCallback)();
+
 protected:
 	static Thread *(*create_func)(ThreadCreateCallback p_callback, void *, const Settings &);
 	static ID (*get_thread_id_func)();
@@ -63,6 +65,13 @@ protected:
 
 	static ID _main_thread_id;
 
+	enum {
+		MAX_EXIT_CALLBACKS = 8
+	};
+
+	static ExitCallback exit_callbacks[MAX_EXIT_CALLBACKS];
+	static int exit_callback_count;
+
 	Thread();
 
 public:
@@ -74,6 +83,12 @@ public:
 	static void wait_to_finish(Thread *p_thread); ///< waits until thread is finished, and deallocates it.
 	static Thread *create(ThreadCreateCallback p_callback, void *p_user, const Settings &p_settings = Settings()); ///< Static function to create a thread, will call p_callback
 
+	// Lets core systems release what they keep per thread (thread local caches,
+	// reader records...) when a thread created with create() exits. Callbacks
+	// are added at startup, before other threads exist, and run in reverse order.
+	static void add_exit_callback(ExitCallback p_callback);
+	static void thread_exited(); ///< called by the platform implementations right before a thread created with create() returns
+
 	virtual ~Thread();
 };
 
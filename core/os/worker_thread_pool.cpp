@@ -0,0 +1,391 @@
+/*************************************************************************/
+/*  worker_thread_pool.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "worker_thread_pool.h"
+
+#include "core/os/os.h"
+
+WorkerThreadPool *WorkerThreadPool::singleton = NULL;
+
+void WorkerThreadPool::ChunkQueue::_grow() {
+
+	uint32_t new_capacity = capacity ? capacity * 2 : 64;
+	Chunk *new_chunks = memnew_arr(Chunk, new_capacity);
+	for (uint32_t i = 0; i < count; i++) {
+		new_chunks[i] = chunks[(first + i) % capacity];
+	}
+	if (chunks) {
+		memdelete_arr(chunks);
+	}
+	chunks = new_chunks;
+	capacity = new_capacity;
+	first = 0;
+}
+
+void WorkerThreadPool::ChunkQueue::push_back(const Chunk &p_chunk) {
+
+	if (count == capacity) {
+		_grow();
+	}
+	chunks[(first + count) % capacity] = p_chunk;
+	count++;
+}
+
+bool WorkerThreadPool::ChunkQueue::pop_back(Chunk &r_chunk) {
+
+	if (count == 0) {
+		return false;
+	}
+	count--;
+	r_chunk = chunks[(first + count) % capacity];
+	return true;
+}
+
+bool WorkerThreadPool::ChunkQueue::pop_front(Chunk &r_chunk) {
+
+	if (count == 0) {
+		return false;
+	}
+	r_chunk = chunks[first];
+	first = (first + 1) % capacity;
+	count--;
+	return true;
+}
+
+WorkerThreadPool::ChunkQueue::ChunkQueue() {
+
+	mutex = Mutex::create(false);
+	chunks = NULL;
+	capacity = 0;
+	first = 0;
+	count = 0;
+}
+
+WorkerThreadPool::ChunkQueue::~ChunkQueue() {
+
+	if (chunks) {
+		memdelete_arr(chunks);
+	}
+	memdelete(mutex);
+}
+
+void WorkerThreadPool::_thread_function(void *p_user) {
+
+	ThreadData *thread_data = (ThreadData *)p_user;
+	WorkerThreadPool *pool = thread_data->pool;
+	thread_data->id = Thread::get_caller_id();
+
+	while (true) {
+
+		if (pool->exit_threads) {
+			break;
+		}
+
+		if (!pool->_process_chunk(thread_data->index)) {
+			pool->wake_semaphore->wait();
+		}
+	}
+}
+
+int WorkerThreadPool::_get_queue_index() const {
+
+	Thread::ID caller = Thread::get_caller_id();
+	for (int i = 0; i < thread_count; i++) {
+		if (threads[i].id == caller) {
+			return i;
+		}
+	}
+	return thread_count;
+}
+
+bool WorkerThreadPool::_process_chunk(int p_queue) {
+
+	Chunk chunk;
+	bool found = false;
+
+	// Own work first, newest chunk since it is the most likely to be cache-hot.
+	queues[p_queue].mutex->lock();
+	found = queues[p_queue].pop_back(chunk);
+	queues[p_queue].mutex->unlock();
+
+	for (int i = 1; !found && i <= thread_count; i++) {
+		ChunkQueue &victim = queues[(p_queue + i) % (thread_count + 1)];
+		if (victim.count == 0) {
+			continue; // Racy peek, only used to avoid locking empty queues.
+		}
+		victim.mutex->lock();
+		found = victim.pop_front(chunk);
+		victim.mutex->unlock();
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	Group *group = chunk.group;
+	group->func(group->userdata, chunk.from, chunk.to);
+
+	if (atomic_decrement(&group->pending_chunks) == 0) {
+		_group_completed(group, p_queue);
+	}
+
+	return true;
+}
+
+void WorkerThreadPool::_wake_threads(uint32_t p_count) {
+
+	uint32_t count = MIN(p_count, (uint32_t)thread_count);
+	for (uint32_t i = 0; i < count; i++) {
+		wake_semaphore->post();
+	}
+}
+
+void WorkerThreadPool::_enqueue_group(Group *p_group, int p_queue) {
+
+	if (p_group->elements == 0) {
+		_group_completed(p_group, p_queue);
+		return;
+	}
+
+	uint32_t chunk_count = (p_group->elements + p_group->grain - 1) / p_group->grain;
+	p_group->pending_chunks = chunk_count;
+
+	ChunkQueue &queue = queues[p_queue];
+	queue.mutex->lock();
+	// Pushed in reverse, so the owner pops them back in ascending order.
+	for (uint32_t i = chunk_count; i > 0; i--) {
+		Chunk chunk;
+		chunk.group = p_group;
+		chunk.from = (i - 1) * p_group->grain;
+		chunk.to = MIN(chunk.from + p_group->grain, p_group->elements);
+		queue.push_back(chunk);
+	}
+	queue.mutex->unlock();
+
+	_wake_threads(chunk_count);
+}
+
+void WorkerThreadPool::_group_completed(Group *p_group, int p_queue) {
+
+	Vector<Group *> ready;
+
+	group_mutex->lock();
+	p_group->completed = true;
+	for (int i = 0; i < p_group->dependents.size(); i++) {
+		Group *dependent = p_group->dependents[i];
+		dependent->pending_dependencies--;
+		if (dependent->pending_dependencies == 0) {
+			ready.push_back(dependent);
+		}
+	}
+	p_group->dependents.clear();
+	group_mutex->unlock();
+
+	// The group may be freed by its waiter from this point on.
+	p_group->done->post();
+
+	for (int i = 0; i < ready.size(); i++) {
+		_enqueue_group(ready[i], p_queue);
+	}
+}
+
+WorkerThreadPool::GroupID WorkerThreadPool::add_group(GroupFunc p_func, void *p_userdata, uint32_t p_elements, uint32_t p_grain, const GroupID *p_dependencies, int p_dependency_count) {
+
+	ERR_FAIL_COND_V(!queues, INVALID_GROUP_ID);
+	ERR_FAIL_COND_V(!p_func, INVALID_GROUP_ID);
+
+	group_mutex->lock();
+
+	Group *group = free_groups;
+	if (group) {
+		free_groups = group->next_free;
+	} else {
+		group = memnew(Group);
+		group->done = Semaphore::create();
+	}
+
+	group->id = ++last_group_id;
+	group->func = p_func;
+	group->userdata = p_userdata;
+	group->elements = p_elements;
+	group->grain = MAX(p_grain, 1u);
+	group->pending_chunks = 0;
+	group->pending_dependencies = 0;
+	group->completed = false;
+	group->next_free = NULL;
+
+	for (int i = 0; i < p_dependency_count; i++) {
+		Group **dependency = groups.getptr(p_dependencies[i]);
+		if (!dependency || (*dependency)->completed) {
+			continue; // Already done (or waited for), nothing to wait on.
+		}
+		(*dependency)->dependents.push_back(group);
+		group->pending_dependencies++;
+	}
+
+	groups[group->id] = group;
+	GroupID id = group->id;
+	bool ready = group->pending_dependencies == 0;
+
+	group_mutex->unlock();
+
+	if (ready) {
+		_enqueue_group(group, _get_queue_index());
+	}
+
+	return id;
+}
+
+bool WorkerThreadPool::is_group_completed(GroupID p_group) const {
+
+	group_mutex->lock();
+	Group *const *group = groups.getptr(p_group);
+	bool completed = !group || (*group)->completed;
+	group_mutex->unlock();
+
+	return completed;
+}
+
+void WorkerThreadPool::wait_for_group(GroupID p_group) {
+
+	group_mutex->lock();
+	Group **groupp = groups.getptr(p_group);
+	Group *group = groupp ? *groupp : NULL;
+	group_mutex->unlock();
+
+	ERR_FAIL_COND_MSG(!group, "Invalid group, or group was already waited for.");
+
+	// Help processing work instead of sleeping, this also guarantees progress
+	// when there are no worker threads at all.
+	int queue = _get_queue_index();
+	while (!group->completed) {
+		if (!_process_chunk(queue)) {
+			break;
+		}
+	}
+
+	group->done->wait();
+
+	group_mutex->lock();
+	groups.erase(p_group);
+	group->next_free = free_groups;
+	free_groups = group;
+	group_mutex->unlock();
+}
+
+void WorkerThreadPool::init(int p_thread_count) {
+
+	ERR_FAIL_COND(queues);
+
+#ifdef NO_THREADS
+	thread_count = 0;
+#else
+	if (p_thread_count < 0) {
+		// The thread calling wait_for_group() helps, so leave it a core.
+		p_thread_count = MAX(1, OS::get_singleton()->get_processor_count() - 1);
+	}
+	thread_count = p_thread_count;
+#endif
+
+	exit_threads = false;
+	wake_semaphore = Semaphore::create();
+	queues = memnew_arr(ChunkQueue, thread_count + 1);
+	threads = thread_count ? memnew_arr(ThreadData, thread_count) : NULL;
+
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].pool = this;
+		threads[i].index = i;
+		threads[i].id = 0;
+		threads[i].thread = Thread::create(_thread_function, &threads[i]);
+	}
+}
+
+void WorkerThreadPool::finish() {
+
+	if (!queues) {
+		return;
+	}
+
+	exit_threads = true;
+	for (int i = 0; i < thread_count; i++) {
+		wake_semaphore->post();
+	}
+	for (int i = 0; i < thread_count; i++) {
+		Thread::wait_to_finish(threads[i].thread);
+		memdelete(threads[i].thread);
+	}
+
+	if (threads) {
+		memdelete_arr(threads);
+		threads = NULL;
+	}
+	memdelete_arr(queues);
+	queues = NULL;
+	memdelete(wake_semaphore);
+	wake_semaphore = NULL;
+	thread_count = 0;
+
+	ERR_FAIL_COND_MSG(groups.size(), "Some worker thread pool groups were never waited for.");
+}
+
+WorkerThreadPool::WorkerThreadPool() {
+
+	singleton = this;
+	threads = NULL;
+	thread_count = 0;
+	queues = NULL;
+	wake_semaphore = NULL;
+	exit_threads = false;
+	group_mutex = Mutex::create(false);
+	free_groups = NULL;
+	last_group_id = 0;
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+
+	finish();
+
+	const GroupID *key = NULL;
+	while ((key = groups.next(key))) {
+		Group *group = groups[*key];
+		memdelete(group->done);
+		memdelete(group);
+	}
+
+	while (free_groups) {
+		Group *group = free_groups;
+		free_groups = group->next_free;
+		memdelete(group->done);
+		memdelete(group);
+	}
+
+	memdelete(group_mutex);
+	singleton = NULL;
+}
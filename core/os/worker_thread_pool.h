@@ -0,0 +1,185 @@
+/*************************************************************************/
+/*  worker_thread_pool.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef WORKER_THREAD_POOL_H
+#define WORKER_THREAD_POOL_H
+
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+#include "core/vector.h"
+
+// Persistent pool of worker threads.
+//
+// Work is submitted as groups: a group runs a callback over a range of
+// elements, split in chunks of "grain" elements. Each worker owns a deque,
+// pops its own work from the back and steals from the front of the others
+// when it runs out. Groups may depend on other groups, in which case their
+// chunks are only queued once every dependency has completed.
+//
+// Every group must be waited for exactly once with wait_for_group(), which
+// also makes the calling thread help processing pending work.
+
+class WorkerThreadPool {
+public:
+	typedef int64_t GroupID;
+	typedef void (*GroupFunc)(void *p_userdata, uint32_t p_from, uint32_t p_to);
+
+	enum {
+		INVALID_GROUP_ID = -1
+	};
+
+private:
+	struct Group {
+		GroupID id;
+		GroupFunc func;
+		void *userdata;
+		uint32_t elements;
+		uint32_t grain;
+		volatile uint32_t pending_chunks;
+		uint32_t pending_dependencies;
+		volatile bool completed;
+		Vector<Group *> dependents;
+		Semaphore *done;
+		Group *next_free;
+	};
+
+	struct Chunk {
+		Group *group;
+		uint32_t from;
+		uint32_t to;
+	};
+
+	// Double ended queue, owner works on the back, thieves on the front.
+	struct ChunkQueue {
+		Mutex *mutex;
+		Chunk *chunks;
+		uint32_t capacity;
+		uint32_t first;
+		uint32_t count;
+
+		void _grow();
+		void push_back(const Chunk &p_chunk);
+		bool pop_back(Chunk &r_chunk);
+		bool pop_front(Chunk &r_chunk);
+
+		ChunkQueue();
+		~ChunkQueue();
+	};
+
+	struct ThreadData {
+		WorkerThreadPool *pool;
+		int index;
+		Thread *thread;
+		Thread::ID id;
+	};
+
+	static WorkerThreadPool *singleton;
+
+	ThreadData *threads;
+	int thread_count;
+	// One queue per worker, plus a shared one (the last) for non-worker threads.
+	ChunkQueue *queues;
+	Semaphore *wake_semaphore;
+	volatile bool exit_threads;
+
+	Mutex *group_mutex;
+	HashMap<GroupID, Group *> groups;
+	Group *free_groups;
+	GroupID last_group_id;
+
+	static void _thread_function(void *p_user);
+
+	int _get_queue_index() const;
+	bool _process_chunk(int p_queue);
+	void _wake_threads(uint32_t p_count);
+	void _enqueue_group(Group *p_group, int p_queue);
+	void _group_completed(Group *p_group, int p_queue);
+
+	template <class C, class U>
+	struct ParallelForData {
+		C *instance;
+		void (C::*method)(uint32_t, U);
+		U userdata;
+	};
+
+	template <class C, class U>
+	static void _parallel_for_func(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+		ParallelForData<C, U> &data = *(ParallelForData<C, U> *)p_userdata;
+		for (uint32_t i = p_from; i < p_to; i++) {
+			(data.instance->*data.method)(i, data.userdata);
+		}
+	}
+
+public:
+	_FORCE_INLINE_ static WorkerThreadPool *get_singleton() { return singleton; }
+
+	int get_thread_count() const { return thread_count; }
+
+	// Queue p_func to be run over p_elements, in chunks of p_grain elements.
+	// The chunks are not queued until every group in p_dependencies completed.
+	GroupID add_group(GroupFunc p_func, void *p_userdata, uint32_t p_elements, uint32_t p_grain = 1, const GroupID *p_dependencies = NULL, int p_dependency_count = 0);
+	GroupID add_task(GroupFunc p_func, void *p_userdata, const GroupID *p_dependencies = NULL, int p_dependency_count = 0) { return add_group(p_func, p_userdata, 1, 1, p_dependencies, p_dependency_count); }
+
+	bool is_group_completed(GroupID p_group) const;
+	void wait_for_group(GroupID p_group);
+
+	// Calls (p_instance->*p_method)(index, p_userdata) for every index in [0, p_elements) and waits for completion.
+	// A grain of 0 picks one that gives each thread a few chunks to balance.
+	template <class C, class M, class U>
+	void parallel_for(uint32_t p_elements, C *p_instance, M p_method, U p_userdata, uint32_t p_grain = 0) {
+
+		ParallelForData<C, U> data;
+		data.instance = p_instance;
+		data.method = p_method;
+		data.userdata = p_userdata;
+
+		if (p_grain == 0) {
+			p_grain = MAX(1u, p_elements / ((thread_count + 1) * 4));
+		}
+
+		if (thread_count == 0 || p_elements <= p_grain) {
+			_parallel_for_func<C, U>(&data, 0, p_elements);
+			return;
+		}
+
+		wait_for_group(add_group(_parallel_for_func<C, U>, &data, p_elements, p_grain));
+	}
+
+	void init(int p_thread_count = -1);
+	void finish();
+
+	WorkerThreadPool();
+	~WorkerThreadPool();
+};
+
+#endif // WORKER_THREAD_POOL_H
@@ -34,7 +34,6 @@
 #include "core/os/copymem.h"
 #include "core/os/memory.h"
 #include "core/os/rw_lock.h"
-#include "core/pool_allocator.h"
 #include "core/safe_refcount.h"
 #include "core/ustring.h"
 
@@ -42,38 +41,49 @@ struct MemoryPool {
 
 	//avoid accessing these directly, must be public for template access
 
-	static PoolAllocator *memory_pool;
-	static uint8_t *pool_memory;
-	static size_t *pool_size;
-
+	// Every buffer owns its Alloc, shared between PoolVectors only through the
+	// atomic refcount, so nothing here needs a global lock.
 	struct Alloc {
 
 		SafeRefCount refcount;
 		uint32_t lock;
 		void *mem;
-		PoolAllocator::ID pool_id;
 		size_t size;
 
-		Alloc *free_list;
-
 		Alloc() :
 				lock(0),
 				mem(NULL),
-				pool_id(POOL_ALLOCATOR_INVALID_ID),
-				size(0),
-				free_list(NULL) {
+				size(0) {
+			refcount.init();
 		}
 	};
 
-	static Alloc *allocs;
-	static Alloc *free_list;
-	static uint32_t alloc_count;
 	static uint32_t allocs_used;
-	static Mutex *alloc_mutex;
-	static size_t total_memory;
-	static size_t max_memory;
+	static uint64_t total_memory;
+	static uint64_t max_memory;
+
+	_FORCE_INLINE_ static Alloc *create_alloc() {
+
+		atomic_increment(&allocs_used);
+		return memnew(Alloc);
+	}
+
+	_FORCE_INLINE_ static void free_alloc(Alloc *p_alloc) {
+
+		memdelete(p_alloc);
+		atomic_decrement(&allocs_used);
+	}
+
+	_FORCE_INLINE_ static void track_resize(size_t p_old_size, size_t p_new_size) {
+#ifdef DEBUG_ENABLED
+		if (p_new_size > p_old_size) {
+			atomic_exchange_if_greater(&max_memory, atomic_add(&total_memory, (uint64_t)(p_new_size - p_old_size)));
+		} else {
+			atomic_sub(&total_memory, (uint64_t)(p_old_size - p_new_size));
+		}
+#endif
+	}
 
-	static void setup(uint32_t p_max_allocs = (1 << 16));
 	static void cleanup();
 };
 
@@ -95,40 +105,12 @@ class PoolVector {
 
 		//must allocate something
 
-		MemoryPool::alloc_mutex->lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex->unlock();
-			ERR_FAIL_MSG("All memory pool allocations are in use, can't COW.");
-		}
-
 		MemoryPool::Alloc *old_alloc = alloc;
 
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
-
-		//copy the alloc data
+		alloc = MemoryPool::create_alloc();
 		alloc->size = old_alloc->size;
-		alloc->refcount.init();
-		alloc->pool_id = POOL_ALLOCATOR_INVALID_ID;
-		alloc->lock = 0;
-
-#ifdef DEBUG_ENABLED
-		MemoryPool::total_memory += alloc->size;
-		if (MemoryPool::total_memory > MemoryPool::max_memory) {
-			MemoryPool::max_memory = MemoryPool::total_memory;
-		}
-#endif
-
-		MemoryPool::alloc_mutex->unlock();
-
-		if (MemoryPool::memory_pool) {
-
-		} else {
-			alloc->mem = memalloc(alloc->size);
-		}
+		alloc->mem = memalloc(alloc->size);
+		MemoryPool::track_resize(0, alloc->size);
 
 		{
 			Write w;
@@ -146,41 +128,33 @@ class PoolVector {
 
 		if (old_alloc->refcount.unref()) {
 			//this should never happen but..
+			_free_alloc(old_alloc);
+		}
+	}
 
-#ifdef DEBUG_ENABLED
-			MemoryPool::alloc_mutex->lock();
-			MemoryPool::total_memory -= old_alloc->size;
-			MemoryPool::alloc_mutex->unlock();
-#endif
+	static void _free_alloc(MemoryPool::Alloc *p_alloc) {
 
-			{
-				Write w;
-				w._ref(old_alloc);
+		{
+			int cur_elements = p_alloc->size / sizeof(T);
 
-				int cur_elements = old_alloc->size / sizeof(T);
-				T *elems = (T *)w.ptr();
-				for (int i = 0; i < cur_elements; i++) {
-					elems[i].~T();
-				}
-			}
+			// Don't use write() here because it could otherwise provoke COW,
+			// which is not desirable here because we are destroying the last reference anyways
+			Write w;
+			// Reference to still prevent other threads from touching the alloc
+			w._ref(p_alloc);
+
+			for (int i = 0; i < cur_elements; i++) {
 
-			if (MemoryPool::memory_pool) {
-				//resize memory pool
-				//if none, create
-				//if some resize
-			} else {
-
-				memfree(old_alloc->mem);
-				old_alloc->mem = NULL;
-				old_alloc->size = 0;
-
-				MemoryPool::alloc_mutex->lock();
-				old_alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = old_alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex->unlock();
+				w[i].~T();
 			}
 		}
+
+		MemoryPool::track_resize(p_alloc->size, 0);
+
+		if (p_alloc->mem) {
+			memfree(p_alloc->mem);
+		}
+		MemoryPool::free_alloc(p_alloc);
 	}
 
 	void _reference(const PoolVector &p_pool_vector) {
@@ -204,49 +178,9 @@ class PoolVector {
 		if (!alloc)
 			return;
 
-		if (!alloc->refcount.unref()) {
-			alloc = NULL;
-			return;
-		}
-
-		//must be disposed!
-
-		{
-			int cur_elements = alloc->size / sizeof(T);
-
-			// Don't use write() here because it could otherwise provoke COW,
-			// which is not desirable here because we are destroying the last reference anyways
-			Write w;
-			// Reference to still prevent other threads from touching the alloc
-			w._ref(alloc);
-
-			for (int i = 0; i < cur_elements; i++) {
-
-				w[i].~T();
-			}
-		}
-
-#ifdef DEBUG_ENABLED
-		MemoryPool::alloc_mutex->lock();
-		MemoryPool::total_memory -= alloc->size;
-		MemoryPool::alloc_mutex->unlock();
-#endif
-
-		if (MemoryPool::memory_pool) {
-			//resize memory pool
-			//if none, create
-			//if some resize
-		} else {
-
-			memfree(alloc->mem);
-			alloc->mem = NULL;
-			alloc->size = 0;
-
-			MemoryPool::alloc_mutex->lock();
-			alloc->free_list = MemoryPool::free_list;
-			MemoryPool::free_list = alloc;
-			MemoryPool::allocs_used--;
-			MemoryPool::alloc_mutex->unlock();
+		if (alloc->refcount.unref()) {
+			//must be disposed!
+			_free_alloc(alloc);
 		}
 
 		alloc = NULL;
@@ -263,12 +197,7 @@ public:
 		_FORCE_INLINE_ void _ref(MemoryPool::Alloc *p_alloc) {
 			alloc = p_alloc;
 			if (alloc) {
-				if (atomic_increment(&alloc->lock) == 1) {
-					if (MemoryPool::memory_pool) {
-						//lock it and get mem
-					}
-				}
-
+				atomic_increment(&alloc->lock);
 				mem = (T *)alloc->mem;
 			}
 		}
@@ -276,12 +205,7 @@ public:
 		_FORCE_INLINE_ void _unref() {
 
 			if (alloc) {
-				if (atomic_decrement(&alloc->lock) == 0) {
-					if (MemoryPool::memory_pool) {
-						//put mem back
-					}
-				}
-
+				atomic_decrement(&alloc->lock);
 				mem = NULL;
 				alloc = NULL;
 			}
@@ -460,6 +384,21 @@ public:
 
 	void invert();
 
+	// Hands the buffer over without touching the refcount, leaving p_from empty.
+	// Lets a producer pass a buffer it's done with to another thread or server
+	// without the receiver having to copy on its first write.
+	void move_from(PoolVector &p_from) {
+		if (this == &p_from)
+			return;
+		_unreference();
+		alloc = p_from.alloc;
+		p_from.alloc = NULL;
+	}
+
+	void swap(PoolVector &p_other) {
+		SWAP(alloc, p_other.alloc);
+	}
+
 	void operator=(const PoolVector &p_pool_vector) { _reference(p_pool_vector); }
 	PoolVector() { alloc = NULL; }
 	PoolVector(const PoolVector &p_pool_vector) {
@@ -522,24 +461,7 @@ Error PoolVector<T>::resize(int p_size) {
 		if (p_size == 0)
 			return OK; //nothing to do here
 
-		//must allocate something
-		MemoryPool::alloc_mutex->lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex->unlock();
-			ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "All memory pool allocations are in use.");
-		}
-
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
-
-		//cleanup the alloc
-		alloc->size = 0;
-		alloc->refcount.init();
-		alloc->pool_id = POOL_ALLOCATOR_INVALID_ID;
-		MemoryPool::alloc_mutex->unlock();
+		alloc = MemoryPool::create_alloc();
 
 	} else {
 
@@ -558,31 +480,16 @@ Error PoolVector<T>::resize(int p_size) {
 
 	_copy_on_write(); // make it unique
 
-#ifdef DEBUG_ENABLED
-	MemoryPool::alloc_mutex->lock();
-	MemoryPool::total_memory -= alloc->size;
-	MemoryPool::total_memory += new_size;
-	if (MemoryPool::total_memory > MemoryPool::max_memory) {
-		MemoryPool::max_memory = MemoryPool::total_memory;
-	}
-	MemoryPool::alloc_mutex->unlock();
-#endif
+	MemoryPool::track_resize(alloc->size, new_size);
 
 	int cur_elements = alloc->size / sizeof(T);
 
 	if (p_size > cur_elements) {
 
-		if (MemoryPool::memory_pool) {
-			//resize memory pool
-			//if none, create
-			//if some resize
+		if (alloc->size == 0) {
+			alloc->mem = memalloc(new_size);
 		} else {
-
-			if (alloc->size == 0) {
-				alloc->mem = memalloc(new_size);
-			} else {
-				alloc->mem = memrealloc(alloc->mem, new_size);
-			}
+			alloc->mem = memrealloc(alloc->mem, new_size);
 		}
 
 		alloc->size = new_size;
@@ -604,28 +511,8 @@ Error PoolVector<T>::resize(int p_size) {
 			}
 		}
 
-		if (MemoryPool::memory_pool) {
-			//resize memory pool
-			//if none, create
-			//if some resize
-		} else {
-
-			if (new_size == 0) {
-				memfree(alloc->mem);
-				alloc->mem = NULL;
-				alloc->size = 0;
-
-				MemoryPool::alloc_mutex->lock();
-				alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex->unlock();
-
-			} else {
-				alloc->mem = memrealloc(alloc->mem, new_size);
-				alloc->size = new_size;
-			}
-		}
+		alloc->mem = memrealloc(alloc->mem, new_size);
+		alloc->size = new_size;
 	}
 
 	return OK;
@@ -61,12 +61,18 @@
 #include "core/math/triangle_mesh.h"
 #include "core/os/input.h"
 #include "core/os/main_loop.h"
+#include "core/os/thread.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/packed_data_container.h"
 #include "core/path_remap.h"
 #include "core/project_settings.h"
 #include "core/translation.h"
 #include "core/undo_redo.h"
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+#include "core/os/small_object_allocator.h"
+#endif
+
 static Ref<ResourceFormatSaverBinary> resource_saver_binary;
 static Ref<ResourceFormatLoaderBinary> resource_loader_binary;
 static Ref<ResourceFormatImporter> resource_format_importer;
@@ -85,6 +91,8 @@ static _JSON *_json = NULL;
 
 static IP *ip = NULL;
 
+static WorkerThreadPool *worker_thread_pool = NULL;
+
 static _Geometry *_geometry = NULL;
 
 extern Mutex *_global_mutex;
@@ -98,11 +106,17 @@ void register_core_types() {
 
 	ObjectDB::setup();
 	ResourceCache::setup();
-	MemoryPool::setup();
 
 	_global_mutex = Mutex::create();
 
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+	// Before any thread is created, see Thread::add_exit_callback().
+	Thread::add_exit_callback(SmallObjectAllocator::thread_exit);
+#endif
 	StringName::setup();
+
+	worker_thread_pool = memnew(WorkerThreadPool);
+	worker_thread_pool->init();
 	ResourceLoader::initialize();
 
 	register_global_constants();
@@ -266,6 +280,9 @@ void register_core_singletons() {
 
 void unregister_core_types() {
 
+	memdelete(worker_thread_pool);
+	worker_thread_pool = NULL;
+
 	memdelete(_resource_loader);
 	memdelete(_resource_saver);
 	memdelete(_os);
@@ -166,4 +166,24 @@ uint64_t atomic_add(volatile uint64_t *pw, volatile uint64_t val) {
 uint64_t atomic_exchange_if_greater(volatile uint64_t *pw, volatile uint64_t val) {
 	return _atomic_exchange_if_greater_impl(pw, val);
 }
+
+bool atomic_compare_and_swap(volatile uint32_t *pw, volatile uint32_t oldval, volatile uint32_t newval) {
+	return InterlockedCompareExchange((LONG volatile *)pw, newval, oldval) == (LONG)oldval;
+}
+
+bool atomic_compare_and_swap(volatile uint64_t *pw, volatile uint64_t oldval, volatile uint64_t newval) {
+	return InterlockedCompareExchange64((LONGLONG volatile *)pw, newval, oldval) == (LONGLONG)oldval;
+}
+
+void atomic_acquire_fence() {
+	MemoryBarrier();
+}
+
+void atomic_release_fence() {
+	MemoryBarrier();
+}
+
+void atomic_cpu_pause() {
+	YieldProcessor();
+}
 #endif
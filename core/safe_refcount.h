@@ -93,6 +93,25 @@ static _ALWAYS_INLINE_ T atomic_exchange_if_greater(volatile T *pw, volatile V v
 	return *pw;
 }
 
+template <class T, class V>
+static _ALWAYS_INLINE_ bool atomic_compare_and_swap(volatile T *pw, volatile V oldval, volatile V newval) {
+
+	if (*pw != oldval)
+		return false;
+
+	*pw = newval;
+
+	return true;
+}
+
+// Fences order plain loads/stores around a flag or pointer published to other threads.
+
+static _ALWAYS_INLINE_ void atomic_acquire_fence() {}
+
+static _ALWAYS_INLINE_ void atomic_release_fence() {}
+
+static _ALWAYS_INLINE_ void atomic_cpu_pause() {}
+
 #elif defined(__GNUC__)
 
 /* Implementation for GCC & Clang */
@@ -148,6 +167,35 @@ static _ALWAYS_INLINE_ T atomic_exchange_if_greater(volatile T *pw, volatile V v
 	}
 }
 
+template <class T, class V>
+static _ALWAYS_INLINE_ bool atomic_compare_and_swap(volatile T *pw, volatile V oldval, volatile V newval) {
+
+	return __sync_bool_compare_and_swap(pw, (T)oldval, (T)newval);
+}
+
+// On x86 these only prevent compiler reordering.
+
+static _ALWAYS_INLINE_ void atomic_acquire_fence() {
+
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+static _ALWAYS_INLINE_ void atomic_release_fence() {
+
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+// Hints the CPU that this is a spin-wait loop, it doesn't order memory.
+
+static _ALWAYS_INLINE_ void atomic_cpu_pause() {
+
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
 #elif defined(_MSC_VER)
 // For MSVC use a separate compilation unit to prevent windows.h from polluting
 // the global namespace.
@@ -165,6 +213,13 @@ uint64_t atomic_sub(volatile uint64_t *pw, volatile uint64_t val);
 uint64_t atomic_add(volatile uint64_t *pw, volatile uint64_t val);
 uint64_t atomic_exchange_if_greater(volatile uint64_t *pw, volatile uint64_t val);
 
+bool atomic_compare_and_swap(volatile uint32_t *pw, volatile uint32_t oldval, volatile uint32_t newval);
+bool atomic_compare_and_swap(volatile uint64_t *pw, volatile uint64_t oldval, volatile uint64_t newval);
+
+void atomic_acquire_fence();
+void atomic_release_fence();
+void atomic_cpu_pause();
+
 #else
 //no threads supported?
 #error Must provide atomic functions for this platform or compiler!
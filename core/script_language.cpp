@@ -320,6 +320,12 @@ void ScriptInstance::call_multilevel_reversed(const StringName &p_method, const
 	call(p_method, p_args, p_argcount, ce); // script may not support multilevel calls
 }
 
+Variant ScriptInstance::call_resolved(const void *p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
+
+	r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
+	return Variant(); // Not reached, resolve_method() never resolves anything by default.
+}
+
 void ScriptInstance::property_set_fallback(const StringName &, const Variant &, bool *r_valid) {
 	if (r_valid)
 		*r_valid = false;
@@ -174,6 +174,14 @@ public:
 	virtual void call_multilevel(const StringName &p_method, VARIANT_ARG_LIST);
 	virtual void call_multilevel(const StringName &p_method, const Variant **p_args, int p_argcount);
 	virtual void call_multilevel_reversed(const StringName &p_method, const Variant **p_args, int p_argcount);
+
+	// Lets call sites resolve a method once and call it without looking it up by name again.
+	// Resolved methods stay valid while get_method_version() returns the same (non zero) value,
+	// NULL means the script has no such method. Languages returning 0 don't support it.
+	virtual uint64_t get_method_version() const { return 0; }
+	virtual const void *resolve_method(const StringName &p_method) const { return NULL; }
+	virtual Variant call_resolved(const void *p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error);
+
 	virtual void notification(int p_notification) = 0;
 	virtual String to_string(bool *r_valid) {
 		if (r_valid)
@@ -333,6 +341,13 @@ public:
 	};
 
 	virtual Vector<StackInfo> debug_get_current_stack_info() { return Vector<StackInfo>(); }
+	// Copies the call stack of the main thread, innermost call first, without stopping it.
+	// Used by ScriptSamplingProfiler, so it's called from another thread. Returns -1 if
+	// no consistent copy could be made because the stack kept changing.
+	virtual int profiling_get_stack_sample(StackInfo *p_info_arr, int p_info_max) { return 0; }
+	// Keeps the call stack of the main thread up to date for profiling_get_stack_sample() even when no
+	// ScriptDebugger is active. Called from the main thread while no script code is running.
+	virtual void profiling_set_sampling(bool p_enable) {}
 
 	virtual void reload_all_scripts() = 0;
 	virtual void reload_tool_script(const Ref<Script> &p_script, bool p_soft_reload) = 0;
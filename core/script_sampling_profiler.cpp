@@ -0,0 +1,191 @@
+/*************************************************************************/
+/*  script_sampling_profiler.cpp                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "script_sampling_profiler.h"
+
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+
+ScriptSamplingProfiler *ScriptSamplingProfiler::singleton = NULL;
+
+void ScriptSamplingProfiler::_thread_function(void *p_user) {
+
+	ScriptSamplingProfiler *profiler = (ScriptSamplingProfiler *)p_user;
+	ScriptLanguage::StackInfo *frames = memnew_arr(ScriptLanguage::StackInfo, MAX_STACK_DEPTH);
+
+	while (!profiler->exit_thread) {
+		OS::get_singleton()->delay_usec(profiler->interval_usec);
+		profiler->_take_sample(frames);
+	}
+
+	memdelete_arr(frames);
+}
+
+void ScriptSamplingProfiler::_take_sample(ScriptLanguage::StackInfo *p_frames) {
+
+	String stack;
+
+	// Stacks of different languages can't be interleaved, they are listed one after the other.
+	for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+		int count = ScriptServer::get_language(i)->profiling_get_stack_sample(p_frames, MAX_STACK_DEPTH);
+		if (count < 0) {
+			return; // Caught the stack changing too often, skip this sample.
+		}
+
+		// Frames come innermost first, collapsed stacks start from the root.
+		for (int j = count - 1; j >= 0; j--) {
+			String frame = p_frames[j].file.empty() ? p_frames[j].func : p_frames[j].file + ":" + p_frames[j].func;
+			if (!stack.empty()) {
+				stack += ";";
+			}
+			stack += frame.replace(";", ":");
+		}
+	}
+
+	if (stack.empty()) {
+		stack = "[native]";
+	}
+
+	mutex->lock();
+	uint64_t *samples = stacks.getptr(stack);
+	if (samples) {
+		(*samples)++;
+	} else {
+		stacks.set(stack, 1);
+	}
+	sample_count++;
+	mutex->unlock();
+}
+
+Error ScriptSamplingProfiler::start(uint32_t p_interval_usec) {
+
+	ERR_FAIL_COND_V_MSG(thread, ERR_ALREADY_IN_USE, "The sampling profiler is already running.");
+	ERR_FAIL_COND_V(p_interval_usec == 0, ERR_INVALID_PARAMETER);
+
+	for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+		ScriptServer::get_language(i)->profiling_set_sampling(true);
+	}
+
+	interval_usec = p_interval_usec;
+	exit_thread = false;
+	thread = Thread::create(_thread_function, this);
+	if (!thread) {
+		for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+			ScriptServer::get_language(i)->profiling_set_sampling(false);
+		}
+		ERR_FAIL_V_MSG(ERR_CANT_CREATE, "Couldn't create the sampling profiler thread.");
+	}
+
+	return OK;
+}
+
+void ScriptSamplingProfiler::stop() {
+
+	if (!thread) {
+		return;
+	}
+
+	exit_thread = true;
+	Thread::wait_to_finish(thread);
+	memdelete(thread);
+	thread = NULL;
+
+	for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+		ScriptServer::get_language(i)->profiling_set_sampling(false);
+	}
+}
+
+void ScriptSamplingProfiler::clear() {
+
+	mutex->lock();
+	stacks.clear();
+	sample_count = 0;
+	mutex->unlock();
+}
+
+uint64_t ScriptSamplingProfiler::get_sample_count() const {
+
+	mutex->lock();
+	uint64_t count = sample_count;
+	mutex->unlock();
+	return count;
+}
+
+String ScriptSamplingProfiler::get_collapsed_stacks() const {
+
+	Vector<String> lines;
+
+	mutex->lock();
+	const String *K = NULL;
+	while ((K = stacks.next(K))) {
+		lines.push_back(*K + " " + itos(stacks[*K]));
+	}
+	mutex->unlock();
+
+	lines.sort();
+
+	String result;
+	for (int i = 0; i < lines.size(); i++) {
+		result += lines[i] + "\n";
+	}
+	return result;
+}
+
+Error ScriptSamplingProfiler::save_collapsed_stacks(const String &p_path) const {
+
+	Error err;
+	FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(!f, err, "Can't open file for writing: " + p_path + ".");
+
+	f->store_string(get_collapsed_stacks());
+	f->close();
+	memdelete(f);
+
+	return OK;
+}
+
+ScriptSamplingProfiler::ScriptSamplingProfiler() {
+
+	ERR_FAIL_COND(singleton);
+	singleton = this;
+
+	thread = NULL;
+	exit_thread = false;
+	interval_usec = 1000;
+	mutex = Mutex::create();
+	sample_count = 0;
+}
+
+ScriptSamplingProfiler::~ScriptSamplingProfiler() {
+
+	stop();
+	memdelete(mutex);
+	singleton = NULL;
+}
@@ -0,0 +1,83 @@
+/*************************************************************************/
+/*  script_sampling_profiler.h                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SCRIPT_SAMPLING_PROFILER_H
+#define SCRIPT_SAMPLING_PROFILER_H
+
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
+#include "core/script_language.h"
+
+// Samples the script call stacks of the main thread at a fixed interval from
+// a thread of its own, so the profiled code doesn't pay for timing every call.
+// Samples are aggregated as collapsed stacks, one "root;caller;callee count"
+// line per distinct stack, which is what flame graph tools take as input.
+//
+// Languages otherwise only keep track of their call stack while a
+// ScriptDebugger is active, start() asks them to do it for the sampler too.
+// Time spent outside of script code is attributed to "[native]".
+
+class ScriptSamplingProfiler {
+
+	enum {
+		MAX_STACK_DEPTH = 256
+	};
+
+	static ScriptSamplingProfiler *singleton;
+
+	Thread *thread;
+	volatile bool exit_thread;
+	uint32_t interval_usec;
+
+	Mutex *mutex;
+	HashMap<String, uint64_t> stacks;
+	uint64_t sample_count;
+
+	static void _thread_function(void *p_user);
+	void _take_sample(ScriptLanguage::StackInfo *p_frames);
+
+public:
+	static ScriptSamplingProfiler *get_singleton() { return singleton; }
+
+	Error start(uint32_t p_interval_usec = 1000);
+	void stop();
+	bool is_running() const { return thread != NULL; }
+
+	void clear();
+	uint64_t get_sample_count() const;
+	String get_collapsed_stacks() const;
+	Error save_collapsed_stacks(const String &p_path) const;
+
+	ScriptSamplingProfiler();
+	~ScriptSamplingProfiler();
+};
+
+#endif // SCRIPT_SAMPLING_PROFILER_H
@@ -31,6 +31,8 @@
 #include "string_name.h"
 
 #include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/os/thread_local.h"
 #include "core/print_string.h"
 
 StaticCString StaticCString::create(const char *p_ptr) {
@@ -39,7 +41,7 @@ StaticCString StaticCString::create(const char *p_ptr) {
 	return scs;
 }
 
-StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+StringName::_Shard StringName::_shards[STRING_TABLE_SHARDS];
 
 StringName _scs_create(const char *p_chr) {
 
@@ -47,49 +49,368 @@ StringName _scs_create(const char *p_chr) {
 }
 
 bool StringName::configured = false;
-Mutex *StringName::lock = NULL;
 
-void StringName::setup() {
+// Each thread that looks names up owns one of these, padded so no two
+// threads write to the same cache line. Records are reused once their
+// thread exits (see _reader_release()) and are never freed, threads may
+// outlive a cleanup(). Threads not created through Thread::create() keep
+// theirs until the process ends.
+struct StringNameReader {
+	volatile uint32_t epoch; // Epoch the current lookup started in, 0 when idle.
+	volatile uint32_t used;
+	StringNameReader *next;
+	uint8_t padding[64];
+};
+
+static StringNameReader *volatile reader_list = NULL;
+static Mutex *reader_lock = NULL;
+// Always odd, so it never reads as an idle record. Only writers advance it.
+static volatile uint32_t reader_epoch = 1;
+
+static _THREAD_LOCAL_(StringNameReader *) thread_reader = NULL;
+
+// Registered as a Thread exit callback.
+static void _reader_release() {
+
+	StringNameReader *reader = thread_reader;
+	if (reader) {
+		atomic_release_fence();
+		reader->used = 0;
+		thread_reader = NULL;
+	}
+}
 
-	lock = Mutex::create();
+static StringNameReader *_reader_acquire() {
 
-	ERR_FAIL_COND(configured);
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
+	reader_lock->lock();
+
+	StringNameReader *reader = reader_list;
+	while (reader && reader->used) {
+		reader = reader->next;
+	}
+
+	if (!reader) {
+		reader = memnew(StringNameReader);
+		reader->epoch = 0;
+		reader->next = reader_list;
+		atomic_release_fence();
+		reader_list = reader;
+	}
+
+	reader->used = 1;
+	reader_lock->unlock();
+
+	thread_reader = reader;
+	return reader;
+}
+
+static _FORCE_INLINE_ StringNameReader *_reader_enter() {
+
+	StringNameReader *reader = thread_reader;
+	if (unlikely(!reader)) {
+		reader = _reader_acquire();
+	}
+
+	// Full barrier, the epoch must be visible before any bucket is read.
+	atomic_add(&reader->epoch, reader_epoch);
+	return reader;
+}
+
+static _FORCE_INLINE_ void _reader_leave(StringNameReader *p_reader) {
+
+	atomic_release_fence();
+	p_reader->epoch = 0;
+}
+
+// How many epochs ago the oldest lookup still running started.
+static uint32_t _oldest_reader_age(uint32_t p_epoch) {
+
+	uint32_t max_age = 0;
+	for (StringNameReader *reader = reader_list; reader; reader = reader->next) {
+
+		uint32_t epoch = reader->epoch;
+		if (epoch == 0) {
+			continue;
+		}
+
+		// Wraps safely, a lookup never lasts for 2^31 epochs.
+		int32_t age = (int32_t)(p_epoch - epoch);
+		if (age > (int32_t)max_age) {
+			max_age = age;
+		}
+	}
+
+	return max_age;
+}
+
+StringName::_Buckets *StringName::_alloc_buckets(uint32_t p_len) {
+
+	_Buckets *buckets = (_Buckets *)memalloc(sizeof(_Buckets) + sizeof(_Data *) * (p_len - 1));
+	buckets->mask = p_len - 1;
+	buckets->next_retired = NULL;
+	for (uint32_t i = 0; i < p_len; i++) {
+		buckets->table[i] = NULL;
+	}
+	return buckets;
+}
+
+void StringName::setup() {
 
-		_table[i] = NULL;
+	ERR_FAIL_COND(configured);
+	if (!reader_lock) {
+		reader_lock = Mutex::create();
+		Thread::add_exit_callback(_reader_release);
+	}
+	for (int i = 0; i < STRING_TABLE_SHARDS; i++) {
+
+		_Shard &shard = _shards[i];
+		shard.lock = Mutex::create();
+		shard.buckets = _alloc_buckets(STRING_TABLE_SHARD_MIN_LEN);
+		shard.count = 0;
+		shard.rehashes = 0;
+		shard.retired = NULL;
+		shard.retired_buckets = NULL;
+		shard.inserted = 0;
+		shard.removed = 0;
 	}
 	configured = true;
 }
 
 void StringName::cleanup() {
 
-	lock->lock();
-
 	int lost_strings = 0;
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
+	for (int i = 0; i < STRING_TABLE_SHARDS; i++) {
+
+		_Shard &shard = _shards[i];
+		shard.lock->lock();
+
+		_Buckets *buckets = shard.buckets;
+		for (uint32_t j = 0; j <= buckets->mask; j++) {
 
-		while (_table[i]) {
+			while (buckets->table[j]) {
 
-			_Data *d = _table[i];
-			lost_strings++;
-			if (OS::get_singleton()->is_stdout_verbose()) {
-				if (d->cname) {
-					print_line("Orphan StringName: " + String(d->cname));
-				} else {
-					print_line("Orphan StringName: " + String(d->name));
+				_Data *d = buckets->table[j];
+				lost_strings++;
+				if (OS::get_singleton()->is_stdout_verbose()) {
+					if (d->cname) {
+						print_line("Orphan StringName: " + String(d->cname));
+					} else {
+						print_line("Orphan StringName: " + String(d->name));
+					}
 				}
-			}
 
-			_table[i] = _table[i]->next;
-			memdelete(d);
+				buckets->table[j] = d->next;
+				memdelete(d);
+			}
 		}
+		memfree(buckets);
+		shard.buckets = NULL;
+
+		_free_retired(shard, true);
+
+		shard.lock->unlock();
+		memdelete(shard.lock);
+		shard.lock = NULL;
 	}
+
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
-	lock->unlock();
+	configured = false;
+}
+
+StringName::TableStats StringName::get_table_stats() {
+
+	TableStats stats;
+	stats.names = 0;
+	stats.buckets = 0;
+	stats.used_buckets = 0;
+	stats.longest_chain = 0;
+	stats.collisions = 0;
+	stats.rehashes = 0;
+	stats.inserted = 0;
+	stats.removed = 0;
+
+	ERR_FAIL_COND_V(!configured, stats);
+
+	for (int i = 0; i < STRING_TABLE_SHARDS; i++) {
+
+		_Shard &shard = _shards[i];
+		shard.lock->lock();
+
+		_Buckets *buckets = shard.buckets;
+		for (uint32_t j = 0; j <= buckets->mask; j++) {
+
+			uint32_t chain = 0;
+			for (_Data *d = buckets->table[j]; d; d = d->next) {
+				chain++;
+			}
+			if (chain) {
+				stats.used_buckets++;
+				stats.collisions += chain - 1;
+			}
+			stats.longest_chain = MAX(stats.longest_chain, chain);
+		}
+
+		stats.names += shard.count;
+		stats.buckets += buckets->mask + 1;
+		stats.rehashes += shard.rehashes;
+		stats.inserted += shard.inserted;
+		stats.removed += shard.removed;
+
+		shard.lock->unlock();
+	}
+
+	return stats;
+}
+
+// Shard lock must be held, the name must be unlinked already.
+void StringName::_retire(_Shard &p_shard, _Data *p_data) {
+
+	// Full barrier, lookups starting in the new epoch can't reach it anymore.
+	p_data->retired_epoch = atomic_add(&reader_epoch, 2);
+	p_data->next_retired = p_shard.retired;
+	p_shard.retired = p_data;
+}
+
+// Shard lock must be held, the buckets must be replaced already.
+void StringName::_retire(_Shard &p_shard, _Buckets *p_buckets) {
+
+	p_buckets->retired_epoch = atomic_add(&reader_epoch, 2);
+	p_buckets->next_retired = p_shard.retired_buckets;
+	p_shard.retired_buckets = p_buckets;
+}
+
+// Shard lock must be held. Frees what no running lookup started early enough
+// to see, or everything if p_all.
+void StringName::_free_retired(_Shard &p_shard, bool p_all) {
+
+	uint32_t epoch = reader_epoch;
+	uint32_t max_age = p_all ? 0 : _oldest_reader_age(epoch);
+
+	_Data **d_ptr = &p_shard.retired;
+	while (*d_ptr) {
+		_Data *d = *d_ptr;
+		if (epoch - d->retired_epoch >= max_age) {
+			*d_ptr = d->next_retired;
+			memdelete(d);
+		} else {
+			d_ptr = &d->next_retired;
+		}
+	}
+
+	_Buckets **b_ptr = &p_shard.retired_buckets;
+	while (*b_ptr) {
+		_Buckets *b = *b_ptr;
+		if (epoch - b->retired_epoch >= max_age) {
+			*b_ptr = b->next_retired;
+			memfree(b);
+		} else {
+			b_ptr = &b->next_retired;
+		}
+	}
+}
+
+// Shard lock must be held.
+void StringName::_grow(_Shard &p_shard) {
+
+	_Buckets *old_buckets = p_shard.buckets;
+	_Buckets *new_buckets = _alloc_buckets((old_buckets->mask + 1) << 1);
+
+	// Concurrent readers may follow a moved name into the wrong chain and
+	// miss, which only sends them to the locked path. They can't loop, as
+	// moved names only ever point to names moved before them.
+	for (uint32_t i = 0; i <= old_buckets->mask; i++) {
+
+		_Data *d = old_buckets->table[i];
+		while (d) {
+			_Data *next = d->next;
+			uint32_t idx = d->hash & new_buckets->mask;
+			d->prev = NULL;
+			d->next = new_buckets->table[idx];
+			if (new_buckets->table[idx]) {
+				new_buckets->table[idx]->prev = d;
+			}
+			new_buckets->table[idx] = d;
+			d = next;
+		}
+	}
 
-	memdelete(lock);
+	atomic_increment(&p_shard.rehashes); // Also acts as a barrier before publishing.
+	p_shard.buckets = new_buckets;
+
+	_retire(p_shard, old_buckets);
+	_free_retired(p_shard, false);
+}
+
+template <class T>
+StringName::_Data *StringName::_find(_Buckets *p_buckets, uint32_t p_hash, const T &p_name) {
+
+	for (_Data *d = p_buckets->table[p_hash & p_buckets->mask]; d; d = d->next) {
+
+		// compare hash first
+		if (d->hash == p_hash && d->get_name() == p_name) {
+			if (d->refcount.ref()) {
+				return d;
+			}
+			// Being released, keep looking for a live one.
+		}
+	}
+
+	return NULL;
+}
+
+template <class T>
+StringName::_Data *StringName::_intern(uint32_t p_hash, const T &p_name, const char *p_cname, bool p_create) {
+
+	_Shard &shard = _get_shard(p_hash);
+
+	// Fast path, already interned names are found without locking.
+	StringNameReader *reader = _reader_enter();
+	_Data *data = _find(shard.buckets, p_hash, p_name);
+	_reader_leave(reader);
+
+	if (data) {
+		return data;
+	}
+
+	// A miss may come from a concurrent _grow(), only a locked lookup is final.
+	shard.lock->lock();
+
+	data = _find(shard.buckets, p_hash, p_name);
+	if (data || !p_create) {
+		shard.lock->unlock();
+		return data;
+	}
+
+	data = memnew(_Data);
+	if (p_cname) {
+		data->cname = p_cname;
+	} else {
+		data->name = p_name;
+	}
+	data->refcount.init();
+	data->hash = p_hash;
+
+	if (shard.count > shard.buckets->mask) {
+		_grow(shard);
+	}
+
+	_Buckets *buckets = shard.buckets;
+	uint32_t idx = p_hash & buckets->mask;
+	data->next = buckets->table[idx];
+	data->prev = NULL;
+	if (buckets->table[idx]) {
+		buckets->table[idx]->prev = data;
+	}
+
+	atomic_increment(&shard.count); // Also acts as a barrier, data must be complete before publishing.
+	buckets->table[idx] = data;
+	shard.inserted++;
+
+	shard.lock->unlock();
+
+	return data;
 }
 
 void StringName::unref() {
@@ -98,22 +419,31 @@ void StringName::unref() {
 
 	if (_data && _data->refcount.unref()) {
 
-		lock->lock();
+		_Shard &shard = _get_shard(_data->hash);
+		shard.lock->lock();
 
+		_Buckets *buckets = shard.buckets;
 		if (_data->prev) {
 			_data->prev->next = _data->next;
 		} else {
-			if (_table[_data->idx] != _data) {
+			uint32_t idx = _data->hash & buckets->mask;
+			if (buckets->table[idx] != _data) {
 				ERR_PRINT("BUG!");
 			}
-			_table[_data->idx] = _data->next;
+			buckets->table[idx] = _data->next;
 		}
 
 		if (_data->next) {
 			_data->next->prev = _data->prev;
 		}
-		memdelete(_data);
-		lock->unlock();
+		atomic_decrement(&shard.count);
+		shard.removed++;
+
+		// Its "next" is left untouched, so readers standing on it can go on.
+		_retire(shard, _data);
+		_free_retired(shard, false);
+
+		shard.lock->unlock();
 	}
 
 	_data = NULL;
@@ -184,43 +514,7 @@ StringName::StringName(const char *p_name) {
 	if (!p_name || p_name[0] == 0)
 		return; //empty, ignore
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(String::hash(p_name), p_name, NULL, true);
 }
 
 StringName::StringName(const StaticCString &p_static_string) {
@@ -231,43 +525,7 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_static_string.ptr);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(String::hash(p_static_string.ptr), p_static_string.ptr, p_static_string.ptr, true);
 }
 
 StringName::StringName(const String &p_name) {
@@ -279,42 +537,7 @@ StringName::StringName(const String &p_name) {
 	if (p_name == String())
 		return;
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(p_name.hash(), p_name, NULL, true);
 }
 
 StringName StringName::search(const char *p_name) {
@@ -325,29 +548,11 @@ StringName StringName::search(const char *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-
-		return StringName(_data);
+	_Data *data = _intern(String::hash(p_name), p_name, NULL, false);
+	if (data) {
+		return StringName(data);
 	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -359,56 +564,23 @@ StringName StringName::search(const CharType *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
+	_Data *data = _intern(String::hash(p_name), p_name, NULL, false);
+	if (data) {
+		return StringName(data);
 	}
 
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-		return StringName(_data);
-	}
-
-	lock->unlock();
 	return StringName(); //does not exist
 }
+
 StringName StringName::search(const String &p_name) {
 
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name())
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-		return StringName(_data);
+	_Data *data = _intern(p_name.hash(), p_name, NULL, false);
+	if (data) {
+		return StringName(data);
 	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -45,9 +45,9 @@ class StringName {
 
 	enum {
 
-		STRING_TABLE_BITS = 12,
-		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_SHARD_BITS = 6,
+		STRING_TABLE_SHARDS = 1 << STRING_TABLE_SHARD_BITS,
+		STRING_TABLE_SHARD_MIN_LEN = 64 // 4096 buckets overall to begin with.
 	};
 
 	struct _Data {
@@ -56,19 +56,43 @@ class StringName {
 		String name;
 
 		String get_name() const { return cname ? String(cname) : name; }
-		int idx;
 		uint32_t hash;
 		_Data *prev;
-		_Data *next;
+		_Data *volatile next;
+		_Data *next_retired;
+		uint32_t retired_epoch;
 		_Data() {
 			cname = NULL;
 			next = prev = NULL;
-			idx = 0;
+			next_retired = NULL;
 			hash = 0;
+			retired_epoch = 0;
 		}
 	};
 
-	static _Data *_table[STRING_TABLE_LEN];
+	struct _Buckets {
+		uint32_t mask;
+		uint32_t retired_epoch;
+		_Buckets *next_retired;
+		_Data *volatile table[1];
+	};
+
+	// Lookups walk the buckets without taking the lock, they only publish the
+	// epoch they started in to a record owned by their thread. Writers hold
+	// the lock, stamp unlinked names or bucket arrays with a newer epoch and
+	// only free them once no reader that started before may still be walking.
+	struct _Shard {
+		Mutex *lock;
+		_Buckets *volatile buckets;
+		volatile uint32_t count;
+		volatile uint32_t rehashes;
+		_Data *retired;
+		_Buckets *retired_buckets;
+		uint64_t inserted;
+		uint64_t removed;
+	};
+
+	static _Shard _shards[STRING_TABLE_SHARDS];
 
 	_Data *_data;
 
@@ -82,14 +106,41 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 
-	static Mutex *lock;
 	static void setup();
 	static void cleanup();
 	static bool configured;
 
+	static _FORCE_INLINE_ _Shard &_get_shard(uint32_t p_hash) {
+		// Fibonacci hashing, short names have little entropy in the high bits.
+		return _shards[(p_hash * 2654435769U) >> (32 - STRING_TABLE_SHARD_BITS)];
+	}
+
+	static _Buckets *_alloc_buckets(uint32_t p_len);
+	static void _grow(_Shard &p_shard);
+	static void _retire(_Shard &p_shard, _Data *p_data);
+	static void _retire(_Shard &p_shard, _Buckets *p_buckets);
+	static void _free_retired(_Shard &p_shard, bool p_all);
+	template <class T>
+	static _Data *_find(_Buckets *p_buckets, uint32_t p_hash, const T &p_name);
+	template <class T>
+	static _Data *_intern(uint32_t p_hash, const T &p_name, const char *p_cname, bool p_create);
+
 	StringName(_Data *p_data) { _data = p_data; }
 
 public:
+	struct TableStats {
+		uint32_t names;
+		uint32_t buckets;
+		uint32_t used_buckets;
+		uint32_t longest_chain;
+		uint32_t collisions; // Names sharing their bucket with a previous one.
+		uint32_t rehashes;
+		uint64_t inserted;
+		uint64_t removed;
+	};
+
+	static TableStats get_table_stats();
+
 	operator const void *() const { return (_data && (_data->cname || !_data->name.empty())) ? (void *)1 : 0; }
 
 	bool operator==(const String &p_name) const;
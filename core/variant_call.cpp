@@ -34,6 +34,7 @@
 #include "core/core_string_names.h"
 #include "core/crypto/crypto_core.h"
 #include "core/io/compression.h"
+#include "core/method_call_cache.h"
 #include "core/object.h"
 #include "core/os/os.h"
 #include "core/script_language.h"
@@ -1132,6 +1133,56 @@ void Variant::call_ptr(const StringName &p_method, const Variant **p_args, int p
 		*r_ret = ret;
 }
 
+void *MethodCallCache::_find_builtin_method(Variant::Type p_type, const StringName &p_method) {
+
+	Map<StringName, _VariantCall::FuncData>::Element *E = _VariantCall::type_funcs[p_type].functions.find(p_method);
+	return E ? &E->get() : NULL;
+}
+
+void MethodCallCache::call_ptr(Variant &p_base, const Variant **p_args, int p_argcount, Variant *r_ret, Variant::CallError &r_error) const {
+	Variant ret;
+
+	if (p_base.type == Variant::OBJECT) {
+
+		Object *obj = p_base._get_obj().obj;
+		if (!obj) {
+			r_error.error = Variant::CallError::CALL_ERROR_INSTANCE_IS_NULL;
+			return;
+		}
+#ifdef DEBUG_ENABLED
+		if (ScriptDebugger::get_singleton() && p_base._get_obj().ref.is_null()) {
+			//only if debugging!
+			if (!ObjectDB::instance_validate(obj)) {
+				r_error.error = Variant::CallError::CALL_ERROR_INSTANCE_IS_NULL;
+				return;
+			}
+		}
+#endif
+
+		ret = call(obj, p_args, p_argcount, r_error);
+
+	} else {
+
+		void *target = NULL;
+		if (!_get_builtin_method(p_base.type, &target)) {
+			p_base.call_ptr(method, p_args, p_argcount, r_ret, r_error);
+			return;
+		}
+
+		r_error.error = Variant::CallError::CALL_OK;
+
+		_VariantCall::FuncData *funcdata = (_VariantCall::FuncData *)target;
+		if (!funcdata) {
+			r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
+			return;
+		}
+		funcdata->call(ret, p_base, p_args, p_argcount, r_error);
+	}
+
+	if (r_error.error == Variant::CallError::CALL_OK && r_ret)
+		*r_ret = ret;
+}
+
 #define VCALL(m_type, m_method) _VariantCall::_call_##m_type##_##m_method
 
 Variant Variant::construct(const Variant::Type p_type, const Variant **p_args, int p_argcount, CallError &r_error, bool p_strict) {
@@ -0,0 +1,105 @@
+/*************************************************************************/
+/*  variant_internal.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef VARIANT_INTERNAL_H
+#define VARIANT_INTERNAL_H
+
+#include "core/variant.h"
+
+/**
+ * Direct access to the value held by a Variant, for hot paths that already
+ * know its type (such as the typed GDScript opcodes). Getters don't check the
+ * type, setters switch the Variant to the value's type if needed.
+ */
+class VariantInternal {
+
+	_FORCE_INLINE_ static void _set_type(Variant *v, Variant::Type p_type) {
+		if (v->type != p_type) {
+			v->clear();
+			v->type = p_type;
+		}
+	}
+
+public:
+	_FORCE_INLINE_ static bool get_bool(const Variant *v) { return v->_data._bool; }
+	_FORCE_INLINE_ static int64_t get_int(const Variant *v) { return v->_data._int; }
+	_FORCE_INLINE_ static double get_real(const Variant *v) { return v->_data._real; }
+	_FORCE_INLINE_ static const Vector2 &get_vector2(const Variant *v) { return *reinterpret_cast<const Vector2 *>(v->_data._mem); }
+	_FORCE_INLINE_ static const Vector3 &get_vector3(const Variant *v) { return *reinterpret_cast<const Vector3 *>(v->_data._mem); }
+	_FORCE_INLINE_ static const Color &get_color(const Variant *v) { return *reinterpret_cast<const Color *>(v->_data._mem); }
+	template <class T>
+	_FORCE_INLINE_ static const PoolVector<T> &get_pool_array(const Variant *v) { return *reinterpret_cast<const PoolVector<T> *>(v->_data._mem); }
+	template <class T>
+	_FORCE_INLINE_ static PoolVector<T> &get_pool_array(Variant *v) { return *reinterpret_cast<PoolVector<T> *>(v->_data._mem); }
+
+	// Pointer to the value in the layout MethodBind::ptrcall uses (int64_t for
+	// INT, double for REAL). For objects, this points at the Object pointer.
+	_FORCE_INLINE_ static const void *get_opaque_pointer(const Variant *v) {
+		switch (v->type) {
+			case Variant::NIL: return NULL;
+			case Variant::BOOL: return &v->_data._bool;
+			case Variant::INT: return &v->_data._int;
+			case Variant::REAL: return &v->_data._real;
+			case Variant::TRANSFORM2D: return v->_data._transform2d;
+			case Variant::AABB: return v->_data._aabb;
+			case Variant::BASIS: return v->_data._basis;
+			case Variant::TRANSFORM: return v->_data._transform;
+			default: return v->_data._mem;
+		}
+	}
+	_FORCE_INLINE_ static void *get_opaque_pointer(Variant *v) { return const_cast<void *>(get_opaque_pointer(const_cast<const Variant *>(v))); }
+
+	_FORCE_INLINE_ static void set_bool(Variant *v, bool p_value) {
+		_set_type(v, Variant::BOOL);
+		v->_data._bool = p_value;
+	}
+	_FORCE_INLINE_ static void set_int(Variant *v, int64_t p_value) {
+		_set_type(v, Variant::INT);
+		v->_data._int = p_value;
+	}
+	_FORCE_INLINE_ static void set_real(Variant *v, double p_value) {
+		_set_type(v, Variant::REAL);
+		v->_data._real = p_value;
+	}
+	_FORCE_INLINE_ static void set_vector2(Variant *v, const Vector2 &p_value) {
+		_set_type(v, Variant::VECTOR2);
+		*reinterpret_cast<Vector2 *>(v->_data._mem) = p_value;
+	}
+	_FORCE_INLINE_ static void set_vector3(Variant *v, const Vector3 &p_value) {
+		_set_type(v, Variant::VECTOR3);
+		*reinterpret_cast<Vector3 *>(v->_data._mem) = p_value;
+	}
+	_FORCE_INLINE_ static void set_color(Variant *v, const Color &p_value) {
+		_set_type(v, Variant::COLOR);
+		*reinterpret_cast<Color *>(v->_data._mem) = p_value;
+	}
+};
+
+#endif // VARIANT_INTERNAL_H
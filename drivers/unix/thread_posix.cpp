@@ -74,6 +74,7 @@ void *ThreadPosix::thread_callback(void *userdata) {
 	t->callback(t->user);
 
 	ScriptServer::thread_exit();
+	Thread::thread_exited();
 
 	return NULL;
 }
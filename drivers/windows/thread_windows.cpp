@@ -55,6 +55,7 @@ DWORD ThreadWindows::thread_callback(LPVOID userdata) {
 	SetEvent(t->handle);
 
 	ScriptServer::thread_exit();
+	Thread::thread_exited();
 
 	return 0;
 }
@@ -2524,7 +2524,7 @@ void EditorPropertyResource::_sub_inspector_resource_selected(const RES &p_resou
 	emit_signal("resource_selected", String(get_edited_property()) + ":" + p_property, p_resource);
 }
 
-void EditorPropertyResource::_sub_inspector_object_id_selected(int p_id) {
+void EditorPropertyResource::_sub_inspector_object_id_selected(ObjectID p_id) {
 
 	emit_signal("object_id_selected", get_edited_property(), p_id);
 }
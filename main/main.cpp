@@ -45,6 +45,7 @@
 #include "core/register_core_types.h"
 #include "core/script_debugger_local.h"
 #include "core/script_language.h"
+#include "core/script_sampling_profiler.h"
 #include "core/translation.h"
 #include "core/version.h"
 #include "core/version_hash.gen.h"
@@ -93,6 +94,7 @@ static ZipArchive *zip_packed_data = NULL;
 #endif
 static FileAccessNetworkClient *file_access_network_client = NULL;
 static ScriptDebugger *script_debugger = NULL;
+static ScriptSamplingProfiler *sampling_profiler = NULL;
 static MessageQueue *message_queue = NULL;
 
 // Initialized in setup2()
@@ -135,6 +137,7 @@ static bool force_lowdpi = false;
 // Debug
 
 static bool use_debug_profiler = false;
+static String sampling_profiler_path;
 #ifdef DEBUG_ENABLED
 static bool debug_collisions = false;
 static bool debug_navigation = false;
@@ -264,6 +267,7 @@ void Main::print_help(const char *p_binary) {
 	OS::get_singleton()->print("  -d, --debug                      Debug (local stdout debugger).\n");
 	OS::get_singleton()->print("  -b, --breakpoints                Breakpoint list as source::line comma-separated pairs, no spaces (use %%20 instead).\n");
 	OS::get_singleton()->print("  --profiling                      Enable profiling in the script debugger.\n");
+	OS::get_singleton()->print("  --sampling-profiler <file>       Sample script call stacks and save them as collapsed stacks (flame graph input) on exit. Needs a debug build, no debugger is required.\n");
 	OS::get_singleton()->print("  --remote-debug <address>         Remote debug (<host/IP>:<port> address).\n");
 #if defined(DEBUG_ENABLED) && !defined(SERVER_ENABLED)
 	OS::get_singleton()->print("  --debug-collisions               Show collision shapes when running the scene.\n");
@@ -289,6 +293,8 @@ void Main::print_help(const char *p_binary) {
 #ifdef DEBUG_METHODS_ENABLED
 	OS::get_singleton()->print("  --gdnative-generate-json-api     Generate JSON dump of the Godot API for GDNative bindings.\n");
 #endif
+#endif
+#if defined(TOOLS_ENABLED) || defined(BENCHMARKS_ENABLED)
 	OS::get_singleton()->print("  --test <test>                    Run a unit test (");
 	const char **test_names = tests_get_names();
 	const char *comma = "";
@@ -593,6 +599,19 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 
 			use_debug_profiler = true;
 
+		} else if (I->get() == "--sampling-profiler") { // sample script call stacks
+
+			if (I->next()) {
+
+				sampling_profiler_path = I->next()->get();
+#ifndef DEBUG_ENABLED
+				OS::get_singleton()->print("Script call stacks aren't tracked in release builds, all samples will be counted as [native].\n");
+#endif
+				N = I->next()->next();
+			} else {
+				OS::get_singleton()->print("Missing sampling profiler output file, aborting.\n");
+				goto error;
+			}
 		} else if (I->get() == "-l" || I->get() == "--language") { // language
 
 			if (I->next()) {
@@ -1343,6 +1362,10 @@ Error Main::setup2(Thread::ID p_main_tid_override) {
 	if (use_debug_profiler && script_debugger) {
 		script_debugger->profiling_start();
 	}
+	if (sampling_profiler_path != "") {
+		sampling_profiler = memnew(ScriptSamplingProfiler);
+		sampling_profiler->start();
+	}
 	_start_success = true;
 	locale = String();
 
@@ -1504,7 +1527,7 @@ bool Main::start() {
 	};
 
 	if (test != "") {
-#ifdef TOOLS_ENABLED
+#if defined(TOOLS_ENABLED) || defined(BENCHMARKS_ENABLED)
 		main_loop = test_main(test, args);
 
 		if (!main_loop)
@@ -1964,6 +1987,7 @@ bool Main::iteration() {
 
 		message_queue->flush();
 
+		PhysicsServer::get_singleton()->end_sync();
 		PhysicsServer::get_singleton()->step(frame_slice * time_scale);
 
 		Physics2DServer::get_singleton()->end_sync();
@@ -2096,6 +2120,12 @@ void Main::cleanup() {
 	message_queue->flush();
 	memdelete(message_queue);
 
+	if (sampling_profiler) {
+		sampling_profiler->stop();
+		sampling_profiler->save_collapsed_stacks(sampling_profiler_path);
+		memdelete(sampling_profiler);
+	}
+
 	if (script_debugger) {
 		if (use_debug_profiler) {
 			script_debugger->profiling_end();
@@ -31,6 +31,7 @@
 #include "performance.h"
 
 #include "core/message_queue.h"
+#include "core/os/small_object_allocator.h"
 #include "core/os/os.h"
 #include "scene/main/node.h"
 #include "scene/main/scene_tree.h"
@@ -44,6 +45,7 @@ Performance *Performance::singleton = NULL;
 void Performance::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_monitor", "monitor"), &Performance::get_monitor);
+	ClassDB::bind_method(D_METHOD("get_small_object_stats"), &Performance::get_small_object_stats);
 
 	BIND_ENUM_CONSTANT(TIME_FPS);
 	BIND_ENUM_CONSTANT(TIME_PROCESS);
@@ -74,6 +76,7 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(MEMORY_SMALL_OBJECTS_RESERVED);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -120,6 +123,7 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"memory/small_objects_reserved",
 
 	};
 
@@ -158,6 +162,9 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY: return AudioServer::get_singleton()->get_output_latency();
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+		case MEMORY_SMALL_OBJECTS_RESERVED: return SmallObjectAllocator::get_reserved_bytes();
+#endif
 
 		default: {
 		}
@@ -200,12 +207,35 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_MEMORY,
 
 	};
 
 	return types[p_monitor];
 }
 
+Array Performance::get_small_object_stats() const {
+
+	Array stats;
+
+#ifdef SMALL_OBJECT_ALLOCATOR_ENABLED
+	for (int i = 0; i < SmallObjectAllocator::SIZE_CLASS_COUNT; i++) {
+
+		SmallObjectAllocator::SizeClassStats class_stats = SmallObjectAllocator::get_size_class_stats(i);
+
+		Dictionary d;
+		d["size"] = class_stats.size;
+		d["reserved"] = class_stats.reserved;
+		d["shared_free"] = class_stats.shared_free;
+		d["refills"] = class_stats.refills;
+		d["flushes"] = class_stats.flushes;
+		stats.push_back(d);
+	}
+#endif
+
+	return stats;
+}
+
 void Performance::set_process_time(float p_pt) {
 
 	_process_time = p_pt;
@@ -81,6 +81,7 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		MEMORY_SMALL_OBJECTS_RESERVED,
 		MONITOR_MAX
 	};
 
@@ -95,6 +96,8 @@ public:
 
 	MonitorType get_monitor_type(Monitor p_monitor) const;
 
+	Array get_small_object_stats() const;
+
 	void set_process_time(float p_pt);
 	void set_physics_process_time(float p_pt);
 
@@ -0,0 +1,553 @@
+/*************************************************************************/
+/*  test_bench.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_bench.h"
+
+#include "core/array.h"
+#include "core/class_db.h"
+#include "core/dictionary.h"
+#include "core/engine.h"
+#include "core/io/json.h"
+#include "core/math/random_pcg.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/reference.h"
+#include "core/script_language.h"
+#include "servers/physics/body_sw.h"
+#include "servers/physics/broad_phase_aabb_tree.h"
+#include "servers/physics/broad_phase_octree.h"
+
+/*
+ * Micro-benchmarks for hot core code, run with:
+ *
+ *   godot_server --test bench [--bench-filter <substring>] [--bench-output <file.json>]
+ *
+ * Tests are only built with tools. Builds without tools, like headless
+ * server templates, include this benchmark when built with benchmarks=yes.
+ *
+ * Every benchmark runs a fixed amount of iterations a few times and reports the
+ * fastest run. Results are printed (and optionally saved) as JSON, so runs of
+ * different builds can be compared by name. The report also includes the
+ * StringName table statistics.
+ */
+
+namespace TestBench {
+
+// Benchmarks return something derived from their work, so it can't be optimized out.
+typedef uint64_t (*BenchFunc)(int p_iterations);
+
+struct Bench {
+	const char *name;
+	BenchFunc func;
+	int iterations;
+};
+
+/* String */
+
+uint64_t bench_string_concat(int p_iterations) {
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		String s = "node_";
+		s += itos(i & 1023);
+		s += "/child";
+		total += s.length();
+	}
+	return total;
+}
+
+uint64_t bench_string_find(int p_iterations) {
+	String text = "The quick brown fox jumps over the lazy dog, then looks for the needle in the haystack.";
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += text.find("needle");
+	}
+	return total;
+}
+
+uint64_t bench_string_compare(int p_iterations) {
+	String a = "res://scenes/levels/level_01.tscn";
+	String b = String("res://scenes/levels/") + "level_01.tscn"; // Equal, but not shared.
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += a == b;
+	}
+	return total;
+}
+
+uint64_t bench_string_utf8(int p_iterations) {
+	String s = "Godot Engine – Multi-platform 2D and 3D game engine";
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += s.utf8().length();
+	}
+	return total;
+}
+
+/* StringName */
+
+uint64_t bench_string_name_from_cstring(int p_iterations) {
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		StringName name = "position";
+		total += name.hash();
+	}
+	return total;
+}
+
+uint64_t bench_string_name_from_string(int p_iterations) {
+	String str = "global_transform";
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		StringName name = str;
+		total += name.hash();
+	}
+	return total;
+}
+
+uint64_t bench_string_name_unique(int p_iterations) {
+	// Each name is new, so this measures interning and releasing.
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		StringName name = "bench_name_" + itos(i);
+		total += name.hash();
+	}
+	return total;
+}
+
+/* Array and Dictionary */
+
+uint64_t bench_array_push_back(int p_iterations) {
+	Array array;
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		if ((i & 1023) == 0) {
+			total += array.size();
+			array.clear();
+		}
+		array.push_back(i);
+	}
+	return total + array.size();
+}
+
+uint64_t bench_array_index(int p_iterations) {
+	Array array;
+	for (int i = 0; i < 1024; i++) {
+		array.push_back(i);
+	}
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += (int)array[i & 1023];
+	}
+	return total;
+}
+
+uint64_t bench_dictionary_set_int(int p_iterations) {
+	Dictionary dict;
+	for (int i = 0; i < p_iterations; i++) {
+		dict[i & 1023] = i;
+	}
+	return dict.size();
+}
+
+uint64_t bench_dictionary_get_int(int p_iterations) {
+	Dictionary dict;
+	Vector<Variant> keys;
+	for (int i = 0; i < 1024; i++) {
+		dict[i] = i;
+		keys.push_back(i);
+	}
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += (int)dict[keys[i & 1023]];
+	}
+	return total;
+}
+
+uint64_t bench_dictionary_get_string(int p_iterations) {
+	Dictionary dict;
+	Vector<Variant> keys;
+	for (int i = 0; i < 1024; i++) {
+		String key = "key_" + itos(i);
+		dict[key] = i;
+		keys.push_back(key);
+	}
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += (int)dict[keys[i & 1023]];
+	}
+	return total;
+}
+
+/* Variant::evaluate */
+
+uint64_t bench_variant_add_int(int p_iterations) {
+	Variant a = 0;
+	Variant b = 3;
+	for (int i = 0; i < p_iterations; i++) {
+		a = Variant::evaluate(Variant::OP_ADD, a, b);
+	}
+	return (int64_t)a;
+}
+
+uint64_t bench_variant_add_real(int p_iterations) {
+	Variant a = 0.0;
+	Variant b = 0.5;
+	for (int i = 0; i < p_iterations; i++) {
+		a = Variant::evaluate(Variant::OP_ADD, a, b);
+	}
+	return (int64_t)(double)a;
+}
+
+uint64_t bench_variant_mul_vector3(int p_iterations) {
+	Variant a = Vector3(1, 2, 3);
+	Variant b = 1.0;
+	for (int i = 0; i < p_iterations; i++) {
+		a = Variant::evaluate(Variant::OP_MULTIPLY, a, b);
+	}
+	return (int64_t)((Vector3)a).x;
+}
+
+uint64_t bench_variant_equal_string(int p_iterations) {
+	Variant a = "res://icon.png";
+	Variant b = String("res://") + "icon.png";
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += (bool)Variant::evaluate(Variant::OP_EQUAL, a, b);
+	}
+	return total;
+}
+
+uint64_t bench_variant_less_int(int p_iterations) {
+	Variant a = 10;
+	Variant b = 20;
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += (bool)Variant::evaluate(Variant::OP_LESS, a, b);
+	}
+	return total;
+}
+
+/* Object */
+
+uint64_t bench_object_call(int p_iterations) {
+	Object *obj = memnew(Object);
+	StringName method = "get_instance_id";
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += (uint64_t)obj->call(method);
+	}
+	memdelete(obj);
+	return total;
+}
+
+uint64_t bench_object_call_arg(int p_iterations) {
+	Object *obj = memnew(Object);
+	StringName method = "is_class";
+	Variant arg = "Node";
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += (bool)obj->call(method, arg);
+	}
+	memdelete(obj);
+	return total;
+}
+
+uint64_t bench_emit_signal(int p_iterations) {
+	Object *emitter = memnew(Object);
+	Object *target = memnew(Object);
+	emitter->connect("script_changed", target, "get_instance_id");
+	StringName signal = "script_changed";
+	for (int i = 0; i < p_iterations; i++) {
+		emitter->emit_signal(signal);
+	}
+	memdelete(emitter);
+	memdelete(target);
+	return p_iterations;
+}
+
+/* Scripts */
+
+// Built through ClassDB, the visual_script module may not be part of the build.
+uint64_t bench_visual_script_call(int p_iterations) {
+	const int ops = 8;
+
+	Object *script_obj = ClassDB::instance("VisualScript");
+	if (!script_obj) {
+		return 0;
+	}
+	Ref<Script> script = Object::cast_to<Script>(script_obj);
+	script->call("set_instance_base_type", "Reference");
+	script->call("add_function", "run");
+
+	Ref<Reference> function_node = Object::cast_to<Reference>(ClassDB::instance("VisualScriptFunction"));
+	script->call("add_node", "run", 0, function_node);
+
+	Ref<Reference> return_node = Object::cast_to<Reference>(ClassDB::instance("VisualScriptReturn"));
+	return_node->call("set_enable_return_value", true);
+	script->call("add_node", "run", 1, return_node);
+	script->call("sequence_connect", "run", 0, 0, 1);
+
+	// A chain of additions, each node is a dependency step of the next one.
+	for (int i = 0; i < ops; i++) {
+		Ref<Reference> op = Object::cast_to<Reference>(ClassDB::instance("VisualScriptOperator"));
+		op->call("set_operator", Variant::OP_ADD);
+		op->call("set_default_input_value", 0, 0);
+		op->call("set_default_input_value", 1, i + 1);
+		script->call("add_node", "run", 2 + i, op);
+		if (i > 0) {
+			script->call("data_connect", "run", 1 + i, 0, 2 + i, 0);
+		}
+	}
+	script->call("data_connect", "run", 1 + ops, 0, 1, 0);
+
+	Ref<Reference> obj = memnew(Reference);
+	obj->set_script(script.get_ref_ptr());
+
+	StringName method = "run";
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		total += (uint64_t)obj->call(method);
+	}
+	return total;
+}
+
+/* Memory */
+
+uint64_t bench_memalloc_memfree(int p_iterations) {
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		size_t size = 16 + (i & 15) * 16;
+		uint8_t *mem = (uint8_t *)memalloc(size);
+		mem[0] = i;
+		total += mem[0];
+		memfree(mem);
+	}
+	return total;
+}
+
+uint64_t bench_memnew_object(int p_iterations) {
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		Object *obj = memnew(Object);
+		total += obj->get_instance_id();
+		memdelete(obj);
+	}
+	return total;
+}
+
+uint64_t bench_memnew_reference(int p_iterations) {
+	uint64_t total = 0;
+	for (int i = 0; i < p_iterations; i++) {
+		Ref<Reference> ref = memnew(Reference);
+		total += ref->is_referenced();
+	}
+	return total;
+}
+
+/* Physics */
+
+static void *_broadphase_pair(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_userdata) {
+	(*(int *)p_userdata)++;
+	return p_userdata;
+}
+
+static void _broadphase_unpair(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_data, void *p_userdata) {
+	(*(int *)p_userdata)--;
+}
+
+// Each iteration is one frame of 10k boxes moving (and bouncing) inside a cube, including setup.
+static uint64_t _bench_broadphase(BroadPhaseSW::CreateFunction p_create, int p_iterations) {
+	const int count = 10000;
+	const real_t extent = 100.0;
+
+	BroadPhaseSW *broadphase = p_create();
+	int pairs = 0;
+	broadphase->set_pair_callback(_broadphase_pair, &pairs);
+	broadphase->set_unpair_callback(_broadphase_unpair, &pairs);
+
+	RandomPCG rng(1);
+	Vector<BodySW *> bodies;
+	Vector<BroadPhaseSW::ID> ids;
+	Vector<AABB> aabbs;
+	Vector<Vector3> velocities;
+	for (int i = 0; i < count; i++) {
+		BodySW *body = memnew(BodySW);
+		BroadPhaseSW::ID id = broadphase->create(body);
+		broadphase->set_static(id, false);
+		AABB aabb(Vector3(rng.randf(), rng.randf(), rng.randf()) * extent, Vector3(1, 1, 1));
+		broadphase->move(id, aabb);
+		bodies.push_back(body);
+		ids.push_back(id);
+		aabbs.push_back(aabb);
+		velocities.push_back(Vector3(rng.randf() - 0.5, rng.randf() - 0.5, rng.randf() - 0.5) * (20.0 / 60.0));
+	}
+	broadphase->update();
+
+	for (int frame = 0; frame < p_iterations; frame++) {
+		for (int i = 0; i < count; i++) {
+			AABB &aabb = aabbs.write[i];
+			Vector3 &velocity = velocities.write[i];
+			aabb.position += velocity;
+			for (int j = 0; j < 3; j++) {
+				if (aabb.position[j] < 0 || aabb.position[j] > extent) {
+					velocity[j] = -velocity[j];
+				}
+			}
+			broadphase->move(ids[i], aabb);
+		}
+		broadphase->update();
+	}
+
+	uint64_t total = pairs;
+	for (int i = 0; i < count; i++) {
+		broadphase->remove(ids[i]);
+		memdelete(bodies[i]);
+	}
+	memdelete(broadphase);
+	return total;
+}
+
+uint64_t bench_broadphase_octree(int p_iterations) {
+	return _bench_broadphase(BroadPhaseOctree::_create, p_iterations);
+}
+
+uint64_t bench_broadphase_aabb_tree(int p_iterations) {
+	return _bench_broadphase(BroadPhaseAABBTree::_create, p_iterations);
+}
+
+Bench benches[] = {
+	{ "string_concat", bench_string_concat, 200000 },
+	{ "string_find", bench_string_find, 500000 },
+	{ "string_compare", bench_string_compare, 1000000 },
+	{ "string_utf8", bench_string_utf8, 200000 },
+	{ "string_name_from_cstring", bench_string_name_from_cstring, 500000 },
+	{ "string_name_from_string", bench_string_name_from_string, 500000 },
+	{ "string_name_unique", bench_string_name_unique, 100000 },
+	{ "array_push_back", bench_array_push_back, 1000000 },
+	{ "array_index", bench_array_index, 1000000 },
+	{ "dictionary_set_int", bench_dictionary_set_int, 500000 },
+	{ "dictionary_get_int", bench_dictionary_get_int, 500000 },
+	{ "dictionary_get_string", bench_dictionary_get_string, 500000 },
+	{ "variant_add_int", bench_variant_add_int, 2000000 },
+	{ "variant_add_real", bench_variant_add_real, 2000000 },
+	{ "variant_mul_vector3", bench_variant_mul_vector3, 2000000 },
+	{ "variant_equal_string", bench_variant_equal_string, 1000000 },
+	{ "variant_less_int", bench_variant_less_int, 2000000 },
+	{ "object_call", bench_object_call, 500000 },
+	{ "object_call_arg", bench_object_call_arg, 500000 },
+	{ "emit_signal", bench_emit_signal, 500000 },
+	{ "visual_script_call", bench_visual_script_call, 200000 },
+	{ "memalloc_memfree", bench_memalloc_memfree, 1000000 },
+	{ "memnew_object", bench_memnew_object, 200000 },
+	{ "memnew_reference", bench_memnew_reference, 200000 },
+	{ "broadphase_octree", bench_broadphase_octree, 60 },
+	{ "broadphase_aabb_tree", bench_broadphase_aabb_tree, 60 },
+	{ NULL, NULL, 0 }
+};
+
+static const int RUNS = 5;
+
+MainLoop *test(const List<String> &p_args) {
+
+	String filter;
+	String output;
+	for (const List<String>::Element *E = p_args.front(); E; E = E->next()) {
+		if (E->get() == "--bench-filter" && E->next()) {
+			filter = E->next()->get();
+		} else if (E->get() == "--bench-output" && E->next()) {
+			output = E->next()->get();
+		}
+	}
+
+	OS *os = OS::get_singleton();
+	Array results;
+
+	for (int i = 0; benches[i].name; i++) {
+
+		const Bench &bench = benches[i];
+		if (filter != "" && String(bench.name).find(filter) == -1) {
+			continue;
+		}
+
+		uint64_t checksum = bench.func(bench.iterations / 10); // Warm up.
+		uint64_t best_usec = 0;
+		for (int run = 0; run < RUNS; run++) {
+			uint64_t from = os->get_ticks_usec();
+			checksum += bench.func(bench.iterations);
+			uint64_t usec = os->get_ticks_usec() - from;
+			if (run == 0 || usec < best_usec) {
+				best_usec = usec;
+			}
+		}
+
+		Dictionary result;
+		result["name"] = bench.name;
+		result["iterations"] = bench.iterations;
+		result["runs"] = RUNS;
+		result["best_usec"] = best_usec;
+		result["ns_per_op"] = best_usec * 1000.0 / bench.iterations;
+		result["checksum"] = checksum;
+		results.push_back(result);
+	}
+
+	Dictionary report;
+	report["version"] = Engine::get_singleton()->get_version_info();
+	report["os"] = os->get_name();
+	report["processor_count"] = os->get_processor_count();
+	report["results"] = results;
+
+	// How the StringName table looks after the run, chains and rehashes
+	// explain StringName timings that differ between builds.
+	StringName::TableStats stats = StringName::get_table_stats();
+	Dictionary string_names;
+	string_names["names"] = stats.names;
+	string_names["buckets"] = stats.buckets;
+	string_names["used_buckets"] = stats.used_buckets;
+	string_names["longest_chain"] = stats.longest_chain;
+	string_names["collisions"] = stats.collisions;
+	string_names["rehashes"] = stats.rehashes;
+	string_names["inserted"] = stats.inserted;
+	string_names["removed"] = stats.removed;
+	report["string_name_table"] = string_names;
+
+	String json = JSON::print(report, "\t", false);
+	os->print("%s\n", json.utf8().get_data());
+
+	if (output != "") {
+		FileAccess *f = FileAccess::open(output, FileAccess::WRITE);
+		ERR_FAIL_COND_V_MSG(!f, NULL, "Can't write benchmark results to '" + output + "'.");
+		f->store_string(json);
+		f->store_line("");
+		memdelete(f);
+	}
+
+	return NULL;
+}
+} // namespace TestBench
@@ -0,0 +1,297 @@
+/*************************************************************************/
+/*  test_broad_phase.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_broad_phase.h"
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/set.h"
+#include "servers/physics/broad_phase_aabb_tree.h"
+#include "servers/physics/broad_phase_octree.h"
+#include "servers/physics/collision_object_sw.h"
+
+// Runs the same random sequence of creations, moves, static changes and
+// removals through the AABB tree and the octree broadphases, checking after
+// every step that both report the same overlapping pairs and cull results.
+
+namespace TestBroadPhase {
+
+enum {
+	OBJECT_COUNT = 96,
+	STEP_COUNT = 500,
+	CULL_MAX = OBJECT_COUNT
+};
+
+class TestObject : public CollisionObjectSW {
+
+public:
+	int index;
+
+	virtual void _shapes_changed() {}
+	virtual void set_space(SpaceSW *p_space) {}
+
+	TestObject() :
+			CollisionObjectSW(TYPE_BODY) {
+		index = 0;
+	}
+};
+
+struct PairRecorder {
+
+	Set<uint64_t> pairs;
+	bool valid; // Cleared on any pair added twice, or removed without being added.
+
+	static uint64_t get_key(CollisionObjectSW *p_a, CollisionObjectSW *p_b) {
+
+		uint64_t a = static_cast<TestObject *>(p_a)->index;
+		uint64_t b = static_cast<TestObject *>(p_b)->index;
+		return a < b ? (a << 32) | b : (b << 32) | a;
+	}
+
+	static void *pair_callback(CollisionObjectSW *p_a, int p_subindex_a, CollisionObjectSW *p_b, int p_subindex_b, void *p_self) {
+
+		PairRecorder *self = (PairRecorder *)p_self;
+		uint64_t key = get_key(p_a, p_b);
+		if (self->pairs.has(key)) {
+			self->valid = false;
+		}
+		self->pairs.insert(key);
+		return self;
+	}
+
+	static void unpair_callback(CollisionObjectSW *p_a, int p_subindex_a, CollisionObjectSW *p_b, int p_subindex_b, void *p_data, void *p_self) {
+
+		PairRecorder *self = (PairRecorder *)p_self;
+		if (p_data != self || !self->pairs.erase(get_key(p_a, p_b))) {
+			self->valid = false;
+		}
+	}
+
+	PairRecorder() {
+		valid = true;
+	}
+};
+
+struct TestBroadPhase {
+
+	BroadPhaseSW *broad_phase;
+	PairRecorder recorder;
+	BroadPhaseSW::ID ids[OBJECT_COUNT]; // 0 when not in the broadphase.
+
+	void create(TestObject *p_object, bool p_static, const AABB &p_aabb) {
+
+		// Same order CollisionObjectSW uses when adding its shapes.
+		BroadPhaseSW::ID id = broad_phase->create(p_object, 0);
+		broad_phase->set_static(id, p_static);
+		broad_phase->move(id, p_aabb);
+		ids[p_object->index] = id;
+	}
+
+	void remove(int p_index) {
+
+		broad_phase->remove(ids[p_index]);
+		ids[p_index] = 0;
+	}
+
+	// Cull results as a sorted list of object indices.
+	Vector<int> cull_aabb(const AABB &p_aabb) {
+
+		CollisionObjectSW *results[CULL_MAX];
+		int count = broad_phase->cull_aabb(p_aabb, results, CULL_MAX);
+
+		Vector<int> indices;
+		for (int i = 0; i < count; i++) {
+			indices.push_back(static_cast<TestObject *>(results[i])->index);
+		}
+		indices.sort();
+		return indices;
+	}
+
+	TestBroadPhase(BroadPhaseSW *p_broad_phase) {
+
+		broad_phase = p_broad_phase;
+		broad_phase->set_pair_callback(PairRecorder::pair_callback, &recorder);
+		broad_phase->set_unpair_callback(PairRecorder::unpair_callback, &recorder);
+		for (int i = 0; i < OBJECT_COUNT; i++) {
+			ids[i] = 0;
+		}
+	}
+
+	~TestBroadPhase() {
+
+		memdelete(broad_phase);
+	}
+};
+
+static Vector3 random_vector(RandomPCG &p_random, real_t p_from, real_t p_to) {
+
+	return Vector3(p_random.random(p_from, p_to), p_random.random(p_from, p_to), p_random.random(p_from, p_to));
+}
+
+static AABB random_aabb(RandomPCG &p_random) {
+
+	return AABB(random_vector(p_random, -40, 40), random_vector(p_random, 0.5, 10));
+}
+
+static bool test_random_moves() {
+
+	RandomPCG random(1234);
+
+	TestObject objects[OBJECT_COUNT];
+	AABB aabbs[OBJECT_COUNT];
+	bool statics[OBJECT_COUNT];
+
+	TestBroadPhase tree(BroadPhaseAABBTree::_create());
+	TestBroadPhase octree(BroadPhaseOctree::_create());
+	TestBroadPhase *broad_phases[2] = { &tree, &octree };
+
+	for (int i = 0; i < OBJECT_COUNT; i++) {
+
+		objects[i].index = i;
+		aabbs[i] = random_aabb(random);
+		statics[i] = random.rand() % 4 == 0;
+		for (int j = 0; j < 2; j++) {
+			broad_phases[j]->create(&objects[i], statics[i], aabbs[i]);
+		}
+	}
+
+	int pairs_seen = 0;
+
+	for (int step = 0; step < STEP_COUNT; step++) {
+
+		// A few objects change each step, like bodies in a physics frame.
+		int changes = 1 + random.rand() % 8;
+		for (int c = 0; c < changes; c++) {
+
+			int i = random.rand() % OBJECT_COUNT;
+			uint32_t action = random.rand() % 100;
+
+			if (tree.ids[i] == 0) {
+				// Removed earlier, add it back.
+				aabbs[i] = random_aabb(random);
+				for (int j = 0; j < 2; j++) {
+					broad_phases[j]->create(&objects[i], statics[i], aabbs[i]);
+				}
+			} else if (action < 5) {
+				for (int j = 0; j < 2; j++) {
+					broad_phases[j]->remove(i);
+				}
+			} else if (action < 15) {
+				statics[i] = !statics[i];
+				for (int j = 0; j < 2; j++) {
+					broad_phases[j]->broad_phase->set_static(broad_phases[j]->ids[i], statics[i]);
+				}
+			} else {
+				if (action < 70) {
+					// Small moves mostly stay inside the tree's fattened AABB.
+					aabbs[i].position += random_vector(random, -0.5, 0.5);
+				} else {
+					aabbs[i] = random_aabb(random);
+				}
+				for (int j = 0; j < 2; j++) {
+					broad_phases[j]->broad_phase->move(broad_phases[j]->ids[i], aabbs[i]);
+				}
+			}
+		}
+
+		for (int j = 0; j < 2; j++) {
+			broad_phases[j]->broad_phase->update();
+		}
+
+		if (!tree.recorder.valid || !octree.recorder.valid) {
+			OS::get_singleton()->print("\tStep %i: inconsistent pair callbacks (tree %s, octree %s)\n", step, tree.recorder.valid ? "ok" : "bad", octree.recorder.valid ? "ok" : "bad");
+			return false;
+		}
+
+		if (tree.recorder.pairs.size() != octree.recorder.pairs.size()) {
+			OS::get_singleton()->print("\tStep %i: %i pairs in the tree, %i in the octree\n", step, tree.recorder.pairs.size(), octree.recorder.pairs.size());
+			return false;
+		}
+
+		for (Set<uint64_t>::Element *E = tree.recorder.pairs.front(); E; E = E->next()) {
+			if (!octree.recorder.pairs.has(E->get())) {
+				OS::get_singleton()->print("\tStep %i: pair %i-%i only in the tree\n", step, int(E->get() >> 32), int(E->get() & 0xFFFFFFFF));
+				return false;
+			}
+		}
+		pairs_seen += tree.recorder.pairs.size();
+
+		AABB query = random_aabb(random);
+		Vector<int> tree_culled = tree.cull_aabb(query);
+		Vector<int> octree_culled = octree.cull_aabb(query);
+		bool same_culled = tree_culled.size() == octree_culled.size();
+		for (int k = 0; same_culled && k < tree_culled.size(); k++) {
+			same_culled = tree_culled[k] == octree_culled[k];
+		}
+		if (!same_culled) {
+			OS::get_singleton()->print("\tStep %i: cull_aabb results differ\n", step);
+			return false;
+		}
+	}
+
+	// Make sure the sequence actually produced overlaps to compare.
+	return pairs_seen > 0;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_random_moves,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestBroadPhase
@@ -0,0 +1,272 @@
+/*************************************************************************/
+/*  test_flat_hash_map.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_flat_hash_map.h"
+
+#include "core/flat_hash_map.h"
+#include "core/hash_map.h"
+#include "core/math/math_funcs.h"
+#include "core/oa_hash_map.h"
+#include "core/os/os.h"
+#include "core/vector.h"
+
+namespace TestFlatHashMap {
+
+bool test_insert() {
+	FlatHashMap<int, int> map;
+	map.set(42, 84);
+	map[7] = 14;
+
+	return map.size() == 2 && map.has(42) && map[42] == 84 && map.get(7) == 14 && !map.has(8);
+}
+
+bool test_insert_overwrite() {
+	FlatHashMap<int, int> map;
+	map.set(42, 84);
+	map.set(42, 1234);
+
+	return map.size() == 1 && map[42] == 1234;
+}
+
+bool test_erase() {
+	FlatHashMap<String, int> map;
+	map.set("Hello", 1);
+	map.set("World", 2);
+
+	return map.erase("Hello") && !map.erase("Hello") && !map.has("Hello") && map.has("World") && map.size() == 1;
+}
+
+bool test_rehash() {
+	FlatHashMap<int, int> map;
+	for (int i = 0; i < 10000; i++) {
+		map.set(i, i * 2);
+	}
+	for (int i = 0; i < 10000; i += 2) {
+		map.erase(i);
+	}
+	for (int i = 0; i < 10000; i++) {
+		const int *value = map.getptr(i);
+		if ((i % 2 == 0) != (value == NULL) || (value && *value != i * 2)) {
+			return false;
+		}
+	}
+
+	return map.size() == 5000;
+}
+
+bool test_churn() {
+	// Keeps replacing keys at a constant size, tombstones must not make the table grow without bound.
+	FlatHashMap<int, int> map;
+	for (int i = 0; i < 100; i++) {
+		map.set(i, i);
+	}
+	uint32_t capacity = map.get_capacity();
+	for (int i = 100; i < 100000; i++) {
+		map.erase(i - 100);
+		map.set(i, i);
+	}
+	for (int i = 99900; i < 100000; i++) {
+		if (!map.has(i)) {
+			return false;
+		}
+	}
+
+	return map.size() == 100 && map.get_capacity() <= capacity * 2;
+}
+
+bool test_iteration() {
+	FlatHashMap<int, int> map;
+	int sum = 0;
+	for (int i = 0; i < 1000; i++) {
+		map.set(i, i);
+		sum += i;
+	}
+
+	int count = 0;
+	const int *k = NULL;
+	while ((k = map.next(k))) {
+		sum -= map[*k];
+		count++;
+	}
+
+	return count == 1000 && sum == 0;
+}
+
+bool test_copy() {
+	FlatHashMap<String, int> map;
+	for (int i = 0; i < 100; i++) {
+		map.set(itos(i), i);
+	}
+
+	FlatHashMap<String, int> copy = map;
+	map.clear();
+	for (int i = 0; i < 100; i++) {
+		if (!copy.has(itos(i)) || copy[itos(i)] != i) {
+			return false;
+		}
+	}
+
+	return map.empty() && copy.size() == 100;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_insert,
+	test_insert_overwrite,
+	test_erase,
+	test_rehash,
+	test_churn,
+	test_iteration,
+	test_copy,
+	0
+
+};
+
+// Benchmarks against HashMap and OAHashMap, through the same three operations.
+
+template <class K>
+void _set(HashMap<K, int> &p_map, const K &p_key, int p_value) { p_map.set(p_key, p_value); }
+template <class K>
+void _set(OAHashMap<K, int> &p_map, const K &p_key, int p_value) { p_map.set(p_key, p_value); }
+template <class K>
+void _set(FlatHashMap<K, int> &p_map, const K &p_key, int p_value) { p_map.set(p_key, p_value); }
+
+template <class K>
+bool _lookup(HashMap<K, int> &p_map, const K &p_key) { return p_map.getptr(p_key) != NULL; }
+template <class K>
+bool _lookup(OAHashMap<K, int> &p_map, const K &p_key) { return p_map.has(p_key); }
+template <class K>
+bool _lookup(FlatHashMap<K, int> &p_map, const K &p_key) { return p_map.getptr(p_key) != NULL; }
+
+template <class K>
+void _erase(HashMap<K, int> &p_map, const K &p_key) { p_map.erase(p_key); }
+template <class K>
+void _erase(OAHashMap<K, int> &p_map, const K &p_key) { p_map.remove(p_key); }
+template <class K>
+void _erase(FlatHashMap<K, int> &p_map, const K &p_key) { p_map.erase(p_key); }
+
+template <class M, class K>
+void benchmark(const char *p_name, const Vector<K> &p_keys, const Vector<K> &p_missing) {
+
+	OS *os = OS::get_singleton();
+	M map;
+	int found = 0;
+
+	uint64_t t0 = os->get_ticks_usec();
+	for (int i = 0; i < p_keys.size(); i++) {
+		_set(map, p_keys[i], i);
+	}
+	uint64_t t1 = os->get_ticks_usec();
+	for (int r = 0; r < 4; r++) {
+		for (int i = 0; i < p_keys.size(); i++) {
+			found += _lookup(map, p_keys[i]);
+		}
+	}
+	uint64_t t2 = os->get_ticks_usec();
+	for (int r = 0; r < 4; r++) {
+		for (int i = 0; i < p_missing.size(); i++) {
+			found += _lookup(map, p_missing[i]);
+		}
+	}
+	uint64_t t3 = os->get_ticks_usec();
+	for (int i = 0; i < p_keys.size(); i++) {
+		_erase(map, p_keys[i]);
+	}
+	uint64_t t4 = os->get_ticks_usec();
+
+	os->print("\t%-12s insert %6d us, hit %6d us, miss %6d us, erase %6d us (%d found)\n", p_name, int(t1 - t0), int(t2 - t1), int(t3 - t2), int(t4 - t3), found);
+}
+
+template <class K>
+void benchmark_all(const char *p_title, const Vector<K> &p_keys, const Vector<K> &p_missing) {
+
+	OS::get_singleton()->print("%s, %d keys:\n", p_title, p_keys.size());
+	benchmark<HashMap<K, int> >("HashMap", p_keys, p_missing);
+	benchmark<OAHashMap<K, int> >("OAHashMap", p_keys, p_missing);
+	benchmark<FlatHashMap<K, int> >("FlatHashMap", p_keys, p_missing);
+}
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n\n", passed, count);
+
+	Math::seed(0);
+	const int N = 200000;
+
+	Vector<int> int_keys;
+	Vector<int> int_missing;
+	for (int i = 0; i < N; i++) {
+		// Even keys are inserted, odd ones are looked up to miss.
+		int key = Math::rand() & ~1;
+		int_keys.push_back(key);
+		int_missing.push_back(key | 1);
+	}
+	benchmark_all("Random int keys", int_keys, int_missing);
+
+	Vector<StringName> name_keys;
+	Vector<StringName> name_missing;
+	for (int i = 0; i < N / 4; i++) {
+		name_keys.push_back(StringName("name_" + itos(i)));
+		name_missing.push_back(StringName("missing_" + itos(i)));
+	}
+	benchmark_all("StringName keys", name_keys, name_missing);
+
+	Vector<String> string_keys;
+	Vector<String> string_missing;
+	for (int i = 0; i < N / 4; i++) {
+		string_keys.push_back("string_" + itos(i));
+		string_missing.push_back("missing_" + itos(i));
+	}
+	benchmark_all("String keys", string_keys, string_missing);
+
+	return NULL;
+}
+} // namespace TestFlatHashMap
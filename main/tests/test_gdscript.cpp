@@ -36,8 +36,11 @@
 
 #ifdef GDSCRIPT_ENABLED
 
+#include "core/io/marshalls.h"
 #include "modules/gdscript/gdscript.h"
+#include "modules/gdscript/gdscript_compiled_cache.h"
 #include "modules/gdscript/gdscript_compiler.h"
+#include "modules/gdscript/gdscript_optimizer.h"
 #include "modules/gdscript/gdscript_parser.h"
 #include "modules/gdscript/gdscript_tokenizer.h"
 
@@ -578,6 +581,21 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += DADDR(3);
 					incr += 5;
 
+				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_TYPED: {
+
+					int op = code[ip + 1];
+					txt += " op_typed ";
+
+					String opname = Variant::get_operator_name(Variant::Operator(op));
+
+					txt += DADDR(5);
+					txt += " = ";
+					txt += DADDR(3);
+					txt += " " + opname + " ";
+					txt += DADDR(4);
+					incr += 6;
+
 				} break;
 				case GDScriptFunction::OPCODE_SET: {
 
@@ -601,6 +619,29 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += "]";
 					incr += 4;
 
+				} break;
+				case GDScriptFunction::OPCODE_SET_POOL_ARRAY: {
+
+					txt += "set_pool_array ";
+					txt += DADDR(1);
+					txt += "[";
+					txt += DADDR(2);
+					txt += "]=";
+					txt += DADDR(3);
+					incr += 4;
+
+				} break;
+				case GDScriptFunction::OPCODE_GET_POOL_ARRAY: {
+
+					txt += " get_pool_array ";
+					txt += DADDR(3);
+					txt += "=";
+					txt += DADDR(1);
+					txt += "[";
+					txt += DADDR(2);
+					txt += "]";
+					incr += 4;
+
 				} break;
 				case GDScriptFunction::OPCODE_SET_NAMED: {
 
@@ -624,6 +665,18 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += "\"]";
 					incr += 4;
 
+				} break;
+				case GDScriptFunction::OPCODE_GET_NAMED_TYPED: {
+
+					txt += " get_named_typed ";
+					txt += DADDR(4);
+					txt += "=";
+					txt += DADDR(2);
+					txt += "[\"";
+					txt += func.get_global_name(code[ip + 3]);
+					txt += "\"]";
+					incr += 5;
+
 				} break;
 				case GDScriptFunction::OPCODE_SET_MEMBER: {
 
@@ -881,6 +934,30 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += " for-loop " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
 					incr += 5;
 
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_RANGE_BEGIN: {
+
+					txt += " for-range-init " + DADDR(5) + " to " + DADDR(2) + " step " + DADDR(3) + " counter " + DADDR(1) + " end " + itos(code[ip + 4]);
+					incr += 6;
+
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_RANGE: {
+
+					txt += " for-range-loop " + DADDR(5) + " to " + DADDR(2) + " step " + DADDR(3) + " counter " + DADDR(1) + " end " + itos(code[ip + 4]);
+					incr += 6;
+
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_POOL_ARRAY_BEGIN: {
+
+					txt += " for-pool-init " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
+					incr += 5;
+
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_POOL_ARRAY: {
+
+					txt += " for-pool-loop " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
+					incr += 5;
+
 				} break;
 				case GDScriptFunction::OPCODE_LINE: {
 
@@ -917,8 +994,309 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 	}
 }
 
+// Checks that a function yielding on a signal from a handler of that same
+// signal isn't resumed by the emission that is running the handler.
+static bool _test_yield_during_emission() {
+
+	const char *code =
+			"extends Reference\n"
+			"signal sig\n"
+			"var events = []\n"
+			"func wait_for_sig(p_name):\n"
+			"\tyield(self, \"sig\")\n"
+			"\tevents.append(p_name)\n"
+			"func _on_sig():\n"
+			"\tevents.append(\"handler\")\n"
+			"\twait_for_sig(\"late\")\n"
+			"func run():\n"
+			"\tconnect(\"sig\", self, \"_on_sig\")\n"
+			"\twait_for_sig(\"early\")\n"
+			"\temit_signal(\"sig\")\n"
+			"\tvar first = events.duplicate()\n"
+			"\tdisconnect(\"sig\", self, \"_on_sig\")\n"
+			"\temit_signal(\"sig\")\n"
+			"\treturn [first, events]\n";
+
+	GDScriptParser parser;
+	Error err = parser.parse(code);
+	ERR_FAIL_COND_V_MSG(err, false, "Parse Error: " + parser.get_error());
+
+	Ref<GDScript> gds;
+	gds.instance();
+
+	GDScriptCompiler gdc;
+	err = gdc.compile(&parser, gds.ptr());
+	ERR_FAIL_COND_V_MSG(err, false, "Compile Error: " + gdc.get_error());
+
+	Ref<Reference> instance = memnew(Reference);
+	instance->set_script(gds.get_ref_ptr());
+
+	Array result = instance->call("run");
+	ERR_FAIL_COND_V(result.size() != 2, false);
+
+	// The queue the waits go to is connected after the handler, so it runs later in the same emission.
+	Array first = result[0];
+	Array all = result[1];
+	print_line("after the first emission: " + Variant(first).get_construct_string());
+	print_line("after the second emission: " + Variant(all).get_construct_string());
+
+	return first.size() == 2 && String(first[0]) == "handler" && String(first[1]) == "early" &&
+		   all.size() == 3 && String(all[2]) == "late";
+}
+
+// Checks that a script parsed the way the preparser does it on its workers
+// runs the same once resolved, and that what needs a preloaded resource to be
+// parsed is left to a regular parse.
+static bool _test_deferred_parse() {
+
+	const char *code =
+			"extends Reference\n"
+			"const A = 2\n"
+			"const K = KEY_A\n"
+			"enum { B = A + 1 }\n"
+			"var c = [A, B]\n"
+			"func run():\n"
+			"\treturn c[0] * 10 + c[1] + (K - KEY_A)\n";
+
+	GDScriptTokenizerRecorded tokens;
+	tokens.record(code);
+
+	GDScriptParser parser;
+	Error err = parser.parse_deferred(&tokens, "res://", "res://deferred.gd");
+	ERR_FAIL_COND_V_MSG(err, false, "Deferred parse error: " + parser.get_error());
+	err = parser.resolve_deferred();
+	ERR_FAIL_COND_V_MSG(err, false, "Resolve error: " + parser.get_error());
+
+	Ref<GDScript> gds;
+	gds.instance();
+
+	GDScriptCompiler gdc;
+	err = gdc.compile(&parser, gds.ptr());
+	ERR_FAIL_COND_V_MSG(err, false, "Compile Error: " + gdc.get_error());
+
+	Ref<Reference> instance = memnew(Reference);
+	instance->set_script(gds.get_ref_ptr());
+	int result = instance->call("run");
+	print_line("resolved script returned: " + itos(result));
+	if (result != 23) {
+		return false;
+	}
+
+	// Folding the preload into the array would need the resource.
+	GDScriptTokenizerRecorded array_tokens;
+	array_tokens.record("extends Reference\nconst LIST = [preload(\"res://missing.gd\")]\n");
+	GDScriptParser array_parser;
+	if (array_parser.parse_deferred(&array_tokens, "res://", "res://deferred.gd") == OK) {
+		print_line("a constant array of preloads was parsed without the resources");
+		return false;
+	}
+
+	// A preload by itself is loaded by resolve_deferred(), which reports it missing.
+	GDScriptTokenizerRecorded preload_tokens;
+	preload_tokens.record("extends Reference\n\nconst S = preload(\"res://missing.gd\")\n");
+	GDScriptParser preload_parser;
+	if (preload_parser.parse_deferred(&preload_tokens, "res://", "res://deferred.gd") != OK) {
+		print_line("a preload constant wasn't deferred: " + preload_parser.get_error());
+		return false;
+	}
+	if (preload_parser.resolve_deferred() == OK || preload_parser.get_error_line() != 3) {
+		print_line("the missing preload wasn't reported on its line");
+		return false;
+	}
+
+	return true;
+}
+
+static Ref<GDScript> _compile_script(const char *p_code, Ref<GDScript> p_script = Ref<GDScript>()) {
+
+	GDScriptParser parser;
+	Error err = parser.parse(p_code);
+	ERR_FAIL_COND_V_MSG(err, Ref<GDScript>(), "Parse Error: " + parser.get_error());
+
+	// Recompiling keeps the state of the instances.
+	bool keep_state = p_script.is_valid();
+	if (!keep_state) {
+		p_script.instance();
+	}
+
+	GDScriptCompiler gdc;
+	err = gdc.compile(&parser, p_script.ptr(), keep_state);
+	ERR_FAIL_COND_V_MSG(err, Ref<GDScript>(), "Compile Error: " + gdc.get_error());
+
+	return p_script;
+}
+
+// Checks that the script method a connection resolved once is dropped when
+// the target's script is recompiled or replaced.
+static bool _test_signal_script_target() {
+
+	Ref<GDScript> gds = _compile_script("extends Reference\nvar hits = 0\nfunc _on_sig():\n\thits += 1\n");
+	ERR_FAIL_COND_V(gds.is_null(), false);
+
+	Ref<Reference> emitter = memnew(Reference);
+	emitter->add_user_signal(MethodInfo("sig"));
+
+	Ref<Reference> target = memnew(Reference);
+	target->set_script(gds.get_ref_ptr());
+	emitter->connect("sig", target.ptr(), "_on_sig");
+
+	emitter->emit_signal("sig");
+	emitter->emit_signal("sig");
+	int hits = target->get("hits");
+	print_line("hits after two emissions: " + itos(hits));
+	if (hits != 2) {
+		return false;
+	}
+
+	ERR_FAIL_COND_V(_compile_script("extends Reference\nvar hits = 0\nfunc _on_sig():\n\thits += 10\n", gds).is_null(), false);
+	emitter->emit_signal("sig");
+	hits = target->get("hits");
+	print_line("hits after recompiling: " + itos(hits));
+	if (hits != 12) {
+		return false;
+	}
+
+	Ref<GDScript> other = _compile_script("extends Reference\nvar hits = 100\nfunc _on_sig():\n\thits += 1000\n");
+	ERR_FAIL_COND_V(other.is_null(), false);
+	target->set_script(other.get_ref_ptr());
+	emitter->emit_signal("sig");
+	hits = target->get("hits");
+	print_line("hits after replacing the script: " + itos(hits));
+
+	return hits == 1100;
+}
+
+static int _find_instruction(const GDScriptFunction *p_function, int p_opcode) {
+
+	const int *code = p_function->get_code();
+	Vector<char> layout;
+	for (int ip = 0; ip < p_function->get_code_size();) {
+		if (code[ip] == p_opcode) {
+			return ip;
+		}
+		int size = GDScriptOptimizer::get_instruction_layout(code, ip, p_function->get_code_size(), layout);
+		ERR_FAIL_COND_V(size <= 0, -1);
+		ip += size;
+	}
+	return -1;
+}
+
+// Copy of p_compiled with the word at p_ip in the code of p_function set to p_value.
+static Vector<uint8_t> _corrupt_compiled_code(const Vector<uint8_t> &p_compiled, const GDScriptFunction *p_function, int p_ip, int p_value) {
+
+	ERR_FAIL_COND_V(p_ip < 0 || p_ip >= p_function->get_code_size(), Vector<uint8_t>());
+
+	// The code is stored as is when it doesn't use globals, so it's found by its contents.
+	Vector<uint8_t> code;
+	code.resize(p_function->get_code_size() * 4);
+	for (int i = 0; i < p_function->get_code_size(); i++) {
+		encode_uint32(p_function->get_code()[i], code.ptrw() + i * 4);
+	}
+
+	for (int ofs = 0; ofs + code.size() <= p_compiled.size(); ofs++) {
+		if (memcmp(p_compiled.ptr() + ofs, code.ptr(), code.size()) == 0) {
+			Vector<uint8_t> corrupt = p_compiled;
+			encode_uint32(p_value, corrupt.ptrw() + ofs + p_ip * 4);
+			return corrupt;
+		}
+	}
+
+	ERR_FAIL_V_MSG(Vector<uint8_t>(), "Code of function '" + String(p_function->get_name()) + "' not found in the compiled script.");
+}
+
+// Checks that a compiled script runs the same once loaded from the cache, and
+// that a cache with an operand out of range is rejected instead of loaded.
+static bool _test_compiled_cache() {
+
+	const char *code =
+			"extends Reference\n"
+			"var total = 0\n"
+			"func add(p_value, p_times = 2):\n"
+			"\tfor i in range(p_times):\n"
+			"\t\ttotal += p_value\n"
+			"\treturn total\n"
+			"func run():\n"
+			"\tvar parts = [add(3), add(4, 1)]\n"
+			"\treturn parts[0] * 100 + parts[1]\n";
+
+	Vector<uint8_t> compiled;
+	Error err = GDScriptCompiledCache::compile("res://cached.gd", code, true, compiled);
+	ERR_FAIL_COND_V_MSG(err, false, "Can't compile the script to the cache.");
+
+	Ref<GDScript> gds;
+	gds.instance();
+	err = GDScriptCompiledCache::load(gds.ptr(), compiled);
+	ERR_FAIL_COND_V_MSG(err, false, "Can't load the compiled script.");
+
+	Ref<Reference> instance = memnew(Reference);
+	instance->set_script(gds.get_ref_ptr());
+	int result = instance->call("run");
+	print_line("loaded script returned: " + itos(result));
+	if (result != 610) {
+		return false;
+	}
+
+	const GDScriptFunction *run = gds->get_member_functions()["run"];
+	const GDScriptFunction *add = gds->get_member_functions()["add"];
+	int call = _find_instruction(run, GDScriptFunction::OPCODE_CALL_RETURN);
+	int jump = _find_instruction(add, GDScriptFunction::OPCODE_JUMP);
+	ERR_FAIL_COND_V(call == -1 || jump == -1, false);
+	int call_argc = run->get_code()[call + 1];
+
+	struct Corruption {
+		const char *what;
+		Vector<uint8_t> compiled;
+	};
+	Corruption corruptions[] = {
+		{ "method name", _corrupt_compiled_code(compiled, run, call + 3, 1000) },
+		{ "stack address", _corrupt_compiled_code(compiled, run, call + 4 + call_argc, (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS) | run->get_max_stack_size()) },
+		{ "jump target", _corrupt_compiled_code(compiled, add, jump + 1, jump + 1) },
+	};
+
+	for (int i = 0; i < int(sizeof(corruptions) / sizeof(corruptions[0])); i++) {
+		ERR_FAIL_COND_V(corruptions[i].compiled.empty(), false);
+
+		Ref<GDScript> corrupt;
+		corrupt.instance();
+		if (GDScriptCompiledCache::load(corrupt.ptr(), corruptions[i].compiled) != ERR_FILE_CORRUPT) {
+			print_line(String("a cache with an invalid ") + corruptions[i].what + " was loaded");
+			return false;
+		}
+	}
+
+	return true;
+}
+
 MainLoop *test(TestType p_type) {
 
+	if (p_type == TEST_COMPILED_CACHE) {
+
+		bool passed = _test_compiled_cache();
+		print_line(String("Compiled cache: ") + (passed ? "PASS" : "FAILED"));
+		return NULL;
+	}
+
+	if (p_type == TEST_SIGNAL_SCRIPT_TARGET) {
+
+		bool passed = _test_signal_script_target();
+		print_line(String("Signal script target: ") + (passed ? "PASS" : "FAILED"));
+		return NULL;
+	}
+
+	if (p_type == TEST_PREPARSE) {
+
+		bool passed = _test_deferred_parse();
+		print_line(String("Deferred parse: ") + (passed ? "PASS" : "FAILED"));
+		return NULL;
+	}
+
+	if (p_type == TEST_YIELD) {
+
+		bool passed = _test_yield_during_emission();
+		print_line(String("Yield during emission: ") + (passed ? "PASS" : "FAILED"));
+		return NULL;
+	}
+
 	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
 
 	if (cmdlargs.empty()) {
@@ -1047,6 +1425,106 @@ MainLoop *test(TestType p_type) {
 			current = current->get_base();
 		}
 
+	} else if (p_type == TEST_OPTIMIZER) {
+
+		// Shows the code with and without optimizations, then checks that both
+		// give the same results for functions named test_*() taking no arguments.
+		Ref<GDScript> versions[2];
+
+		for (int i = 0; i < 2; i++) {
+
+			GDScriptParser parser;
+
+			Error err = parser.parse(code);
+			if (err) {
+				print_line("Parse Error:\n" + itos(parser.get_error_line()) + ":" + itos(parser.get_error_column()) + ":" + parser.get_error());
+				memdelete(fa);
+				return NULL;
+			}
+
+			versions[i].instance();
+
+			GDScriptCompiler gdc;
+			gdc.set_optimize(i == 1);
+			err = gdc.compile(&parser, versions[i].ptr());
+			if (err) {
+
+				print_line("Compile Error:\n" + itos(gdc.get_error_line()) + ":" + itos(gdc.get_error_column()) + ":" + gdc.get_error());
+				memdelete(fa);
+				return NULL;
+			}
+
+			print_line(i == 0 ? "** UNOPTIMIZED **" : "** OPTIMIZED **");
+			_disassemble_class(versions[i], lines);
+		}
+
+		Object *instances[2];
+		Variant refs[2]; // Keeps references alive while calling.
+		for (int i = 0; i < 2; i++) {
+
+			instances[i] = ClassDB::instance(versions[i]->get_instance_base_type());
+			if (instances[i]) {
+				if (Object::cast_to<Reference>(instances[i])) {
+					refs[i] = REF(Object::cast_to<Reference>(instances[i]));
+				}
+				instances[i]->set_script(versions[i].get_ref_ptr());
+			}
+		}
+
+		print_line("** SUMMARY **");
+
+		int code_size[2] = { 0, 0 };
+		int stack_size[2] = { 0, 0 };
+		int failed = 0;
+
+		const Map<StringName, GDScriptFunction *> &mf = versions[0]->debug_get_member_functions();
+		const Map<StringName, GDScriptFunction *> &optimized = versions[1]->debug_get_member_functions();
+
+		for (const Map<StringName, GDScriptFunction *>::Element *E = mf.front(); E; E = E->next()) {
+
+			const Map<StringName, GDScriptFunction *>::Element *O = optimized.find(E->key());
+			ERR_CONTINUE(!O);
+
+			const GDScriptFunction *funcs[2] = { E->get(), O->get() };
+			String txt = String(E->key()) + "():";
+			for (int i = 0; i < 2; i++) {
+				code_size[i] += funcs[i]->get_code_size();
+				stack_size[i] += funcs[i]->get_max_stack_size();
+			}
+			txt += " code " + itos(funcs[0]->get_code_size()) + " -> " + itos(funcs[1]->get_code_size());
+			txt += ", stack " + itos(funcs[0]->get_max_stack_size()) + " -> " + itos(funcs[1]->get_max_stack_size());
+
+			if (String(E->key()).begins_with("test_") && funcs[0]->get_argument_count() == 0 && instances[0] && instances[1]) {
+
+				String results[2];
+				for (int i = 0; i < 2; i++) {
+					Variant::CallError ce;
+					Variant ret = instances[i]->call(E->key(), NULL, 0, ce);
+					results[i] = ce.error == Variant::CallError::CALL_OK ? ret.get_construct_string() : "<call error " + itos(ce.error) + ">";
+				}
+
+				if (results[0] == results[1]) {
+					txt += ", same result";
+				} else {
+					txt += ", DIFFERENT RESULT: " + results[0] + " != " + results[1];
+					failed++;
+				}
+			}
+
+			print_line(txt);
+		}
+
+		print_line("total code " + itos(code_size[0]) + " -> " + itos(code_size[1]) + ", stack " + itos(stack_size[0]) + " -> " + itos(stack_size[1]));
+		if (failed) {
+			print_line(itos(failed) + " function(s) gave different results.");
+		}
+
+		for (int i = 0; i < 2; i++) {
+			if (instances[i] && !Object::cast_to<Reference>(instances[i])) {
+				memdelete(instances[i]);
+			}
+		}
+
 	} else if (p_type == TEST_BYTECODE) {
 
 		Vector<uint8_t> buf2 = GDScriptTokenizerBuffer::parse_code_string(code);
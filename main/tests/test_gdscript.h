@@ -40,6 +40,11 @@ enum TestType {
 	TEST_PARSER,
 	TEST_COMPILER,
 	TEST_BYTECODE,
+	TEST_OPTIMIZER,
+	TEST_YIELD,
+	TEST_PREPARSE,
+	TEST_SIGNAL_SCRIPT_TARGET,
+	TEST_COMPILED_CACHE,
 };
 
 MainLoop *test(TestType p_type);
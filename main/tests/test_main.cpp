@@ -31,19 +31,26 @@
 #include "core/list.h"
 #include "core/os/main_loop.h"
 
-#ifdef DEBUG_ENABLED
+#if defined(TOOLS_ENABLED) && defined(DEBUG_ENABLED)
 
 #include "test_astar.h"
+#include "test_bench.h"
+#include "test_broad_phase.h"
+#include "test_flat_hash_map.h"
 #include "test_gdscript.h"
 #include "test_gui.h"
 #include "test_math.h"
 #include "test_oa_hash_map.h"
+#include "test_object_db.h"
 #include "test_ordered_hash_map.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
+#include "test_physics_islands.h"
+#include "test_pool_vector.h"
 #include "test_render.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
+#include "test_worker_thread_pool.h"
 
 const char **tests_get_names() {
 
@@ -52,16 +59,28 @@ const char **tests_get_names() {
 		"math",
 		"physics",
 		"physics_2d",
+		"broadphase",
+		"physics_islands",
 		"render",
 		"oa_hash_map",
+		"flat_hash_map",
+		"object_db",
 		"gui",
 		"shaderlang",
 		"gd_tokenizer",
 		"gd_parser",
 		"gd_compiler",
 		"gd_bytecode",
+		"gd_optimizer",
+		"gd_yield",
+		"gd_preparse",
+		"gd_signal",
+		"gd_compiled_cache",
 		"ordered_hash_map",
+		"pool_vector",
 		"astar",
+		"worker_thread_pool",
+		"bench",
 		NULL
 	};
 
@@ -90,6 +109,16 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestPhysics2D::test();
 	}
 
+	if (p_test == "broadphase") {
+
+		return TestBroadPhase::test();
+	}
+
+	if (p_test == "physics_islands") {
+
+		return TestPhysicsIslands::test();
+	}
+
 	if (p_test == "render") {
 
 		return TestRender::test();
@@ -100,6 +129,16 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestOAHashMap::test();
 	}
 
+	if (p_test == "flat_hash_map") {
+
+		return TestFlatHashMap::test();
+	}
+
+	if (p_test == "object_db") {
+
+		return TestObjectDB::test();
+	}
+
 #ifndef _3D_DISABLED
 	if (p_test == "gui") {
 
@@ -132,16 +171,81 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestGDScript::test(TestGDScript::TEST_BYTECODE);
 	}
 
+	if (p_test == "gd_optimizer") {
+
+		return TestGDScript::test(TestGDScript::TEST_OPTIMIZER);
+	}
+
+	if (p_test == "gd_yield") {
+
+		return TestGDScript::test(TestGDScript::TEST_YIELD);
+	}
+
+	if (p_test == "gd_preparse") {
+
+		return TestGDScript::test(TestGDScript::TEST_PREPARSE);
+	}
+
+	if (p_test == "gd_signal") {
+
+		return TestGDScript::test(TestGDScript::TEST_SIGNAL_SCRIPT_TARGET);
+	}
+
+	if (p_test == "gd_compiled_cache") {
+
+		return TestGDScript::test(TestGDScript::TEST_COMPILED_CACHE);
+	}
+
 	if (p_test == "ordered_hash_map") {
 
 		return TestOrderedHashMap::test();
 	}
 
+	if (p_test == "pool_vector") {
+
+		return TestPoolVector::test();
+	}
+
 	if (p_test == "astar") {
 
 		return TestAStar::test();
 	}
 
+	if (p_test == "worker_thread_pool") {
+
+		return TestWorkerThreadPool::test();
+	}
+
+	if (p_test == "bench") {
+
+		return TestBench::test(p_args);
+	}
+
+	print_line("Unknown test: " + p_test);
+	return NULL;
+}
+
+#elif defined(BENCHMARKS_ENABLED)
+
+#include "test_bench.h"
+
+const char **tests_get_names() {
+
+	static const char *test_names[] = {
+		"bench",
+		NULL
+	};
+
+	return test_names;
+}
+
+MainLoop *test_main(String p_test, const List<String> &p_args) {
+
+	if (p_test == "bench") {
+
+		return TestBench::test(p_args);
+	}
+
 	print_line("Unknown test: " + p_test);
 	return NULL;
 }
@@ -31,6 +31,7 @@
 #include "test_math.h"
 
 #include "core/math/basis.h"
+#include "core/math/batch_math.h"
 #include "core/math/camera_matrix.h"
 #include "core/math/math_funcs.h"
 #include "core/math/transform.h"
@@ -402,8 +403,218 @@ uint32_t ihash3(uint32_t a) {
 	return a;
 }
 
+// Checks the BatchMath kernels against the per element math they replace,
+// which is also what their scalar fallback runs. Counts cover empty arrays,
+// tails shorter than a SIMD step and several full steps. Inputs come from
+// ihash() so a failure always reproduces.
+
+#define BATCH_MATH_MAX_COUNT 67
+
+static const int batch_math_counts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 13, 64, BATCH_MATH_MAX_COUNT, -1 };
+
+static real_t batch_math_value(uint32_t p_seed) {
+
+	return (ihash(p_seed) % 20001) / 100.0 - 100.0;
+}
+
+static Vector3 batch_math_vector(uint32_t p_seed) {
+
+	return Vector3(batch_math_value(p_seed * 3), batch_math_value(p_seed * 3 + 1), batch_math_value(p_seed * 3 + 2));
+}
+
+static bool batch_math_equal(real_t p_a, real_t p_b) {
+
+	// SIMD and scalar code may round (or fuse multiply-adds) differently.
+	return Math::abs(p_a - p_b) <= 0.001 * MAX(1.0, Math::abs(p_b));
+}
+
+static bool batch_math_equal(const Vector3 &p_a, const Vector3 &p_b) {
+
+	return batch_math_equal(p_a.x, p_b.x) && batch_math_equal(p_a.y, p_b.y) && batch_math_equal(p_a.z, p_b.z);
+}
+
+static bool batch_math_equal(const AABB &p_a, const AABB &p_b) {
+
+	return batch_math_equal(p_a.position, p_b.position) && batch_math_equal(p_a.size, p_b.size);
+}
+
+static void batch_math_report(const char *p_kernel, bool p_pass) {
+
+	OS::get_singleton()->print("BatchMath %s (%s): %s\n", p_kernel, BatchMath::get_backend_name(), p_pass ? "PASS" : "FAILED");
+}
+
+static void test_batch_transform() {
+
+	Transform xform(Basis(Vector3(0.3, -0.8, 0.5).normalized(), 1.3).scaled(Vector3(1.5, 0.7, 2.0)), Vector3(10, -4, 7));
+
+	Vector3 src[BATCH_MATH_MAX_COUNT];
+	Vector3 dst[BATCH_MATH_MAX_COUNT + 1];
+	bool points_pass = true;
+	bool vectors_pass = true;
+	bool in_place_pass = true;
+
+	for (int c = 0; batch_math_counts[c] >= 0; c++) {
+
+		int count = batch_math_counts[c];
+		for (int i = 0; i < count; i++) {
+			src[i] = batch_math_vector(c * 1000 + i);
+		}
+
+		// The element past the end must be left alone.
+		dst[count] = Vector3(12345, 12345, 12345);
+		BatchMath::transform_points(xform, src, dst, count);
+		for (int i = 0; i < count; i++) {
+			points_pass = points_pass && batch_math_equal(dst[i], xform.xform(src[i]));
+		}
+		points_pass = points_pass && dst[count] == Vector3(12345, 12345, 12345);
+
+		BatchMath::transform_vectors(xform.basis, src, dst, count);
+		for (int i = 0; i < count; i++) {
+			vectors_pass = vectors_pass && batch_math_equal(dst[i], xform.basis.xform(src[i]));
+		}
+		vectors_pass = vectors_pass && dst[count] == Vector3(12345, 12345, 12345);
+
+		for (int i = 0; i < count; i++) {
+			dst[i] = src[i];
+		}
+		BatchMath::transform_points(xform, dst, dst, count);
+		for (int i = 0; i < count; i++) {
+			in_place_pass = in_place_pass && batch_math_equal(dst[i], xform.xform(src[i]));
+		}
+	}
+
+	batch_math_report("transform_points", points_pass);
+	batch_math_report("transform_vectors", vectors_pass);
+	batch_math_report("transform_points in place", in_place_pass);
+}
+
+static void test_batch_plane_distances() {
+
+	Plane plane(Vector3(0.2, 0.9, -0.4).normalized(), 3.5);
+
+	Vector3 points[BATCH_MATH_MAX_COUNT];
+	real_t distances[BATCH_MATH_MAX_COUNT + 1];
+	bool pass = true;
+
+	for (int c = 0; batch_math_counts[c] >= 0; c++) {
+
+		int count = batch_math_counts[c];
+		for (int i = 0; i < count; i++) {
+			points[i] = batch_math_vector(c * 1000 + i + 500);
+		}
+
+		distances[count] = 12345;
+		BatchMath::get_plane_distances(plane, points, distances, count);
+		for (int i = 0; i < count; i++) {
+			pass = pass && batch_math_equal(distances[i], plane.distance_to(points[i]));
+		}
+		pass = pass && distances[count] == 12345;
+	}
+
+	batch_math_report("get_plane_distances", pass);
+}
+
+static void test_batch_cull() {
+
+	CameraMatrix projection;
+	projection.set_perspective(70, 1.5, 0.5, 150);
+	Vector<Plane> planes = projection.get_projection_planes(Transform(Basis(Vector3(0, 1, 0), 0.4), Vector3(0, 0, 20)));
+
+	Vector3 points[BATCH_MATH_MAX_COUNT];
+	AABB aabbs[BATCH_MATH_MAX_COUNT];
+	uint8_t inside[BATCH_MATH_MAX_COUNT + 1];
+	bool points_pass = true;
+	bool aabbs_pass = true;
+
+	for (int c = 0; batch_math_counts[c] >= 0; c++) {
+
+		int count = batch_math_counts[c];
+		for (int i = 0; i < count; i++) {
+			points[i] = batch_math_vector(c * 1000 + i + 200);
+			Vector3 size = batch_math_vector(c * 1000 + i + 700).abs() * 0.1;
+			aabbs[i] = AABB(points[i], size);
+		}
+
+		inside[count] = 255;
+		int expected = 0;
+		int inside_count = BatchMath::cull_points(planes.ptr(), planes.size(), points, count, inside);
+		for (int i = 0; i < count; i++) {
+
+			bool point_inside = true;
+			for (int j = 0; j < planes.size(); j++) {
+				if (planes[j].is_point_over(points[i])) {
+					point_inside = false;
+				}
+			}
+			points_pass = points_pass && inside[i] == (uint8_t)point_inside;
+			expected += point_inside;
+		}
+		points_pass = points_pass && inside_count == expected && inside[count] == 255;
+
+		expected = 0;
+		inside_count = BatchMath::cull_aabbs(planes.ptr(), planes.size(), aabbs, count, inside);
+		for (int i = 0; i < count; i++) {
+
+			bool aabb_inside = aabbs[i].intersects_convex_shape(planes.ptr(), planes.size());
+			aabbs_pass = aabbs_pass && inside[i] == (uint8_t)aabb_inside;
+			expected += aabb_inside;
+		}
+		aabbs_pass = aabbs_pass && inside_count == expected && inside[count] == 255;
+	}
+
+	batch_math_report("cull_points", points_pass);
+	batch_math_report("cull_aabbs", aabbs_pass);
+}
+
+static void test_batch_bounds() {
+
+	Vector3 points[BATCH_MATH_MAX_COUNT];
+	AABB aabbs[BATCH_MATH_MAX_COUNT];
+	bool bounds_pass = true;
+	bool merge_pass = true;
+
+	for (int c = 0; batch_math_counts[c] >= 0; c++) {
+
+		int count = batch_math_counts[c];
+		for (int i = 0; i < count; i++) {
+			points[i] = batch_math_vector(c * 1000 + i + 300);
+			aabbs[i] = AABB(batch_math_vector(c * 1000 + i + 800), batch_math_vector(c * 1000 + i + 900).abs());
+		}
+
+		AABB expected_bounds;
+		AABB expected_merge;
+		for (int i = 0; i < count; i++) {
+			if (i == 0) {
+				expected_bounds = AABB(points[0], Vector3());
+				expected_merge = aabbs[0];
+			} else {
+				expected_bounds.expand_to(points[i]);
+				expected_merge.merge_with(aabbs[i]);
+			}
+		}
+
+		bounds_pass = bounds_pass && batch_math_equal(BatchMath::get_bounds(points, count), expected_bounds);
+		merge_pass = merge_pass && batch_math_equal(BatchMath::merge_aabbs(aabbs, count), expected_merge);
+	}
+
+	batch_math_report("get_bounds", bounds_pass);
+	batch_math_report("merge_aabbs", merge_pass);
+}
+
+#undef BATCH_MATH_MAX_COUNT
+
+static void test_batch_math() {
+
+	test_batch_transform();
+	test_batch_plane_distances();
+	test_batch_cull();
+	test_batch_bounds();
+}
+
 MainLoop *test() {
 
+	test_batch_math();
+
 	{
 		float r = 1;
 		float g = 0.5;
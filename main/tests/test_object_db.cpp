@@ -0,0 +1,135 @@
+/*************************************************************************/
+/*  test_object_db.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_object_db.h"
+
+#include "core/object.h"
+#include "core/os/os.h"
+#include "servers/physics_2d_server.h"
+#include "servers/physics_server.h"
+
+namespace TestObjectDB {
+
+// Freed slots are reused right away, so a single slot goes past 32 bit IDs
+// after 256 generations.
+const int REUSE_COUNT = 300;
+
+Object *reuse_slot(Object *p_object, int p_times, ObjectID &r_first_id) {
+
+	r_first_id = p_object->get_instance_id();
+	for (int i = 0; i < p_times; i++) {
+		memdelete(p_object);
+		p_object = memnew(Object);
+	}
+	return p_object;
+}
+
+bool test_slot_reuse() {
+
+	ObjectID first_id;
+	Object *obj = reuse_slot(memnew(Object), REUSE_COUNT, first_id);
+	ObjectID id = obj->get_instance_id();
+
+	bool pass = (id & 0xFFFFFF) == (first_id & 0xFFFFFF); // same slot
+	pass = pass && (id >> 32) != 0;
+	pass = pass && ObjectDB::get_instance(id) == obj;
+	pass = pass && ObjectDB::get_instance(first_id) == NULL;
+	pass = pass && ObjectDB::get_instance(id & 0xFFFFFFFF) == NULL; // a truncated ID must not resolve
+
+	memdelete(obj);
+	return pass && ObjectDB::get_instance(id) == NULL;
+}
+
+bool test_physics_instance_id() {
+
+	PhysicsServer *ps = PhysicsServer::get_singleton();
+	Physics2DServer *ps2d = Physics2DServer::get_singleton();
+	if (!ps || !ps2d) {
+		OS::get_singleton()->print("\tphysics servers unavailable, skipped\n");
+		return true;
+	}
+
+	ObjectID first_id;
+	Object *obj = reuse_slot(memnew(Object), REUSE_COUNT, first_id);
+	ObjectID id = obj->get_instance_id();
+
+	RID body = ps->body_create();
+	ps->body_attach_object_instance_id(body, id);
+	bool pass = ps->body_get_object_instance_id(body) == id;
+	ps->free(body);
+
+	RID body_2d = ps2d->body_create();
+	ps2d->body_attach_object_instance_id(body_2d, id);
+	ps2d->body_attach_canvas_instance_id(body_2d, id);
+	pass = pass && ps2d->body_get_object_instance_id(body_2d) == id;
+	pass = pass && ps2d->body_get_canvas_instance_id(body_2d) == id;
+	ps2d->free(body_2d);
+
+	pass = pass && ObjectDB::get_instance(id) == obj;
+	memdelete(obj);
+	return pass;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_slot_reuse,
+	test_physics_instance_id,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestObjectDB
@@ -0,0 +1,226 @@
+/*************************************************************************/
+/*  test_physics_islands.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_physics_islands.h"
+
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "servers/physics_2d_server.h"
+#include "servers/physics_server.h"
+
+// Steps the same scene, many stacks of boxes on a static floor (so one island
+// per stack), with the worker thread pool restarted with no threads and then
+// with several, and compares where the boxes end up.
+// Constraints inside an island are ordered by address, which differs between
+// runs, so transforms are compared with a tolerance rather than bit for bit.
+
+namespace TestPhysicsIslands {
+
+enum {
+	STACK_COUNT = 16,
+	STACK_HEIGHT = 3,
+	STEP_COUNT = 180,
+	THREAD_COUNT = 4
+};
+
+static const real_t STEP_DELTA = 1.0 / 60.0;
+static const real_t TOLERANCE = 0.01;
+
+static void set_worker_thread_count(int p_count) {
+
+	// Nothing else is running yet when tests start, so the pool can be restarted.
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	pool->finish();
+	pool->init(p_count);
+}
+
+static Vector<Transform> run_scene_3d() {
+
+	PhysicsServer *ps = PhysicsServer::get_singleton();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+	ps->area_set_param(space, PhysicsServer::AREA_PARAM_GRAVITY, 9.8);
+	ps->area_set_param(space, PhysicsServer::AREA_PARAM_GRAVITY_VECTOR, Vector3(0, -1, 0));
+
+	RID floor_shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+	ps->shape_set_data(floor_shape, Vector3(100, 1, 100));
+	RID floor = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+	ps->body_add_shape(floor, floor_shape);
+	ps->body_set_state(floor, PhysicsServer::BODY_STATE_TRANSFORM, Transform(Basis(), Vector3(0, -1, 0)));
+	ps->body_set_space(floor, space);
+
+	RID box_shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+	ps->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+
+	Vector<RID> boxes;
+	for (int i = 0; i < STACK_COUNT; i++) {
+		for (int j = 0; j < STACK_HEIGHT; j++) {
+
+			// Stacks are 5 units apart, boxes are turned a little so they don't all settle the same way.
+			Transform xform(Basis(Vector3(0, 1, 0), i * 0.1 + j * 0.2), Vector3((i % 4) * 5, 0.6 + j * 1.1, (i / 4) * 5));
+			RID box = ps->body_create(PhysicsServer::BODY_MODE_RIGID);
+			ps->body_add_shape(box, box_shape);
+			ps->body_set_state(box, PhysicsServer::BODY_STATE_TRANSFORM, xform);
+			ps->body_set_space(box, space);
+			boxes.push_back(box);
+		}
+	}
+
+	for (int i = 0; i < STEP_COUNT; i++) {
+		ps->step(STEP_DELTA);
+	}
+
+	Vector<Transform> transforms;
+	for (int i = 0; i < boxes.size(); i++) {
+		transforms.push_back(ps->body_get_state(boxes[i], PhysicsServer::BODY_STATE_TRANSFORM));
+		ps->free(boxes[i]);
+	}
+
+	ps->free(box_shape);
+	ps->free(floor);
+	ps->free(floor_shape);
+	ps->free(space);
+
+	return transforms;
+}
+
+static Vector<Transform2D> run_scene_2d() {
+
+	Physics2DServer *ps = Physics2DServer::get_singleton();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+	ps->area_set_param(space, Physics2DServer::AREA_PARAM_GRAVITY, 98);
+	ps->area_set_param(space, Physics2DServer::AREA_PARAM_GRAVITY_VECTOR, Vector2(0, 1));
+
+	RID floor_shape = ps->rectangle_shape_create();
+	ps->shape_set_data(floor_shape, Vector2(1000, 10));
+	RID floor = ps->body_create();
+	ps->body_set_mode(floor, Physics2DServer::BODY_MODE_STATIC);
+	ps->body_add_shape(floor, floor_shape);
+	ps->body_set_state(floor, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Vector2(0, 10)));
+	ps->body_set_space(floor, space);
+
+	RID box_shape = ps->rectangle_shape_create();
+	ps->shape_set_data(box_shape, Vector2(10, 10));
+
+	Vector<RID> boxes;
+	for (int i = 0; i < STACK_COUNT; i++) {
+		for (int j = 0; j < STACK_HEIGHT; j++) {
+
+			Transform2D xform(i * 0.02 + j * 0.05, Vector2(i * 50, -11 - j * 22));
+			RID box = ps->body_create();
+			ps->body_set_mode(box, Physics2DServer::BODY_MODE_RIGID);
+			ps->body_add_shape(box, box_shape);
+			ps->body_set_state(box, Physics2DServer::BODY_STATE_TRANSFORM, xform);
+			ps->body_set_space(box, space);
+			boxes.push_back(box);
+		}
+	}
+
+	for (int i = 0; i < STEP_COUNT; i++) {
+		ps->step(STEP_DELTA);
+	}
+
+	Vector<Transform2D> transforms;
+	for (int i = 0; i < boxes.size(); i++) {
+		transforms.push_back(ps->body_get_state(boxes[i], Physics2DServer::BODY_STATE_TRANSFORM));
+		ps->free(boxes[i]);
+	}
+
+	ps->free(box_shape);
+	ps->free(floor);
+	ps->free(floor_shape);
+	ps->free(space);
+
+	return transforms;
+}
+
+static real_t get_difference(const Transform &p_a, const Transform &p_b) {
+
+	real_t difference = p_a.origin.distance_to(p_b.origin);
+	for (int i = 0; i < 3; i++) {
+		difference = MAX(difference, p_a.basis[i].distance_to(p_b.basis[i]));
+	}
+	return difference;
+}
+
+static real_t get_difference(const Transform2D &p_a, const Transform2D &p_b) {
+
+	real_t difference = 0;
+	for (int i = 0; i < 3; i++) {
+		difference = MAX(difference, p_a.elements[i].distance_to(p_b.elements[i]));
+	}
+	return difference;
+}
+
+template <class T>
+static bool compare_transforms(const char *p_name, const Vector<T> &p_single, const Vector<T> &p_multi) {
+
+	real_t max_difference = 0;
+	for (int i = 0; i < p_single.size(); i++) {
+		max_difference = MAX(max_difference, get_difference(p_single[i], p_multi[i]));
+	}
+
+	bool pass = p_single.size() == p_multi.size() && max_difference <= TOLERANCE;
+	OS::get_singleton()->print("\t%s, largest difference %f: %s\n", p_name, max_difference, pass ? "PASS" : "FAILED");
+	return pass;
+}
+
+MainLoop *test() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	int thread_count = pool->get_thread_count();
+
+	set_worker_thread_count(0);
+	Vector<Transform> single_3d = run_scene_3d();
+	Vector<Transform2D> single_2d = run_scene_2d();
+
+	set_worker_thread_count(THREAD_COUNT);
+	Vector<Transform> multi_3d = run_scene_3d();
+	Vector<Transform2D> multi_2d = run_scene_2d();
+
+	set_worker_thread_count(thread_count);
+
+	int passed = 0;
+	passed += compare_transforms("3D", single_3d, multi_3d);
+	passed += compare_transforms("2D", single_2d, multi_2d);
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, 2);
+
+	return NULL;
+}
+} // namespace TestPhysicsIslands
@@ -0,0 +1,177 @@
+/*************************************************************************/
+/*  test_pool_vector.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_pool_vector.h"
+
+#include "core/os/os.h"
+#include "core/pool_vector.h"
+
+namespace TestPoolVector {
+
+static PoolVector<int> make_array(int p_size, int p_first) {
+
+	PoolVector<int> array;
+	array.resize(p_size);
+	PoolVector<int>::Write w = array.write();
+	for (int i = 0; i < p_size; i++) {
+		w[i] = p_first + i;
+	}
+	return array;
+}
+
+static bool check_array(const PoolVector<int> &p_array, int p_size, int p_first) {
+
+	if (p_array.size() != p_size) {
+		return false;
+	}
+	PoolVector<int>::Read r = p_array.read();
+	for (int i = 0; i < p_size; i++) {
+		if (r[i] != p_first + i) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static const int *buffer_of(const PoolVector<int> &p_array) {
+
+	return p_array.read().ptr();
+}
+
+bool test_move_from() {
+
+	PoolVector<int> from = make_array(100, 0);
+	const int *buffer = buffer_of(from);
+
+	PoolVector<int> to = make_array(10, 1000);
+	to.move_from(from);
+
+	// Same buffer, and since nothing else references it writing doesn't copy.
+	bool pass = from.size() == 0 && check_array(to, 100, 0) && buffer_of(to) == buffer;
+	pass = pass && to.write().ptr() == buffer;
+	return pass;
+}
+
+bool test_move_from_self() {
+
+	PoolVector<int> array = make_array(10, 0);
+	array.move_from(array);
+
+	return check_array(array, 10, 0);
+}
+
+bool test_move_from_shared() {
+
+	// Moving a buffer that's still shared keeps it shared, the first write
+	// through either side copies.
+	PoolVector<int> from = make_array(10, 0);
+	PoolVector<int> other = from;
+	const int *buffer = buffer_of(from);
+
+	PoolVector<int> to;
+	to.move_from(from);
+	to.set(0, 42);
+
+	return from.size() == 0 && buffer_of(other) == buffer && buffer_of(to) != buffer && other[0] == 0 && to[0] == 42;
+}
+
+bool test_move_from_empty() {
+
+	PoolVector<int> from;
+	PoolVector<int> to = make_array(10, 0);
+	to.move_from(from);
+
+	return to.size() == 0 && from.size() == 0;
+}
+
+bool test_swap() {
+
+	PoolVector<int> a = make_array(10, 0);
+	PoolVector<int> b = make_array(20, 100);
+	const int *buffer_a = buffer_of(a);
+	const int *buffer_b = buffer_of(b);
+
+	a.swap(b);
+
+	bool pass = check_array(a, 20, 100) && check_array(b, 10, 0) && buffer_of(a) == buffer_b && buffer_of(b) == buffer_a;
+	pass = pass && a.write().ptr() == buffer_b && b.write().ptr() == buffer_a;
+	return pass;
+}
+
+bool test_swap_empty() {
+
+	PoolVector<int> a = make_array(10, 0);
+	PoolVector<int> b;
+
+	a.swap(b);
+
+	return a.size() == 0 && check_array(b, 10, 0);
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_move_from,
+	test_move_from_self,
+	test_move_from_shared,
+	test_move_from_empty,
+	test_swap,
+	test_swap_empty,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestPoolVector
@@ -0,0 +1,300 @@
+/*************************************************************************/
+/*  test_worker_thread_pool.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_worker_thread_pool.h"
+
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/safe_refcount.h"
+
+namespace TestWorkerThreadPool {
+
+enum {
+	ELEMENT_COUNT = 1000,
+	STAGE_COUNT = 4,
+	NESTED_COUNT = 8,
+	NESTED_ELEMENTS = 100
+};
+
+struct RangeData {
+	volatile uint32_t visits[ELEMENT_COUNT];
+};
+
+static void range_func(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	RangeData *data = (RangeData *)p_userdata;
+	for (uint32_t i = p_from; i < p_to; i++) {
+		atomic_increment(&data->visits[i]);
+	}
+}
+
+bool test_range() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+
+	// A grain that doesn't divide the element count, so the last chunk is shorter.
+	RangeData data;
+	for (int i = 0; i < ELEMENT_COUNT; i++) {
+		data.visits[i] = 0;
+	}
+	pool->wait_for_group(pool->add_group(range_func, &data, ELEMENT_COUNT, 7));
+
+	for (int i = 0; i < ELEMENT_COUNT; i++) {
+		if (data.visits[i] != 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Each stage checks, for every element it processes, that the stages it
+// depends on are entirely done.
+struct StageData {
+	volatile uint32_t done[STAGE_COUNT];
+	volatile uint32_t errors;
+};
+
+struct Stage {
+	StageData *data;
+	int index;
+	int dependencies[2];
+	int dependency_count;
+};
+
+static void stage_func(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	Stage *stage = (Stage *)p_userdata;
+	StageData *data = stage->data;
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		for (int j = 0; j < stage->dependency_count; j++) {
+			if (data->done[stage->dependencies[j]] != ELEMENT_COUNT) {
+				atomic_increment(&data->errors);
+			}
+		}
+		atomic_increment(&data->done[stage->index]);
+	}
+}
+
+bool test_dependencies() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+
+	// Diamond: 1 and 2 depend on 0, 3 depends on 1 and 2. Later stages are
+	// added while the earlier ones may still be running.
+	StageData data;
+	data.errors = 0;
+	Stage stages[STAGE_COUNT];
+	for (int i = 0; i < STAGE_COUNT; i++) {
+		data.done[i] = 0;
+		stages[i].data = &data;
+		stages[i].index = i;
+		stages[i].dependency_count = 0;
+	}
+	stages[1].dependencies[0] = 0;
+	stages[1].dependency_count = 1;
+	stages[2].dependencies[0] = 0;
+	stages[2].dependency_count = 1;
+	stages[3].dependencies[0] = 1;
+	stages[3].dependencies[1] = 2;
+	stages[3].dependency_count = 2;
+
+	WorkerThreadPool::GroupID ids[STAGE_COUNT];
+	for (int i = 0; i < STAGE_COUNT; i++) {
+
+		WorkerThreadPool::GroupID dependencies[2];
+		for (int j = 0; j < stages[i].dependency_count; j++) {
+			dependencies[j] = ids[stages[i].dependencies[j]];
+		}
+		ids[i] = pool->add_group(stage_func, &stages[i], ELEMENT_COUNT, 16, dependencies, stages[i].dependency_count);
+	}
+
+	// Waiting on the last stage first must not stall, the others are still pending.
+	for (int i = STAGE_COUNT - 1; i >= 0; i--) {
+		pool->wait_for_group(ids[i]);
+	}
+
+	if (data.errors) {
+		return false;
+	}
+	for (int i = 0; i < STAGE_COUNT; i++) {
+		if (data.done[i] != ELEMENT_COUNT) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool test_completed_dependency() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+
+	StageData data;
+	data.errors = 0;
+	Stage stages[2];
+	for (int i = 0; i < 2; i++) {
+		data.done[i] = 0;
+		stages[i].data = &data;
+		stages[i].index = i;
+		stages[i].dependency_count = 0;
+	}
+	stages[1].dependencies[0] = 0;
+	stages[1].dependency_count = 1;
+
+	// Depending on a group that was already waited for runs right away.
+	WorkerThreadPool::GroupID first = pool->add_group(stage_func, &stages[0], ELEMENT_COUNT, 16);
+	pool->wait_for_group(first);
+	WorkerThreadPool::GroupID second = pool->add_group(stage_func, &stages[1], ELEMENT_COUNT, 16, &first, 1);
+	pool->wait_for_group(second);
+
+	return data.errors == 0 && data.done[1] == ELEMENT_COUNT && pool->is_group_completed(second);
+}
+
+bool test_empty_dependency() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+
+	StageData data;
+	data.errors = 0;
+	data.done[0] = ELEMENT_COUNT; // An empty group counts as done.
+	data.done[1] = 0;
+	Stage stage;
+	stage.data = &data;
+	stage.index = 1;
+	stage.dependencies[0] = 0;
+	stage.dependency_count = 1;
+
+	WorkerThreadPool::GroupID empty = pool->add_group(range_func, NULL, 0);
+	WorkerThreadPool::GroupID dependent = pool->add_group(stage_func, &stage, ELEMENT_COUNT, 16, &empty, 1);
+	pool->wait_for_group(dependent);
+	pool->wait_for_group(empty);
+
+	return data.errors == 0 && data.done[1] == ELEMENT_COUNT;
+}
+
+// Tasks adding their own group and waiting for it, as a task splitting its
+// work further would. The waiting task helps, so this can't deadlock even
+// when every worker is busy waiting.
+struct NestedData {
+	RangeData ranges[NESTED_COUNT];
+	volatile uint32_t finished;
+};
+
+static void nested_func(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	NestedData *data = (NestedData *)p_userdata;
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		pool->wait_for_group(pool->add_group(range_func, &data->ranges[i], NESTED_ELEMENTS, 3));
+		atomic_increment(&data->finished);
+	}
+}
+
+bool test_wait_in_task() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+
+	NestedData *data = memnew(NestedData);
+	data->finished = 0;
+	for (int i = 0; i < NESTED_COUNT; i++) {
+		for (int j = 0; j < NESTED_ELEMENTS; j++) {
+			data->ranges[i].visits[j] = 0;
+		}
+	}
+
+	pool->wait_for_group(pool->add_group(nested_func, data, NESTED_COUNT));
+
+	bool pass = data->finished == NESTED_COUNT;
+	for (int i = 0; i < NESTED_COUNT; i++) {
+		for (int j = 0; j < NESTED_ELEMENTS; j++) {
+			pass = pass && data->ranges[i].visits[j] == 1;
+		}
+	}
+
+	memdelete(data);
+	return pass;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_range,
+	test_dependencies,
+	test_completed_dependency,
+	test_empty_dependency,
+	test_wait_in_task,
+	0
+
+};
+
+// Every test runs without worker threads (the waiting thread does all the
+// work) and with several.
+static const int thread_counts[] = { 0, 4, -1 };
+
+MainLoop *test() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	int original_thread_count = pool->get_thread_count();
+
+	int count = 0;
+	int passed = 0;
+
+	for (int t = 0; thread_counts[t] >= 0; t++) {
+
+		// Nothing else is running yet when tests start, so the pool can be restarted.
+		pool->finish();
+		pool->init(thread_counts[t]);
+		OS::get_singleton()->print("%i worker threads:\n", thread_counts[t]);
+
+		for (int i = 0; test_funcs[i]; i++) {
+			bool pass = test_funcs[i]();
+			if (pass)
+				passed++;
+			OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+			count++;
+		}
+	}
+
+	pool->finish();
+	pool->init(original_thread_count);
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestWorkerThreadPool
@@ -633,3 +633,15 @@ def using_gcc(env):
 
 def using_clang(env):
     return 'clang' in os.path.basename(env["CC"])
+
+def configure_thread_local(env):
+    # Used by core/os/thread_local.h, which falls back to pthread/FLS keys when none of these compile.
+    conf = env.Configure()
+    if conf.TryCompile('thread_local int foo = 0; int main() { return foo; }', '.cpp'):
+        env.Append(CPPDEFINES=['HAVE_CXX11_THREAD_LOCAL'])
+    elif env.msvc:
+        if conf.TryCompile('__declspec(thread) int foo = 0; int main() { return foo; }', '.cpp'):
+            env.Append(CPPDEFINES=['HAVE_DECLSPEC_THREAD'])
+    elif conf.TryCompile('__thread int foo = 0; int main() { return foo; }', '.cpp'):
+        env.Append(CPPDEFINES=['HAVE_GCC___THREAD'])
+    conf.Finish()
@@ -569,14 +569,14 @@ void BulletPhysicsServer::body_clear_shapes(RID p_body) {
 	body->remove_all_shapes();
 }
 
-void BulletPhysicsServer::body_attach_object_instance_id(RID p_body, uint32_t p_id) {
+void BulletPhysicsServer::body_attach_object_instance_id(RID p_body, ObjectID p_id) {
 	CollisionObjectBullet *body = get_collisin_object(p_body);
 	ERR_FAIL_COND(!body);
 
 	body->set_instance_id(p_id);
 }
 
-uint32_t BulletPhysicsServer::body_get_object_instance_id(RID p_body) const {
+ObjectID BulletPhysicsServer::body_get_object_instance_id(RID p_body) const {
 	CollisionObjectBullet *body = get_collisin_object(p_body);
 	ERR_FAIL_COND_V(!body, 0);
 
@@ -684,6 +684,30 @@ Variant BulletPhysicsServer::body_get_state(RID p_body, BodyState p_state) const
 	return body->get_state(p_state);
 }
 
+void BulletPhysicsServer::bodies_get_state(const RID *p_bodies, int p_count, Transform *r_transforms, Vector3 *r_linear_velocities, Vector3 *r_angular_velocities) const {
+
+	for (int i = 0; i < p_count; i++) {
+
+		RigidBodyBullet *body = rigid_body_owner.get(p_bodies[i]);
+		if (!body) {
+			if (r_transforms)
+				r_transforms[i] = Transform();
+			if (r_linear_velocities)
+				r_linear_velocities[i] = Vector3();
+			if (r_angular_velocities)
+				r_angular_velocities[i] = Vector3();
+			ERR_CONTINUE(!body);
+		}
+
+		if (r_transforms)
+			r_transforms[i] = body->get_transform();
+		if (r_linear_velocities)
+			r_linear_velocities[i] = body->get_linear_velocity();
+		if (r_angular_velocities)
+			r_angular_velocities[i] = body->get_angular_velocity();
+	}
+}
+
 void BulletPhysicsServer::body_set_applied_force(RID p_body, const Vector3 &p_force) {
 	RigidBodyBullet *body = rigid_body_owner.get(p_body);
 	ERR_FAIL_COND(!body);
@@ -1574,6 +1598,9 @@ void BulletPhysicsServer::sync() {
 void BulletPhysicsServer::flush_queries() {
 }
 
+void BulletPhysicsServer::end_sync() {
+}
+
 void BulletPhysicsServer::finish() {
 	BulletPhysicsDirectBodyState::destroySingleton();
 }
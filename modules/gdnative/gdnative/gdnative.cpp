@@ -36,6 +36,8 @@
 #include "core/global_constants.h"
 #include "core/os/os.h"
 #include "core/variant.h"
+#include "servers/physics_server.h"
+#include "servers/visual_server.h"
 
 #include "modules/gdnative/gdnative.h"
 
@@ -91,6 +93,69 @@ godot_variant GDAPI godot_method_bind_call(godot_method_bind *p_method_bind, god
 	return ret;
 }
 
+void GDAPI godot_method_bind_ptrcall_batch(godot_method_bind *p_method_bind, godot_object **p_instances, const void ***p_args, void **p_rets, const int p_count) {
+
+	ERR_FAIL_COND(p_count < 0);
+	if (p_count == 0)
+		return;
+	ERR_FAIL_NULL(p_method_bind);
+	ERR_FAIL_NULL(p_instances);
+	ERR_FAIL_NULL(p_args);
+
+	MethodBind *mb = (MethodBind *)p_method_bind;
+	// ptrcall always encodes the return value into r_ret, there is no way to discard it
+	ERR_FAIL_COND(mb->has_return() && !p_rets);
+	for (int i = 0; i < p_count; i++) {
+		mb->ptrcall((Object *)p_instances[i], p_args[i], p_rets ? p_rets[i] : NULL);
+	}
+}
+
+// Batched server API
+
+void GDAPI godot_visual_server_instances_set_transform(const godot_rid *p_instances, const godot_transform *p_transforms, const int p_count) {
+
+	ERR_FAIL_COND(p_count < 0);
+	if (p_count == 0)
+		return;
+	ERR_FAIL_NULL(p_instances);
+	ERR_FAIL_NULL(p_transforms);
+
+	VisualServer *vs = VisualServer::get_singleton();
+	const RID *instances = (const RID *)p_instances;
+	const Transform *transforms = (const Transform *)p_transforms;
+
+	for (int i = 0; i < p_count; i++) {
+		vs->instance_set_transform(instances[i], transforms[i]);
+	}
+}
+
+void GDAPI godot_physics_server_bodies_set_transform(const godot_rid *p_bodies, const godot_transform *p_transforms, const int p_count) {
+
+	ERR_FAIL_COND(p_count < 0);
+	if (p_count == 0)
+		return;
+	ERR_FAIL_NULL(p_bodies);
+	ERR_FAIL_NULL(p_transforms);
+
+	PhysicsServer *ps = PhysicsServer::get_singleton();
+	const RID *bodies = (const RID *)p_bodies;
+	const Transform *transforms = (const Transform *)p_transforms;
+
+	for (int i = 0; i < p_count; i++) {
+		ps->body_set_state(bodies[i], PhysicsServer::BODY_STATE_TRANSFORM, transforms[i]);
+	}
+}
+
+void GDAPI godot_physics_server_bodies_get_state(const godot_rid *p_bodies, const int p_count, godot_transform *r_transforms, godot_vector3 *r_linear_velocities, godot_vector3 *r_angular_velocities) {
+
+	ERR_FAIL_COND(p_count < 0);
+	if (p_count == 0)
+		return;
+	ERR_FAIL_NULL(p_bodies);
+
+	PhysicsServer::get_singleton()->bodies_get_state((const RID *)p_bodies, p_count, (Transform *)r_transforms, (Vector3 *)r_linear_velocities, (Vector3 *)r_angular_velocities);
+}
+
 godot_class_constructor GDAPI godot_get_class_constructor(const char *p_classname) {
 	ClassDB::ClassInfo *class_info = ClassDB::classes.getptr(StringName(p_classname));
 	if (class_info)
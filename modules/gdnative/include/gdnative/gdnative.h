@@ -222,6 +222,17 @@ typedef struct {
 godot_method_bind GDAPI *godot_method_bind_get_method(const char *p_classname, const char *p_methodname);
 void GDAPI godot_method_bind_ptrcall(godot_method_bind *p_method_bind, godot_object *p_instance, const void **p_args, void *p_ret);
 godot_variant GDAPI godot_method_bind_call(godot_method_bind *p_method_bind, godot_object *p_instance, const godot_variant **p_args, const int p_arg_count, godot_variant_call_error *p_call_error);
+// calls the method on p_count instances, p_args[i] and p_rets[i] are used for p_instances[i]
+// p_rets may only be NULL for methods without a return value
+void GDAPI godot_method_bind_ptrcall_batch(godot_method_bind *p_method_bind, godot_object **p_instances, const void ***p_args, void **p_rets, const int p_count);
+
+////// Batched server API
+
+void GDAPI godot_visual_server_instances_set_transform(const godot_rid *p_instances, const godot_transform *p_transforms, const int p_count);
+void GDAPI godot_physics_server_bodies_set_transform(const godot_rid *p_bodies, const godot_transform *p_transforms, const int p_count);
+// any of the output arrays may be NULL
+void GDAPI godot_physics_server_bodies_get_state(const godot_rid *p_bodies, const int p_count, godot_transform *r_transforms, godot_vector3 *r_linear_velocities, godot_vector3 *r_angular_velocities);
+
 ////// Script API
 
 typedef struct godot_gdnative_api_version {
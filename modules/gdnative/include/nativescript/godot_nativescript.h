@@ -243,6 +243,29 @@ void GDAPI *godot_nativescript_get_instance_binding_data(int p_idx, godot_object
 
 void GDAPI godot_nativescript_profiling_add_data(const char *p_signature, uint64_t p_time);
 
+/*
+ *
+ *
+ * NativeScript 1.2
+ *
+ *
+ */
+
+// typed method entry points, called without boxing arguments into variants
+
+typedef struct {
+	// instance pointer, method data, user data, args, return value
+	// args and return value are laid out like in godot_method_bind_ptrcall
+	GDCALLINGCONV void (*ptrcall_func)(godot_object *, void *, void *, const void **, void *);
+	void *method_data;
+	GDCALLINGCONV void (*free_func)(void *);
+} godot_instance_method_ptrcall;
+
+// GODOT_VARIANT_TYPE_NIL means any type, passed as a godot_variant *
+// the return value points to a default value of p_return_type to overwrite
+// calls whose arguments don't match p_arg_types exactly use the regular method
+void GDAPI godot_nativescript_set_method_ptrcall(void *p_gdnative_handle, const char *p_name, const char *p_function_name, godot_variant_type p_return_type, int p_num_args, const godot_variant_type *p_arg_types, godot_instance_method_ptrcall p_method);
+
 #ifdef __cplusplus
 }
 #endif
@@ -111,6 +111,12 @@ void GDAPI godot_nativescript_register_method(void *p_gdnative_handle, const cha
 	method.rpc_mode = p_attr.rpc_type;
 	method.info = MethodInfo(p_function_name);
 
+	// Registering again replaces the method, its ptrcall entry point goes with it.
+	Map<StringName, NativeScriptDesc::Method>::Element *old = E->get().methods.find(p_function_name);
+	if (old && old->get().ptrcall.free_func) {
+		old->get().ptrcall.free_func(old->get().ptrcall.method_data);
+	}
+
 	E->get().methods.insert(p_function_name, method);
 }
 
@@ -321,6 +327,31 @@ void GDAPI godot_nativescript_profiling_add_data(const char *p_signature, uint64
 	NativeScriptLanguage::get_singleton()->profiling_add_data(StringName(p_signature), p_time);
 }
 
+void GDAPI godot_nativescript_set_method_ptrcall(void *p_gdnative_handle, const char *p_name, const char *p_function_name, godot_variant_type p_return_type, int p_num_args, const godot_variant_type *p_arg_types, godot_instance_method_ptrcall p_method) {
+	String *s = (String *)p_gdnative_handle;
+
+	Map<StringName, NativeScriptDesc>::Element *E = NSL->library_classes[*s].find(p_name);
+	ERR_FAIL_COND_MSG(!E, "Attempted to add a ptrcall entry point for a method on a non-existent class.");
+
+	Map<StringName, NativeScriptDesc::Method>::Element *method = E->get().methods.find(p_function_name);
+	ERR_FAIL_COND_MSG(!method, "Attempted to add a ptrcall entry point to non-existent method.");
+
+	ERR_FAIL_COND(!p_method.ptrcall_func);
+	ERR_FAIL_COND(p_num_args < 0 || (p_num_args > 0 && !p_arg_types));
+
+	NativeScriptDesc::Method &m = method->get();
+
+	if (m.ptrcall.free_func)
+		m.ptrcall.free_func(m.ptrcall.method_data);
+
+	m.ptrcall = p_method;
+	m.ptrcall_return_type = (Variant::Type)p_return_type;
+	m.ptrcall_arg_types.resize(p_num_args);
+	for (int i = 0; i < p_num_args; i++) {
+		m.ptrcall_arg_types.write[i] = (Variant::Type)p_arg_types[i];
+	}
+}
+
 #ifdef __cplusplus
 }
 #endif
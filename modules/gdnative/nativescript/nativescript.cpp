@@ -38,6 +38,7 @@
 #include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
+#include "core/variant_internal.h"
 
 #include "scene/main/scene_tree.h"
 #include "scene/resources/resource_format_text.h"
@@ -703,6 +704,56 @@ bool NativeScriptInstance::has_method(const StringName &p_method) const {
 	return script->has_method(p_method);
 }
 
+bool NativeScriptInstance::_ptrcall(const NativeScriptDesc::Method &p_method, const Variant **p_args, int p_argcount, Variant &r_ret) {
+
+	if (p_argcount != p_method.ptrcall_arg_types.size())
+		return false;
+
+	const void **args = (const void **)alloca(sizeof(void *) * MAX(p_argcount, 1));
+	const Variant::Type *types = p_method.ptrcall_arg_types.ptr();
+
+	for (int i = 0; i < p_argcount; i++) {
+		if (types[i] == Variant::NIL) {
+			args[i] = p_args[i];
+		} else if (p_args[i]->get_type() != types[i]) {
+			return false; // let the variant entry point convert or report it
+		} else if (types[i] == Variant::OBJECT) {
+			args[i] = p_args[i]->operator Object *();
+		} else {
+			args[i] = VariantInternal::get_opaque_pointer(p_args[i]);
+		}
+	}
+
+	Object *ret_object = NULL;
+	void *ret;
+
+	if (p_method.ptrcall_return_type == Variant::NIL) {
+		ret = &r_ret;
+	} else if (p_method.ptrcall_return_type == Variant::OBJECT) {
+		ret = &ret_object;
+	} else {
+		Variant::CallError ce;
+		r_ret = Variant::construct(p_method.ptrcall_return_type, NULL, 0, ce);
+		ret = VariantInternal::get_opaque_pointer(&r_ret);
+	}
+
+#ifdef DEBUG_ENABLED
+	current_method_call = p_method.info.name;
+#endif
+
+	p_method.ptrcall.ptrcall_func((godot_object *)owner, p_method.ptrcall.method_data, userdata, args, ret);
+
+#ifdef DEBUG_ENABLED
+	current_method_call = "";
+#endif
+
+	if (p_method.ptrcall_return_type == Variant::OBJECT) {
+		r_ret = ret_object;
+	}
+
+	return true;
+}
+
 Variant NativeScriptInstance::call(const StringName &p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
 
 	NativeScriptDesc *script_data = GET_SCRIPT_DESC();
@@ -710,6 +761,14 @@ Variant NativeScriptInstance::call(const StringName &p_method, const Variant **p
 	while (script_data) {
 		Map<StringName, NativeScriptDesc::Method>::Element *E = script_data->methods.find(p_method);
 		if (E) {
+			if (E->get().ptrcall.ptrcall_func) {
+				Variant res;
+				if (_ptrcall(E->get(), p_args, p_argcount, res)) {
+					r_error.error = Variant::CallError::CALL_OK;
+					return res;
+				}
+			}
+
 			godot_variant result;
 
 #ifdef DEBUG_ENABLED
@@ -976,6 +1035,9 @@ void NativeScriptLanguage::_unload_stuff(bool p_reload) {
 			for (Map<StringName, NativeScriptDesc::Method>::Element *M = C->get().methods.front(); M; M = M->next()) {
 				if (M->get().method.free_func)
 					M->get().method.free_func(M->get().method.method_data);
+
+				if (M->get().ptrcall.free_func)
+					M->get().ptrcall.free_func(M->get().ptrcall.method_data);
 			}
 
 			// free constructor/destructor
@@ -55,6 +55,18 @@ struct NativeScriptDesc {
 		MethodInfo info;
 		int rpc_mode;
 		String documentation;
+
+		// optional typed entry point, see godot_nativescript_set_method_ptrcall()
+		godot_instance_method_ptrcall ptrcall;
+		Variant::Type ptrcall_return_type;
+		Vector<Variant::Type> ptrcall_arg_types;
+
+		Method() {
+			ptrcall.ptrcall_func = NULL;
+			ptrcall.method_data = NULL;
+			ptrcall.free_func = NULL;
+			ptrcall_return_type = Variant::NIL;
+		}
 	};
 	struct Property {
 		godot_property_set_func setter;
@@ -196,6 +208,7 @@ class NativeScriptInstance : public ScriptInstance {
 #endif
 
 	void _ml_call_reversed(NativeScriptDesc *script_data, const StringName &p_method, const Variant **p_args, int p_argcount);
+	bool _ptrcall(const NativeScriptDesc::Method &p_method, const Variant **p_args, int p_argcount, Variant &r_ret);
 
 public:
 	void *userdata;
@@ -37,6 +37,7 @@
 #include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
+#include "gdscript_compiled_cache.h"
 #include "gdscript_compiler.h"
 
 ///////////////////////////
@@ -566,20 +567,45 @@ Error GDScript::reload(bool p_keep_state) {
 	}
 
 	valid = false;
-	GDScriptParser parser;
-	Error err = parser.parse(source, basedir, false, path);
-	if (err) {
+	Error err;
+	if (preparsed_parser) {
+		// Parsed on a worker already, what needs loading resources is left.
+		GDScriptParser *parser = preparsed_parser;
+		preparsed_parser = NULL;
+		err = _compile_parsed(*parser, parser->resolve_deferred(), p_keep_state);
+		memdelete(parser);
+	} else {
+		GDScriptParser parser;
+		if (preparsed_tokens) {
+			err = parser.parse_recorded(preparsed_tokens, basedir, path);
+		} else {
+			err = parser.parse(source, basedir, false, path);
+		}
+		err = _compile_parsed(parser, err, p_keep_state);
+	}
+
+	if (preparsed_tokens) {
+		memdelete(preparsed_tokens);
+		preparsed_tokens = NULL;
+	}
+
+	return err;
+}
+
+Error GDScript::_compile_parsed(GDScriptParser &p_parser, Error p_parse_error, bool p_keep_state) {
+
+	if (p_parse_error) {
 		if (ScriptDebugger::get_singleton()) {
-			GDScriptLanguage::get_singleton()->debug_break_parse(get_path(), parser.get_error_line(), "Parser Error: " + parser.get_error());
+			GDScriptLanguage::get_singleton()->debug_break_parse(get_path(), p_parser.get_error_line(), "Parser Error: " + p_parser.get_error());
 		}
-		_err_print_error("GDScript::reload", path.empty() ? "built-in" : (const char *)path.utf8().get_data(), parser.get_error_line(), ("Parse Error: " + parser.get_error()).utf8().get_data(), ERR_HANDLER_SCRIPT);
+		_err_print_error("GDScript::reload", path.empty() ? "built-in" : (const char *)path.utf8().get_data(), p_parser.get_error_line(), ("Parse Error: " + p_parser.get_error()).utf8().get_data(), ERR_HANDLER_SCRIPT);
 		ERR_FAIL_V(ERR_PARSE_ERROR);
 	}
 
-	bool can_run = ScriptServer::is_scripting_enabled() || parser.is_tool_script();
+	bool can_run = ScriptServer::is_scripting_enabled() || p_parser.is_tool_script();
 
 	GDScriptCompiler compiler;
-	err = compiler.compile(&parser, this, p_keep_state);
+	Error err = compiler.compile(&p_parser, this, p_keep_state);
 
 	if (err) {
 
@@ -594,7 +620,7 @@ Error GDScript::reload(bool p_keep_state) {
 		}
 	}
 #ifdef DEBUG_ENABLED
-	for (const List<GDScriptWarning>::Element *E = parser.get_warnings().front(); E; E = E->next()) {
+	for (const List<GDScriptWarning>::Element *E = p_parser.get_warnings().front(); E; E = E->next()) {
 		const GDScriptWarning &warning = E->get();
 		if (ScriptDebugger::get_singleton()) {
 			Vector<ScriptLanguage::StackInfo> si;
@@ -721,9 +747,7 @@ Vector<uint8_t> GDScript::get_as_byte_code() const {
 	return tokenizer.parse_code_string(source);
 };
 
-Error GDScript::load_byte_code(const String &p_path) {
-
-	Vector<uint8_t> bytecode;
+Error GDScript::read_byte_code(const String &p_path, Vector<uint8_t> &r_bytecode) {
 
 	if (p_path.ends_with("gde")) {
 
@@ -749,19 +773,57 @@ Error GDScript::load_byte_code(const String &p_path) {
 			ERR_FAIL_COND_V(err, err);
 		}
 
-		bytecode.resize(fae->get_len());
-		fae->get_buffer(bytecode.ptrw(), bytecode.size());
+		r_bytecode.resize(fae->get_len());
+		fae->get_buffer(r_bytecode.ptrw(), r_bytecode.size());
 		fae->close();
 		memdelete(fae);
 
 	} else {
 
-		bytecode = FileAccess::get_file_as_array(p_path);
+		r_bytecode = FileAccess::get_file_as_array(p_path);
+	}
+
+	ERR_FAIL_COND_V(r_bytecode.size() == 0, ERR_PARSE_ERROR);
+	return OK;
+}
+
+Error GDScript::load_byte_code(const String &p_path) {
+
+	Vector<uint8_t> bytecode;
+	Error err = read_byte_code(p_path, bytecode);
+	if (err) {
+		return err;
 	}
 
-	ERR_FAIL_COND_V(bytecode.size() == 0, ERR_PARSE_ERROR);
+	return load_byte_code(p_path, bytecode);
+}
+
+Error GDScript::load_byte_code(const String &p_path, const Vector<uint8_t> &p_bytecode) {
+
+	Vector<uint8_t> bytecode = p_bytecode;
 	path = p_path;
 
+	Vector<uint8_t> compiled;
+	Vector<uint8_t> tokens;
+	if (GDScriptCompiledCache::unpack(bytecode, compiled, tokens)) {
+
+		bytecode = tokens;
+
+		valid = false;
+		if (GDScriptCompiledCache::load(this, compiled) == OK) {
+
+			valid = true;
+
+			for (Map<StringName, Ref<GDScript> >::Element *E = subclasses.front(); E; E = E->next()) {
+
+				_set_subclass_path(E->get(), path);
+			}
+
+			return OK;
+		}
+		// Fall back to compiling the token stream stored along it.
+	}
+
 	String basedir = path;
 
 	if (basedir == "")
@@ -796,7 +858,7 @@ Error GDScript::load_byte_code(const String &p_path) {
 	return OK;
 }
 
-Error GDScript::load_source_code(const String &p_path) {
+Error GDScript::read_source_code(const String &p_path, String &r_source) {
 
 	PoolVector<uint8_t> sourcef;
 	Error err;
@@ -821,6 +883,18 @@ Error GDScript::load_source_code(const String &p_path) {
 		ERR_FAIL_V_MSG(ERR_INVALID_DATA, "Script '" + p_path + "' contains invalid unicode (UTF-8), so it was not loaded. Please ensure that scripts are saved in valid UTF-8 unicode.");
 	}
 
+	r_source = s;
+	return OK;
+}
+
+Error GDScript::load_source_code(const String &p_path) {
+
+	String s;
+	Error err = read_source_code(p_path, s);
+	if (err) {
+		return err;
+	}
+
 	source = s;
 #ifdef TOOLS_ENABLED
 	source_changed_cache = true;
@@ -888,16 +962,21 @@ void GDScript::get_script_signal_list(List<MethodInfo> *r_signals) const {
 #endif
 }
 
+volatile uint32_t GDScript::last_method_serial = 0;
+
 GDScript::GDScript() :
 		script_list(this) {
 
 	_static_ref = this;
+	method_serial = atomic_increment(&last_method_serial);
 	valid = false;
 	subclass_count = 0;
 	initializer = NULL;
 	_base = NULL;
 	_owner = NULL;
 	tool = false;
+	preparsed_tokens = NULL;
+	preparsed_parser = NULL;
 #ifdef TOOLS_ENABLED
 	source_changed_cache = false;
 	placeholder_fallback_enabled = false;
@@ -916,6 +995,13 @@ GDScript::GDScript() :
 }
 
 GDScript::~GDScript() {
+	if (preparsed_parser) {
+		memdelete(preparsed_parser);
+	}
+	if (preparsed_tokens) {
+		memdelete(preparsed_tokens);
+	}
+
 	for (Map<StringName, GDScriptFunction *>::Element *E = member_functions.front(); E; E = E->next()) {
 		memdelete(E->get());
 	}
@@ -1169,6 +1255,24 @@ Variant GDScriptInstance::call(const StringName &p_method, const Variant **p_arg
 	return Variant();
 }
 
+const void *GDScriptInstance::resolve_method(const StringName &p_method) const {
+
+	const GDScript *sptr = script.ptr();
+	while (sptr) {
+		const Map<StringName, GDScriptFunction *>::Element *E = sptr->member_functions.find(p_method);
+		if (E) {
+			return E->get();
+		}
+		sptr = sptr->_base;
+	}
+	return NULL;
+}
+
+Variant GDScriptInstance::call_resolved(const void *p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
+
+	return ((GDScriptFunction *)p_method)->call(this, p_args, p_argcount, r_error);
+}
+
 void GDScriptInstance::call_multilevel(const StringName &p_method, const Variant **p_args, int p_argcount) {
 
 	GDScript *sptr = script.ptr();
@@ -1351,14 +1455,23 @@ String GDScriptLanguage::get_name() const {
 
 void GDScriptLanguage::_add_global(const StringName &p_name, const Variant &p_value) {
 
+	// Scripts can be preparsed on other threads meanwhile.
+	if (lock) {
+		lock->lock();
+	}
+
 	if (globals.has(p_name)) {
 		//overwrite existing
 		global_array.write[globals[p_name]] = p_value;
-		return;
+	} else {
+		globals[p_name] = global_array.size();
+		global_array.push_back(p_value);
+		_global_array = global_array.ptrw();
+	}
+
+	if (lock) {
+		lock->unlock();
 	}
-	globals[p_name] = global_array.size();
-	global_array.push_back(p_value);
-	_global_array = global_array.ptrw();
 }
 
 void GDScriptLanguage::add_global_constant(const StringName &p_variable, const Variant &p_value) {
@@ -1367,12 +1480,26 @@ void GDScriptLanguage::add_global_constant(const StringName &p_variable, const V
 }
 
 void GDScriptLanguage::add_named_global_constant(const StringName &p_name, const Variant &p_value) {
+
+	if (lock) {
+		lock->lock();
+	}
 	named_globals[p_name] = p_value;
+	if (lock) {
+		lock->unlock();
+	}
 }
 
 void GDScriptLanguage::remove_named_global_constant(const StringName &p_name) {
 	ERR_FAIL_COND(!named_globals.has(p_name));
+
+	if (lock) {
+		lock->lock();
+	}
 	named_globals.erase(p_name);
+	if (lock) {
+		lock->unlock();
+	}
 }
 
 void GDScriptLanguage::init() {
@@ -1414,6 +1541,11 @@ void GDScriptLanguage::init() {
 
 		_add_global(E->get().name, E->get().ptr);
 	}
+
+	if (!Engine::get_singleton()->is_editor_hint()) {
+		int preparse_mode = GLOBAL_GET("application/run/preparse_gdscript");
+		preparser.start(GDScriptPreparser::Mode(preparse_mode));
+	}
 }
 
 String GDScriptLanguage::get_type() const {
@@ -1430,6 +1562,8 @@ Error GDScriptLanguage::execute_file(const String &p_path) {
 	return OK;
 }
 void GDScriptLanguage::finish() {
+
+	preparser.clear();
 }
 
 void GDScriptLanguage::profiling_start() {
@@ -1537,6 +1671,82 @@ int GDScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_
 	return current;
 }
 
+int GDScriptLanguage::profiling_get_stack_sample(StackInfo *p_info_arr, int p_info_max) {
+
+	int count = 0;
+
+#ifdef DEBUG_ENABLED
+	if (!_call_stack) {
+		return 0;
+	}
+
+	// Functions can't be freed while holding the lock, so the ones on the copied stack stay valid until it's released.
+	if (lock) {
+		lock->lock();
+	}
+
+	// The main thread doesn't lock to change its call stack. Copy it without following any pointer
+	// but the line one, which points to the main thread's stack, and retry if it changed meanwhile.
+	int sampled = -1;
+	for (int attempt = 0; attempt < PROFILING_SAMPLE_ATTEMPTS && sampled < 0; attempt++) {
+		uint32_t version = _debug_call_stack_version;
+		atomic_acquire_fence();
+		if (version & 1) {
+			continue;
+		}
+
+		int n = 0;
+		for (int i = _debug_call_stack_pos - 1; i >= 0 && n < p_info_max; i--) {
+			int *line = _call_stack[i].line;
+			_sampled_call_stack[n].function = _call_stack[i].function;
+			_sampled_call_stack[n].line = line ? *line : 0;
+			n++;
+		}
+
+		atomic_acquire_fence();
+		if (_debug_call_stack_version == version) {
+			sampled = n;
+		}
+	}
+
+	for (int i = 0; i < sampled; i++) {
+		const SampledLevel &sl = _sampled_call_stack[i];
+		if (!sl.function) {
+			continue;
+		}
+		p_info_arr[count].func = sl.function->get_name();
+		p_info_arr[count].file = sl.function->get_script() ? sl.function->get_script()->get_path() : String();
+		p_info_arr[count].line = sl.line;
+		count++;
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	if (sampled < 0) {
+		return -1; // Kept changing, drop the sample rather than guess.
+	}
+#endif
+
+	return count;
+}
+
+void GDScriptLanguage::profiling_set_sampling(bool p_enable) {
+
+	if (p_enable && !_call_stack) {
+		_allocate_call_stack(GLOBAL_GET("debug/settings/gdscript/max_call_stack"));
+	}
+	_sampling_call_stack = p_enable;
+}
+
+void GDScriptLanguage::_allocate_call_stack(int p_max_call_stack) {
+
+	_debug_max_call_stack = p_max_call_stack;
+	_call_stack = memnew_arr(CallLevel, _debug_max_call_stack + 1);
+	_sampled_call_stack = memnew_arr(SampledLevel, _debug_max_call_stack + 1);
+}
+
 struct GDScriptDepSort {
 
 	//must support sorting so inheritance works properly (parent must be reloaded first)
@@ -1732,6 +1942,44 @@ void GDScriptLanguage::frame() {
 
 	calls = 0;
 
+	// Whatever startup needed is loaded by now, scripts loaded later on are
+	// loaded from their files.
+	preparser.release();
+
+	// Disconnect yield queues nobody waits on anymore, this can't be done
+	// from within the signal emission itself. They are taken out of the map
+	// under the lock, so a yield from another thread meanwhile starts a new
+	// queue instead of waiting on one that is about to go away.
+	Vector<Ref<GDScriptYieldQueue> > idle_queues;
+
+	if (lock) {
+		lock->lock();
+	}
+	Map<GDScriptYieldQueue::Key, GDScriptYieldQueue *>::Element *E = yield_queues.front();
+	while (E) {
+		Map<GDScriptYieldQueue::Key, GDScriptYieldQueue *>::Element *N = E->next();
+		if (E->get()->waiting.empty()) {
+			Ref<GDScriptYieldQueue> queue(E->get());
+			if (queue.is_valid()) {
+				queue->registered = false;
+				yield_queues.erase(E);
+				idle_queues.push_back(queue);
+			}
+		}
+		E = N;
+	}
+	if (lock) {
+		lock->unlock();
+	}
+
+	for (int i = 0; i < idle_queues.size(); i++) {
+		GDScriptYieldQueue *queue = idle_queues.write[i].ptr();
+		Object *obj = ObjectDB::get_instance(queue->key.object);
+		if (obj && obj->is_connected(queue->key.signal, queue, "_signal_callback")) {
+			obj->disconnect(queue->key.signal, queue, "_signal_callback");
+		}
+	}
+
 #ifdef DEBUG_ENABLED
 	if (profiling) {
 		if (lock) {
@@ -2124,18 +2372,22 @@ GDScriptLanguage::GDScriptLanguage() {
 	script_frame_time = 0;
 
 	_debug_call_stack_pos = 0;
+	_debug_call_stack_version = 0;
+	_sampling_call_stack = false;
 	int dmcs = GLOBAL_DEF("debug/settings/gdscript/max_call_stack", 1024);
 	ProjectSettings::get_singleton()->set_custom_property_info("debug/settings/gdscript/max_call_stack", PropertyInfo(Variant::INT, "debug/settings/gdscript/max_call_stack", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater")); //minimum is 1024
+	GLOBAL_DEF("application/run/preparse_gdscript", GDScriptPreparser::MODE_DISABLED);
+	ProjectSettings::get_singleton()->set_custom_property_info("application/run/preparse_gdscript", PropertyInfo(Variant::INT, "application/run/preparse_gdscript", PROPERTY_HINT_ENUM, "Disabled,Main Scene,Project"));
 
 	if (ScriptDebugger::get_singleton()) {
 		//debugging enabled!
 
-		_debug_max_call_stack = dmcs;
-		_call_stack = memnew_arr(CallLevel, _debug_max_call_stack + 1);
+		_allocate_call_stack(dmcs);
 
 	} else {
 		_debug_max_call_stack = 0;
 		_call_stack = NULL;
+		_sampled_call_stack = NULL;
 	}
 
 #ifdef DEBUG_ENABLED
@@ -2158,6 +2410,7 @@ GDScriptLanguage::~GDScriptLanguage() {
 	}
 	if (_call_stack) {
 		memdelete_arr(_call_stack);
+		memdelete_arr(_sampled_call_stack);
 	}
 	singleton = NULL;
 }
@@ -2173,16 +2426,25 @@ RES ResourceFormatLoaderGDScript::load(const String &p_path, const String &p_ori
 
 	Ref<GDScript> scriptres(script);
 
+	GDScriptPreparser::Preparsed preparsed;
+	bool was_preparsed = GDScriptLanguage::get_singleton()->get_preparser().take(p_original_path, p_path, preparsed);
+
 	if (p_path.ends_with(".gde") || p_path.ends_with(".gdc")) {
 
 		script->set_script_path(p_original_path); // script needs this.
 		script->set_path(p_original_path);
-		Error err = script->load_byte_code(p_path);
+		Error err = was_preparsed ? script->load_byte_code(p_path, preparsed.bytecode) : script->load_byte_code(p_path);
 		ERR_FAIL_COND_V_MSG(err != OK, RES(), "Cannot load byte code from file '" + p_path + "'.");
 
 	} else {
-		Error err = script->load_source_code(p_path);
-		ERR_FAIL_COND_V_MSG(err != OK, RES(), "Cannot load source code from file '" + p_path + "'.");
+		if (was_preparsed) {
+			script->set_source_code(preparsed.source);
+			script->preparsed_tokens = preparsed.tokens;
+			script->preparsed_parser = preparsed.parser;
+		} else {
+			Error err = script->load_source_code(p_path);
+			ERR_FAIL_COND_V_MSG(err != OK, RES(), "Cannot load source code from file '" + p_path + "'.");
+		}
 
 		script->set_script_path(p_original_path); // script needs this.
 		script->set_path(p_original_path);
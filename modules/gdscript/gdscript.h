@@ -33,8 +33,10 @@
 
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
+#include "core/safe_refcount.h"
 #include "core/script_language.h"
 #include "gdscript_function.h"
+#include "gdscript_preparser.h"
 
 class GDScriptNativeClass : public Reference {
 
@@ -72,12 +74,19 @@ class GDScript : public Script {
 	friend class GDScriptCompiler;
 	friend class GDScriptFunctions;
 	friend class GDScriptLanguage;
+	friend class GDScriptCompiledWriter;
+	friend class GDScriptCompiledReader;
+	friend class GDScriptOptimizer;
+	friend class ResourceFormatLoaderGDScript;
 
 	Variant _static_ref; //used for static call
 	Ref<GDScriptNativeClass> native;
 	Ref<GDScript> base;
 	GDScript *_base; //fast pointer access
 	GDScript *_owner; //for subclasses
+	uint32_t method_serial; // Unique to this script, see GDScriptInstance::get_method_version().
+
+	static volatile uint32_t last_method_serial;
 
 	Set<StringName> members; //members are just indices to the instanced script.
 	Map<StringName, Variant> constants;
@@ -112,10 +121,13 @@ class GDScript : public Script {
 	String path;
 	String name;
 	SelfList<GDScript> script_list;
+	GDScriptTokenizerRecorded *preparsed_tokens; //consumed by the next reload()
+	GDScriptParser *preparsed_parser; //parsed from preparsed_tokens, resolved by the next reload()
 
 	GDScriptInstance *_create_instance(const Variant **p_args, int p_argcount, Object *p_owner, bool p_isref, Variant::CallError &r_error);
 
 	void _set_subclass_path(Ref<GDScript> &p_sc, const String &p_path);
+	Error _compile_parsed(GDScriptParser &p_parser, Error p_parse_error, bool p_keep_state);
 
 #ifdef TOOLS_ENABLED
 	Set<PlaceHolderScriptInstance *> placeholders;
@@ -183,8 +195,11 @@ public:
 	virtual Error reload(bool p_keep_state = false);
 
 	void set_script_path(const String &p_path) { path = p_path; } //because subclasses need a path too...
+	static Error read_source_code(const String &p_path, String &r_source);
 	Error load_source_code(const String &p_path);
+	static Error read_byte_code(const String &p_path, Vector<uint8_t> &r_bytecode);
 	Error load_byte_code(const String &p_path);
+	Error load_byte_code(const String &p_path, const Vector<uint8_t> &p_bytecode);
 
 	Vector<uint8_t> get_as_byte_code() const;
 
@@ -248,6 +263,11 @@ public:
 	virtual void call_multilevel(const StringName &p_method, const Variant **p_args, int p_argcount);
 	virtual void call_multilevel_reversed(const StringName &p_method, const Variant **p_args, int p_argcount);
 
+	// Methods depend on the script only, so all its instances share what call sites resolved.
+	virtual uint64_t get_method_version() const { return ((uint64_t)script->method_serial << 32) | GDScriptFunction::get_generation(); }
+	virtual const void *resolve_method(const StringName &p_method) const;
+	virtual Variant call_resolved(const void *p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error);
+
 	Variant debug_get_member_by_index(int p_idx) const { return members[p_idx]; }
 
 	virtual void notification(int p_notification);
@@ -331,12 +351,28 @@ class GDScriptLanguage : public ScriptLanguage {
 		int *line;
 	};
 
+	enum {
+		PROFILING_SAMPLE_ATTEMPTS = 16
+	};
+
+	struct SampledLevel {
+
+		GDScriptFunction *function;
+		int line;
+	};
+
 	int _debug_parse_err_line;
 	String _debug_parse_err_file;
 	String _debug_error;
 	int _debug_call_stack_pos;
 	int _debug_max_call_stack;
 	CallLevel *_call_stack;
+	// Odd while the main thread changes the call stack, see profiling_get_stack_sample().
+	volatile uint32_t _debug_call_stack_version;
+	SampledLevel *_sampled_call_stack;
+	bool _sampling_call_stack; // Call stack kept for the sampling profiler, even without a debugger.
+
+	void _allocate_call_stack(int p_max_call_stack);
 
 	void _add_global(const StringName &p_name, const Variant &p_value);
 
@@ -344,6 +380,8 @@ class GDScriptLanguage : public ScriptLanguage {
 
 	Mutex *lock;
 
+	friend class GDScriptParser; // Takes the lock to read the globals while preparsing.
+
 	friend class GDScript;
 
 	SelfList<GDScript>::List script_list;
@@ -353,33 +391,51 @@ class GDScriptLanguage : public ScriptLanguage {
 	bool profiling;
 	uint64_t script_frame_time;
 
+	friend class GDScriptFunctionState;
+	friend class GDScriptYieldQueue;
+
+	GDScriptFramePool frame_pool;
+	Map<GDScriptYieldQueue::Key, GDScriptYieldQueue *> yield_queues;
+
+	GDScriptPreparser preparser;
+
 public:
 	int calls;
 
 	bool debug_break(const String &p_error, bool p_allow_continue = true);
 	bool debug_break_parse(const String &p_file, int p_line, const String &p_error);
 
+	_FORCE_INLINE_ bool is_tracking_call_stack() const { return _sampling_call_stack || ScriptDebugger::get_singleton(); }
+
 	_FORCE_INLINE_ void enter_function(GDScriptInstance *p_instance, GDScriptFunction *p_function, Variant *p_stack, int *p_ip, int *p_line) {
 
 		if (Thread::get_main_id() != Thread::get_caller_id())
 			return; //no support for other threads than main for now
 
-		if (ScriptDebugger::get_singleton()->get_lines_left() > 0 && ScriptDebugger::get_singleton()->get_depth() >= 0)
-			ScriptDebugger::get_singleton()->set_depth(ScriptDebugger::get_singleton()->get_depth() + 1);
+		ScriptDebugger *debugger = ScriptDebugger::get_singleton();
+		if (debugger && debugger->get_lines_left() > 0 && debugger->get_depth() >= 0)
+			debugger->set_depth(debugger->get_depth() + 1);
 
 		if (_debug_call_stack_pos >= _debug_max_call_stack) {
 			//stack overflow
 			_debug_error = "Stack Overflow (Stack Size: " + itos(_debug_max_call_stack) + ")";
-			ScriptDebugger::get_singleton()->debug(this);
+			if (debugger)
+				debugger->debug(this);
 			return;
 		}
 
+		_debug_call_stack_version++;
+		atomic_release_fence();
+
 		_call_stack[_debug_call_stack_pos].stack = p_stack;
 		_call_stack[_debug_call_stack_pos].instance = p_instance;
 		_call_stack[_debug_call_stack_pos].function = p_function;
 		_call_stack[_debug_call_stack_pos].ip = p_ip;
 		_call_stack[_debug_call_stack_pos].line = p_line;
 		_debug_call_stack_pos++;
+
+		atomic_release_fence();
+		_debug_call_stack_version++;
 	}
 
 	_FORCE_INLINE_ void exit_function() {
@@ -387,17 +443,23 @@ public:
 		if (Thread::get_main_id() != Thread::get_caller_id())
 			return; //no support for other threads than main for now
 
-		if (ScriptDebugger::get_singleton()->get_lines_left() > 0 && ScriptDebugger::get_singleton()->get_depth() >= 0)
-			ScriptDebugger::get_singleton()->set_depth(ScriptDebugger::get_singleton()->get_depth() - 1);
+		ScriptDebugger *debugger = ScriptDebugger::get_singleton();
+		if (debugger && debugger->get_lines_left() > 0 && debugger->get_depth() >= 0)
+			debugger->set_depth(debugger->get_depth() - 1);
 
 		if (_debug_call_stack_pos == 0) {
 
 			_debug_error = "Stack Underflow (Engine Bug)";
-			ScriptDebugger::get_singleton()->debug(this);
+			if (debugger)
+				debugger->debug(this);
 			return;
 		}
 
+		_debug_call_stack_version++;
+		atomic_release_fence();
 		_debug_call_stack_pos--;
+		atomic_release_fence();
+		_debug_call_stack_version++;
 	}
 
 	virtual Vector<StackInfo> debug_get_current_stack_info() {
@@ -431,6 +493,7 @@ public:
 	_FORCE_INLINE_ Variant *get_global_array() { return _global_array; }
 	_FORCE_INLINE_ const Map<StringName, int> &get_global_map() const { return globals; }
 	_FORCE_INLINE_ const Map<StringName, Variant> &get_named_globals_map() const { return named_globals; }
+	_FORCE_INLINE_ GDScriptPreparser &get_preparser() { return preparser; }
 
 	_FORCE_INLINE_ static GDScriptLanguage *get_singleton() { return singleton; }
 
@@ -494,6 +557,8 @@ public:
 
 	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max);
 	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max);
+	virtual int profiling_get_stack_sample(StackInfo *p_info_arr, int p_info_max);
+	virtual void profiling_set_sampling(bool p_enable);
 
 	/* LOADER FUNCTIONS */
 
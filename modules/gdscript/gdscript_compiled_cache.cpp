@@ -0,0 +1,1090 @@
+/*************************************************************************/
+/*  gdscript_compiled_cache.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_compiled_cache.h"
+
+#include "core/io/marshalls.h"
+#include "core/io/resource_loader.h"
+#include "core/version.h"
+#include "gdscript_compiler.h"
+#include "gdscript_functions.h"
+#include "gdscript_optimizer.h"
+#include "gdscript_typed_ops.h"
+
+static const uint8_t container_magic[4] = { 'G', 'D', 'C', 'B' };
+
+enum {
+	VARIANT_PLAIN,
+	VARIANT_OBJECT,
+	VARIANT_ARRAY,
+	VARIANT_DICTIONARY,
+};
+
+enum {
+	OBJECT_NULL,
+	OBJECT_NATIVE_CLASS, // Name of the class in GDScriptLanguage's globals.
+	OBJECT_OWN_CLASS, // Path of inner class names from the script being saved.
+	OBJECT_RESOURCE, // Resource path, followed by a path of inner class names for scripts.
+};
+
+// Size of the instruction at p_ip, and offsets of its operands holding addresses
+// (as opposed to jump targets, name indices, types...). Returns -1 for unknown opcodes.
+static int _get_instruction_addresses(const int *p_code, int p_ip, int p_code_size, Vector<int> &r_offsets) {
+
+	r_offsets.clear();
+
+	Vector<char> layout;
+	int size = GDScriptOptimizer::get_instruction_layout(p_code, p_ip, p_code_size, layout);
+	for (int i = 0; i < size; i++) {
+		if (layout[i] != GDScriptOptimizer::OPERAND_OTHER && layout[i] != GDScriptOptimizer::OPERAND_JUMP) {
+			r_offsets.push_back(i);
+		}
+	}
+	return size;
+}
+
+/* WRITER */
+
+class GDScriptCompiledWriter {
+
+	const GDScript *root;
+	Map<int, StringName> global_names; // Reverse of GDScriptLanguage::get_global_map().
+
+	void _fail(const String &p_reason) {
+		if (error == OK) {
+			print_verbose("GDScript: Can't save compiled script '" + root->get_path() + "': " + p_reason);
+			error = ERR_UNAVAILABLE;
+		}
+	}
+
+public:
+	Vector<uint8_t> data;
+	Error error;
+
+	void put_u32(uint32_t p_value) {
+		int ofs = data.size();
+		data.resize(ofs + 4);
+		encode_uint32(p_value, data.ptrw() + ofs);
+	}
+
+	void put_string(const String &p_string) {
+		CharString utf8 = p_string.utf8();
+		put_u32(utf8.length());
+		int ofs = data.size();
+		data.resize(ofs + utf8.length());
+		copymem(data.ptrw() + ofs, utf8.get_data(), utf8.length());
+	}
+
+	void put_object(const Object *p_object) {
+
+		if (!p_object) {
+			put_u32(OBJECT_NULL);
+			return;
+		}
+
+		const GDScriptNativeClass *native = Object::cast_to<GDScriptNativeClass>(p_object);
+		if (native) {
+			put_u32(OBJECT_NATIVE_CLASS);
+			put_string(native->get_name());
+			return;
+		}
+
+		const Resource *resource = Object::cast_to<Resource>(p_object);
+		if (!resource) {
+			_fail("Constant of class '" + p_object->get_class() + "' is not a resource.");
+			return;
+		}
+
+		// Inner classes are stored as the path to them from the script owning them.
+		Vector<StringName> names;
+		const GDScript *script = Object::cast_to<GDScript>(resource);
+		if (script) {
+			while (script->_owner) {
+				names.push_back(script->name);
+				script = script->_owner;
+			}
+			names.invert();
+			resource = script;
+		}
+
+		if (resource == root) {
+			put_u32(OBJECT_OWN_CLASS);
+		} else {
+			String path = resource->get_path();
+			if (!path.is_resource_file()) {
+				_fail("Constant holds a built-in resource of type '" + resource->get_class() + "'.");
+				return;
+			}
+			put_u32(OBJECT_RESOURCE);
+			put_string(path);
+		}
+
+		put_u32(names.size());
+		for (int i = 0; i < names.size(); i++) {
+			put_string(names[i]);
+		}
+	}
+
+	void put_variant(const Variant &p_value) {
+
+		switch (p_value.get_type()) {
+			case Variant::OBJECT: {
+				put_u32(VARIANT_OBJECT);
+				put_object(p_value.operator Object *());
+			} break;
+			case Variant::ARRAY: {
+				Array array = p_value;
+				put_u32(VARIANT_ARRAY);
+				put_u32(array.size());
+				for (int i = 0; i < array.size(); i++) {
+					put_variant(array[i]);
+				}
+			} break;
+			case Variant::DICTIONARY: {
+				Dictionary dict = p_value;
+				List<Variant> keys;
+				dict.get_key_list(&keys);
+				put_u32(VARIANT_DICTIONARY);
+				put_u32(keys.size());
+				for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
+					put_variant(E->get());
+					put_variant(dict[E->get()]);
+				}
+			} break;
+			default: {
+				int len;
+				Error err = encode_variant(p_value, NULL, len);
+				if (err != OK) {
+					_fail("Can't encode constant of type '" + Variant::get_type_name(p_value.get_type()) + "'.");
+					return;
+				}
+				put_u32(VARIANT_PLAIN);
+				put_u32(len);
+				int ofs = data.size();
+				data.resize(ofs + len);
+				encode_variant(p_value, data.ptrw() + ofs, len);
+			}
+		}
+	}
+
+	void put_datatype(const GDScriptDataType &p_type) {
+
+		put_u32(p_type.has_type);
+		if (!p_type.has_type) {
+			return;
+		}
+		put_u32(p_type.kind);
+		put_u32(p_type.builtin_type);
+		put_string(p_type.native_type);
+		put_object(p_type.script_type.ptr());
+	}
+
+	void put_property(const PropertyInfo &p_property) {
+
+		put_u32(p_property.type);
+		put_string(p_property.name);
+		put_string(p_property.class_name);
+		put_u32(p_property.hint);
+		put_string(p_property.hint_string);
+		put_u32(p_property.usage);
+	}
+
+	void put_function(const GDScriptFunction *p_function) {
+
+		put_string(p_function->name);
+		put_u32(p_function->_static);
+		put_u32(p_function->rpc_mode);
+		put_u32(p_function->_argument_count);
+		put_u32(p_function->_stack_size);
+		put_u32(p_function->_call_size);
+		put_u32(p_function->_initial_line);
+
+		put_u32(p_function->argument_types.size());
+		for (int i = 0; i < p_function->argument_types.size(); i++) {
+			put_datatype(p_function->argument_types[i]);
+		}
+		put_datatype(p_function->return_type);
+
+#ifdef TOOLS_ENABLED
+		put_u32(p_function->arg_names.size());
+		for (int i = 0; i < p_function->arg_names.size(); i++) {
+			put_string(p_function->arg_names[i]);
+		}
+#else
+		put_u32(0);
+#endif
+
+		put_u32(p_function->constants.size());
+		for (int i = 0; i < p_function->constants.size(); i++) {
+			put_variant(p_function->constants[i]);
+		}
+
+		put_u32(p_function->global_names.size());
+		for (int i = 0; i < p_function->global_names.size(); i++) {
+			put_string(p_function->global_names[i]);
+		}
+
+		put_u32(p_function->default_arguments.size());
+		for (int i = 0; i < p_function->default_arguments.size(); i++) {
+			put_u32(p_function->default_arguments[i]);
+		}
+
+		// Global (and, in the editor, named global) addresses are replaced by an index in a table of names.
+		Vector<int> code = p_function->code;
+		Vector<StringName> globals;
+		Vector<int> offsets;
+
+		for (int ip = 0; ip < code.size();) {
+			int size = _get_instruction_addresses(code.ptr(), ip, code.size(), offsets);
+			if (size <= 0) {
+				_fail("Invalid bytecode in function '" + String(p_function->name) + "'.");
+				return;
+			}
+
+			for (int i = 0; i < offsets.size(); i++) {
+				int address = code[ip + offsets[i]];
+				int index = address & GDScriptFunction::ADDR_MASK;
+
+				StringName name;
+				switch ((address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) {
+					case GDScriptFunction::ADDR_TYPE_GLOBAL: {
+						if (!global_names.has(index)) {
+							_fail("Unknown global in function '" + String(p_function->name) + "'.");
+							return;
+						}
+						name = global_names[index];
+					} break;
+#ifdef TOOLS_ENABLED
+					case GDScriptFunction::ADDR_TYPE_NAMED_GLOBAL: {
+						name = p_function->named_globals[index];
+					} break;
+#endif
+					default: {
+						continue;
+					}
+				}
+
+				int global = globals.find(name);
+				if (global == -1) {
+					global = globals.size();
+					globals.push_back(name);
+				}
+				code.write[ip + offsets[i]] = global | (GDScriptFunction::ADDR_TYPE_GLOBAL << GDScriptFunction::ADDR_BITS);
+			}
+			ip += size;
+		}
+
+		put_u32(globals.size());
+		for (int i = 0; i < globals.size(); i++) {
+			put_string(globals[i]);
+		}
+
+		put_u32(code.size());
+		for (int i = 0; i < code.size(); i++) {
+			put_u32(code[i]);
+		}
+	}
+
+	// Written before any class, so references to inner classes can be resolved while reading.
+	void put_class_tree(const GDScript *p_script) {
+
+		put_u32(p_script->subclasses.size());
+		for (const Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+			put_string(E->key());
+			put_class_tree(E->get().ptr());
+		}
+	}
+
+	void put_class(const GDScript *p_script) {
+
+		put_u32(p_script->tool);
+		put_string(p_script->name);
+		put_object(p_script->native.ptr());
+		put_object(p_script->base.ptr());
+
+		put_u32(p_script->member_indices.size());
+		for (const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.front(); E; E = E->next()) {
+			put_string(E->key());
+			put_u32(E->get().index);
+			put_string(E->get().setter);
+			put_string(E->get().getter);
+			put_u32(E->get().rpc_mode);
+			put_datatype(E->get().data_type);
+		}
+
+		put_u32(p_script->members.size());
+		for (const Set<StringName>::Element *E = p_script->members.front(); E; E = E->next()) {
+			put_string(E->get());
+		}
+
+		put_u32(p_script->member_info.size());
+		for (const Map<StringName, PropertyInfo>::Element *E = p_script->member_info.front(); E; E = E->next()) {
+			put_string(E->key());
+			put_property(E->get());
+		}
+
+		// Inner classes are also constants, but are created from the class tree.
+		int constant_count = 0;
+		for (const Map<StringName, Variant>::Element *E = p_script->constants.front(); E; E = E->next()) {
+			if (!p_script->subclasses.has(E->key())) {
+				constant_count++;
+			}
+		}
+		put_u32(constant_count);
+		for (const Map<StringName, Variant>::Element *E = p_script->constants.front(); E; E = E->next()) {
+			if (!p_script->subclasses.has(E->key())) {
+				put_string(E->key());
+				put_variant(E->get());
+			}
+		}
+
+		put_u32(p_script->_signals.size());
+		for (const Map<StringName, Vector<StringName> >::Element *E = p_script->_signals.front(); E; E = E->next()) {
+			put_string(E->key());
+			put_u32(E->get().size());
+			for (int i = 0; i < E->get().size(); i++) {
+				put_string(E->get()[i]);
+			}
+		}
+
+		put_u32(p_script->member_functions.size());
+		for (const Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+			put_function(E->get());
+		}
+
+		for (const Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+			put_class(E->get().ptr());
+		}
+	}
+
+	GDScriptCompiledWriter(const GDScript *p_root) {
+
+		root = p_root;
+		error = OK;
+
+		const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+		for (const Map<StringName, int>::Element *E = global_map.front(); E; E = E->next()) {
+			global_names[E->get()] = E->key();
+		}
+	}
+};
+
+/* READER */
+
+class GDScriptCompiledReader {
+
+	const uint8_t *data;
+	int size;
+	int pos;
+	GDScript *root;
+
+	void _fail(const String &p_reason) {
+		if (error == OK) {
+			print_verbose("GDScript: Can't load compiled script '" + root->get_path() + "': " + p_reason);
+			error = ERR_FILE_CORRUPT;
+		}
+	}
+
+	bool _has(int p_bytes) {
+		if (error != OK) {
+			return false;
+		}
+		if (p_bytes < 0 || p_bytes > size - pos) {
+			_fail("Unexpected end of data.");
+			return false;
+		}
+		return true;
+	}
+
+	static bool _check_address(const GDScriptFunction *p_function, int p_address, int p_member_count, int p_global_count) {
+
+		int index = p_address & GDScriptFunction::ADDR_MASK;
+
+		switch ((p_address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) {
+			case GDScriptFunction::ADDR_TYPE_SELF:
+			case GDScriptFunction::ADDR_TYPE_CLASS:
+			case GDScriptFunction::ADDR_TYPE_NIL: {
+				return true;
+			}
+			case GDScriptFunction::ADDR_TYPE_MEMBER: {
+				return index < p_member_count;
+			}
+			case GDScriptFunction::ADDR_TYPE_CLASS_CONSTANT: {
+				return index < p_function->_global_names_count;
+			}
+			case GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT: {
+				return index < p_function->_constant_count;
+			}
+			case GDScriptFunction::ADDR_TYPE_STACK:
+			case GDScriptFunction::ADDR_TYPE_STACK_VARIABLE: {
+				return index < p_function->_stack_size;
+			}
+			case GDScriptFunction::ADDR_TYPE_GLOBAL: {
+				return index < p_global_count;
+			}
+			default: {
+				// Named globals are stored as globals, so anything else is corrupt.
+				return false;
+			}
+		}
+	}
+
+	// The VM only checks operands in debug builds, so everything it would index
+	// with is checked here: addresses, jump targets, name indices, types, operators
+	// and argument counts. Global addresses are resolved through p_globals as well.
+	bool _check_function(GDScriptFunction *p_function, int p_member_count, const Vector<int> &p_globals) {
+
+		Vector<int> &code = p_function->code;
+		int code_size = code.size();
+
+		if (p_function->_stack_size < 0 || p_function->_stack_size > GDScriptFunction::ADDR_MASK + 1) {
+			return false;
+		}
+		if (p_function->_call_size < 0 || p_function->_call_size > GDScriptFunction::ADDR_MASK + 1) {
+			return false;
+		}
+		if (p_function->_argument_count < 0 || p_function->_argument_count > p_function->_stack_size) {
+			return false;
+		}
+		if (p_function->argument_types.size() != p_function->_argument_count || p_function->default_arguments.size() > p_function->_argument_count + 1) {
+			return false;
+		}
+
+		Vector<bool> instruction_at;
+		instruction_at.resize(code_size + 1);
+		for (int i = 0; i < code_size; i++) {
+			instruction_at.write[i] = false;
+		}
+		instruction_at.write[code_size] = true;
+
+		for (int ip = 0; ip < code_size;) {
+			Vector<char> layout;
+			int size = GDScriptOptimizer::get_instruction_layout(code.ptr(), ip, code_size, layout);
+			if (size <= 0) {
+				return false;
+			}
+			instruction_at.write[ip] = true;
+			ip += size;
+		}
+
+		for (int i = 0; i < p_function->default_arguments.size(); i++) {
+			int address = p_function->default_arguments[i];
+			if (address < 0 || address > code_size || !instruction_at[address]) {
+				return false;
+			}
+		}
+
+		Vector<char> layout;
+		for (int ip = 0; ip < code_size;) {
+			int size = GDScriptOptimizer::get_instruction_layout(code.ptr(), ip, code_size, layout);
+			const int *operands = code.ptr() + ip;
+
+			for (int i = 0; i < size; i++) {
+				int operand = operands[i];
+				if (layout[i] == GDScriptOptimizer::OPERAND_OTHER) {
+					continue;
+				}
+				if (layout[i] == GDScriptOptimizer::OPERAND_JUMP) {
+					if (operand < 0 || operand > code_size || !instruction_at[operand]) {
+						return false;
+					}
+					continue;
+				}
+
+				bool global = (operand & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS == GDScriptFunction::ADDR_TYPE_GLOBAL;
+				// Unused addresses are never read by the VM, but globals among them are resolved all the same.
+				if ((global || layout[i] != GDScriptOptimizer::OPERAND_UNUSED) && !_check_address(p_function, operand, p_member_count, p_globals.size())) {
+					return false;
+				}
+				if (global) {
+					code.write[ip + i] = p_globals[operand & GDScriptFunction::ADDR_MASK];
+				}
+			}
+
+			// Operands that aren't addresses.
+			int names = p_function->_global_names_count;
+			bool valid = true;
+			switch (operands[0]) {
+				case GDScriptFunction::OPCODE_OPERATOR: {
+					valid = operands[1] >= 0 && operands[1] < Variant::OP_MAX;
+				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_TYPED: {
+					valid = operands[1] >= 0 && operands[1] < Variant::OP_MAX && operands[2] >= 0 && operands[2] < GDScriptTypedOps::get_operator_count();
+				} break;
+				case GDScriptFunction::OPCODE_IS_BUILTIN: {
+					valid = operands[2] >= 0 && operands[2] < Variant::VARIANT_MAX;
+				} break;
+				case GDScriptFunction::OPCODE_SET_NAMED:
+				case GDScriptFunction::OPCODE_GET_NAMED: {
+					valid = operands[2] >= 0 && operands[2] < names;
+				} break;
+				case GDScriptFunction::OPCODE_GET_NAMED_TYPED: {
+					valid = operands[1] >= 0 && operands[1] < GDScriptTypedOps::get_member_count() && operands[3] >= 0 && operands[3] < names;
+				} break;
+				case GDScriptFunction::OPCODE_SET_MEMBER:
+				case GDScriptFunction::OPCODE_GET_MEMBER: {
+					valid = operands[1] >= 0 && operands[1] < names;
+				} break;
+				case GDScriptFunction::OPCODE_ASSIGN_TYPED_BUILTIN:
+				case GDScriptFunction::OPCODE_CAST_TO_BUILTIN: {
+					valid = operands[1] >= 0 && operands[1] < Variant::VARIANT_MAX;
+				} break;
+				case GDScriptFunction::OPCODE_CONSTRUCT: {
+					valid = operands[1] >= 0 && operands[1] < Variant::VARIANT_MAX && operands[2] <= p_function->_call_size;
+				} break;
+				case GDScriptFunction::OPCODE_CALL:
+				case GDScriptFunction::OPCODE_CALL_RETURN: {
+					valid = operands[1] <= p_function->_call_size && operands[3] >= 0 && operands[3] < names;
+				} break;
+				case GDScriptFunction::OPCODE_CALL_BUILT_IN: {
+					valid = operands[1] >= 0 && operands[1] < GDScriptFunctions::FUNC_MAX && operands[2] <= p_function->_call_size;
+				} break;
+				case GDScriptFunction::OPCODE_CALL_SELF_BASE: {
+					valid = operands[1] >= 0 && operands[1] < names && operands[2] <= p_function->_call_size;
+				} break;
+				case GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT: {
+					valid = p_function->default_arguments.size() > 0;
+				} break;
+			}
+			if (!valid) {
+				return false;
+			}
+
+			ip += size;
+		}
+
+		return true;
+	}
+
+public:
+	Error error;
+
+	uint32_t get_u32() {
+		if (!_has(4)) {
+			return 0;
+		}
+		uint32_t value = decode_uint32(data + pos);
+		pos += 4;
+		return value;
+	}
+
+	// Reads an element count, each element taking at least p_min_size bytes.
+	int get_count(int p_min_size = 4) {
+		uint32_t count = get_u32();
+		if (error != OK || count > uint32_t(size - pos) / p_min_size) {
+			_fail("Invalid element count.");
+			return 0;
+		}
+		return count;
+	}
+
+	String get_string() {
+		int len = get_u32();
+		if (!_has(len)) {
+			return String();
+		}
+		String string;
+		string.parse_utf8((const char *)data + pos, len);
+		pos += len;
+		return string;
+	}
+
+	Variant get_object() {
+
+		uint32_t kind = get_u32();
+		switch (kind) {
+			case OBJECT_NULL: {
+				return Variant();
+			}
+			case OBJECT_NATIVE_CLASS: {
+				StringName name = get_string();
+				const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+				if (!global_map.has(name)) {
+					_fail("Unknown native class '" + String(name) + "'.");
+					return Variant();
+				}
+				return GDScriptLanguage::get_singleton()->get_global_array()[global_map[name]];
+			}
+			case OBJECT_OWN_CLASS:
+			case OBJECT_RESOURCE: {
+				RES resource;
+				if (kind == OBJECT_OWN_CLASS) {
+					resource = Ref<GDScript>(root);
+				} else {
+					String path = get_string();
+					if (error != OK) {
+						return Variant();
+					}
+					resource = ResourceLoader::load(path);
+					if (resource.is_null()) {
+						_fail("Can't load resource '" + path + "'.");
+						return Variant();
+					}
+				}
+
+				int name_count = get_count();
+				for (int i = 0; i < name_count; i++) {
+					StringName name = get_string();
+					Ref<GDScript> script = resource;
+					if (script.is_null() || !script->subclasses.has(name)) {
+						_fail("Can't find inner class '" + String(name) + "'.");
+						return Variant();
+					}
+					resource = script->subclasses[name];
+				}
+				return resource;
+			}
+		}
+
+		_fail("Invalid object.");
+		return Variant();
+	}
+
+	Variant get_variant() {
+
+		switch (get_u32()) {
+			case VARIANT_PLAIN: {
+				int len = get_u32();
+				if (!_has(len)) {
+					return Variant();
+				}
+				Variant value;
+				Error err = decode_variant(value, data + pos, len);
+				if (err != OK) {
+					_fail("Can't decode constant.");
+					return Variant();
+				}
+				pos += len;
+				return value;
+			}
+			case VARIANT_OBJECT: {
+				return get_object();
+			}
+			case VARIANT_ARRAY: {
+				Array array;
+				array.resize(get_count());
+				for (int i = 0; i < array.size(); i++) {
+					array[i] = get_variant();
+				}
+				return array;
+			}
+			case VARIANT_DICTIONARY: {
+				Dictionary dict;
+				int count = get_count(8);
+				for (int i = 0; i < count; i++) {
+					Variant key = get_variant();
+					dict[key] = get_variant();
+				}
+				return dict;
+			}
+		}
+
+		_fail("Invalid constant.");
+		return Variant();
+	}
+
+	GDScriptDataType get_datatype() {
+
+		GDScriptDataType type;
+		type.has_type = get_u32();
+		if (!type.has_type) {
+			return type;
+		}
+		uint32_t kind = get_u32();
+		uint32_t builtin_type = get_u32();
+		if (kind > GDScriptDataType::GDSCRIPT || builtin_type >= Variant::VARIANT_MAX) {
+			_fail("Invalid type.");
+			return GDScriptDataType();
+		}
+		type.kind = static_cast<decltype(type.kind)>(kind);
+		type.builtin_type = Variant::Type(builtin_type);
+		type.native_type = get_string();
+		type.script_type = get_object();
+		return type;
+	}
+
+	PropertyInfo get_property() {
+
+		PropertyInfo property;
+		property.type = Variant::Type(get_u32());
+		property.name = get_string();
+		property.class_name = get_string();
+		property.hint = PropertyHint(get_u32());
+		property.hint_string = get_string();
+		property.usage = get_u32();
+		return property;
+	}
+
+	void get_function(GDScript *p_script) {
+
+		StringName name = get_string();
+		if (error != OK) {
+			return;
+		}
+
+		// Owned by the script from now on, so it's freed even if reading fails.
+		GDScriptFunction *function = memnew(GDScriptFunction);
+		if (p_script->member_functions.has(name)) {
+			memdelete(p_script->member_functions[name]);
+		}
+		p_script->member_functions[name] = function;
+
+		function->name = name;
+		function->_script = p_script;
+		function->source = p_script->get_path();
+		function->_static = get_u32();
+		function->rpc_mode = MultiplayerAPI::RPCMode(get_u32());
+		function->_argument_count = get_u32();
+		function->_stack_size = get_u32();
+		function->_call_size = get_u32();
+		function->_initial_line = get_u32();
+
+		function->argument_types.resize(get_count());
+		for (int i = 0; i < function->argument_types.size(); i++) {
+			function->argument_types.write[i] = get_datatype();
+		}
+		function->return_type = get_datatype();
+
+		int arg_name_count = get_count();
+		for (int i = 0; i < arg_name_count; i++) {
+			StringName arg_name = get_string();
+#ifdef TOOLS_ENABLED
+			function->arg_names.push_back(arg_name);
+#endif
+		}
+
+		function->constants.resize(get_count());
+		for (int i = 0; i < function->constants.size(); i++) {
+			function->constants.write[i] = get_variant();
+		}
+		function->_constant_count = function->constants.size();
+		function->_constants_ptr = function->_constant_count ? function->constants.ptrw() : NULL;
+
+		function->global_names.resize(get_count());
+		for (int i = 0; i < function->global_names.size(); i++) {
+			function->global_names.write[i] = get_string();
+		}
+		function->_global_names_count = function->global_names.size();
+		function->_global_names_ptr = function->_global_names_count ? function->global_names.ptr() : NULL;
+
+		function->method_call_caches.resize(function->_global_names_count);
+		function->_method_call_caches_ptr = function->_global_names_count ? function->method_call_caches.ptrw() : NULL;
+		for (int i = 0; i < function->_global_names_count; i++) {
+			function->_method_call_caches_ptr[i].set_method(function->global_names[i]);
+		}
+
+		function->default_arguments.resize(get_count());
+		for (int i = 0; i < function->default_arguments.size(); i++) {
+			function->default_arguments.write[i] = get_u32();
+		}
+		function->_default_arg_count = MAX(function->default_arguments.size() - 1, 0);
+		function->_default_arg_ptr = function->default_arguments.size() ? function->default_arguments.ptr() : NULL;
+
+		// Resolve globals by name, like the compiler would.
+		const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+		Vector<int> globals;
+		globals.resize(get_count());
+		for (int i = 0; i < globals.size(); i++) {
+			StringName global = get_string();
+			if (global_map.has(global)) {
+				globals.write[i] = global_map[global] | (GDScriptFunction::ADDR_TYPE_GLOBAL << GDScriptFunction::ADDR_BITS);
+				continue;
+			}
+#ifdef TOOLS_ENABLED
+			if (GDScriptLanguage::get_singleton()->get_named_globals_map().has(global)) {
+				globals.write[i] = function->named_globals.size() | (GDScriptFunction::ADDR_TYPE_NAMED_GLOBAL << GDScriptFunction::ADDR_BITS);
+				function->named_globals.push_back(global);
+				continue;
+			}
+#endif
+			_fail("Identifier not found: " + String(global));
+			return;
+		}
+#ifdef TOOLS_ENABLED
+		function->_named_globals_count = function->named_globals.size();
+		function->_named_globals_ptr = function->_named_globals_count ? function->named_globals.ptr() : NULL;
+#endif
+
+		function->code.resize(get_count());
+		for (int i = 0; i < function->code.size(); i++) {
+			function->code.write[i] = get_u32();
+		}
+		if (error != OK) {
+			return;
+		}
+
+		if (!_check_function(function, p_script->member_indices.size(), globals)) {
+			_fail("Invalid bytecode in function '" + String(name) + "'.");
+			return;
+		}
+
+		function->_code_size = function->code.size();
+		function->_code_ptr = function->_code_size ? function->code.ptr() : NULL;
+
+#ifdef DEBUG_ENABLED
+		function->func_cname = (String(function->source) + " - " + String(name)).utf8();
+		function->_func_cname = function->func_cname.get_data();
+
+		if (ScriptDebugger::get_singleton()) {
+			String signature = p_script->get_path() + "::" + itos(function->_initial_line);
+			if (p_script->name != StringName()) {
+				signature += "::" + String(p_script->name) + "." + String(name);
+			} else {
+				signature += "::" + String(name);
+			}
+			function->profile.signature = signature;
+		}
+#endif
+	}
+
+	void get_class_tree(GDScript *p_script) {
+
+		p_script->subclasses.clear();
+
+		int subclass_count = get_count();
+		for (int i = 0; i < subclass_count; i++) {
+			StringName name = get_string();
+			if (error != OK) {
+				return;
+			}
+
+			Ref<GDScript> subclass;
+			subclass.instance();
+			subclass->_owner = p_script;
+			p_script->subclasses.insert(name, subclass);
+			get_class_tree(subclass.ptr());
+		}
+	}
+
+	void get_class(GDScript *p_script) {
+
+		p_script->members.clear();
+		p_script->constants.clear();
+		for (Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+			memdelete(E->get());
+		}
+		p_script->member_functions.clear();
+		p_script->member_indices.clear();
+		p_script->member_info.clear();
+		p_script->_signals.clear();
+		p_script->initializer = NULL;
+
+		p_script->tool = get_u32();
+		p_script->name = get_string();
+		p_script->native = get_object();
+		p_script->base = get_object();
+		p_script->_base = p_script->base.ptr();
+
+		int member_count = get_count();
+		for (int i = 0; i < member_count; i++) {
+			StringName name = get_string();
+			GDScript::MemberInfo minfo;
+			minfo.index = get_u32();
+			minfo.setter = get_string();
+			minfo.getter = get_string();
+			minfo.rpc_mode = MultiplayerAPI::RPCMode(get_u32());
+			minfo.data_type = get_datatype();
+			if (minfo.index < 0 || minfo.index >= member_count) {
+				_fail("Invalid member index.");
+				return;
+			}
+			p_script->member_indices[name] = minfo;
+		}
+
+		int own_member_count = get_count();
+		for (int i = 0; i < own_member_count; i++) {
+			p_script->members.insert(get_string());
+		}
+
+		int member_info_count = get_count();
+		for (int i = 0; i < member_info_count; i++) {
+			StringName name = get_string();
+			p_script->member_info[name] = get_property();
+		}
+
+		int constant_count = get_count();
+		for (int i = 0; i < constant_count; i++) {
+			StringName name = get_string();
+			p_script->constants[name] = get_variant();
+		}
+		for (Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+			p_script->constants[E->key()] = E->get();
+		}
+
+		int signal_count = get_count();
+		for (int i = 0; i < signal_count; i++) {
+			StringName name = get_string();
+			Vector<StringName> &arguments = p_script->_signals[name];
+			arguments.resize(get_count());
+			for (int j = 0; j < arguments.size(); j++) {
+				arguments.write[j] = get_string();
+			}
+		}
+
+		int function_count = get_count();
+		for (int i = 0; i < function_count && error == OK; i++) {
+			get_function(p_script);
+		}
+
+		if (error != OK) {
+			return;
+		}
+
+		if (p_script->member_functions.has("_init")) {
+			p_script->initializer = p_script->member_functions["_init"];
+		}
+
+		for (Map<StringName, Ref<GDScript> >::Element *E = p_script->subclasses.front(); E && error == OK; E = E->next()) {
+			get_class(E->get().ptr());
+		}
+
+		p_script->valid = error == OK;
+	}
+
+	GDScriptCompiledReader(GDScript *p_root, const Vector<uint8_t> &p_data) {
+
+		root = p_root;
+		data = p_data.ptr();
+		size = p_data.size();
+		pos = 0;
+		error = OK;
+	}
+};
+
+/* HEADER */
+
+// Compiled scripts only work with the same opcodes, builtin functions and typed operators they were compiled for.
+static void _get_header(uint32_t *r_header) {
+
+	r_header[0] = GDScriptCompiledCache::FORMAT_VERSION;
+	r_header[1] = VERSION_HEX;
+	r_header[2] = GDScriptFunction::OPCODE_END;
+	r_header[3] = GDScriptFunctions::FUNC_MAX;
+	r_header[4] = GDScriptTypedOps::get_operator_count();
+	r_header[5] = GDScriptTypedOps::get_member_count();
+}
+
+#define HEADER_SIZE 6
+
+Error GDScriptCompiledCache::compile(const String &p_path, const String &p_source, bool p_debug, Vector<uint8_t> &r_compiled) {
+
+	Ref<GDScript> script;
+	script.instance();
+	script->set_script_path(p_path);
+
+	GDScriptParser parser;
+	Error err = parser.parse(p_source, p_path.get_base_dir(), false, p_path);
+	if (err != OK) {
+		return err;
+	}
+
+	GDScriptCompiler compiler;
+	compiler.set_strip_debug_code(!p_debug);
+	err = compiler.compile(&parser, script.ptr());
+	if (err != OK) {
+		return err;
+	}
+
+	return save(script.ptr(), r_compiled);
+}
+
+Error GDScriptCompiledCache::save(const GDScript *p_script, Vector<uint8_t> &r_compiled) {
+
+	GDScriptCompiledWriter writer(p_script);
+
+	uint32_t header[HEADER_SIZE];
+	_get_header(header);
+	for (int i = 0; i < HEADER_SIZE; i++) {
+		writer.put_u32(header[i]);
+	}
+
+	writer.put_class_tree(p_script);
+	writer.put_class(p_script);
+
+	if (writer.error != OK) {
+		return writer.error;
+	}
+
+	r_compiled = writer.data;
+	return OK;
+}
+
+Error GDScriptCompiledCache::load(GDScript *p_script, const Vector<uint8_t> &p_compiled) {
+
+	GDScriptCompiledReader reader(p_script, p_compiled);
+
+	uint32_t header[HEADER_SIZE];
+	_get_header(header);
+	for (int i = 0; i < HEADER_SIZE; i++) {
+		if (reader.get_u32() != header[i]) {
+			print_verbose("GDScript: Compiled script '" + p_script->get_path() + "' was made for another version, compiling it again.");
+			return ERR_FILE_UNRECOGNIZED;
+		}
+	}
+
+	reader.get_class_tree(p_script);
+	reader.get_class(p_script);
+
+	return reader.error;
+}
+
+Vector<uint8_t> GDScriptCompiledCache::pack(const Vector<uint8_t> &p_compiled, const Vector<uint8_t> &p_tokens) {
+
+	Vector<uint8_t> buffer;
+	buffer.resize(8 + p_compiled.size() + p_tokens.size());
+
+	uint8_t *w = buffer.ptrw();
+	copymem(w, container_magic, 4);
+	encode_uint32(p_compiled.size(), w + 4);
+	copymem(w + 8, p_compiled.ptr(), p_compiled.size());
+	copymem(w + 8 + p_compiled.size(), p_tokens.ptr(), p_tokens.size());
+
+	return buffer;
+}
+
+bool GDScriptCompiledCache::unpack(const Vector<uint8_t> &p_buffer, Vector<uint8_t> &r_compiled, Vector<uint8_t> &r_tokens) {
+
+	if (p_buffer.size() < 8 || memcmp(p_buffer.ptr(), container_magic, 4) != 0) {
+		return false;
+	}
+
+	const uint8_t *r = p_buffer.ptr();
+	uint32_t compiled_size = decode_uint32(r + 4);
+	ERR_FAIL_COND_V(compiled_size > uint32_t(p_buffer.size() - 8), false);
+
+	r_compiled.resize(compiled_size);
+	copymem(r_compiled.ptrw(), r + 8, compiled_size);
+
+	int tokens_size = p_buffer.size() - 8 - compiled_size;
+	r_tokens.resize(tokens_size);
+	copymem(r_tokens.ptrw(), r + 8 + compiled_size, tokens_size);
+
+	return true;
+}
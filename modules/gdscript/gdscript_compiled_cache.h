@@ -0,0 +1,65 @@
+/*************************************************************************/
+/*  gdscript_compiled_cache.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_COMPILED_CACHE_H
+#define GDSCRIPT_COMPILED_CACHE_H
+
+#include "gdscript.h"
+
+/**
+ * Serializes compiled GDScript classes (functions, constants, members,
+ * signals and type information) so exported projects can skip parsing and
+ * compiling scripts on load.
+ *
+ * References to other scripts and resources are stored by path and loaded
+ * again when reading, and global addresses in the bytecode are stored by
+ * name, since global indices depend on the classes registered by the running
+ * binary. Anything that can't be stored that way (e.g. constants holding
+ * built-in resources) makes save() fail, in which case the script is compiled
+ * from source as before.
+ */
+class GDScriptCompiledCache {
+public:
+	enum {
+		FORMAT_VERSION = 2
+	};
+
+	// Parses and compiles p_source into a new script, without using or touching the one in the resource cache.
+	static Error compile(const String &p_path, const String &p_source, bool p_debug, Vector<uint8_t> &r_compiled);
+
+	static Error save(const GDScript *p_script, Vector<uint8_t> &r_compiled);
+	static Error load(GDScript *p_script, const Vector<uint8_t> &p_compiled);
+
+	// Exported .gdc files hold the compiled script followed by its token stream, used if the former can't be loaded.
+	static Vector<uint8_t> pack(const Vector<uint8_t> &p_compiled, const Vector<uint8_t> &p_tokens);
+	static bool unpack(const Vector<uint8_t> &p_buffer, Vector<uint8_t> &r_compiled, Vector<uint8_t> &r_tokens);
+};
+
+#endif // GDSCRIPT_COMPILED_CACHE_H
@@ -31,6 +31,54 @@
 #include "gdscript_compiler.h"
 
 #include "gdscript.h"
+#include "gdscript_optimizer.h"
+#include "gdscript_typed_ops.h"
+
+// Builtin type the parser inferred for an expression, or NIL when unknown.
+static Variant::Type _get_builtin_type(const GDScriptParser::Node *p_node) {
+
+	GDScriptParser::DataType datatype = p_node->get_datatype();
+	if (!datatype.has_type || datatype.kind != GDScriptParser::DataType::BUILTIN) {
+		return Variant::NIL;
+	}
+	return datatype.builtin_type;
+}
+
+// Whether a for loop container is a range() with int arguments, see GDScriptParser::_parse_block().
+static bool _is_int_range(const GDScriptParser::Node *p_node) {
+
+	if (p_node->type != GDScriptParser::Node::TYPE_OPERATOR) {
+		return false;
+	}
+	const GDScriptParser::OperatorNode *on = static_cast<const GDScriptParser::OperatorNode *>(p_node);
+	if (on->op != GDScriptParser::OperatorNode::OP_CALL || on->arguments[0]->type != GDScriptParser::Node::TYPE_TYPE) {
+		return false;
+	}
+
+	int arg_count;
+	switch (static_cast<const GDScriptParser::TypeNode *>(on->arguments[0])->vtype) {
+		case Variant::INT: arg_count = 1; break;
+		case Variant::VECTOR2: arg_count = 2; break;
+		case Variant::VECTOR3: arg_count = 3; break;
+		default: return false;
+	}
+	if (on->arguments.size() != arg_count + 1) {
+		return false;
+	}
+
+	for (int i = 1; i < on->arguments.size(); i++) {
+		if (_get_builtin_type(on->arguments[i]) != Variant::INT) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Whether indexing p_base with p_index can use the *_POOL_ARRAY opcodes.
+static bool _is_pool_array_index(const GDScriptParser::Node *p_base, const GDScriptParser::Node *p_index) {
+
+	return GDScriptTypedOps::is_pool_array(_get_builtin_type(p_base)) && _get_builtin_type(p_index) == Variant::INT;
+}
 
 bool GDScriptCompiler::_is_class_member_property(CodeGen &codegen, const StringName &p_name) {
 
@@ -82,8 +130,17 @@ bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptPa
 	if (src_address_a < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
-	codegen.opcodes.push_back(op); //which operator
+	Variant::Type type_a = _get_builtin_type(on->arguments[0]);
+	int typed_op = type_a != Variant::NIL ? GDScriptTypedOps::find_operator(op, type_a, type_a) : -1;
+
+	if (typed_op >= 0) {
+		codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR_TYPED); // perform operator with known types
+		codegen.opcodes.push_back(op); //which operator
+		codegen.opcodes.push_back(typed_op); //which typed implementation
+	} else {
+		codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+		codegen.opcodes.push_back(op); //which operator
+	}
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_a); // argument 2 (repeated)
 	//codegen.opcodes.push_back(GDScriptFunction::ADDR_TYPE_NIL); // argument 2 (unary only takes one parameter)
@@ -104,8 +161,18 @@ bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptP
 	if (src_address_b < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
-	codegen.opcodes.push_back(op); //which operator
+	Variant::Type type_a = _get_builtin_type(on->arguments[0]);
+	Variant::Type type_b = _get_builtin_type(on->arguments[1]);
+	int typed_op = (type_a != Variant::NIL && type_b != Variant::NIL) ? GDScriptTypedOps::find_operator(op, type_a, type_b) : -1;
+
+	if (typed_op >= 0) {
+		codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR_TYPED); // perform operator with known types
+		codegen.opcodes.push_back(op); //which operator
+		codegen.opcodes.push_back(typed_op); //which typed implementation
+	} else {
+		codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+		codegen.opcodes.push_back(op); //which operator
+	}
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
 	return true;
@@ -747,7 +814,22 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						}
 					}
 
-					codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
+					int typed_member = -1;
+					if (named && on->op == GDScriptParser::OperatorNode::OP_INDEX_NAMED) {
+						Variant::Type base_type = _get_builtin_type(on->arguments[0]);
+						if (base_type != Variant::NIL) {
+							typed_member = GDScriptTypedOps::find_member(base_type, static_cast<GDScriptParser::IdentifierNode *>(on->arguments[1])->name);
+						}
+					}
+
+					if (typed_member >= 0) {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_NAMED_TYPED); // perform operator with known base type
+						codegen.opcodes.push_back(typed_member); // which typed getter
+					} else if (!named && _is_pool_array_index(on->arguments[0], on->arguments[1])) {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_POOL_ARRAY); // perform operator with known base type
+					} else {
+						codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
+					}
 					codegen.opcodes.push_back(from); // argument 1
 					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
 
@@ -1049,7 +1131,13 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							if (key_idx < 0) //error
 								return key_idx;
 
-							codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET);
+							bool pool_array = !named && _is_pool_array_index(E->get()->arguments[0], E->get()->arguments[1]);
+
+							if (pool_array) {
+								codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_POOL_ARRAY);
+							} else {
+								codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET);
+							}
 							codegen.opcodes.push_back(prev_pos);
 							codegen.opcodes.push_back(key_idx);
 							slevel++;
@@ -1063,7 +1151,11 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							setchain.push_back(dst_pos);
 							setchain.push_back(key_idx);
 							setchain.push_back(prev_pos);
-							setchain.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+							if (pool_array) {
+								setchain.push_back(GDScriptFunction::OPCODE_SET_POOL_ARRAY);
+							} else {
+								setchain.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+							}
 
 							prev_pos = dst_pos;
 						}
@@ -1095,7 +1187,11 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						if (set_value < 0) //error
 							return set_value;
 
-						codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+						if (!named && _is_pool_array_index(op->arguments[0], op->arguments[1])) {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET_POOL_ARRAY);
+						} else {
+							codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_SET_NAMED : GDScriptFunction::OPCODE_SET);
+						}
 						codegen.opcodes.push_back(prev_pos);
 						codegen.opcodes.push_back(set_index);
 						codegen.opcodes.push_back(set_value);
@@ -1272,6 +1368,8 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 		switch (s->type) {
 			case GDScriptParser::Node::TYPE_NEWLINE: {
 #ifdef DEBUG_ENABLED
+				if (strip_debug_code)
+					break;
 				const GDScriptParser::NewLineNode *nl = static_cast<const GDScriptParser::NewLineNode *>(s);
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_LINE);
 				codegen.opcodes.push_back(nl->line);
@@ -1402,6 +1500,78 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.push_stack_identifiers();
 						codegen.add_stack_identifier(static_cast<const GDScriptParser::IdentifierNode *>(cf->arguments[0])->name, iter_stack_pos);
 
+						if (_is_int_range(cf->arguments[1])) {
+							// The parser turns range() into a Vector2/Vector3 constructor, iterate on its
+							// int arguments directly instead.
+							const GDScriptParser::OperatorNode *range = static_cast<const GDScriptParser::OperatorNode *>(cf->arguments[1]);
+							int step_pos = (slevel++) | (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS);
+							codegen.alloc_stack(slevel);
+
+							int arg_count = range->arguments.size() - 1;
+							int arg_pos[3] = {
+								counter_pos,
+								container_pos,
+								step_pos
+							};
+							if (arg_count == 1) {
+								arg_pos[0] = container_pos;
+							}
+
+							for (int j = 0; j < arg_count; j++) {
+								int ret2 = _parse_expression(codegen, range->arguments[j + 1], slevel, false);
+								if (ret2 < 0)
+									return ERR_COMPILATION_FAILED;
+
+								codegen.opcodes.push_back(GDScriptFunction::OPCODE_ASSIGN);
+								codegen.opcodes.push_back(arg_pos[j]);
+								codegen.opcodes.push_back(ret2);
+							}
+
+							if (arg_count == 1) {
+								codegen.opcodes.push_back(GDScriptFunction::OPCODE_ASSIGN);
+								codegen.opcodes.push_back(counter_pos);
+								codegen.opcodes.push_back(codegen.get_constant_pos(0) | (GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT << GDScriptFunction::ADDR_BITS));
+							}
+							if (arg_count < 3) {
+								codegen.opcodes.push_back(GDScriptFunction::OPCODE_ASSIGN);
+								codegen.opcodes.push_back(step_pos);
+								codegen.opcodes.push_back(codegen.get_constant_pos(1) | (GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT << GDScriptFunction::ADDR_BITS));
+							}
+
+							//begin loop
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_RANGE_BEGIN);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(step_pos);
+							codegen.opcodes.push_back(codegen.opcodes.size() + 4);
+							codegen.opcodes.push_back(iterator_pos);
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
+							codegen.opcodes.push_back(codegen.opcodes.size() + 9);
+							//break loop
+							int break_pos = codegen.opcodes.size();
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
+							codegen.opcodes.push_back(0); //skip code for next
+							//next loop
+							int continue_pos = codegen.opcodes.size();
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_RANGE);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(step_pos);
+							codegen.opcodes.push_back(break_pos);
+							codegen.opcodes.push_back(iterator_pos);
+
+							Error err = _parse_block(codegen, cf->body, slevel, break_pos, continue_pos);
+							if (err)
+								return err;
+
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP);
+							codegen.opcodes.push_back(continue_pos);
+							codegen.opcodes.write[break_pos + 1] = codegen.opcodes.size();
+
+							codegen.pop_stack_identifiers();
+							break;
+						}
+
 						int ret2 = _parse_expression(codegen, cf->arguments[1], slevel, false);
 						if (ret2 < 0)
 							return ERR_COMPILATION_FAILED;
@@ -1411,8 +1581,11 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(ret2);
 
+						// Pool arrays store their elements straight into the iterator.
+						bool pool_array = GDScriptTypedOps::is_pool_array(_get_builtin_type(cf->arguments[1]));
+
 						//begin loop
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_BEGIN);
+						codegen.opcodes.push_back(pool_array ? GDScriptFunction::OPCODE_ITERATE_POOL_ARRAY_BEGIN : GDScriptFunction::OPCODE_ITERATE_BEGIN);
 						codegen.opcodes.push_back(counter_pos);
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(codegen.opcodes.size() + 4);
@@ -1425,7 +1598,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(0); //skip code for next
 						//next loop
 						int continue_pos = codegen.opcodes.size();
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE);
+						codegen.opcodes.push_back(pool_array ? GDScriptFunction::OPCODE_ITERATE_POOL_ARRAY : GDScriptFunction::OPCODE_ITERATE);
 						codegen.opcodes.push_back(counter_pos);
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(break_pos);
@@ -1512,6 +1685,8 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 			} break;
 			case GDScriptParser::Node::TYPE_ASSERT: {
 #ifdef DEBUG_ENABLED
+				if (strip_debug_code)
+					break;
 				// try subblocks
 
 				const GDScriptParser::AssertNode *as = static_cast<const GDScriptParser::AssertNode *>(s);
@@ -1534,6 +1709,8 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 			} break;
 			case GDScriptParser::Node::TYPE_BREAKPOINT: {
 #ifdef DEBUG_ENABLED
+				if (strip_debug_code)
+					break;
 				// try subblocks
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_BREAKPOINT);
 #endif
@@ -1719,9 +1896,16 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 		}
 		gdfunc->_global_names_count = gdfunc->global_names.size();
 
+		gdfunc->method_call_caches.resize(gdfunc->_global_names_count);
+		gdfunc->_method_call_caches_ptr = gdfunc->method_call_caches.ptrw();
+		for (int i = 0; i < gdfunc->_global_names_count; i++) {
+			gdfunc->_method_call_caches_ptr[i].set_method(gdfunc->global_names[i]);
+		}
+
 	} else {
 		gdfunc->_global_names_ptr = NULL;
 		gdfunc->_global_names_count = 0;
+		gdfunc->_method_call_caches_ptr = NULL;
 	}
 
 #ifdef TOOLS_ENABLED
@@ -1810,6 +1994,9 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	if (codegen.debug_stack)
 		gdfunc->stack_debug = codegen.stack_debug;
 
+	if (optimize)
+		GDScriptOptimizer::optimize(gdfunc);
+
 	if (is_initializer)
 		p_script->initializer = gdfunc;
 
@@ -2177,5 +2364,18 @@ int GDScriptCompiler::get_error_column() const {
 	return err_column;
 }
 
+void GDScriptCompiler::set_strip_debug_code(bool p_strip) {
+
+	strip_debug_code = p_strip;
+}
+
+void GDScriptCompiler::set_optimize(bool p_optimize) {
+
+	optimize = p_optimize;
+}
+
 GDScriptCompiler::GDScriptCompiler() {
+
+	strip_debug_code = false;
+	optimize = true;
 }
@@ -155,10 +155,17 @@ class GDScriptCompiler {
 	int err_column;
 	StringName source;
 	String error;
+	bool strip_debug_code;
+	bool optimize;
 
 public:
 	Error compile(const GDScriptParser *p_parser, GDScript *p_script, bool p_keep_state = false);
 
+	// Leaves out line numbers, asserts and breakpoints, as a build without DEBUG_ENABLED would.
+	void set_strip_debug_code(bool p_strip);
+	// Runs GDScriptOptimizer over each function, enabled by default.
+	void set_optimize(bool p_optimize);
+
 	String get_error() const;
 	int get_error_line() const;
 	int get_error_column() const;
@@ -30,9 +30,13 @@
 
 #include "gdscript_function.h"
 
+#include "core/os/copymem.h"
 #include "core/os/os.h"
 #include "gdscript.h"
 #include "gdscript_functions.h"
+#include "gdscript_typed_ops.h"
+
+#include "core/variant_internal.h"
 
 Variant *GDScriptFunction::_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const {
 
@@ -193,12 +197,16 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 #define OPCODES_TABLE                         \
 	static const void *switch_table_ops[] = { \
 		&&OPCODE_OPERATOR,                    \
+		&&OPCODE_OPERATOR_TYPED,              \
 		&&OPCODE_EXTENDS_TEST,                \
 		&&OPCODE_IS_BUILTIN,                  \
 		&&OPCODE_SET,                         \
 		&&OPCODE_GET,                         \
+		&&OPCODE_SET_POOL_ARRAY,              \
+		&&OPCODE_GET_POOL_ARRAY,              \
 		&&OPCODE_SET_NAMED,                   \
 		&&OPCODE_GET_NAMED,                   \
+		&&OPCODE_GET_NAMED_TYPED,             \
 		&&OPCODE_SET_MEMBER,                  \
 		&&OPCODE_GET_MEMBER,                  \
 		&&OPCODE_ASSIGN,                      \
@@ -228,6 +236,10 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 		&&OPCODE_RETURN,                      \
 		&&OPCODE_ITERATE_BEGIN,               \
 		&&OPCODE_ITERATE,                     \
+		&&OPCODE_ITERATE_RANGE_BEGIN,         \
+		&&OPCODE_ITERATE_RANGE,               \
+		&&OPCODE_ITERATE_POOL_ARRAY_BEGIN,    \
+		&&OPCODE_ITERATE_POOL_ARRAY,          \
 		&&OPCODE_ASSERT,                      \
 		&&OPCODE_BREAKPOINT,                  \
 		&&OPCODE_LINE,                        \
@@ -281,17 +293,18 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #endif
 
 	uint32_t alloca_size = 0;
+	bool stack_moved = false; // Handed over to a GDScriptFunctionState by yield.
 	GDScript *script;
 	int ip = 0;
 	int line = _initial_line;
 
 	if (p_state) {
 		//use existing (supplied) state (yielded)
-		stack = (Variant *)p_state->stack.ptr();
-		call_args = (Variant **)&p_state->stack.ptr()[sizeof(Variant) * p_state->stack_size]; //ptr() to avoid bounds check
+		stack = (Variant *)p_state->frame;
+		call_args = (Variant **)&p_state->frame[sizeof(Variant) * p_state->stack_size];
 		line = p_state->line;
 		ip = p_state->ip;
-		alloca_size = p_state->stack.size();
+		alloca_size = p_state->alloca_size;
 		script = p_state->script.ptr();
 		p_instance = p_state->instance;
 		defarg = p_state->defarg;
@@ -389,7 +402,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 #ifdef DEBUG_ENABLED
 
-	if (ScriptDebugger::get_singleton())
+	if (GDScriptLanguage::get_singleton()->is_tracking_call_stack())
 		GDScriptLanguage::get_singleton()->enter_function(p_instance, this, stack, &ip, &line);
 
 #define GD_ERR_BREAK(m_cond)                                                                                           \
@@ -479,6 +492,47 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_OPERATOR_TYPED) {
+
+				CHECK_SPACE(6);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
+				int typed_op = _code_ptr[ip + 2];
+				GD_ERR_BREAK(typed_op < 0 || typed_op >= GDScriptTypedOps::get_operator_count());
+				const GDScriptTypedOps::Operator &top = GDScriptTypedOps::get_operator(typed_op);
+
+				GET_VARIANT_PTR(a, 3);
+				GET_VARIANT_PTR(b, 4);
+				GET_VARIANT_PTR(dst, 5);
+
+				// Types were inferred at compile time, but aren't guaranteed at runtime.
+				if (a->get_type() != top.type_a || b->get_type() != top.type_b || !top.func(a, b, dst)) {
+
+					bool valid;
+#ifdef DEBUG_ENABLED
+					Variant ret;
+					Variant::evaluate(op, *a, *b, ret, valid);
+					if (!valid) {
+
+						if (ret.get_type() == Variant::STRING) {
+							//return a string when invalid with the error
+							err_text = ret;
+							err_text += " in operator '" + Variant::get_operator_name(op) + "'.";
+						} else {
+							err_text = "Invalid operands '" + Variant::get_type_name(a->get_type()) + "' and '" + Variant::get_type_name(b->get_type()) + "' in operator '" + Variant::get_operator_name(op) + "'.";
+						}
+						OPCODE_BREAK;
+					}
+					*dst = ret;
+#else
+					Variant::evaluate(op, *a, *b, *dst, valid);
+#endif
+				}
+				ip += 6;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_EXTENDS_TEST) {
 
 				CHECK_SPACE(4);
@@ -617,6 +671,69 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_SET_POOL_ARRAY) {
+
+				CHECK_SPACE(3);
+
+				GET_VARIANT_PTR(dst, 1);
+				GET_VARIANT_PTR(index, 2);
+				GET_VARIANT_PTR(value, 3);
+
+				// Types were inferred at compile time, but aren't guaranteed at runtime.
+				if (index->get_type() != Variant::INT || !GDScriptTypedOps::pool_array_set(dst, VariantInternal::get_int(index), value)) {
+
+					bool valid;
+					dst->set(*index, *value, &valid);
+
+#ifdef DEBUG_ENABLED
+					if (!valid) {
+						String v = index->operator String();
+						if (v != "") {
+							v = "'" + v + "'";
+						} else {
+							v = "of type '" + _get_var_type(index) + "'";
+						}
+						err_text = "Invalid set index " + v + " (on base: '" + _get_var_type(dst) + "') with value of type '" + _get_var_type(value) + "'";
+						OPCODE_BREAK;
+					}
+#endif
+				}
+				ip += 4;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_POOL_ARRAY) {
+
+				CHECK_SPACE(3);
+
+				GET_VARIANT_PTR(src, 1);
+				GET_VARIANT_PTR(index, 2);
+				GET_VARIANT_PTR(dst, 3);
+
+				if (index->get_type() != Variant::INT || !GDScriptTypedOps::pool_array_get(src, VariantInternal::get_int(index), dst)) {
+
+					bool valid;
+#ifdef DEBUG_ENABLED
+					Variant ret = src->get(*index, &valid);
+					if (!valid) {
+						String v = index->operator String();
+						if (v != "") {
+							v = "'" + v + "'";
+						} else {
+							v = "of type '" + _get_var_type(index) + "'";
+						}
+						err_text = "Invalid get index " + v + " (on base: '" + _get_var_type(src) + "').";
+						OPCODE_BREAK;
+					}
+					*dst = ret;
+#else
+					*dst = src->get(*index, &valid);
+#endif
+				}
+				ip += 4;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_SET_NAMED) {
 
 				CHECK_SPACE(3);
@@ -678,6 +795,45 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_GET_NAMED_TYPED) {
+
+				CHECK_SPACE(5);
+
+				int typed_member = _code_ptr[ip + 1];
+				GD_ERR_BREAK(typed_member < 0 || typed_member >= GDScriptTypedOps::get_member_count());
+				const GDScriptTypedOps::Member &tmember = GDScriptTypedOps::get_member(typed_member);
+
+				GET_VARIANT_PTR(src, 2);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (src->get_type() == tmember.type) {
+					tmember.get(src, dst);
+				} else {
+
+					int indexname = _code_ptr[ip + 3];
+					GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+					const StringName *index = &_global_names_ptr[indexname];
+
+					bool valid;
+#ifdef DEBUG_ENABLED
+					Variant ret = src->get_named(*index, &valid);
+					if (!valid) {
+						if (src->has_method(*index)) {
+							err_text = "Invalid get index '" + index->operator String() + "' (on base: '" + _get_var_type(src) + "'). Did you mean '." + index->operator String() + "()' or funcref(obj, \"" + index->operator String() + "\") ?";
+						} else {
+							err_text = "Invalid get index '" + index->operator String() + "' (on base: '" + _get_var_type(src) + "').";
+						}
+						OPCODE_BREAK;
+					}
+					*dst = ret;
+#else
+					*dst = src->get_named(*index, &valid);
+#endif
+				}
+				ip += 5;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_SET_MEMBER) {
 
 				CHECK_SPACE(3);
@@ -1051,7 +1207,6 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				int nameg = _code_ptr[ip + 3];
 
 				GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
-				const StringName *methodname = &_global_names_ptr[nameg];
 
 				GD_ERR_BREAK(argc < 0);
 				ip += 4;
@@ -1072,13 +1227,14 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 #endif
 				Variant::CallError err;
+				MethodCallCache &call_cache = _method_call_caches_ptr[nameg];
 				if (call_ret) {
 
 					GET_VARIANT_PTR(ret, argc);
-					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
+					call_cache.call_ptr(*base, (const Variant **)argptrs, argc, ret, err);
 				} else {
 
-					base->call_ptr(*methodname, (const Variant **)argptrs, argc, NULL, err);
+					call_cache.call_ptr(*base, (const Variant **)argptrs, argc, NULL, err);
 				}
 #ifdef DEBUG_ENABLED
 				if (GDScriptLanguage::get_singleton()->profiling) {
@@ -1087,7 +1243,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				if (err.error != Variant::CallError::CALL_OK) {
 
-					String methodstr = *methodname;
+					String methodstr = _global_names_ptr[nameg];
 					String basestr = _get_var_type(base);
 
 					if (methodstr == "call") {
@@ -1116,7 +1272,6 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 #endif
 
-				//_call_func(NULL,base,*methodname,ip,argc,p_instance,stack);
 				ip += argc + 1;
 			}
 			DISPATCH_OPCODE;
@@ -1256,11 +1411,18 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				Ref<GDScriptFunctionState> gdfs = memnew(GDScriptFunctionState);
 				gdfs->function = this;
 
-				gdfs->state.stack.resize(alloca_size);
-				//copy variant stack
-				for (int i = 0; i < _stack_size; i++) {
-					memnew_placement(&gdfs->state.stack.write[sizeof(Variant) * i], Variant(stack[i]));
+				if (p_state) {
+					// Resumed from a previous yield, the stack already lives in a pooled frame.
+					gdfs->state.frame = p_state->frame;
+					p_state->frame = NULL;
+				} else if (alloca_size) {
+					// Variants can be relocated with a plain memory copy, so move
+					// the stack out of alloca() instead of copy constructing it.
+					gdfs->state.frame = GDScriptLanguage::get_singleton()->frame_pool.alloc(alloca_size);
+					copymem(gdfs->state.frame, stack, sizeof(Variant) * _stack_size);
+					stack = (Variant *)gdfs->state.frame;
 				}
+				stack_moved = true;
 				gdfs->state.stack_size = _stack_size;
 				gdfs->state.self = self;
 				gdfs->state.alloca_size = alloca_size;
@@ -1311,13 +1473,13 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 						OPCODE_BREAK;
 					}
 
-					Error err = obj->connect(signal, gdfs.ptr(), "_signal_callback", varray(gdfs), Object::CONNECT_ONESHOT);
+					Error err = GDScriptYieldQueue::wait(obj, signal, gdfs);
 					if (err != OK) {
 						err_text = "Error connecting to signal: " + signal + " during yield().";
 						OPCODE_BREAK;
 					}
 #else
-					obj->connect(signal, gdfs.ptr(), "_signal_callback", varray(gdfs), Object::CONNECT_ONESHOT);
+					GDScriptYieldQueue::wait(obj, signal, gdfs);
 #endif
 				}
 
@@ -1473,6 +1635,171 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_ITERATE_RANGE_BEGIN) {
+
+				CHECK_SPACE(10); //space for this a regular iterate
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(to, 2);
+				GET_VARIANT_PTR(step, 3);
+
+				// Arguments were typed as int at compile time, so convert floats like the range() would.
+				Variant *args[3] = { counter, to, step };
+				bool args_ok = true;
+				for (int i = 0; i < 3; i++) {
+					if (args[i]->get_type() == Variant::REAL) {
+						VariantInternal::set_int(args[i], (int64_t)VariantInternal::get_real(args[i]));
+					} else if (args[i]->get_type() != Variant::INT) {
+#ifdef DEBUG_ENABLED
+						err_text = "Unable to iterate on range with argument of type '" + Variant::get_type_name(args[i]->get_type()) + "'.";
+#endif
+						args_ok = false;
+						break;
+					}
+				}
+				if (!args_ok) {
+					OPCODE_BREAK;
+				}
+
+				int64_t from_value = VariantInternal::get_int(counter);
+				int64_t to_value = VariantInternal::get_int(to);
+				int64_t step_value = VariantInternal::get_int(step);
+
+				// Same rules as iterating on a Vector3.
+				bool empty = from_value == to_value || (from_value < to_value ? step_value <= 0 : step_value >= 0);
+				if (empty) {
+					int jumpto = _code_ptr[ip + 4];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				} else {
+					GET_VARIANT_PTR(iterator, 5);
+					VariantInternal::set_int(iterator, from_value);
+					ip += 6; //skip regular iterate which is always next
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_ITERATE_RANGE) {
+
+				CHECK_SPACE(6);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(to, 2);
+				GET_VARIANT_PTR(step, 3);
+
+				// Both were checked by OPCODE_ITERATE_RANGE_BEGIN and aren't visible to the script.
+				int64_t to_value = VariantInternal::get_int(to);
+				int64_t step_value = VariantInternal::get_int(step);
+				int64_t idx = VariantInternal::get_int(counter) + step_value;
+
+				if (step_value < 0 ? idx <= to_value : idx >= to_value) {
+					int jumpto = _code_ptr[ip + 4];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				} else {
+					VariantInternal::set_int(counter, idx);
+					GET_VARIANT_PTR(iterator, 5);
+					VariantInternal::set_int(iterator, idx);
+					ip += 6; //loop again
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_ITERATE_POOL_ARRAY_BEGIN) {
+
+				CHECK_SPACE(8); //space for this a regular iterate
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+				GET_VARIANT_PTR(iterator, 4);
+
+				if (GDScriptTypedOps::is_pool_array(container->get_type())) {
+
+					// Counts like Variant::iter_init(), but elements are stored straight into the iterator.
+					VariantInternal::set_int(counter, 0);
+					if (!GDScriptTypedOps::pool_array_get(container, 0, iterator)) {
+						int jumpto = _code_ptr[ip + 3];
+						GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+						ip = jumpto;
+					} else {
+						ip += 5; //skip regular iterate which is always next
+					}
+				} else {
+
+					bool valid;
+					if (!container->iter_init(*counter, valid)) {
+#ifdef DEBUG_ENABLED
+						if (!valid) {
+							err_text = "Unable to iterate on object of type '" + Variant::get_type_name(container->get_type()) + "'.";
+							OPCODE_BREAK;
+						}
+#endif
+						int jumpto = _code_ptr[ip + 3];
+						GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+						ip = jumpto;
+					} else {
+
+						*iterator = container->iter_get(*counter, valid);
+#ifdef DEBUG_ENABLED
+						if (!valid) {
+							err_text = "Unable to obtain iterator object of type '" + Variant::get_type_name(container->get_type()) + "'.";
+							OPCODE_BREAK;
+						}
+#endif
+						ip += 5; //skip regular iterate which is always next
+					}
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_ITERATE_POOL_ARRAY) {
+
+				CHECK_SPACE(4);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+				GET_VARIANT_PTR(iterator, 4);
+
+				if (GDScriptTypedOps::is_pool_array(container->get_type())) {
+
+					// The array may have shrunk in the loop body, which ends the loop like Variant::iter_next().
+					int64_t idx = VariantInternal::get_int(counter) + 1;
+					if (!GDScriptTypedOps::pool_array_get(container, idx, iterator)) {
+						int jumpto = _code_ptr[ip + 3];
+						GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+						ip = jumpto;
+					} else {
+						VariantInternal::set_int(counter, idx);
+						ip += 5; //loop again
+					}
+				} else {
+
+					bool valid;
+					if (!container->iter_next(*counter, valid)) {
+#ifdef DEBUG_ENABLED
+						if (!valid) {
+							err_text = "Unable to iterate on object of type '" + Variant::get_type_name(container->get_type()) + "' (type changed since first iteration?).";
+							OPCODE_BREAK;
+						}
+#endif
+						int jumpto = _code_ptr[ip + 3];
+						GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+						ip = jumpto;
+					} else {
+
+						*iterator = container->iter_get(*counter, valid);
+#ifdef DEBUG_ENABLED
+						if (!valid) {
+							err_text = "Unable to obtain iterator object of type '" + Variant::get_type_name(container->get_type()) + "' (but was obtained on first iteration?).";
+							OPCODE_BREAK;
+						}
+#endif
+						ip += 5; //loop again
+					}
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_ASSERT) {
 				CHECK_SPACE(3);
 
@@ -1600,11 +1927,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 	// When it's the last resume it will postpone the exit from stack,
 	// so the debugger knows which function triggered the resume of the next function (if any)
 	if (!p_state || yielded) {
-		if (ScriptDebugger::get_singleton())
+		if (GDScriptLanguage::get_singleton()->is_tracking_call_stack())
 			GDScriptLanguage::get_singleton()->exit_function();
 #endif
 
-		if (_stack_size) {
+		if (_stack_size && !stack_moved) {
 			//free stack
 			for (int i = 0; i < _stack_size; i++)
 				stack[i].~Variant();
@@ -1737,6 +2064,8 @@ void GDScriptFunction::debug_get_stack_member_state(int p_line, List<Pair<String
 	}
 }
 
+volatile uint32_t GDScriptFunction::generation = 1;
+
 GDScriptFunction::GDScriptFunction() :
 		function_list(this) {
 
@@ -1770,6 +2099,9 @@ GDScriptFunction::GDScriptFunction() :
 }
 
 GDScriptFunction::~GDScriptFunction() {
+
+	atomic_increment(&generation);
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->lock) {
 		GDScriptLanguage::get_singleton()->lock->lock();
@@ -1784,27 +2116,114 @@ GDScriptFunction::~GDScriptFunction() {
 
 /////////////////////
 
+GDScriptFramePool::GDScriptFramePool() {
+
+	for (int i = 0; i < SIZE_CLASS_COUNT; i++) {
+		free_frames[i] = NULL;
+		free_count[i] = 0;
+	}
+#ifdef NO_THREADS
+	mutex = NULL;
+#else
+	mutex = Mutex::create();
+#endif
+}
+
+GDScriptFramePool::~GDScriptFramePool() {
+
+	for (int i = 0; i < SIZE_CLASS_COUNT; i++) {
+		while (free_frames[i]) {
+			FreeFrame *frame = free_frames[i];
+			free_frames[i] = frame->next;
+			memfree(frame);
+		}
+	}
+	if (mutex) {
+		memdelete(mutex);
+	}
+}
+
+uint8_t *GDScriptFramePool::alloc(uint32_t p_size) {
+
+	int size_class = _get_size_class(p_size);
+	if (size_class < 0) {
+		return (uint8_t *)memalloc(p_size);
+	}
+
+	if (mutex) {
+		mutex->lock();
+	}
+	FreeFrame *frame = free_frames[size_class];
+	if (frame) {
+		free_frames[size_class] = frame->next;
+		free_count[size_class]--;
+	}
+	if (mutex) {
+		mutex->unlock();
+	}
+
+	if (!frame) {
+		frame = (FreeFrame *)memalloc(1 << (size_class + MIN_SIZE_SHIFT));
+	}
+	return (uint8_t *)frame;
+}
+
+void GDScriptFramePool::free(uint8_t *p_frame, uint32_t p_size) {
+
+	int size_class = _get_size_class(p_size);
+	if (size_class >= 0) {
+
+		if (mutex) {
+			mutex->lock();
+		}
+		bool pooled = free_count[size_class] < MAX_FREE_FRAMES;
+		if (pooled) {
+			FreeFrame *frame = (FreeFrame *)p_frame;
+			frame->next = free_frames[size_class];
+			free_frames[size_class] = frame;
+			free_count[size_class]++;
+		}
+		if (mutex) {
+			mutex->unlock();
+		}
+
+		if (pooled) {
+			return;
+		}
+	}
+
+	memfree(p_frame);
+}
+
+/////////////////////
+
+// The bound argument comes last, the ones before it are what the signal emitted.
+static Variant _get_yield_signal_result(const Variant **p_args, int p_argcount) {
+
+	if (p_argcount == 2) {
+		return *p_args[0];
+	} else if (p_argcount > 2) {
+		Array extra_args;
+		for (int i = 0; i < p_argcount - 1; i++) {
+			extra_args.push_back(*p_args[i]);
+		}
+		return extra_args;
+	}
+	return Variant();
+}
+
 Variant GDScriptFunctionState::_signal_callback(const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
 
-	Variant arg;
 	r_error.error = Variant::CallError::CALL_OK;
 
 	if (p_argcount == 0) {
 		r_error.error = Variant::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS;
 		r_error.argument = 1;
 		return Variant();
-	} else if (p_argcount == 1) {
-		//noooneee
-	} else if (p_argcount == 2) {
-		arg = *p_args[0];
-	} else {
-		Array extra_args;
-		for (int i = 0; i < p_argcount - 1; i++) {
-			extra_args.push_back(*p_args[i]);
-		}
-		arg = extra_args;
 	}
 
+	Variant arg = _get_yield_signal_result(p_args, p_argcount);
+
 	Ref<GDScriptFunctionState> self = *p_args[p_argcount - 1];
 
 	if (self.is_null()) {
@@ -1869,20 +2288,37 @@ Variant GDScriptFunctionState::resume(const Variant &p_arg) {
 		}
 
 #ifdef DEBUG_ENABLED
-		if (ScriptDebugger::get_singleton())
+		if (GDScriptLanguage::get_singleton()->is_tracking_call_stack())
 			GDScriptLanguage::get_singleton()->exit_function();
-		if (state.stack_size) {
+		if (state.stack_size && state.frame) {
 			//free stack
-			Variant *stack = (Variant *)state.stack.ptr();
+			Variant *stack = (Variant *)state.frame;
 			for (int i = 0; i < state.stack_size; i++)
 				stack[i].~Variant();
 		}
 #endif
 	}
 
+	// The stack is either freed by now, or was handed over to the state of the next yield.
+	_release_frame();
+
 	return ret;
 }
 
+void GDScriptFunctionState::_release_frame() {
+
+	if (!state.frame) {
+		return;
+	}
+
+	if (GDScriptLanguage::get_singleton()) {
+		GDScriptLanguage::get_singleton()->frame_pool.free(state.frame, state.alloca_size);
+	} else {
+		memfree(state.frame);
+	}
+	state.frame = NULL;
+}
+
 void GDScriptFunctionState::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("resume", "arg"), &GDScriptFunctionState::resume, DEFVAL(Variant()));
@@ -1895,15 +2331,149 @@ void GDScriptFunctionState::_bind_methods() {
 GDScriptFunctionState::GDScriptFunctionState() {
 
 	function = NULL;
+	state.frame = NULL;
+	state.alloca_size = 0;
 }
 
 GDScriptFunctionState::~GDScriptFunctionState() {
 
-	if (function != NULL) {
+	if (function != NULL && state.frame) {
 		//never called, deinitialize stack
+		Variant *stack = (Variant *)state.frame;
 		for (int i = 0; i < state.stack_size; i++) {
-			Variant *v = (Variant *)&state.stack[sizeof(Variant) * i];
-			v->~Variant();
+			stack[i].~Variant();
+		}
+	}
+	_release_frame();
+}
+
+/////////////////////
+
+Error GDScriptYieldQueue::wait(Object *p_object, const StringName &p_signal, const Ref<GDScriptFunctionState> &p_state) {
+
+	if (Object::cast_to<GDScriptFunctionState>(p_object)) {
+		// "completed" is only ever emitted once, a queue would be of no use.
+		Ref<GDScriptFunctionState> state = p_state;
+		return p_object->connect(p_signal, state.ptr(), "_signal_callback", varray(state), Object::CONNECT_ONESHOT);
+	}
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+
+	Key key;
+	key.object = p_object->get_instance_id();
+	key.signal = p_signal;
+
+	// Waiting from a handler of this same signal must not resume with the
+	// ongoing emission, the way a connection made during it wouldn't.
+	Waiter waiter;
+	waiter.state = p_state;
+	waiter.emission_count = p_object->get_signal_emission_count(p_signal);
+
+	if (language->lock) {
+		language->lock->lock();
+	}
+
+	Map<Key, GDScriptYieldQueue *>::Element *E = language->yield_queues.find(key);
+	if (E) {
+		E->get()->waiting.push_back(waiter);
+		if (language->lock) {
+			language->lock->unlock();
 		}
+		return OK;
+	}
+
+	// The connection holds the only reference, so the queue goes away
+	// together with it, i.e. when the object is freed or the queue goes idle.
+	Ref<GDScriptYieldQueue> queue = memnew(GDScriptYieldQueue);
+	queue->key = key;
+
+	Error err = p_object->connect(p_signal, queue.ptr(), "_signal_callback", varray(queue));
+	if (err == OK) {
+		queue->waiting.push_back(waiter);
+		queue->registered = true;
+		language->yield_queues.insert(key, queue.ptr());
+	}
+
+	if (language->lock) {
+		language->lock->unlock();
+	}
+
+	return err;
+}
+
+Variant GDScriptYieldQueue::_signal_callback(const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
+
+	r_error.error = Variant::CallError::CALL_OK;
+
+	if (p_argcount == 0) {
+		r_error.error = Variant::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS;
+		r_error.argument = 1;
+		return Variant();
+	}
+
+	Variant arg = _get_yield_signal_result(p_args, p_argcount);
+
+	// Only functions that were waiting when this emission started are resumed. Those
+	// yielding on the signal again while being resumed wait for the next one.
+	Object *object = ObjectDB::get_instance(key.object);
+	uint64_t emission_count = object ? object->get_signal_emission_count(key.signal) : 0;
+	Vector<Waiter> resuming;
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+	if (language->lock) {
+		language->lock->lock();
+	}
+	// Waiters are queued in emission count order.
+	int count = 0;
+	while (count < waiting.size() && waiting[count].emission_count < emission_count) {
+		count++;
+	}
+	if (count == waiting.size()) {
+		SWAP(resuming, waiting);
+	} else if (count > 0) {
+		resuming.resize(count);
+		for (int i = 0; i < waiting.size(); i++) {
+			if (i < count) {
+				resuming.write[i] = waiting[i];
+			} else {
+				waiting.write[i - count] = waiting[i];
+			}
+		}
+		waiting.resize(waiting.size() - count);
+	}
+	if (language->lock) {
+		language->lock->unlock();
+	}
+
+	for (int i = 0; i < resuming.size(); i++) {
+		resuming.write[i].state->resume(arg);
+	}
+
+	return Variant();
+}
+
+void GDScriptYieldQueue::_bind_methods() {
+
+	ClassDB::bind_vararg_method(METHOD_FLAGS_DEFAULT, "_signal_callback", &GDScriptYieldQueue::_signal_callback, MethodInfo("_signal_callback"));
+}
+
+GDScriptYieldQueue::GDScriptYieldQueue() {
+
+	registered = false;
+}
+
+GDScriptYieldQueue::~GDScriptYieldQueue() {
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+	if (!registered || !language) {
+		return;
+	}
+
+	if (language->lock) {
+		language->lock->lock();
+	}
+	language->yield_queues.erase(key);
+	if (language->lock) {
+		language->lock->unlock();
 	}
 }
@@ -31,6 +31,8 @@
 #ifndef GDSCRIPT_FUNCTION_H
 #define GDSCRIPT_FUNCTION_H
 
+#include "core/method_call_cache.h"
+#include "core/os/mutex.h"
 #include "core/os/thread.h"
 #include "core/pair.h"
 #include "core/reference.h"
@@ -42,6 +44,37 @@
 class GDScriptInstance;
 class GDScript;
 
+// Recycles the buffers holding the stack of yielded functions, so coroutines
+// which yield every frame don't go through the allocator each time.
+class GDScriptFramePool {
+
+	enum {
+		MIN_SIZE_SHIFT = 6, // 64 bytes.
+		SIZE_CLASS_COUNT = 10, // Up to 32 KiB, bigger frames aren't pooled.
+		MAX_FREE_FRAMES = 256, // Per size class.
+	};
+
+	struct FreeFrame {
+		FreeFrame *next;
+	};
+
+	FreeFrame *free_frames[SIZE_CLASS_COUNT];
+	uint32_t free_count[SIZE_CLASS_COUNT];
+	Mutex *mutex;
+
+	static _FORCE_INLINE_ int _get_size_class(uint32_t p_size) {
+		int shift = MAX((int)nearest_shift(p_size - 1), (int)MIN_SIZE_SHIFT) - MIN_SIZE_SHIFT;
+		return shift < SIZE_CLASS_COUNT ? shift : -1;
+	}
+
+public:
+	uint8_t *alloc(uint32_t p_size);
+	void free(uint8_t *p_frame, uint32_t p_size);
+
+	GDScriptFramePool();
+	~GDScriptFramePool();
+};
+
 struct GDScriptDataType {
 	bool has_type;
 	enum {
@@ -148,12 +181,16 @@ class GDScriptFunction {
 public:
 	enum Opcode {
 		OPCODE_OPERATOR,
+		OPCODE_OPERATOR_TYPED,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_IS_BUILTIN,
 		OPCODE_SET,
 		OPCODE_GET,
+		OPCODE_SET_POOL_ARRAY,
+		OPCODE_GET_POOL_ARRAY,
 		OPCODE_SET_NAMED,
 		OPCODE_GET_NAMED,
+		OPCODE_GET_NAMED_TYPED,
 		OPCODE_SET_MEMBER,
 		OPCODE_GET_MEMBER,
 		OPCODE_ASSIGN,
@@ -183,6 +220,10 @@ public:
 		OPCODE_RETURN,
 		OPCODE_ITERATE_BEGIN,
 		OPCODE_ITERATE,
+		OPCODE_ITERATE_RANGE_BEGIN,
+		OPCODE_ITERATE_RANGE,
+		OPCODE_ITERATE_POOL_ARRAY_BEGIN,
+		OPCODE_ITERATE_POOL_ARRAY,
 		OPCODE_ASSERT,
 		OPCODE_BREAKPOINT,
 		OPCODE_LINE,
@@ -215,6 +256,9 @@ public:
 
 private:
 	friend class GDScriptCompiler;
+	friend class GDScriptCompiledWriter;
+	friend class GDScriptCompiledReader;
+	friend class GDScriptOptimizer;
 
 	StringName source;
 
@@ -223,6 +267,7 @@ private:
 	int _constant_count;
 	const StringName *_global_names_ptr;
 	int _global_names_count;
+	MethodCallCache *_method_call_caches_ptr;
 #ifdef TOOLS_ENABLED
 	const StringName *_named_globals_ptr;
 	int _named_globals_count;
@@ -243,6 +288,7 @@ private:
 	StringName name;
 	Vector<Variant> constants;
 	Vector<StringName> global_names;
+	Vector<MethodCallCache> method_call_caches; // One per global name, used when calling it as a method.
 #ifdef TOOLS_ENABLED
 	Vector<StringName> named_globals;
 #endif
@@ -263,6 +309,8 @@ private:
 	friend class GDScriptLanguage;
 
 	SelfList<GDScriptFunction> function_list;
+	static volatile uint32_t generation;
+
 #ifdef DEBUG_ENABLED
 	CharString func_cname;
 	const char *_func_cname;
@@ -287,7 +335,7 @@ public:
 
 		ObjectID instance_id;
 		GDScriptInstance *instance;
-		Vector<uint8_t> stack;
+		uint8_t *frame; // Variant stack followed by call arguments, from GDScriptFramePool.
 		int stack_size;
 		Variant self;
 		uint32_t alloca_size;
@@ -300,6 +348,10 @@ public:
 
 	_FORCE_INLINE_ bool is_static() const { return _static; }
 
+	// Changes whenever a function is freed, so pointers to functions taken
+	// under the same generation are still valid.
+	_FORCE_INLINE_ static uint32_t get_generation() { return generation; }
+
 	const int *get_code() const; //used for debug
 	int get_code_size() const;
 	Variant get_constant(int p_idx) const;
@@ -347,6 +399,8 @@ class GDScriptFunctionState : public Reference {
 	Variant _signal_callback(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
 	Ref<GDScriptFunctionState> first_state;
 
+	void _release_frame();
+
 protected:
 	static void _bind_methods();
 
@@ -357,4 +411,46 @@ public:
 	~GDScriptFunctionState();
 };
 
+// Resumes every function waiting on one signal of one object.
+// It stays connected while functions keep yielding on the signal, so waits
+// like yield(get_tree(), "idle_frame") don't connect and disconnect every frame.
+// Idle queues are disconnected by GDScriptLanguage::frame().
+class GDScriptYieldQueue : public Reference {
+
+	GDCLASS(GDScriptYieldQueue, Reference);
+	friend class GDScriptLanguage;
+
+public:
+	struct Key {
+		ObjectID object;
+		StringName signal;
+
+		bool operator<(const Key &p_key) const {
+			return object == p_key.object ? signal < p_key.signal : object < p_key.object;
+		}
+	};
+
+private:
+	struct Waiter {
+		Ref<GDScriptFunctionState> state;
+		// Emissions of the signal started before the wait, only later ones resume it.
+		uint64_t emission_count;
+	};
+
+	Key key;
+	bool registered;
+	Vector<Waiter> waiting;
+
+	Variant _signal_callback(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
+
+protected:
+	static void _bind_methods();
+
+public:
+	static Error wait(Object *p_object, const StringName &p_signal, const Ref<GDScriptFunctionState> &p_state);
+
+	GDScriptYieldQueue();
+	~GDScriptYieldQueue();
+};
+
 #endif // GDSCRIPT_FUNCTION_H
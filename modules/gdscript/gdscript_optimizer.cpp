@@ -0,0 +1,1052 @@
+/*************************************************************************/
+/*  gdscript_optimizer.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_optimizer.h"
+
+#include "gdscript.h"
+
+// Upper bound for the number of times passes are run over a function, each
+// run can enable more work for the next one.
+#define MAX_PASSES 8
+
+static int _make_layout(const char *p_head, int p_reads, char p_tail, Vector<char> &r_layout) {
+
+	int head = strlen(p_head);
+	r_layout.resize(head + p_reads + 1);
+	char *w = r_layout.ptrw();
+	for (int i = 0; i < head; i++) {
+		w[i] = p_head[i];
+	}
+	for (int i = 0; i < p_reads; i++) {
+		w[head + i] = GDScriptOptimizer::OPERAND_READ;
+	}
+	w[head + p_reads] = p_tail;
+	return r_layout.size();
+}
+
+int GDScriptOptimizer::get_instruction_layout(const int *p_code, int p_ip, int p_code_size, Vector<char> &r_layout) {
+
+	ERR_FAIL_COND_V(p_ip < 0 || p_ip >= p_code_size, -1);
+
+	const char *layout = NULL;
+	int argc = 0;
+
+	switch (p_code[p_ip]) {
+		case GDScriptFunction::OPCODE_OPERATOR: layout = "--rrw"; break;
+		case GDScriptFunction::OPCODE_OPERATOR_TYPED: layout = "---rrw"; break;
+		case GDScriptFunction::OPCODE_EXTENDS_TEST: layout = "-rrw"; break;
+		case GDScriptFunction::OPCODE_IS_BUILTIN: layout = "-r-w"; break;
+		case GDScriptFunction::OPCODE_SET: layout = "-mrr"; break;
+		case GDScriptFunction::OPCODE_GET: layout = "-rrw"; break;
+		case GDScriptFunction::OPCODE_SET_POOL_ARRAY: layout = "-mrr"; break;
+		case GDScriptFunction::OPCODE_GET_POOL_ARRAY: layout = "-rrw"; break;
+		case GDScriptFunction::OPCODE_SET_NAMED: layout = "-m-r"; break;
+		case GDScriptFunction::OPCODE_GET_NAMED: layout = "-r-w"; break;
+		case GDScriptFunction::OPCODE_GET_NAMED_TYPED: layout = "--r-w"; break;
+		case GDScriptFunction::OPCODE_SET_MEMBER: layout = "--r"; break;
+		case GDScriptFunction::OPCODE_GET_MEMBER: layout = "--w"; break;
+		case GDScriptFunction::OPCODE_ASSIGN: layout = "-wr"; break;
+		case GDScriptFunction::OPCODE_ASSIGN_TRUE: layout = "-w"; break;
+		case GDScriptFunction::OPCODE_ASSIGN_FALSE: layout = "-w"; break;
+		case GDScriptFunction::OPCODE_ASSIGN_TYPED_BUILTIN: layout = "--wr"; break;
+		case GDScriptFunction::OPCODE_ASSIGN_TYPED_NATIVE: layout = "-rwr"; break;
+		case GDScriptFunction::OPCODE_ASSIGN_TYPED_SCRIPT: layout = "-rwr"; break;
+		case GDScriptFunction::OPCODE_CAST_TO_BUILTIN: layout = "--rw"; break;
+		case GDScriptFunction::OPCODE_CAST_TO_NATIVE: layout = "-rrw"; break;
+		case GDScriptFunction::OPCODE_CAST_TO_SCRIPT: layout = "-rrw"; break;
+		case GDScriptFunction::OPCODE_YIELD: layout = "-"; break;
+		case GDScriptFunction::OPCODE_YIELD_SIGNAL: layout = "-rr"; break;
+		case GDScriptFunction::OPCODE_YIELD_RESUME: layout = "-w"; break;
+		case GDScriptFunction::OPCODE_JUMP: layout = "-j"; break;
+		case GDScriptFunction::OPCODE_JUMP_IF: layout = "-rj"; break;
+		case GDScriptFunction::OPCODE_JUMP_IF_NOT: layout = "-rj"; break;
+		case GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT: layout = "-"; break;
+		case GDScriptFunction::OPCODE_RETURN: layout = "-r"; break;
+		// The iterator is only written when the loop goes on, so it's not a plain write.
+		case GDScriptFunction::OPCODE_ITERATE_BEGIN: layout = "-mrjm"; break;
+		case GDScriptFunction::OPCODE_ITERATE: layout = "-mrjm"; break;
+		case GDScriptFunction::OPCODE_ITERATE_RANGE_BEGIN: layout = "-mrrjm"; break;
+		case GDScriptFunction::OPCODE_ITERATE_RANGE: layout = "-mrrjm"; break;
+		case GDScriptFunction::OPCODE_ITERATE_POOL_ARRAY_BEGIN: layout = "-mrjm"; break;
+		case GDScriptFunction::OPCODE_ITERATE_POOL_ARRAY: layout = "-mrjm"; break;
+		case GDScriptFunction::OPCODE_ASSERT: layout = "-rr"; break;
+		case GDScriptFunction::OPCODE_BREAKPOINT: layout = "-"; break;
+		case GDScriptFunction::OPCODE_LINE: layout = "--"; break;
+		case GDScriptFunction::OPCODE_END: layout = "-"; break;
+
+		// Variable size instructions.
+		case GDScriptFunction::OPCODE_CONSTRUCT: {
+			ERR_FAIL_COND_V(p_ip + 2 >= p_code_size, -1);
+			argc = p_code[p_ip + 2];
+			ERR_FAIL_COND_V(argc < 0 || p_ip + 4 + argc > p_code_size, -1);
+			return _make_layout("---", argc, OPERAND_WRITE, r_layout);
+		}
+		case GDScriptFunction::OPCODE_CONSTRUCT_ARRAY: {
+			ERR_FAIL_COND_V(p_ip + 1 >= p_code_size, -1);
+			argc = p_code[p_ip + 1];
+			ERR_FAIL_COND_V(argc < 0 || p_ip + 3 + argc > p_code_size, -1);
+			return _make_layout("--", argc, OPERAND_WRITE, r_layout);
+		}
+		case GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY: {
+			ERR_FAIL_COND_V(p_ip + 1 >= p_code_size, -1);
+			argc = p_code[p_ip + 1];
+			ERR_FAIL_COND_V(argc < 0 || p_ip + 3 + argc * 2 > p_code_size, -1);
+			return _make_layout("--", argc * 2, OPERAND_WRITE, r_layout);
+		}
+		case GDScriptFunction::OPCODE_CALL:
+		case GDScriptFunction::OPCODE_CALL_RETURN: {
+			ERR_FAIL_COND_V(p_ip + 1 >= p_code_size, -1);
+			argc = p_code[p_ip + 1];
+			ERR_FAIL_COND_V(argc < 0 || p_ip + 5 + argc > p_code_size, -1);
+			// Methods of builtin types can modify their base.
+			bool call_ret = p_code[p_ip] == GDScriptFunction::OPCODE_CALL_RETURN;
+			return _make_layout("--m-", argc, call_ret ? OPERAND_WRITE : OPERAND_UNUSED, r_layout);
+		}
+		case GDScriptFunction::OPCODE_CALL_BUILT_IN:
+		case GDScriptFunction::OPCODE_CALL_SELF_BASE: {
+			ERR_FAIL_COND_V(p_ip + 2 >= p_code_size, -1);
+			argc = p_code[p_ip + 2];
+			ERR_FAIL_COND_V(argc < 0 || p_ip + 4 + argc > p_code_size, -1);
+			return _make_layout("---", argc, OPERAND_WRITE, r_layout);
+		}
+		default: {
+			ERR_FAIL_V_MSG(-1, "Unknown opcode " + itos(p_code[p_ip]) + " at address " + itos(p_ip) + ".");
+		}
+	}
+
+	int size = strlen(layout);
+	ERR_FAIL_COND_V(p_ip + size > p_code_size, -1);
+	r_layout.resize(size);
+	for (int i = 0; i < size; i++) {
+		r_layout.write[i] = layout[i];
+	}
+	return size;
+}
+
+int GDScriptOptimizer::_get_slot(int p_address) {
+
+	switch ((p_address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) {
+		case GDScriptFunction::ADDR_TYPE_STACK:
+		case GDScriptFunction::ADDR_TYPE_STACK_VARIABLE: {
+			return p_address & GDScriptFunction::ADDR_MASK;
+		}
+		default: {
+			return -1;
+		}
+	}
+}
+
+bool GDScriptOptimizer::_is_live_in(int p_index, int p_slot) const {
+
+	if (p_index >= instructions.size()) {
+		return false;
+	}
+
+	const Instruction &instruction = instructions[p_index];
+	bool written = false;
+	for (int i = 0; i < instruction.size; i++) {
+		char operand = instruction.layout[i];
+		if (_get_slot(code[instruction.ip + i]) != p_slot) {
+			continue;
+		}
+		if (operand == OPERAND_READ || operand == OPERAND_MODIFY) {
+			return true;
+		}
+		if (operand == OPERAND_WRITE) {
+			written = true;
+		}
+	}
+
+	return !written && _is_live_out(p_index, p_slot);
+}
+
+int GDScriptOptimizer::_get_next(int p_index) const {
+
+	int next = p_index + 1;
+	while (next < instructions.size() && instructions[next].removed) {
+		next++;
+	}
+	return next;
+}
+
+int GDScriptOptimizer::_get_written_operand(int p_index) const {
+
+	const Instruction &instruction = instructions[p_index];
+	int written = -1;
+	for (int i = 0; i < instruction.size; i++) {
+		if (instruction.layout[i] != OPERAND_WRITE) {
+			continue;
+		}
+		if (written != -1) {
+			return -1;
+		}
+		written = i;
+	}
+	return written;
+}
+
+void GDScriptOptimizer::_get_successors(int p_index, Vector<int> &r_successors) const {
+
+	r_successors.clear();
+
+	const Instruction &instruction = instructions[p_index];
+	for (int i = 0; i < instruction.size; i++) {
+		if (instruction.layout[i] == OPERAND_JUMP) {
+			r_successors.push_back(instruction_at[code[instruction.ip + i]]);
+		}
+	}
+
+	switch (code[instruction.ip]) {
+		case GDScriptFunction::OPCODE_JUMP:
+		case GDScriptFunction::OPCODE_RETURN:
+		case GDScriptFunction::OPCODE_END: {
+		} break;
+		case GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT: {
+			for (int i = 1; i < entries.size(); i++) {
+				r_successors.push_back(entries[i]);
+			}
+		} break;
+		default: {
+			r_successors.push_back(p_index + 1);
+		}
+	}
+}
+
+bool GDScriptOptimizer::_decode() {
+
+	instructions.clear();
+	instruction_at.resize(code.size() + 1);
+	for (int i = 0; i < code.size(); i++) {
+		instruction_at.write[i] = -1;
+	}
+
+	for (int ip = 0; ip < code.size();) {
+		Instruction instruction;
+		instruction.ip = ip;
+		instruction.size = get_instruction_layout(code.ptr(), ip, code.size(), instruction.layout);
+		ERR_FAIL_COND_V(instruction.size <= 0, false);
+		instruction.removed = false;
+		instruction.changed = false;
+		instruction_at.write[ip] = instructions.size();
+		instructions.push_back(instruction);
+		ip += instruction.size;
+	}
+	instruction_at.write[code.size()] = instructions.size();
+
+	for (int i = 0; i < instructions.size(); i++) {
+		const Instruction &instruction = instructions[i];
+		for (int j = 0; j < instruction.size; j++) {
+			int operand = code[instruction.ip + j];
+			switch (instruction.layout[j]) {
+				case OPERAND_OTHER: {
+				} break;
+				case OPERAND_JUMP: {
+					ERR_FAIL_COND_V(operand < 0 || operand > code.size() || instruction_at[operand] == -1, false);
+				} break;
+				default: {
+					ERR_FAIL_COND_V(_get_slot(operand) >= slot_count, false);
+				}
+			}
+		}
+	}
+
+	entries.clear();
+	entries.push_back(0);
+	for (int i = 0; i < function->default_arguments.size(); i++) {
+		int address = function->default_arguments[i];
+		ERR_FAIL_COND_V(address < 0 || address > code.size() || instruction_at[address] == -1, false);
+		entries.push_back(instruction_at[address]);
+	}
+
+	return true;
+}
+
+void GDScriptOptimizer::_find_temporaries() {
+
+	temporary.resize(slot_count);
+	for (int i = 0; i < slot_count; i++) {
+		temporary.write[i] = i >= function->_argument_count;
+	}
+
+	for (const List<GDScriptFunction::StackDebug>::Element *E = function->stack_debug.front(); E; E = E->next()) {
+		if (E->get().pos >= 0 && E->get().pos < slot_count) {
+			temporary.write[E->get().pos] = false;
+		}
+	}
+
+	for (int i = 0; i < instructions.size(); i++) {
+		const Instruction &instruction = instructions[i];
+		for (int j = 0; j < instruction.size; j++) {
+			int address = code[instruction.ip + j];
+			if (instruction.layout[j] != OPERAND_OTHER && instruction.layout[j] != OPERAND_JUMP && ((address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) == GDScriptFunction::ADDR_TYPE_STACK_VARIABLE) {
+				temporary.write[address & GDScriptFunction::ADDR_MASK] = false;
+			}
+		}
+	}
+}
+
+bool GDScriptOptimizer::_remove_unreachable() {
+
+	int count = instructions.size();
+	Vector<bool> reached;
+	reached.resize(count);
+	for (int i = 0; i < count; i++) {
+		reached.write[i] = false;
+	}
+
+	Vector<int> pending = entries;
+	Vector<int> successors;
+	while (pending.size()) {
+		int index = pending[pending.size() - 1];
+		pending.resize(pending.size() - 1);
+		if (index >= count || reached[index]) {
+			continue;
+		}
+		reached.write[index] = true;
+		_get_successors(index, successors);
+		for (int i = 0; i < successors.size(); i++) {
+			pending.push_back(successors[i]);
+		}
+	}
+
+	bool changed = false;
+	for (int i = 0; i < count; i++) {
+		if (!reached[i] && !instructions[i].removed) {
+			instructions.write[i].removed = true;
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+void GDScriptOptimizer::_find_jump_targets() {
+
+	int count = instructions.size();
+	jump_target.resize(count + 1);
+	for (int i = 0; i <= count; i++) {
+		jump_target.write[i] = false;
+	}
+
+	for (int i = 0; i < entries.size(); i++) {
+		jump_target.write[entries[i]] = true;
+	}
+
+	for (int i = 0; i < count; i++) {
+		const Instruction &instruction = instructions[i];
+		if (instruction.removed) {
+			continue;
+		}
+		for (int j = 0; j < instruction.size; j++) {
+			if (instruction.layout[j] == OPERAND_JUMP) {
+				jump_target.write[instruction_at[code[instruction.ip + j]]] = true;
+			}
+		}
+	}
+}
+
+void GDScriptOptimizer::_compute_liveness() {
+
+	int count = instructions.size();
+	live_out.resize(count * words);
+	Vector<uint32_t> live_in;
+	live_in.resize(count * words);
+	for (int i = 0; i < count * words; i++) {
+		live_out.write[i] = 0;
+		live_in.write[i] = 0;
+	}
+
+	Vector<uint32_t> in;
+	in.resize(words);
+	Vector<int> successors;
+
+	// Backwards dataflow until nothing changes, loops need more than one run.
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (int i = count - 1; i >= 0; i--) {
+			const Instruction &instruction = instructions[i];
+			if (instruction.removed) {
+				continue;
+			}
+
+			uint32_t *out = live_out.ptrw() + i * words;
+			_get_successors(i, successors);
+			for (int j = 0; j < successors.size(); j++) {
+				if (successors[j] >= count) {
+					continue;
+				}
+				const uint32_t *succ_in = live_in.ptr() + successors[j] * words;
+				for (int k = 0; k < words; k++) {
+					out[k] |= succ_in[k];
+				}
+			}
+
+			uint32_t *w = in.ptrw();
+			for (int k = 0; k < words; k++) {
+				w[k] = out[k];
+			}
+			for (int j = 0; j < instruction.size; j++) {
+				int slot = _get_slot(code[instruction.ip + j]);
+				if (slot != -1 && instruction.layout[j] == OPERAND_WRITE) {
+					w[slot >> 5] &= ~(1 << (slot & 31));
+				}
+			}
+			for (int j = 0; j < instruction.size; j++) {
+				int slot = _get_slot(code[instruction.ip + j]);
+				if (slot != -1 && (instruction.layout[j] == OPERAND_READ || instruction.layout[j] == OPERAND_MODIFY)) {
+					w[slot >> 5] |= 1 << (slot & 31);
+				}
+			}
+
+			uint32_t *current = live_in.ptrw() + i * words;
+			for (int k = 0; k < words; k++) {
+				if (current[k] != w[k]) {
+					current[k] = w[k];
+					changed = true;
+				}
+			}
+		}
+	}
+}
+
+const Variant *GDScriptOptimizer::_get_constant(int p_address) const {
+
+	int index = p_address & GDScriptFunction::ADDR_MASK;
+
+	switch ((p_address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) {
+		case GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT: {
+			if (index < function->constants.size()) {
+				return &function->constants[index];
+			}
+		} break;
+		case GDScriptFunction::ADDR_TYPE_CLASS_CONSTANT: {
+			if (index >= function->global_names.size()) {
+				break;
+			}
+			// Same lookup as the VM, but constants inherited from other
+			// scripts are left alone, those could be reloaded separately.
+			const StringName &name = function->global_names[index];
+			for (GDScript *o = function->_script; o; o = o->_owner) {
+				for (GDScript *s = o; s; s = s->_base) {
+					Map<StringName, Variant>::Element *E = s->constants.find(name);
+					if (E) {
+						return s == o ? &E->get() : NULL;
+					}
+				}
+			}
+		} break;
+	}
+
+	return NULL;
+}
+
+bool GDScriptOptimizer::_is_foldable(const Variant *p_value) {
+
+	// Only math types, as containers and objects can change at runtime.
+	return p_value && p_value->get_type() != Variant::NIL && p_value->get_type() < Variant::NODE_PATH;
+}
+
+int GDScriptOptimizer::_add_constant(const Variant &p_value) {
+
+	for (int i = 0; i < function->constants.size(); i++) {
+		if (function->constants[i].get_type() == p_value.get_type() && function->constants[i] == p_value) {
+			return i;
+		}
+	}
+
+	function->constants.push_back(p_value);
+	return function->constants.size() - 1;
+}
+
+bool GDScriptOptimizer::_fold_constants() {
+
+	bool changed = false;
+
+	for (int i = 0; i < instructions.size(); i++) {
+		if (instructions[i].removed || instructions[i].changed) {
+			continue;
+		}
+		int ip = instructions[i].ip;
+
+		Variant value;
+		bool valid = false;
+		int dst;
+
+		switch (code[ip]) {
+			case GDScriptFunction::OPCODE_OPERATOR:
+			case GDScriptFunction::OPCODE_OPERATOR_TYPED: {
+				int ofs = code[ip] == GDScriptFunction::OPCODE_OPERATOR ? 2 : 3;
+				const Variant *a = _get_constant(code[ip + ofs]);
+				const Variant *b = _get_constant(code[ip + ofs + 1]);
+				Variant::Operator op = (Variant::Operator)code[ip + 1];
+				if (_is_foldable(a) && _is_foldable(b) && op >= 0 && op < Variant::OP_MAX) {
+					// Invalid operations are left for the VM to report.
+					Variant::evaluate(op, *a, *b, value, valid);
+				}
+				dst = code[ip + ofs + 2];
+			} break;
+			case GDScriptFunction::OPCODE_GET_NAMED:
+			case GDScriptFunction::OPCODE_GET_NAMED_TYPED: {
+				int ofs = code[ip] == GDScriptFunction::OPCODE_GET_NAMED ? 1 : 2;
+				const Variant *base = _get_constant(code[ip + ofs]);
+				int name = code[ip + ofs + 1];
+				if (_is_foldable(base) && name >= 0 && name < function->global_names.size()) {
+					value = base->get_named(function->global_names[name], &valid);
+				}
+				dst = code[ip + ofs + 2];
+			} break;
+			default: {
+				continue;
+			}
+		}
+
+		if (!valid) {
+			continue;
+		}
+
+		int constant = _add_constant(value);
+		code.write[ip + 0] = GDScriptFunction::OPCODE_ASSIGN;
+		code.write[ip + 1] = dst;
+		code.write[ip + 2] = constant | (GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT << GDScriptFunction::ADDR_BITS);
+		// The rest of the old instruction is dropped by _compact().
+		Instruction &instruction = instructions.write[i];
+		instruction.size = get_instruction_layout(code.ptr(), ip, code.size(), instruction.layout);
+		instruction.changed = true;
+		changed = true;
+	}
+
+	return changed;
+}
+
+bool GDScriptOptimizer::_forward_constants() {
+
+	bool changed = false;
+	int count = instructions.size();
+
+	for (int i = 0; i < count; i++) {
+		if (instructions[i].removed || instructions[i].changed) {
+			continue;
+		}
+		int ip = instructions[i].ip;
+		if (code[ip] != GDScriptFunction::OPCODE_ASSIGN) {
+			continue;
+		}
+
+		// Sources that nothing can write to.
+		int src = code[ip + 2];
+		switch ((src & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) {
+			case GDScriptFunction::ADDR_TYPE_CLASS_CONSTANT:
+			case GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT:
+			case GDScriptFunction::ADDR_TYPE_NIL: {
+			} break;
+			default: {
+				continue;
+			}
+		}
+
+		int temp = _get_slot(code[ip + 1]);
+		if (temp == -1 || !temporary[temp]) {
+			continue;
+		}
+
+		int user = _get_next(i);
+		if (user >= count || instructions[user].changed) {
+			continue;
+		}
+		bool targeted = false;
+		for (int j = i + 1; j <= user; j++) {
+			targeted = targeted || jump_target[j];
+		}
+		if (targeted) {
+			continue;
+		}
+
+		// The temporary must only be read by the next instruction, which can't modify it.
+		const Instruction &instruction = instructions[user];
+		bool reads = false;
+		bool writes = false;
+		bool modifies = false;
+		for (int j = 0; j < instruction.size; j++) {
+			if (_get_slot(code[instruction.ip + j]) != temp) {
+				continue;
+			}
+			reads = reads || instruction.layout[j] == OPERAND_READ;
+			writes = writes || instruction.layout[j] == OPERAND_WRITE;
+			modifies = modifies || instruction.layout[j] == OPERAND_MODIFY;
+		}
+		if (!reads || modifies || (!writes && _is_live_out(user, temp))) {
+			continue;
+		}
+
+		for (int j = 0; j < instruction.size; j++) {
+			if (instruction.layout[j] == OPERAND_READ && _get_slot(code[instruction.ip + j]) == temp) {
+				code.write[instruction.ip + j] = src;
+			}
+		}
+		instructions.write[user].changed = true;
+		instructions.write[i].removed = true;
+		changed = true;
+	}
+
+	return changed;
+}
+
+bool GDScriptOptimizer::_thread_jumps() {
+
+	bool changed = false;
+	int count = instructions.size();
+
+	for (int i = 0; i < count; i++) {
+		const Instruction &instruction = instructions[i];
+		if (instruction.removed) {
+			continue;
+		}
+		int ip = instruction.ip;
+
+		// A slot whose boolean value is known when taking the jump.
+		int known_slot = -1;
+		bool known_value = false;
+		if (code[ip] == GDScriptFunction::OPCODE_JUMP_IF || code[ip] == GDScriptFunction::OPCODE_JUMP_IF_NOT) {
+			known_slot = _get_slot(code[ip + 1]);
+			known_value = code[ip] == GDScriptFunction::OPCODE_JUMP_IF;
+		} else if (code[ip] == GDScriptFunction::OPCODE_JUMP && i > 0 && !jump_target[i]) {
+			int prev_ip = instructions[i - 1].ip;
+			if (code[prev_ip] == GDScriptFunction::OPCODE_ASSIGN_TRUE || code[prev_ip] == GDScriptFunction::OPCODE_ASSIGN_FALSE) {
+				known_slot = _get_slot(code[prev_ip + 1]);
+				known_value = code[prev_ip] == GDScriptFunction::OPCODE_ASSIGN_TRUE;
+			}
+		}
+
+		for (int j = 0; j < instruction.size; j++) {
+			if (instruction.layout[j] != OPERAND_JUMP) {
+				continue;
+			}
+
+			int target = instruction_at[code[ip + j]];
+			// Bounded, as jumps can form cycles.
+			for (int steps = 0; steps < 32 && target < count; steps++) {
+				int target_ip = instructions[target].ip;
+				int opcode = code[target_ip];
+				int next = -1;
+
+				if (opcode == GDScriptFunction::OPCODE_JUMP) {
+					next = instruction_at[code[target_ip + 1]];
+				} else if ((opcode == GDScriptFunction::OPCODE_JUMP_IF || opcode == GDScriptFunction::OPCODE_JUMP_IF_NOT) && known_slot != -1 && _get_slot(code[target_ip + 1]) == known_slot) {
+					bool taken = known_value == (opcode == GDScriptFunction::OPCODE_JUMP_IF);
+					next = taken ? instruction_at[code[target_ip + 2]] : target + 1;
+				} else if ((opcode == GDScriptFunction::OPCODE_ASSIGN_TRUE || opcode == GDScriptFunction::OPCODE_ASSIGN_FALSE) && target + 1 < count) {
+					// `and`/`or` store their result to a temporary, which is then tested.
+					// Skip both if the temporary isn't needed where the test leads.
+					int slot = _get_slot(code[target_ip + 1]);
+					int test_ip = instructions[target + 1].ip;
+					int test = code[test_ip];
+					if (slot != -1 && temporary[slot] && (test == GDScriptFunction::OPCODE_JUMP_IF || test == GDScriptFunction::OPCODE_JUMP_IF_NOT) && _get_slot(code[test_ip + 1]) == slot) {
+						bool taken = (opcode == GDScriptFunction::OPCODE_ASSIGN_TRUE) == (test == GDScriptFunction::OPCODE_JUMP_IF);
+						int destination = taken ? instruction_at[code[test_ip + 2]] : target + 2;
+						if (!_is_live_in(destination, slot)) {
+							next = destination;
+						}
+					}
+				}
+
+				if (next == -1 || next == target) {
+					break;
+				}
+				target = next;
+			}
+
+			int address = target < count ? instructions[target].ip : code.size();
+			if (address != code[ip + j]) {
+				code.write[ip + j] = address;
+				changed = true;
+			}
+		}
+	}
+
+	return changed;
+}
+
+bool GDScriptOptimizer::_propagate_copies() {
+
+	bool changed = false;
+	int count = instructions.size();
+
+	for (int i = 0; i < count; i++) {
+		if (instructions[i].removed || instructions[i].changed) {
+			continue;
+		}
+		int ip = instructions[i].ip;
+
+		// Whether the result can be stored to one of the operands. For the others,
+		// writing the result may happen before all operands are read.
+		bool alias_safe;
+		switch (code[ip]) {
+			case GDScriptFunction::OPCODE_OPERATOR:
+			case GDScriptFunction::OPCODE_OPERATOR_TYPED:
+			case GDScriptFunction::OPCODE_GET:
+			case GDScriptFunction::OPCODE_GET_POOL_ARRAY:
+			case GDScriptFunction::OPCODE_GET_NAMED:
+			case GDScriptFunction::OPCODE_GET_NAMED_TYPED:
+			case GDScriptFunction::OPCODE_GET_MEMBER:
+			case GDScriptFunction::OPCODE_ASSIGN:
+			case GDScriptFunction::OPCODE_ASSIGN_TRUE:
+			case GDScriptFunction::OPCODE_ASSIGN_FALSE:
+			case GDScriptFunction::OPCODE_YIELD_RESUME: {
+				alias_safe = true;
+			} break;
+			case GDScriptFunction::OPCODE_EXTENDS_TEST:
+			case GDScriptFunction::OPCODE_IS_BUILTIN:
+			case GDScriptFunction::OPCODE_CAST_TO_BUILTIN:
+			case GDScriptFunction::OPCODE_CAST_TO_NATIVE:
+			case GDScriptFunction::OPCODE_CAST_TO_SCRIPT:
+			case GDScriptFunction::OPCODE_CONSTRUCT:
+			case GDScriptFunction::OPCODE_CONSTRUCT_ARRAY:
+			case GDScriptFunction::OPCODE_CONSTRUCT_DICTIONARY:
+			case GDScriptFunction::OPCODE_CALL_RETURN:
+			case GDScriptFunction::OPCODE_CALL_BUILT_IN:
+			case GDScriptFunction::OPCODE_CALL_SELF_BASE: {
+				alias_safe = false;
+			} break;
+			default: {
+				continue;
+			}
+		}
+
+		int written = _get_written_operand(i);
+		if (written == -1) {
+			continue;
+		}
+		int temp = _get_slot(code[ip + written]);
+		if (temp == -1 || !temporary[temp]) {
+			continue;
+		}
+
+		// The result must be copied right away, and not reachable from elsewhere.
+		int copy = _get_next(i);
+		if (copy >= count || instructions[copy].changed) {
+			continue;
+		}
+		int copy_ip = instructions[copy].ip;
+		if (code[copy_ip] != GDScriptFunction::OPCODE_ASSIGN || _get_slot(code[copy_ip + 2]) != temp || _is_live_out(copy, temp)) {
+			continue;
+		}
+		bool targeted = false;
+		for (int j = i + 1; j <= copy; j++) {
+			targeted = targeted || jump_target[j];
+		}
+		if (targeted) {
+			continue;
+		}
+
+		int dst = code[copy_ip + 1];
+		int dst_slot = _get_slot(dst);
+		if (dst_slot == -1 || dst_slot == temp) {
+			continue;
+		}
+
+		if (!alias_safe) {
+			bool aliased = false;
+			for (int j = 0; j < instructions[i].size; j++) {
+				char operand = instructions[i].layout[j];
+				if ((operand == OPERAND_READ || operand == OPERAND_MODIFY) && _get_slot(code[ip + j]) == dst_slot) {
+					aliased = true;
+				}
+			}
+			if (aliased) {
+				continue;
+			}
+		}
+
+		code.write[ip + written] = dst;
+		instructions.write[i].changed = true;
+		instructions.write[copy].removed = true;
+		changed = true;
+	}
+
+	return changed;
+}
+
+bool GDScriptOptimizer::_remove_dead_code() {
+
+	bool changed = false;
+	int count = instructions.size();
+
+	for (int i = 0; i < count; i++) {
+		if (instructions[i].removed || instructions[i].changed) {
+			continue;
+		}
+		int ip = instructions[i].ip;
+
+		switch (code[ip]) {
+			case GDScriptFunction::OPCODE_ASSIGN:
+			case GDScriptFunction::OPCODE_ASSIGN_TRUE:
+			case GDScriptFunction::OPCODE_ASSIGN_FALSE: {
+				// Copies have no side effects, named variables are kept for the debugger.
+				int slot = _get_slot(code[ip + 1]);
+				if (slot == -1 || !temporary[slot] || _is_live_out(i, slot)) {
+					continue;
+				}
+			} break;
+			case GDScriptFunction::OPCODE_JUMP:
+			case GDScriptFunction::OPCODE_JUMP_IF:
+			case GDScriptFunction::OPCODE_JUMP_IF_NOT: {
+				// Jumps to where execution would go anyway.
+				int target = instruction_at[code[ip + instructions[i].size - 1]];
+				if (target < count && instructions[target].removed) {
+					target = _get_next(target);
+				}
+				if (target != _get_next(i)) {
+					continue;
+				}
+			} break;
+			default: {
+				continue;
+			}
+		}
+
+		instructions.write[i].removed = true;
+		changed = true;
+	}
+
+	return changed;
+}
+
+void GDScriptOptimizer::_compact() {
+
+	// Addresses of removed instructions map to the next one kept.
+	Vector<int> remap;
+	remap.resize(code.size() + 1);
+	int size = 0;
+	for (int i = 0; i < instructions.size(); i++) {
+		remap.write[instructions[i].ip] = size;
+		if (!instructions[i].removed) {
+			size += instructions[i].size;
+		}
+	}
+	remap.write[code.size()] = size;
+
+	Vector<int> compacted;
+	compacted.resize(size);
+	int *w = compacted.ptrw();
+	for (int i = 0; i < instructions.size(); i++) {
+		const Instruction &instruction = instructions[i];
+		if (instruction.removed) {
+			continue;
+		}
+		for (int j = 0; j < instruction.size; j++) {
+			int value = code[instruction.ip + j];
+			*w++ = instruction.layout[j] == OPERAND_JUMP ? remap[value] : value;
+		}
+	}
+
+	for (int i = 0; i < function->default_arguments.size(); i++) {
+		function->default_arguments.write[i] = remap[function->default_arguments[i]];
+	}
+
+	code = compacted;
+}
+
+void GDScriptOptimizer::_allocate_slots() {
+
+	// Temporaries read before being written (holding null) keep their slot.
+	Vector<bool> pinned;
+	pinned.resize(slot_count);
+	for (int i = 0; i < slot_count; i++) {
+		pinned.write[i] = !temporary[i];
+		for (int j = 0; j < entries.size() && !pinned[i]; j++) {
+			pinned.write[i] = _is_live_in(entries[j], i);
+		}
+	}
+
+	Vector<bool> used;
+	used.resize(slot_count);
+	for (int i = 0; i < slot_count; i++) {
+		used.write[i] = !temporary[i];
+	}
+	for (int i = 0; i < instructions.size(); i++) {
+		const Instruction &instruction = instructions[i];
+		if (instruction.removed) {
+			continue;
+		}
+		for (int j = 0; j < instruction.size; j++) {
+			int slot = _get_slot(code[instruction.ip + j]);
+			if (slot != -1) {
+				used.write[slot] = true;
+			}
+		}
+	}
+
+	Vector<int> temps;
+	Vector<int> temp_index;
+	temp_index.resize(slot_count);
+	int stack_size = function->_argument_count;
+	for (int i = 0; i < slot_count; i++) {
+		temp_index.write[i] = -1;
+		if (!used[i]) {
+			continue;
+		}
+		if (pinned[i]) {
+			stack_size = MAX(stack_size, i + 1);
+		} else {
+			temp_index.write[i] = temps.size();
+			temps.push_back(i);
+		}
+	}
+
+	// Two temporaries interfere if one is written while the other is live.
+	int temp_count = temps.size();
+	Vector<bool> interference;
+	interference.resize(temp_count * temp_count);
+	for (int i = 0; i < interference.size(); i++) {
+		interference.write[i] = false;
+	}
+	for (int i = 0; i < instructions.size(); i++) {
+		const Instruction &instruction = instructions[i];
+		if (instruction.removed) {
+			continue;
+		}
+		for (int j = 0; j < instruction.size; j++) {
+			if (instruction.layout[j] != OPERAND_WRITE && instruction.layout[j] != OPERAND_MODIFY) {
+				continue;
+			}
+			int slot = _get_slot(code[instruction.ip + j]);
+			if (slot == -1 || temp_index[slot] == -1) {
+				continue;
+			}
+			int a = temp_index[slot];
+			for (int b = 0; b < temp_count; b++) {
+				if (b != a && _is_live_out(i, temps[b])) {
+					interference.write[a * temp_count + b] = true;
+					interference.write[b * temp_count + a] = true;
+				}
+			}
+		}
+	}
+
+	// Greedy, lowest free slot first.
+	Vector<int> assigned;
+	assigned.resize(temp_count);
+	int identity_size = stack_size;
+	int packed_size = stack_size;
+	for (int i = 0; i < temp_count; i++) {
+		identity_size = MAX(identity_size, temps[i] + 1);
+		for (int slot = 0;; slot++) {
+			if (slot < slot_count && pinned[slot]) {
+				continue;
+			}
+			bool free = true;
+			for (int j = 0; j < i && free; j++) {
+				free = assigned[j] != slot || !interference[i * temp_count + j];
+			}
+			if (free) {
+				assigned.write[i] = slot;
+				packed_size = MAX(packed_size, slot + 1);
+				break;
+			}
+		}
+	}
+
+	if (packed_size >= identity_size) {
+		function->_stack_size = identity_size;
+		return;
+	}
+
+	for (int i = 0; i < instructions.size(); i++) {
+		const Instruction &instruction = instructions[i];
+		if (instruction.removed) {
+			continue;
+		}
+		for (int j = 0; j < instruction.size; j++) {
+			int address = code[instruction.ip + j];
+			int slot = _get_slot(address);
+			if (instruction.layout[j] == OPERAND_OTHER || instruction.layout[j] == OPERAND_JUMP || slot == -1 || temp_index[slot] == -1) {
+				continue;
+			}
+			code.write[instruction.ip + j] = (address & GDScriptFunction::ADDR_TYPE_MASK) | assigned[temp_index[slot]];
+		}
+	}
+	function->_stack_size = packed_size;
+}
+
+GDScriptOptimizer::GDScriptOptimizer(GDScriptFunction *p_function) {
+
+	function = p_function;
+	code = p_function->code;
+	slot_count = p_function->_stack_size;
+	words = (slot_count + 31) / 32;
+}
+
+void GDScriptOptimizer::optimize(GDScriptFunction *p_function) {
+
+	ERR_FAIL_NULL(p_function);
+	if (p_function->code.empty()) {
+		return;
+	}
+
+	GDScriptOptimizer optimizer(p_function);
+	ERR_FAIL_COND_MSG(!optimizer._decode(), "Invalid bytecode in function '" + String(p_function->name) + "', not optimizing it.");
+	optimizer._find_temporaries();
+
+	for (int pass = 0;; pass++) {
+		bool changed = optimizer._remove_unreachable();
+		optimizer._find_jump_targets();
+		optimizer._compute_liveness();
+		if (pass == MAX_PASSES) {
+			break;
+		}
+
+		changed = optimizer._thread_jumps() || changed;
+		changed = optimizer._fold_constants() || changed;
+		changed = optimizer._forward_constants() || changed;
+		changed = optimizer._propagate_copies() || changed;
+		changed = optimizer._remove_dead_code() || changed;
+		if (!changed) {
+			break;
+		}
+
+		optimizer._compact();
+		optimizer._decode();
+	}
+
+	optimizer._allocate_slots();
+	optimizer._compact();
+
+	p_function->code = optimizer.code;
+	p_function->_code_ptr = p_function->code.ptr();
+	p_function->_code_size = p_function->code.size();
+
+	if (p_function->constants.size()) {
+		p_function->_constants_ptr = p_function->constants.ptrw();
+		p_function->_constant_count = p_function->constants.size();
+	}
+	if (p_function->default_arguments.size()) {
+		p_function->_default_arg_ptr = p_function->default_arguments.ptr();
+	}
+}
@@ -0,0 +1,121 @@
+/*************************************************************************/
+/*  gdscript_optimizer.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_OPTIMIZER_H
+#define GDSCRIPT_OPTIMIZER_H
+
+#include "gdscript_function.h"
+
+/**
+ * Optimization passes run over the bytecode of a function once the compiler is
+ * done with it. The compiler emits code straight from the syntax tree, so every
+ * expression goes through its own temporary stack slot, and control flow
+ * statements leave chains of jumps behind. This removes what's left of that:
+ *
+ * - Named access on constant math values (e.g. `CONST_VECTOR.x`) and operators
+ *   between them are folded into new constants, so they aren't evaluated in
+ *   loops anymore. Constants copied to a temporary are read directly instead.
+ * - Jumps to jumps, and to conditions whose outcome is already known (as in
+ *   `and`/`or` chains), are threaded to their final destination.
+ * - Results stored to a temporary and copied right away to a local are stored
+ *   to the local directly (copy propagation).
+ * - Copies to temporaries that are never read afterwards, unreachable code and
+ *   jumps to the next instruction are removed.
+ * - Temporaries whose lifetimes don't overlap share stack slots, which lowers
+ *   the stack size allocated by each call.
+ *
+ * Slots of named variables are left alone, so the debugger still sees them.
+ */
+class GDScriptOptimizer {
+public:
+	// Kinds of operands in an instruction layout.
+	enum Operand {
+		OPERAND_OTHER = '-', // Opcode, name index, type, argument count...
+		OPERAND_READ = 'r',
+		OPERAND_WRITE = 'w',
+		OPERAND_MODIFY = 'm', // Read, and possibly written (e.g. base of a call or loop counter).
+		OPERAND_UNUSED = 'u', // Address the instruction ignores.
+		OPERAND_JUMP = 'j',
+	};
+
+private:
+	struct Instruction {
+		int ip;
+		int size;
+		Vector<char> layout;
+		bool removed;
+		bool changed;
+	};
+
+	GDScriptFunction *function;
+	Vector<int> code;
+	Vector<Instruction> instructions;
+	Vector<int> instruction_at; // Index of the instruction starting at each address, -1 inside instructions.
+	Vector<int> entries; // Instructions where execution can start: 0 and default argument addresses.
+	Vector<bool> jump_target; // Per instruction, whether something other than the previous instruction leads to it.
+	Vector<bool> temporary; // Per stack slot, whether it only holds compiler temporaries.
+	int slot_count;
+	int words;
+	Vector<uint32_t> live_out; // Per instruction, bitset of slots read later on.
+
+	static int _get_slot(int p_address);
+	static bool _is_foldable(const Variant *p_value);
+	const Variant *_get_constant(int p_address) const; // NULL unless known at compile time.
+	int _add_constant(const Variant &p_value);
+	_FORCE_INLINE_ bool _is_live_out(int p_index, int p_slot) const { return live_out[p_index * words + (p_slot >> 5)] & (1 << (p_slot & 31)); }
+	bool _is_live_in(int p_index, int p_slot) const;
+	int _get_next(int p_index) const;
+	int _get_written_operand(int p_index) const; // Offset of the only operand written, or -1.
+	void _get_successors(int p_index, Vector<int> &r_successors) const;
+
+	bool _decode();
+	void _find_temporaries();
+	bool _remove_unreachable();
+	void _find_jump_targets();
+	void _compute_liveness();
+	bool _fold_constants();
+	bool _forward_constants();
+	bool _thread_jumps();
+	bool _propagate_copies();
+	bool _remove_dead_code();
+	void _compact();
+	void _allocate_slots();
+
+	GDScriptOptimizer(GDScriptFunction *p_function);
+
+public:
+	// Size of the instruction at p_ip, filling r_layout with the kind of each
+	// of its operands (the opcode included). Returns -1 for invalid code.
+	static int get_instruction_layout(const int *p_code, int p_ip, int p_code_size, Vector<char> &r_layout);
+
+	static void optimize(GDScriptFunction *p_function);
+};
+
+#endif // GDSCRIPT_OPTIMIZER_H
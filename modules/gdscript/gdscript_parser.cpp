@@ -490,7 +490,7 @@ GDScriptParser::Node *GDScriptParser::_parse_expression(Node *p_parent, bool p_s
 
 			Ref<Resource> res;
 			dependencies.push_back(path);
-			if (!dependencies_only) {
+			if (!dependencies_only && !deferred) {
 				if (!validating) {
 
 					//this can be too slow for just validating code
@@ -531,6 +531,13 @@ GDScriptParser::Node *GDScriptParser::_parse_expression(Node *p_parent, bool p_s
 			constant->value = res;
 			constant->datatype = _type_from_variant(constant->value);
 
+			if (deferred) {
+				DeferredPreload preload;
+				preload.constant = constant;
+				preload.path = path;
+				deferred_preloads.push_back(preload);
+			}
+
 			expr = constant;
 		} else if (tokenizer->get_token() == GDScriptTokenizer::TK_PR_YIELD) {
 
@@ -810,6 +817,12 @@ GDScriptParser::Node *GDScriptParser::_parse_expression(Node *p_parent, bool p_s
 			}
 
 			if (!bfn && p_parsing_constant) {
+				// The loading thread can add globals meanwhile.
+				Mutex *globals_lock = deferred ? GDScriptLanguage::get_singleton()->lock : NULL;
+				if (globals_lock) {
+					globals_lock->lock();
+				}
+
 				if (cln->constant_expressions.has(identifier)) {
 					expr = cln->constant_expressions[identifier].expression;
 					bfn = true;
@@ -831,7 +844,11 @@ GDScriptParser::Node *GDScriptParser::_parse_expression(Node *p_parent, bool p_s
 					bfn = true;
 				}
 
-				if (!dependencies_only) {
+				if (globals_lock) {
+					globals_lock->unlock();
+				}
+
+				if (!dependencies_only && !deferred) {
 					if (!bfn && ScriptServer::is_global_class(identifier)) {
 						Ref<Script> scr = ResourceLoader::load(ScriptServer::get_global_class_path(identifier));
 						if (scr.is_valid() && scr->is_valid()) {
@@ -1640,7 +1657,7 @@ GDScriptParser::Node *GDScriptParser::_reduce_expression(Node *p_node, bool p_to
 			for (int i = 0; i < an->elements.size(); i++) {
 
 				an->elements.write[i] = _reduce_expression(an->elements[i], p_to_const);
-				if (an->elements[i]->type != Node::TYPE_CONSTANT)
+				if (an->elements[i]->type != Node::TYPE_CONSTANT || _is_deferred_constant(an->elements[i]))
 					all_constants = false;
 			}
 
@@ -1670,10 +1687,10 @@ GDScriptParser::Node *GDScriptParser::_reduce_expression(Node *p_node, bool p_to
 			for (int i = 0; i < dn->elements.size(); i++) {
 
 				dn->elements.write[i].key = _reduce_expression(dn->elements[i].key, p_to_const);
-				if (dn->elements[i].key->type != Node::TYPE_CONSTANT)
+				if (dn->elements[i].key->type != Node::TYPE_CONSTANT || _is_deferred_constant(dn->elements[i].key))
 					all_constants = false;
 				dn->elements.write[i].value = _reduce_expression(dn->elements[i].value, p_to_const);
-				if (dn->elements[i].value->type != Node::TYPE_CONSTANT)
+				if (dn->elements[i].value->type != Node::TYPE_CONSTANT || _is_deferred_constant(dn->elements[i].value))
 					all_constants = false;
 			}
 
@@ -1706,7 +1723,7 @@ GDScriptParser::Node *GDScriptParser::_reduce_expression(Node *p_node, bool p_to
 			for (int i = 0; i < op->arguments.size(); i++) {
 
 				op->arguments.write[i] = _reduce_expression(op->arguments[i], p_to_const);
-				if (op->arguments[i]->type != Node::TYPE_CONSTANT) {
+				if (op->arguments[i]->type != Node::TYPE_CONSTANT || _is_deferred_constant(op->arguments[i])) {
 					all_constants = false;
 					last_not_constant = i;
 				}
@@ -1827,7 +1844,7 @@ GDScriptParser::Node *GDScriptParser::_reduce_expression(Node *p_node, bool p_to
 
 			} else if (op->op == OperatorNode::OP_INDEX_NAMED) {
 
-				if (op->arguments[0]->type == Node::TYPE_CONSTANT && op->arguments[1]->type == Node::TYPE_IDENTIFIER) {
+				if (op->arguments[0]->type == Node::TYPE_CONSTANT && !_is_deferred_constant(op->arguments[0]) && op->arguments[1]->type == Node::TYPE_IDENTIFIER) {
 
 					ConstantNode *ca = static_cast<ConstantNode *>(op->arguments[0]);
 					IdentifierNode *ib = static_cast<IdentifierNode *>(op->arguments[1]);
@@ -4483,7 +4500,7 @@ void GDScriptParser::_parse_class(ClassNode *p_class) {
 						}
 						parenthesis--;
 
-						if (subexpr->type != Node::TYPE_CONSTANT) {
+						if (subexpr->type != Node::TYPE_CONSTANT || _is_deferred_constant(subexpr)) {
 							current_export = PropertyInfo();
 							_set_error("Expected a constant expression.");
 						}
@@ -4815,6 +4832,12 @@ void GDScriptParser::_parse_class(ClassNode *p_class) {
 
 					member.expression = subexpr;
 
+					if (_is_deferred_constant(subexpr) && (autoexport || member._export.type != Variant::NIL || member.data_type.has_type)) {
+						// The default value is taken from the resource right away.
+						_set_error("Can't use a preload as default value before it is loaded.");
+						return;
+					}
+
 					if (autoexport && !member.data_type.has_type) {
 
 						if (subexpr->type != Node::TYPE_CONSTANT) {
@@ -5129,7 +5152,7 @@ void GDScriptParser::_parse_class(ClassNode *p_class) {
 								return;
 							}
 
-							if (subexpr->type != Node::TYPE_CONSTANT) {
+							if (subexpr->type != Node::TYPE_CONSTANT || _is_deferred_constant(subexpr)) {
 								_set_error("Expected a constant expression.");
 								return;
 							}
@@ -8427,6 +8450,20 @@ bool GDScriptParser::has_error() const {
 	return error_set;
 }
 
+bool GDScriptParser::_is_deferred_constant(const Node *p_node) const {
+
+	if (!deferred || p_node->type != Node::TYPE_CONSTANT) {
+		return false;
+	}
+
+	for (int i = 0; i < deferred_preloads.size(); i++) {
+		if (deferred_preloads[i].constant == p_node) {
+			return true;
+		}
+	}
+	return false;
+}
+
 Error GDScriptParser::_parse(const String &p_base_path) {
 
 	base_path = p_base_path;
@@ -8450,10 +8487,17 @@ Error GDScriptParser::_parse(const String &p_base_path) {
 		return ERR_PARSE_ERROR;
 	}
 
-	if (dependencies_only) {
+	if (dependencies_only || deferred) {
 		return OK;
 	}
 
+	return _resolve();
+}
+
+Error GDScriptParser::_resolve() {
+
+	ClassNode *main_class = static_cast<ClassNode *>(head);
+
 	_determine_inheritance(main_class);
 
 	if (error_set) {
@@ -8532,6 +8576,64 @@ Error GDScriptParser::parse_bytecode(const Vector<uint8_t> &p_bytecode, const St
 	return ret;
 }
 
+Error GDScriptParser::parse_recorded(GDScriptTokenizerRecorded *p_tokenizer, const String &p_base_path, const String &p_self_path) {
+
+	clear();
+
+	self_path = p_self_path;
+	tokenizer = p_tokenizer;
+	Error ret = _parse(p_base_path);
+	tokenizer = NULL;
+	return ret;
+}
+
+Error GDScriptParser::parse_deferred(GDScriptTokenizerRecorded *p_tokenizer, const String &p_base_path, const String &p_self_path) {
+
+	clear();
+
+	self_path = p_self_path;
+	deferred = true;
+	tokenizer = p_tokenizer;
+	Error ret = _parse(p_base_path);
+	if (ret != OK) {
+		deferred = false;
+		tokenizer = NULL;
+	}
+	return ret;
+}
+
+Error GDScriptParser::resolve_deferred() {
+
+	ERR_FAIL_COND_V(!deferred, ERR_UNCONFIGURED);
+	deferred = false;
+
+	// Same order the preloads would have been loaded in while parsing.
+	for (int i = 0; i < deferred_preloads.size(); i++) {
+
+		const DeferredPreload &preload = deferred_preloads[i];
+
+		Ref<Resource> res = ResourceLoader::load(preload.path);
+		if (!res.is_valid()) {
+			_set_error("Can't preload resource at path: " + preload.path, preload.constant->line);
+			break;
+		}
+
+		Ref<GDScript> gds = res;
+		if (gds.is_valid() && !gds->is_valid()) {
+			_set_error("Couldn't fully preload the script, possible cyclic reference or compilation error. Use \"load()\" instead if a cyclic reference is intended.", preload.constant->line);
+			break;
+		}
+
+		preload.constant->value = res;
+		preload.constant->datatype = _type_from_variant(res);
+	}
+	deferred_preloads.clear();
+
+	Error ret = error_set ? ERR_PARSE_ERROR : _resolve();
+	tokenizer = NULL;
+	return ret;
+}
+
 Error GDScriptParser::parse(const String &p_code, const String &p_base_path, bool p_just_validate, const String &p_self_path, bool p_for_completion, Set<int> *r_safe_lines, bool p_dependencies_only) {
 
 	clear();
@@ -8601,6 +8703,8 @@ void GDScriptParser::clear() {
 	check_types = true;
 	dependencies_only = false;
 	dependencies.clear();
+	deferred = false;
+	deferred_preloads.clear();
 	error = "";
 #ifdef DEBUG_ENABLED
 	safe_lines = NULL;
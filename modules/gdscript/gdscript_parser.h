@@ -542,6 +542,15 @@ private:
 	bool check_types;
 	bool dependencies_only;
 	List<String> dependencies;
+
+	// Preloads left for resolve_deferred(), the constant nodes hold a null value until then.
+	struct DeferredPreload {
+		ConstantNode *constant;
+		String path;
+	};
+
+	bool deferred;
+	Vector<DeferredPreload> deferred_preloads;
 #ifdef DEBUG_ENABLED
 	Set<int> *safe_lines;
 #endif // DEBUG_ENABLED
@@ -655,7 +664,10 @@ private:
 #endif // DEBUG_ENABLED
 	}
 
+	bool _is_deferred_constant(const Node *p_node) const;
+
 	Error _parse(const String &p_base_path);
+	Error _resolve();
 
 public:
 	bool has_error() const;
@@ -667,6 +679,12 @@ public:
 #endif // DEBUG_ENABLED
 	Error parse(const String &p_code, const String &p_base_path = "", bool p_just_validate = false, const String &p_self_path = "", bool p_for_completion = false, Set<int> *r_safe_lines = NULL, bool p_dependencies_only = false);
 	Error parse_bytecode(const Vector<uint8_t> &p_bytecode, const String &p_base_path = "", const String &p_self_path = "");
+	Error parse_recorded(GDScriptTokenizerRecorded *p_tokenizer, const String &p_base_path = "", const String &p_self_path = "");
+	// Syntax pass only, without loading any resource or reading the language globals, so it can
+	// run on any thread. Fails wherever the script needs a preloaded resource to be parsed, and
+	// resolve_deferred() must then finish it on the loading thread. p_tokenizer must outlive both.
+	Error parse_deferred(GDScriptTokenizerRecorded *p_tokenizer, const String &p_base_path, const String &p_self_path);
+	Error resolve_deferred();
 
 	bool is_tool_script() const;
 	const Node *get_parse_tree() const;
@@ -0,0 +1,333 @@
+/*************************************************************************/
+/*  gdscript_preparser.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_preparser.h"
+
+#include "core/class_db.h"
+#include "core/io/resource_loader.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/project_settings.h"
+#include "gdscript.h"
+#include "gdscript_parser.h"
+#include "gdscript_tokenizer.h"
+
+void GDScriptPreparser::_preparse_func(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+
+	GDScriptPreparser *self = (GDScriptPreparser *)p_userdata;
+	for (uint32_t i = p_from; i < p_to; i++) {
+		Entry &e = self->entries[i];
+		if (atomic_increment(&e.claimed) == 1) {
+			_preparse(e);
+		}
+	}
+}
+
+void GDScriptPreparser::_preparse(Entry &r_entry) {
+
+	Preparsed &pp = r_entry.preparsed;
+	String extension = r_entry.file.get_extension();
+
+	if (extension == "gdc" || extension == "gde") {
+		if (GDScript::read_byte_code(r_entry.file, pp.bytecode) != OK) {
+			pp.bytecode.clear();
+		}
+	} else if (GDScript::read_source_code(r_entry.file, pp.source) == OK && pp.source.find("%BASE%") == -1) {
+		pp.tokens = memnew(GDScriptTokenizerRecorded);
+		pp.tokens->record(pp.source);
+
+		// Scripts that can't be parsed this way are parsed from the tokens on the loading thread.
+		pp.parser = memnew(GDScriptParser);
+		if (pp.parser->parse_deferred(pp.tokens, r_entry.path.get_base_dir(), r_entry.path) != OK) {
+			memdelete(pp.parser);
+			pp.parser = NULL;
+		}
+	}
+
+	atomic_release_fence();
+	r_entry.ready = true;
+}
+
+void GDScriptPreparser::_free(Preparsed &r_preparsed) {
+
+	// The parser reads from the tokens, free it first.
+	if (r_preparsed.parser) {
+		memdelete(r_preparsed.parser);
+		r_preparsed.parser = NULL;
+	}
+	if (r_preparsed.tokens) {
+		memdelete(r_preparsed.tokens);
+		r_preparsed.tokens = NULL;
+	}
+	r_preparsed.source = String();
+	r_preparsed.bytecode.clear();
+}
+
+void GDScriptPreparser::_find_project_scripts(const String &p_dir, Set<String> &r_paths) {
+
+	DirAccessRef da = DirAccess::open(p_dir);
+	if (!da) {
+		return;
+	}
+
+	if (da->file_exists(".gdignore")) {
+		return;
+	}
+
+	da->list_dir_begin();
+	String f = da->get_next();
+	while (f != String()) {
+
+		if (f.begins_with(".")) {
+			//navigational, hidden and import folders
+		} else if (da->current_is_dir()) {
+			_find_project_scripts(p_dir.plus_file(f), r_paths);
+		} else if (f.get_extension() == "gd") {
+			r_paths.insert(p_dir.plus_file(f));
+		} else if (f.ends_with(".gd.remap")) {
+			// Exported, the script is loaded from the file it's remapped to.
+			r_paths.insert(p_dir.plus_file(f.get_basename()));
+		}
+		f = da->get_next();
+	}
+	da->list_dir_end();
+}
+
+void GDScriptPreparser::_find_dependency_scripts(const String &p_path, Set<String> &r_visited, Set<String> &r_paths) {
+
+	if (r_visited.has(p_path)) {
+		return;
+	}
+	r_visited.insert(p_path);
+
+	if (p_path.get_extension() == "gd") {
+		// Dependencies of a script are only known by parsing it, which is
+		// what is being avoided here, so stop at scripts.
+		r_paths.insert(p_path);
+		return;
+	}
+
+	String type = ResourceLoader::get_resource_type(p_path);
+	if (!ClassDB::class_exists(type) || ClassDB::is_parent_class(type, "Script")) {
+		return;
+	}
+
+	List<String> dependencies;
+	ResourceLoader::get_dependencies(p_path, &dependencies);
+	for (List<String>::Element *E = dependencies.front(); E; E = E->next()) {
+		_find_dependency_scripts(E->get(), r_visited, r_paths);
+	}
+}
+
+void GDScriptPreparser::start(Mode p_mode) {
+
+	ERR_FAIL_COND(entries);
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (p_mode == MODE_DISABLED || !pool || pool->get_thread_count() == 0) {
+		return;
+	}
+
+	Set<String> paths;
+
+	if (p_mode == MODE_PROJECT) {
+		_find_project_scripts("res://", paths);
+	} else {
+		Set<String> visited;
+
+		String main_scene = GLOBAL_GET("application/run/main_scene");
+		if (main_scene != String()) {
+			_find_dependency_scripts(main_scene, visited, paths);
+		}
+
+		List<PropertyInfo> props;
+		ProjectSettings::get_singleton()->get_property_list(&props);
+		for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
+
+			String s = E->get().name;
+			if (!s.begins_with("autoload/"))
+				continue;
+			String path = ProjectSettings::get_singleton()->get(s);
+			if (path.begins_with("*")) {
+				path = path.substr(1, path.length() - 1);
+			}
+			_find_dependency_scripts(path, visited, paths);
+		}
+
+		// Named classes are loaded by whatever script mentions them.
+		if (ProjectSettings::get_singleton()->has_setting("_global_script_classes")) {
+			Array classes = ProjectSettings::get_singleton()->get("_global_script_classes");
+			for (int i = 0; i < classes.size(); i++) {
+				Dictionary c = classes[i];
+				if (c.has("path")) {
+					_find_dependency_scripts(c["path"], visited, paths);
+				}
+			}
+		}
+	}
+
+	if (paths.empty()) {
+		return;
+	}
+
+	entry_count = paths.size();
+	entries = memnew_arr(Entry, entry_count);
+
+	uint32_t idx = 0;
+	for (Set<String>::Element *E = paths.front(); E; E = E->next()) {
+
+		Entry &e = entries[idx];
+		e.path = E->get();
+		e.file = ResourceLoader::path_remap(e.path);
+		e.claimed = 0;
+		e.taken = 0;
+		e.ready = false;
+		entry_indices[e.path] = idx;
+		idx++;
+	}
+
+	group = pool->add_group(_preparse_func, this, entry_count);
+}
+
+void GDScriptPreparser::wait() {
+
+	if (group != WorkerThreadPool::INVALID_GROUP_ID) {
+		WorkerThreadPool::get_singleton()->wait_for_group(group);
+		group = WorkerThreadPool::INVALID_GROUP_ID;
+	}
+}
+
+void GDScriptPreparser::release() {
+
+	if (released) {
+		return;
+	}
+
+	wait();
+
+	// Taking them first keeps a load on another thread from getting them meanwhile.
+	for (uint32_t i = 0; i < entry_count; i++) {
+		if (atomic_increment(&entries[i].taken) == 1) {
+			_free(entries[i].preparsed);
+		}
+	}
+
+	released = true;
+}
+
+bool GDScriptPreparser::take(const String &p_path, const String &p_file, Preparsed &r_preparsed) {
+
+	if (!entries) {
+		return false;
+	}
+
+	const uint32_t *idx = entry_indices.getptr(p_path);
+	if (!idx) {
+		return false;
+	}
+
+	Entry &e = entries[*idx];
+	if (e.file != p_file) {
+		return false;
+	}
+
+	if (atomic_increment(&e.taken) != 1) {
+		return false; //loaded before, the file may have changed since
+	}
+
+	if (atomic_increment(&e.claimed) == 1) {
+		// No worker got to it yet, cheaper to do it here than to wait.
+		_preparse(e);
+	} else {
+		while (!e.ready) {
+			OS::get_singleton()->delay_usec(10);
+		}
+		atomic_acquire_fence();
+	}
+
+	if (!e.preparsed.tokens && e.preparsed.bytecode.empty()) {
+		_free(e.preparsed);
+		return false;
+	}
+
+	r_preparsed = e.preparsed;
+	e.preparsed = Preparsed();
+
+	if (r_preparsed.parser) {
+		// Link in dependency order: the scripts this one extends or preloads get
+		// compiled before it, from their own preparsed trees. Cycles end at
+		// scripts that are taken already.
+		for (const List<String>::Element *E = r_preparsed.parser->get_dependencies().front(); E; E = E->next()) {
+
+			String dependency = E->get();
+			if (dependency.is_rel_path()) {
+				dependency = p_path.get_base_dir().plus_file(dependency).simplify_path(); // "extends" keeps the path as written
+			}
+
+			const uint32_t *dep_idx = entry_indices.getptr(dependency);
+			if (dep_idx && !entries[*dep_idx].taken) {
+				ResourceLoader::load(dependency);
+			}
+		}
+	}
+
+	return true;
+}
+
+void GDScriptPreparser::clear() {
+
+	wait();
+
+	for (uint32_t i = 0; i < entry_count; i++) {
+		_free(entries[i].preparsed);
+	}
+	if (entries) {
+		memdelete_arr(entries);
+	}
+
+	entries = NULL;
+	entry_count = 0;
+	entry_indices.clear();
+	released = false;
+}
+
+GDScriptPreparser::GDScriptPreparser() {
+
+	entries = NULL;
+	entry_count = 0;
+	group = WorkerThreadPool::INVALID_GROUP_ID;
+	released = false;
+}
+
+GDScriptPreparser::~GDScriptPreparser() {
+
+	clear();
+}
@@ -0,0 +1,108 @@
+/*************************************************************************/
+/*  gdscript_preparser.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_PREPARSER_H
+#define GDSCRIPT_PREPARSER_H
+
+#include "core/hash_map.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/set.h"
+#include "core/ustring.h"
+#include "core/vector.h"
+
+class GDScriptParser;
+class GDScriptTokenizerRecorded;
+
+// Reads, tokenizes and parses the scripts a project is expected to load at
+// startup on the worker thread pool. Parsing on a worker stops short of
+// anything that loads resources (see GDScriptParser::parse_deferred()), the
+// loader resolves and compiles the tree when the script is loaded. Scripts
+// are compiled in dependency order, preparsed scripts a script depends on are
+// loaded before it. Exported byte code files are only read (and decrypted)
+// ahead of time, what they hold is mostly compiled already.
+class GDScriptPreparser {
+public:
+	enum Mode {
+		MODE_DISABLED,
+		MODE_MAIN_SCENE,
+		MODE_PROJECT,
+	};
+
+	struct Preparsed {
+		String source;
+		GDScriptTokenizerRecorded *tokens;
+		GDScriptParser *parser; // Parsed from tokens, NULL if the script needs the loading thread for it.
+		Vector<uint8_t> bytecode; // Byte code files only.
+
+		Preparsed() {
+			tokens = NULL;
+			parser = NULL;
+		}
+	};
+
+private:
+	struct Entry {
+		String path;
+		String file; // After remapping, what the loader opens.
+		Preparsed preparsed;
+		uint32_t claimed; //whoever gets it first does the work, worker or loader
+		uint32_t taken;
+		volatile bool ready;
+	};
+
+	Entry *entries;
+	uint32_t entry_count;
+	HashMap<String, uint32_t> entry_indices;
+	WorkerThreadPool::GroupID group;
+	bool released;
+
+	static void _preparse_func(void *p_userdata, uint32_t p_from, uint32_t p_to);
+	static void _preparse(Entry &r_entry);
+	static void _free(Preparsed &r_preparsed);
+
+	static void _find_project_scripts(const String &p_dir, Set<String> &r_paths);
+	static void _find_dependency_scripts(const String &p_path, Set<String> &r_visited, Set<String> &r_paths);
+
+public:
+	void start(Mode p_mode);
+	void wait();
+	// Waits for the workers and frees whatever wasn't taken yet, for once startup is done.
+	void release();
+	// Hands over what was preparsed for p_path, if it wasn't taken before and p_file is still
+	// what it loads from. Loads the preparsed scripts the parsed tree depends on first. The
+	// caller owns the tokens and parser in r_preparsed afterwards.
+	bool take(const String &p_path, const String &p_file, Preparsed &r_preparsed);
+	void clear();
+
+	GDScriptPreparser();
+	~GDScriptPreparser();
+};
+
+#endif // GDSCRIPT_PREPARSER_H
@@ -1189,6 +1189,159 @@ void GDScriptTokenizerText::advance(int p_amount) {
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void GDScriptTokenizerRecorded::record(const String &p_code) {
+
+	identifiers.clear();
+	constants.clear();
+	tokens.clear();
+	token = 0;
+
+	GDScriptTokenizerText tt;
+	tt.set_code(p_code);
+
+	while (true) {
+
+		TokenData td;
+		td.type = tt.get_token();
+		td.line = tt.get_token_line();
+		td.column = tt.get_token_column();
+		td.value = 0;
+		td.tab_indent = 0;
+
+		switch (td.type) {
+
+			case TK_IDENTIFIER: {
+				td.value = identifiers.size();
+				identifiers.push_back(tt.get_token_identifier());
+			} break;
+			case TK_CONSTANT: {
+				td.value = constants.size();
+				constants.push_back(tt.get_token_constant());
+			} break;
+			case TK_BUILT_IN_TYPE: {
+				td.value = tt.get_token_type();
+			} break;
+			case TK_BUILT_IN_FUNC: {
+				td.value = tt.get_token_built_in_func();
+			} break;
+			case TK_NEWLINE: {
+				td.value = tt.get_token_line_indent();
+				td.tab_indent = tt.get_token_line_tab_indent();
+			} break;
+			case TK_ERROR: {
+				td.value = constants.size();
+				constants.push_back(tt.get_token_error());
+			} break;
+			default: {
+			}
+		}
+
+		tokens.push_back(td);
+
+		if (td.type == TK_EOF || td.type == TK_ERROR)
+			break; //the text tokenizer repeats these forever
+		tt.advance();
+	}
+
+#ifdef DEBUG_ENABLED
+	warning_skips = tt.get_warning_skips();
+	warning_global_skips = tt.get_warning_global_skips();
+	ignore_warnings = tt.is_ignoring_warnings();
+#endif // DEBUG_ENABLED
+}
+
+const GDScriptTokenizerRecorded::TokenData *GDScriptTokenizerRecorded::_get_token_data(int p_offset) const {
+
+	static const TokenData empty = { TK_EMPTY, 0, 0, 0, 0 };
+
+	int offset = token + p_offset;
+	if (offset < 0 || tokens.empty())
+		return &empty;
+	if (offset >= tokens.size())
+		offset = tokens.size() - 1;
+	return &tokens[offset];
+}
+
+GDScriptTokenizer::Token GDScriptTokenizerRecorded::get_token(int p_offset) const {
+
+	return _get_token_data(p_offset)->type;
+}
+
+StringName GDScriptTokenizerRecorded::get_token_identifier(int p_offset) const {
+
+	const TokenData *td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td->type != TK_IDENTIFIER, StringName());
+	return identifiers[td->value];
+}
+
+GDScriptFunctions::Function GDScriptTokenizerRecorded::get_token_built_in_func(int p_offset) const {
+
+	const TokenData *td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td->type != TK_BUILT_IN_FUNC, GDScriptFunctions::FUNC_MAX);
+	return GDScriptFunctions::Function(td->value);
+}
+
+Variant::Type GDScriptTokenizerRecorded::get_token_type(int p_offset) const {
+
+	const TokenData *td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td->type != TK_BUILT_IN_TYPE, Variant::NIL);
+	return Variant::Type(td->value);
+}
+
+int GDScriptTokenizerRecorded::get_token_line(int p_offset) const {
+
+	return _get_token_data(p_offset)->line;
+}
+
+int GDScriptTokenizerRecorded::get_token_column(int p_offset) const {
+
+	return _get_token_data(p_offset)->column;
+}
+
+int GDScriptTokenizerRecorded::get_token_line_indent(int p_offset) const {
+
+	const TokenData *td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td->type != TK_NEWLINE, 0);
+	return td->value;
+}
+
+int GDScriptTokenizerRecorded::get_token_line_tab_indent(int p_offset) const {
+
+	const TokenData *td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td->type != TK_NEWLINE, 0);
+	return td->tab_indent;
+}
+
+const Variant &GDScriptTokenizerRecorded::get_token_constant(int p_offset) const {
+
+	const TokenData *td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td->type != TK_CONSTANT, nil);
+	return constants[td->value];
+}
+
+String GDScriptTokenizerRecorded::get_token_error(int p_offset) const {
+
+	const TokenData *td = _get_token_data(p_offset);
+	ERR_FAIL_COND_V(td->type != TK_ERROR, String());
+	return constants[td->value];
+}
+
+void GDScriptTokenizerRecorded::advance(int p_amount) {
+
+	ERR_FAIL_COND(p_amount <= 0);
+	token += p_amount; //reading past the end repeats the last token, like the text tokenizer
+}
+
+GDScriptTokenizerRecorded::GDScriptTokenizerRecorded() {
+
+	token = 0;
+#ifdef DEBUG_ENABLED
+	ignore_warnings = false;
+#endif // DEBUG_ENABLED
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
 #define BYTECODE_VERSION 13
 
 Error GDScriptTokenizerBuffer::set_code_buffer(const Vector<uint8_t> &p_buffer) {
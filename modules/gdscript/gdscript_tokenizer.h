@@ -252,6 +252,52 @@ public:
 #endif // DEBUG_ENABLED
 };
 
+// Holds the complete token stream of a GDScriptTokenizerText, so source can be
+// tokenized ahead of time (possibly on another thread) and parsed later on.
+class GDScriptTokenizerRecorded : public GDScriptTokenizer {
+
+	struct TokenData {
+		Token type;
+		int line, column;
+		int value; //identifier or constant index, type, function or line indent
+		int tab_indent;
+	};
+
+	Vector<StringName> identifiers;
+	Vector<Variant> constants; //also holds error messages
+	Vector<TokenData> tokens;
+	Variant nil;
+	int token;
+
+#ifdef DEBUG_ENABLED
+	Vector<Pair<int, String> > warning_skips;
+	Set<String> warning_global_skips;
+	bool ignore_warnings;
+#endif // DEBUG_ENABLED
+
+	_FORCE_INLINE_ const TokenData *_get_token_data(int p_offset) const;
+
+public:
+	void record(const String &p_code);
+	virtual Token get_token(int p_offset = 0) const;
+	virtual StringName get_token_identifier(int p_offset = 0) const;
+	virtual GDScriptFunctions::Function get_token_built_in_func(int p_offset = 0) const;
+	virtual Variant::Type get_token_type(int p_offset = 0) const;
+	virtual int get_token_line(int p_offset = 0) const;
+	virtual int get_token_column(int p_offset = 0) const;
+	virtual int get_token_line_indent(int p_offset = 0) const;
+	virtual int get_token_line_tab_indent(int p_offset = 0) const;
+	virtual const Variant &get_token_constant(int p_offset = 0) const;
+	virtual String get_token_error(int p_offset = 0) const;
+	virtual void advance(int p_amount = 1);
+#ifdef DEBUG_ENABLED
+	virtual const Vector<Pair<int, String> > &get_warning_skips() const { return warning_skips; }
+	virtual const Set<String> &get_warning_global_skips() const { return warning_global_skips; }
+	virtual bool is_ignoring_warnings() const { return ignore_warnings; }
+#endif // DEBUG_ENABLED
+	GDScriptTokenizerRecorded();
+};
+
 class GDScriptTokenizerBuffer : public GDScriptTokenizer {
 
 	enum {
@@ -0,0 +1,424 @@
+/*************************************************************************/
+/*  gdscript_typed_ops.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_typed_ops.h"
+
+#include "core/variant_internal.h"
+
+#define GET_INT(m_v) VariantInternal::get_int(m_v)
+#define GET_REAL(m_v) VariantInternal::get_real(m_v)
+#define GET_VECTOR2(m_v) VariantInternal::get_vector2(m_v)
+#define GET_VECTOR3(m_v) VariantInternal::get_vector3(m_v)
+
+// Mixing int and float follows Variant::evaluate(): int with int stays an int,
+// anything involving a float gives a float.
+
+#define ARITHMETIC_OP(m_name, m_op)                                                  \
+	static bool _##m_name##_int_int(const Variant *a, const Variant *b, Variant *r) {   \
+		VariantInternal::set_int(r, GET_INT(a) m_op GET_INT(b));                       \
+		return true;                                                                   \
+	}                                                                                  \
+	static bool _##m_name##_int_real(const Variant *a, const Variant *b, Variant *r) {  \
+		VariantInternal::set_real(r, GET_INT(a) m_op GET_REAL(b));                     \
+		return true;                                                                   \
+	}                                                                                  \
+	static bool _##m_name##_real_int(const Variant *a, const Variant *b, Variant *r) {  \
+		VariantInternal::set_real(r, GET_REAL(a) m_op GET_INT(b));                     \
+		return true;                                                                   \
+	}                                                                                  \
+	static bool _##m_name##_real_real(const Variant *a, const Variant *b, Variant *r) { \
+		VariantInternal::set_real(r, GET_REAL(a) m_op GET_REAL(b));                    \
+		return true;                                                                   \
+	}
+
+// Division by zero is left to Variant::evaluate(), which reports it.
+#define DIVISION_OP(m_name, m_op)                                                    \
+	static bool _##m_name##_int_int(const Variant *a, const Variant *b, Variant *r) {   \
+		if (GET_INT(b) == 0)                                                           \
+			return false;                                                              \
+		VariantInternal::set_int(r, GET_INT(a) m_op GET_INT(b));                       \
+		return true;                                                                   \
+	}                                                                                  \
+	static bool _##m_name##_int_real(const Variant *a, const Variant *b, Variant *r) {  \
+		if (GET_REAL(b) == 0)                                                          \
+			return false;                                                              \
+		VariantInternal::set_real(r, GET_INT(a) m_op GET_REAL(b));                     \
+		return true;                                                                   \
+	}                                                                                  \
+	static bool _##m_name##_real_int(const Variant *a, const Variant *b, Variant *r) {  \
+		if (GET_INT(b) == 0)                                                           \
+			return false;                                                              \
+		VariantInternal::set_real(r, GET_REAL(a) m_op GET_INT(b));                     \
+		return true;                                                                   \
+	}                                                                                  \
+	static bool _##m_name##_real_real(const Variant *a, const Variant *b, Variant *r) { \
+		if (GET_REAL(b) == 0)                                                          \
+			return false;                                                              \
+		VariantInternal::set_real(r, GET_REAL(a) m_op GET_REAL(b));                    \
+		return true;                                                                   \
+	}
+
+#define COMPARISON_OP(m_name, m_op)                                                  \
+	static bool _##m_name##_int_int(const Variant *a, const Variant *b, Variant *r) {   \
+		VariantInternal::set_bool(r, GET_INT(a) m_op GET_INT(b));                      \
+		return true;                                                                   \
+	}                                                                                  \
+	static bool _##m_name##_int_real(const Variant *a, const Variant *b, Variant *r) {  \
+		VariantInternal::set_bool(r, GET_INT(a) m_op GET_REAL(b));                     \
+		return true;                                                                   \
+	}                                                                                  \
+	static bool _##m_name##_real_int(const Variant *a, const Variant *b, Variant *r) {  \
+		VariantInternal::set_bool(r, GET_REAL(a) m_op GET_INT(b));                     \
+		return true;                                                                   \
+	}                                                                                  \
+	static bool _##m_name##_real_real(const Variant *a, const Variant *b, Variant *r) { \
+		VariantInternal::set_bool(r, GET_REAL(a) m_op GET_REAL(b));                    \
+		return true;                                                                   \
+	}
+
+#define INT_OP(m_name, m_op)                                                       \
+	static bool _##m_name##_int_int(const Variant *a, const Variant *b, Variant *r) { \
+		VariantInternal::set_int(r, GET_INT(a) m_op GET_INT(b));                     \
+		return true;                                                                 \
+	}
+
+#define VECTOR_OP(m_name, m_type, m_op)                                                                         \
+	static bool _##m_name##_##m_type##_##m_type(const Variant *a, const Variant *b, Variant *r) {                  \
+		VariantInternal::set_##m_type(r, VariantInternal::get_##m_type(a) m_op VariantInternal::get_##m_type(b)); \
+		return true;                                                                                              \
+	}
+
+#define VECTOR_SCALAR_OP(m_name, m_type, m_op)                                                        \
+	static bool _##m_name##_##m_type##_real(const Variant *a, const Variant *b, Variant *r) {         \
+		VariantInternal::set_##m_type(r, VariantInternal::get_##m_type(a) m_op(real_t) GET_REAL(b)); \
+		return true;                                                                                  \
+	}                                                                                                 \
+	static bool _##m_name##_##m_type##_int(const Variant *a, const Variant *b, Variant *r) {          \
+		VariantInternal::set_##m_type(r, VariantInternal::get_##m_type(a) m_op(real_t) GET_INT(b));  \
+		return true;                                                                                  \
+	}
+
+#define VECTOR_COMPARISON_OP(m_name, m_type, m_op)                                                                \
+	static bool _##m_name##_##m_type##_##m_type(const Variant *a, const Variant *b, Variant *r) {                    \
+		VariantInternal::set_bool(r, VariantInternal::get_##m_type(a) m_op VariantInternal::get_##m_type(b));       \
+		return true;                                                                                                \
+	}
+
+ARITHMETIC_OP(add, +)
+ARITHMETIC_OP(sub, -)
+ARITHMETIC_OP(mul, *)
+DIVISION_OP(div, /)
+
+COMPARISON_OP(equal, ==)
+COMPARISON_OP(not_equal, !=)
+COMPARISON_OP(less, <)
+COMPARISON_OP(less_equal, <=)
+COMPARISON_OP(greater, >)
+COMPARISON_OP(greater_equal, >=)
+
+INT_OP(bit_and, &)
+INT_OP(bit_or, |)
+INT_OP(bit_xor, ^)
+
+static bool _mod_int_int(const Variant *a, const Variant *b, Variant *r) {
+	if (GET_INT(b) == 0)
+		return false;
+	VariantInternal::set_int(r, GET_INT(a) % GET_INT(b));
+	return true;
+}
+
+// Unary operators get their operand twice.
+static bool _negate_int_int(const Variant *a, const Variant *b, Variant *r) {
+	VariantInternal::set_int(r, -GET_INT(a));
+	return true;
+}
+static bool _negate_real_real(const Variant *a, const Variant *b, Variant *r) {
+	VariantInternal::set_real(r, -GET_REAL(a));
+	return true;
+}
+static bool _negate_vector2_vector2(const Variant *a, const Variant *b, Variant *r) {
+	VariantInternal::set_vector2(r, -GET_VECTOR2(a));
+	return true;
+}
+static bool _negate_vector3_vector3(const Variant *a, const Variant *b, Variant *r) {
+	VariantInternal::set_vector3(r, -GET_VECTOR3(a));
+	return true;
+}
+static bool _not_bool_bool(const Variant *a, const Variant *b, Variant *r) {
+	VariantInternal::set_bool(r, !VariantInternal::get_bool(a));
+	return true;
+}
+
+VECTOR_OP(add_v, vector2, +)
+VECTOR_OP(sub_v, vector2, -)
+VECTOR_OP(mul_v, vector2, *)
+VECTOR_SCALAR_OP(mul_v, vector2, *)
+VECTOR_OP(add_v, vector3, +)
+VECTOR_OP(sub_v, vector3, -)
+VECTOR_OP(mul_v, vector3, *)
+VECTOR_SCALAR_OP(mul_v, vector3, *)
+VECTOR_COMPARISON_OP(equal, vector2, ==)
+VECTOR_COMPARISON_OP(not_equal, vector2, !=)
+VECTOR_COMPARISON_OP(equal, vector3, ==)
+VECTOR_COMPARISON_OP(not_equal, vector3, !=)
+
+#define NUMERIC_ENTRIES(m_op, m_name)                                     \
+	{ Variant::m_op, Variant::INT, Variant::INT, _##m_name##_int_int },     \
+			{ Variant::m_op, Variant::INT, Variant::REAL, _##m_name##_int_real }, \
+			{ Variant::m_op, Variant::REAL, Variant::INT, _##m_name##_real_int }, \
+			{ Variant::m_op, Variant::REAL, Variant::REAL, _##m_name##_real_real }
+
+const GDScriptTypedOps::Operator GDScriptTypedOps::operators[] = {
+	NUMERIC_ENTRIES(OP_ADD, add),
+	NUMERIC_ENTRIES(OP_SUBTRACT, sub),
+	NUMERIC_ENTRIES(OP_MULTIPLY, mul),
+	NUMERIC_ENTRIES(OP_DIVIDE, div),
+	NUMERIC_ENTRIES(OP_EQUAL, equal),
+	NUMERIC_ENTRIES(OP_NOT_EQUAL, not_equal),
+	NUMERIC_ENTRIES(OP_LESS, less),
+	NUMERIC_ENTRIES(OP_LESS_EQUAL, less_equal),
+	NUMERIC_ENTRIES(OP_GREATER, greater),
+	NUMERIC_ENTRIES(OP_GREATER_EQUAL, greater_equal),
+	{ Variant::OP_MODULE, Variant::INT, Variant::INT, _mod_int_int },
+	{ Variant::OP_BIT_AND, Variant::INT, Variant::INT, _bit_and_int_int },
+	{ Variant::OP_BIT_OR, Variant::INT, Variant::INT, _bit_or_int_int },
+	{ Variant::OP_BIT_XOR, Variant::INT, Variant::INT, _bit_xor_int_int },
+	{ Variant::OP_NEGATE, Variant::INT, Variant::INT, _negate_int_int },
+	{ Variant::OP_NEGATE, Variant::REAL, Variant::REAL, _negate_real_real },
+	{ Variant::OP_NEGATE, Variant::VECTOR2, Variant::VECTOR2, _negate_vector2_vector2 },
+	{ Variant::OP_NEGATE, Variant::VECTOR3, Variant::VECTOR3, _negate_vector3_vector3 },
+	{ Variant::OP_NOT, Variant::BOOL, Variant::BOOL, _not_bool_bool },
+	{ Variant::OP_ADD, Variant::VECTOR2, Variant::VECTOR2, _add_v_vector2_vector2 },
+	{ Variant::OP_SUBTRACT, Variant::VECTOR2, Variant::VECTOR2, _sub_v_vector2_vector2 },
+	{ Variant::OP_MULTIPLY, Variant::VECTOR2, Variant::VECTOR2, _mul_v_vector2_vector2 },
+	{ Variant::OP_MULTIPLY, Variant::VECTOR2, Variant::REAL, _mul_v_vector2_real },
+	{ Variant::OP_MULTIPLY, Variant::VECTOR2, Variant::INT, _mul_v_vector2_int },
+	{ Variant::OP_EQUAL, Variant::VECTOR2, Variant::VECTOR2, _equal_vector2_vector2 },
+	{ Variant::OP_NOT_EQUAL, Variant::VECTOR2, Variant::VECTOR2, _not_equal_vector2_vector2 },
+	{ Variant::OP_ADD, Variant::VECTOR3, Variant::VECTOR3, _add_v_vector3_vector3 },
+	{ Variant::OP_SUBTRACT, Variant::VECTOR3, Variant::VECTOR3, _sub_v_vector3_vector3 },
+	{ Variant::OP_MULTIPLY, Variant::VECTOR3, Variant::VECTOR3, _mul_v_vector3_vector3 },
+	{ Variant::OP_MULTIPLY, Variant::VECTOR3, Variant::REAL, _mul_v_vector3_real },
+	{ Variant::OP_MULTIPLY, Variant::VECTOR3, Variant::INT, _mul_v_vector3_int },
+	{ Variant::OP_EQUAL, Variant::VECTOR3, Variant::VECTOR3, _equal_vector3_vector3 },
+	{ Variant::OP_NOT_EQUAL, Variant::VECTOR3, Variant::VECTOR3, _not_equal_vector3_vector3 },
+};
+
+const int GDScriptTypedOps::operator_count = sizeof(GDScriptTypedOps::operators) / sizeof(GDScriptTypedOps::Operator);
+
+#define MEMBER_GETTER(m_type, m_member)                                                         \
+	static void _get_##m_type##_##m_member(const Variant *p_base, Variant *r_ret) {             \
+		VariantInternal::set_real(r_ret, VariantInternal::get_##m_type(p_base).m_member);       \
+	}
+
+MEMBER_GETTER(vector2, x)
+MEMBER_GETTER(vector2, y)
+MEMBER_GETTER(vector3, x)
+MEMBER_GETTER(vector3, y)
+MEMBER_GETTER(vector3, z)
+MEMBER_GETTER(color, r)
+MEMBER_GETTER(color, g)
+MEMBER_GETTER(color, b)
+MEMBER_GETTER(color, a)
+
+const GDScriptTypedOps::Member GDScriptTypedOps::members[] = {
+	{ Variant::VECTOR2, "x", _get_vector2_x },
+	{ Variant::VECTOR2, "y", _get_vector2_y },
+	{ Variant::VECTOR3, "x", _get_vector3_x },
+	{ Variant::VECTOR3, "y", _get_vector3_y },
+	{ Variant::VECTOR3, "z", _get_vector3_z },
+	{ Variant::COLOR, "r", _get_color_r },
+	{ Variant::COLOR, "g", _get_color_g },
+	{ Variant::COLOR, "b", _get_color_b },
+	{ Variant::COLOR, "a", _get_color_a },
+};
+
+const int GDScriptTypedOps::member_count = sizeof(GDScriptTypedOps::members) / sizeof(GDScriptTypedOps::Member);
+
+int GDScriptTypedOps::find_operator(Variant::Operator p_op, Variant::Type p_type_a, Variant::Type p_type_b) {
+
+	for (int i = 0; i < operator_count; i++) {
+		const Operator &op = operators[i];
+		if (op.op == p_op && op.type_a == p_type_a && op.type_b == p_type_b) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int GDScriptTypedOps::find_member(Variant::Type p_type, const StringName &p_name) {
+
+	for (int i = 0; i < member_count; i++) {
+		const Member &member = members[i];
+		if (member.type == p_type && p_name == member.name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+bool GDScriptTypedOps::is_pool_array(Variant::Type p_type) {
+
+	switch (p_type) {
+		case Variant::POOL_BYTE_ARRAY:
+		case Variant::POOL_INT_ARRAY:
+		case Variant::POOL_REAL_ARRAY:
+		case Variant::POOL_STRING_ARRAY:
+		case Variant::POOL_VECTOR2_ARRAY:
+		case Variant::POOL_VECTOR3_ARRAY:
+		case Variant::POOL_COLOR_ARRAY:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Elements are stored without going through a temporary Variant.
+
+static _FORCE_INLINE_ void _store_element(uint8_t p_value, Variant *r_ret) {
+	VariantInternal::set_int(r_ret, p_value);
+}
+static _FORCE_INLINE_ void _store_element(int p_value, Variant *r_ret) {
+	VariantInternal::set_int(r_ret, p_value);
+}
+static _FORCE_INLINE_ void _store_element(real_t p_value, Variant *r_ret) {
+	VariantInternal::set_real(r_ret, p_value);
+}
+static _FORCE_INLINE_ void _store_element(const String &p_value, Variant *r_ret) {
+	*r_ret = p_value;
+}
+static _FORCE_INLINE_ void _store_element(const Vector2 &p_value, Variant *r_ret) {
+	VariantInternal::set_vector2(r_ret, p_value);
+}
+static _FORCE_INLINE_ void _store_element(const Vector3 &p_value, Variant *r_ret) {
+	VariantInternal::set_vector3(r_ret, p_value);
+}
+static _FORCE_INLINE_ void _store_element(const Color &p_value, Variant *r_ret) {
+	VariantInternal::set_color(r_ret, p_value);
+}
+
+template <class T>
+static _FORCE_INLINE_ bool _pool_array_get(const Variant *p_array, int64_t p_index, Variant *r_ret) {
+
+	const PoolVector<T> &arr = VariantInternal::get_pool_array<T>(p_array);
+	int size = arr.size();
+	if (p_index < 0) {
+		p_index += size;
+	}
+	if (p_index < 0 || p_index >= size) {
+		return false;
+	}
+
+	// Copied out first, r_ret may be the array itself.
+	T value = arr.read()[p_index];
+	_store_element(value, r_ret);
+	return true;
+}
+
+bool GDScriptTypedOps::pool_array_get(const Variant *p_array, int64_t p_index, Variant *r_ret) {
+
+	switch (p_array->get_type()) {
+		case Variant::POOL_BYTE_ARRAY: return _pool_array_get<uint8_t>(p_array, p_index, r_ret);
+		case Variant::POOL_INT_ARRAY: return _pool_array_get<int>(p_array, p_index, r_ret);
+		case Variant::POOL_REAL_ARRAY: return _pool_array_get<real_t>(p_array, p_index, r_ret);
+		case Variant::POOL_STRING_ARRAY: return _pool_array_get<String>(p_array, p_index, r_ret);
+		case Variant::POOL_VECTOR2_ARRAY: return _pool_array_get<Vector2>(p_array, p_index, r_ret);
+		case Variant::POOL_VECTOR3_ARRAY: return _pool_array_get<Vector3>(p_array, p_index, r_ret);
+		case Variant::POOL_COLOR_ARRAY: return _pool_array_get<Color>(p_array, p_index, r_ret);
+		default: return false;
+	}
+}
+
+template <class T, class V>
+static _FORCE_INLINE_ bool _pool_array_set(Variant *p_array, int64_t p_index, const V &p_value) {
+
+	PoolVector<T> &arr = VariantInternal::get_pool_array<T>(p_array);
+	int size = arr.size();
+	if (p_index < 0) {
+		p_index += size;
+	}
+	if (p_index < 0 || p_index >= size) {
+		return false;
+	}
+
+	arr.write()[p_index] = p_value;
+	return true;
+}
+
+bool GDScriptTypedOps::pool_array_set(Variant *p_array, int64_t p_index, const Variant *p_value) {
+
+	// Same value types as Variant::set() accepts.
+	Variant::Type value_type = p_value->get_type();
+
+	switch (p_array->get_type()) {
+		case Variant::POOL_BYTE_ARRAY:
+		case Variant::POOL_INT_ARRAY:
+		case Variant::POOL_REAL_ARRAY: {
+			if (value_type != Variant::INT && value_type != Variant::REAL) {
+				return false;
+			}
+			real_t real_value = value_type == Variant::INT ? (real_t)GET_INT(p_value) : (real_t)GET_REAL(p_value);
+			int64_t int_value = value_type == Variant::INT ? GET_INT(p_value) : (int64_t)GET_REAL(p_value);
+			if (p_array->get_type() == Variant::POOL_BYTE_ARRAY) {
+				return _pool_array_set<uint8_t>(p_array, p_index, (uint8_t)int_value);
+			} else if (p_array->get_type() == Variant::POOL_INT_ARRAY) {
+				return _pool_array_set<int>(p_array, p_index, (int)int_value);
+			}
+			return _pool_array_set<real_t>(p_array, p_index, real_value);
+		}
+		case Variant::POOL_STRING_ARRAY: {
+			if (value_type != Variant::STRING) {
+				return false;
+			}
+			return _pool_array_set<String>(p_array, p_index, p_value->operator String());
+		}
+		case Variant::POOL_VECTOR2_ARRAY: {
+			if (value_type != Variant::VECTOR2) {
+				return false;
+			}
+			return _pool_array_set<Vector2>(p_array, p_index, GET_VECTOR2(p_value));
+		}
+		case Variant::POOL_VECTOR3_ARRAY: {
+			if (value_type != Variant::VECTOR3) {
+				return false;
+			}
+			return _pool_array_set<Vector3>(p_array, p_index, GET_VECTOR3(p_value));
+		}
+		case Variant::POOL_COLOR_ARRAY: {
+			if (value_type != Variant::COLOR) {
+				return false;
+			}
+			return _pool_array_set<Color>(p_array, p_index, VariantInternal::get_color(p_value));
+		}
+		default: {
+			return false;
+		}
+	}
+}
@@ -0,0 +1,89 @@
+/*************************************************************************/
+/*  gdscript_typed_ops.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_TYPED_OPS_H
+#define GDSCRIPT_TYPED_OPS_H
+
+#include "core/variant.h"
+
+/**
+ * Operators and builtin members the compiler can bind at compile time when the
+ * parser knows the types involved. Each entry works directly on the Variant's
+ * value instead of going through Variant::evaluate() or Variant::get_named().
+ *
+ * Functions may assume their operands have the types of their entry. The
+ * opcodes check that before calling them, and fall back to the generic path
+ * when it's not the case.
+ */
+class GDScriptTypedOps {
+public:
+	// Returns false, without touching r_ret, for cases that must go through the
+	// generic path (e.g. to report a division by zero).
+	typedef bool (*OperatorFunc)(const Variant *p_a, const Variant *p_b, Variant *r_ret);
+	typedef void (*MemberGetFunc)(const Variant *p_base, Variant *r_ret);
+
+	struct Operator {
+		Variant::Operator op;
+		Variant::Type type_a;
+		Variant::Type type_b;
+		OperatorFunc func;
+	};
+
+	struct Member {
+		Variant::Type type;
+		const char *name;
+		MemberGetFunc get;
+	};
+
+private:
+	static const Operator operators[];
+	static const int operator_count;
+	static const Member members[];
+	static const int member_count;
+
+public:
+	// Both return -1 if there is no typed version.
+	static int find_operator(Variant::Operator p_op, Variant::Type p_type_a, Variant::Type p_type_b);
+	static int find_member(Variant::Type p_type, const StringName &p_name);
+
+	// Indexed access on the Pool*Array types, with an int index. Like the
+	// operators, they return false without side effects when the generic
+	// Variant::get()/set() has to handle it (other types, index out of range).
+	static bool is_pool_array(Variant::Type p_type);
+	static bool pool_array_get(const Variant *p_array, int64_t p_index, Variant *r_ret);
+	static bool pool_array_set(Variant *p_array, int64_t p_index, const Variant *p_value);
+
+	_FORCE_INLINE_ static int get_operator_count() { return operator_count; }
+	_FORCE_INLINE_ static const Operator &get_operator(int p_index) { return operators[p_index]; }
+	_FORCE_INLINE_ static int get_member_count() { return member_count; }
+	_FORCE_INLINE_ static const Member &get_member(int p_index) { return members[p_index]; }
+};
+
+#endif // GDSCRIPT_TYPED_OPS_H
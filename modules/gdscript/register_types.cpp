@@ -35,6 +35,7 @@
 #include "core/os/dir_access.h"
 #include "core/os/file_access.h"
 #include "gdscript.h"
+#include "gdscript_compiled_cache.h"
 #include "gdscript_tokenizer.h"
 
 GDScriptLanguage *script_language_gd = NULL;
@@ -57,7 +58,14 @@ class EditorExportGDScript : public EditorExportPlugin {
 
 	GDCLASS(EditorExportGDScript, EditorExportPlugin);
 
+	bool debug;
+
 public:
+	virtual void _export_begin(const Set<String> &p_features, bool p_debug, const String &p_path, int p_flags) {
+
+		debug = p_debug;
+	}
+
 	virtual void _export_file(const String &p_path, const String &p_type, const Set<String> &p_features) {
 
 		int script_mode = EditorExportPreset::MODE_SCRIPT_COMPILED;
@@ -83,6 +91,12 @@ public:
 
 		if (!file.empty()) {
 
+			// Ship the compiled script too, the tokens are only used if it can't be loaded.
+			Vector<uint8_t> compiled;
+			if (GDScriptCompiledCache::compile(p_path, txt, debug, compiled) == OK) {
+				file = GDScriptCompiledCache::pack(compiled, file);
+			}
+
 			if (script_mode == EditorExportPreset::MODE_SCRIPT_ENCRYPTED) {
 
 				String tmp_path = EditorSettings::get_singleton()->get_cache_dir().plus_file("script.gde");
@@ -132,6 +146,11 @@ public:
 			}
 		}
 	}
+
+	EditorExportGDScript() {
+
+		debug = false;
+	}
 };
 
 static void _editor_init() {
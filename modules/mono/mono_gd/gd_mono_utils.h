@@ -35,10 +35,10 @@
 
 #include "../mono_gc_handle.h"
 #include "../utils/macros.h"
-#include "../utils/thread_local.h"
 #include "gd_mono_header.h"
 
 #include "core/object.h"
+#include "core/os/thread_local.h"
 #include "core/reference.h"
 
 #define UNHANDLED_EXCEPTION(m_exc)                     \
@@ -158,6 +158,10 @@ VisualScriptNodeInstance::VisualScriptNodeInstance() {
 
 	sequence_outputs = NULL;
 	input_ports = NULL;
+	stack_inputs = NULL;
+	stack_input_count = 0;
+	default_inputs = NULL;
+	default_input_count = 0;
 }
 
 VisualScriptNodeInstance::~VisualScriptNodeInstance() {
@@ -173,6 +177,14 @@ VisualScriptNodeInstance::~VisualScriptNodeInstance() {
 	if (output_ports) {
 		memdelete_arr(output_ports);
 	}
+
+	if (stack_inputs) {
+		memdelete_arr(stack_inputs);
+	}
+
+	if (default_inputs) {
+		memdelete_arr(default_inputs);
+	}
 }
 
 void VisualScript::add_function(const StringName &p_name) {
@@ -1480,54 +1492,75 @@ bool VisualScriptInstance::has_method(const StringName &p_method) const {
 //#define VSDEBUG(m_text) print_line(m_text)
 #define VSDEBUG(m_text)
 
-void VisualScriptInstance::_dependency_step(VisualScriptNodeInstance *node, int p_pass, int *pass_stack, const Variant **input_args, Variant **output_args, Variant *variant_stack, Variant::CallError &r_error, String &error_str, VisualScriptNodeInstance **r_error_node) {
-
-	ERR_FAIL_COND(node->pass_idx == -1);
+void VisualScriptInstance::_flatten_dependencies(VisualScriptNodeInstance *p_node, Set<VisualScriptNodeInstance *> &r_visited, Vector<VisualScriptNodeInstance *> &r_steps) {
 
-	if (pass_stack[node->pass_idx] == p_pass)
-		return;
-
-	pass_stack[node->pass_idx] = p_pass;
+	//same order a depth-first walk would step them in, each dependency only once
+	for (int i = 0; i < p_node->dependencies.size(); i++) {
 
-	if (!node->dependencies.empty()) {
+		VisualScriptNodeInstance *dep = p_node->dependencies[i];
+		if (r_visited.has(dep))
+			continue;
 
-		int dc = node->dependencies.size();
-		VisualScriptNodeInstance **deps = node->dependencies.ptrw();
+		r_visited.insert(dep);
+		_flatten_dependencies(dep, r_visited, r_steps);
+		r_steps.push_back(dep);
+	}
+}
 
-		for (int i = 0; i < dc; i++) {
+void VisualScriptInstance::_resolve_input_ports(VisualScriptNodeInstance *p_node) {
 
-			_dependency_step(deps[i], p_pass, pass_stack, input_args, output_args, variant_stack, r_error, error_str, r_error_node);
-			if (r_error.error != Variant::CallError::CALL_OK)
-				return;
+	int default_count = 0;
+	for (int i = 0; i < p_node->input_port_count; i++) {
+		if (p_node->input_ports[i] & VisualScriptNodeInstance::INPUT_DEFAULT_VALUE_BIT) {
+			default_count++;
 		}
 	}
 
-	for (int i = 0; i < node->input_port_count; i++) {
+	int stack_count = p_node->input_port_count - default_count;
+	if (stack_count) {
+		p_node->stack_inputs = memnew_arr(VisualScriptNodeInstance::StackInput, stack_count);
+	}
+	if (default_count) {
+		p_node->default_inputs = memnew_arr(VisualScriptNodeInstance::DefaultInput, default_count);
+	}
 
-		int index = node->input_ports[i] & VisualScriptNodeInstance::INPUT_MASK;
+	for (int i = 0; i < p_node->input_port_count; i++) {
 
-		if (node->input_ports[i] & VisualScriptNodeInstance::INPUT_DEFAULT_VALUE_BIT) {
+		int index = p_node->input_ports[i] & VisualScriptNodeInstance::INPUT_MASK;
+
+		if (p_node->input_ports[i] & VisualScriptNodeInstance::INPUT_DEFAULT_VALUE_BIT) {
 			//is a default value (unassigned input port)
-			input_args[i] = &default_values[index];
+			VisualScriptNodeInstance::DefaultInput &di = p_node->default_inputs[p_node->default_input_count++];
+			di.port = i;
+			di.value = &default_values[index];
 		} else {
 			//regular temporary in stack
-			input_args[i] = &variant_stack[index];
+			VisualScriptNodeInstance::StackInput &si = p_node->stack_inputs[p_node->stack_input_count++];
+			si.port = i;
+			si.stack_pos = index;
 		}
 	}
-	for (int i = 0; i < node->output_port_count; i++) {
-		output_args[i] = &variant_stack[node->output_ports[i]];
+}
+
+void VisualScriptInstance::_setup_node_ports(VisualScriptNodeInstance *p_node, Variant *p_variant_stack, const Variant **r_input_args, Variant **r_output_args) {
+
+	const VisualScriptNodeInstance::StackInput *stack_inputs = p_node->stack_inputs;
+	for (int i = 0; i < p_node->stack_input_count; i++) {
+		r_input_args[stack_inputs[i].port] = &p_variant_stack[stack_inputs[i].stack_pos];
 	}
 
-	Variant *working_mem = node->working_mem_idx >= 0 ? &variant_stack[node->working_mem_idx] : (Variant *)NULL;
+	const VisualScriptNodeInstance::DefaultInput *default_inputs = p_node->default_inputs;
+	for (int i = 0; i < p_node->default_input_count; i++) {
+		r_input_args[default_inputs[i].port] = default_inputs[i].value;
+	}
 
-	node->step(input_args, output_args, VisualScriptNodeInstance::START_MODE_BEGIN_SEQUENCE, working_mem, r_error, error_str);
-	//ignore return
-	if (r_error.error != Variant::CallError::CALL_OK) {
-		*r_error_node = node;
+	const int *output_ports = p_node->output_ports;
+	for (int i = 0; i < p_node->output_port_count; i++) {
+		r_output_args[i] = &p_variant_stack[output_ports[i]];
 	}
 }
 
-Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p_stack, int p_stack_size, VisualScriptNodeInstance *p_node, int p_flow_stack_pos, int p_pass, bool p_resuming_yield, Variant::CallError &r_error) {
+Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p_stack, int p_stack_size, VisualScriptNodeInstance *p_node, int p_flow_stack_pos, bool p_resuming_yield, Variant::CallError &r_error) {
 
 	Map<StringName, Function>::Element *F = functions.find(p_method);
 	ERR_FAIL_COND_V(!F, Variant());
@@ -1540,7 +1573,7 @@ Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p
 	Variant **output_args = (Variant **)(input_args + max_input_args);
 	int flow_max = f->flow_stack_size;
 	int *flow_stack = flow_max ? (int *)(output_args + max_output_args) : (int *)NULL;
-	int *pass_stack = flow_stack ? (int *)(flow_stack + flow_max) : (int *)NULL;
+	VisualScriptNodeInstance *const *sequence_nodes = f->sequence_nodes.ptr();
 
 	String error_str;
 
@@ -1553,14 +1586,14 @@ Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p
 	int flow_stack_pos = p_flow_stack_pos;
 
 #ifdef DEBUG_ENABLED
-	if (ScriptDebugger::get_singleton()) {
-		VisualScriptLanguage::singleton->enter_function(this, &p_method, variant_stack, &working_mem, &current_node_id);
+	if (VisualScriptLanguage::singleton->is_tracking_call_stack()) {
+		// The name is owned by the instance, so it outlives the call for the sampling profiler.
+		VisualScriptLanguage::singleton->enter_function(this, &F->key(), variant_stack, &working_mem, &current_node_id);
 	}
 #endif
 
 	while (true) {
 
-		p_pass++; //increment pass
 		current_node_id = node->get_id();
 
 		VSDEBUG("==========AT NODE: " + itos(current_node_id) + " base: " + node->get_base_node()->get_class_name());
@@ -1577,57 +1610,38 @@ Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p
 			for (int i = 0; i < f->argument_count; i++) {
 				input_args[i] = &variant_stack[i];
 			}
+			for (int i = 0; i < node->output_port_count; i++) {
+				output_args[i] = &variant_stack[node->output_ports[i]];
+			}
 		} else {
 
-			//run dependencies first
-
-			if (!node->dependencies.empty()) {
-
-				int dc = node->dependencies.size();
-				VisualScriptNodeInstance **deps = node->dependencies.ptrw();
-
-				for (int i = 0; i < dc; i++) {
-
-					_dependency_step(deps[i], p_pass, pass_stack, input_args, output_args, variant_stack, r_error, error_str, &node);
-					if (r_error.error != Variant::CallError::CALL_OK) {
-						error = true;
-						current_node_id = node->id;
-						break;
-					}
-				}
-			}
+			//run dependencies first, linearly in the order flattened on load
 
-			if (!error) {
+			int dc = node->dependency_steps.size();
+			VisualScriptNodeInstance *const *deps = node->dependency_steps.ptr();
 
-				//setup input pointers normally
-				VSDEBUG("INPUT PORTS: " + itos(node->input_port_count));
+			for (int i = 0; i < dc; i++) {
 
-				for (int i = 0; i < node->input_port_count; i++) {
+				VisualScriptNodeInstance *dep = deps[i];
+				_setup_node_ports(dep, variant_stack, input_args, output_args);
 
-					int index = node->input_ports[i] & VisualScriptNodeInstance::INPUT_MASK;
+				Variant *dep_working_mem = dep->working_mem_idx >= 0 ? &variant_stack[dep->working_mem_idx] : (Variant *)NULL;
 
-					if (node->input_ports[i] & VisualScriptNodeInstance::INPUT_DEFAULT_VALUE_BIT) {
-						//is a default value (unassigned input port)
-						input_args[i] = &default_values[index];
-						VSDEBUG("\tPORT " + itos(i) + " DEFAULT VAL");
-					} else {
-						//regular temporary in stack
-						input_args[i] = &variant_stack[index];
-						VSDEBUG("PORT " + itos(i) + " AT STACK " + itos(index));
-					}
+				dep->step(input_args, output_args, VisualScriptNodeInstance::START_MODE_BEGIN_SEQUENCE, dep_working_mem, r_error, error_str);
+				//ignore return
+				if (r_error.error != Variant::CallError::CALL_OK) {
+					node = dep;
+					error = true;
+					current_node_id = node->id;
+					break;
 				}
 			}
-		}
 
-		if (error)
-			break;
-
-		//setup output pointers
+			if (error)
+				break;
 
-		VSDEBUG("OUTPUT PORTS: " + itos(node->output_port_count));
-		for (int i = 0; i < node->output_port_count; i++) {
-			output_args[i] = &variant_stack[node->output_ports[i]];
-			VSDEBUG("PORT " + itos(i) + " AT STACK " + itos(node->output_ports[i]));
+			//setup input and output pointers normally
+			_setup_node_ports(node, variant_stack, input_args, output_args);
 		}
 
 		//do step
@@ -1683,14 +1697,13 @@ Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p
 				state->node = node;
 				state->flow_stack_pos = flow_stack_pos;
 				state->stack.resize(p_stack_size);
-				state->pass = p_pass;
 				copymem(state->stack.ptrw(), p_stack, p_stack_size);
 				//step 2, run away, return directly
 				r_error.error = Variant::CallError::CALL_OK;
 
 #ifdef DEBUG_ENABLED
 				//will re-enter later, so exiting
-				if (ScriptDebugger::get_singleton()) {
+				if (VisualScriptLanguage::singleton->is_tracking_call_stack()) {
 					VisualScriptLanguage::singleton->exit_function();
 				}
 #endif
@@ -1763,7 +1776,7 @@ Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p
 		if (flow_stack) {
 
 			//update flow stack pos (may have changed)
-			flow_stack[flow_stack_pos] = current_node_id;
+			flow_stack[flow_stack_pos] = node->sequence_index;
 
 			//add stack push bit if requested
 			if (ret & VisualScriptNodeInstance::STEP_FLAG_PUSH_STACK_BIT) {
@@ -1781,7 +1794,7 @@ Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p
 
 				if (flow_stack_pos > 0) {
 					flow_stack_pos--;
-					node = instances[flow_stack[flow_stack_pos] & VisualScriptNodeInstance::FLOW_STACK_MASK];
+					node = sequence_nodes[flow_stack[flow_stack_pos] & VisualScriptNodeInstance::FLOW_STACK_MASK];
 					VSDEBUG("NEXT IS GO BACK");
 				} else {
 					VSDEBUG("NEXT IS GO BACK, BUT NO NEXT SO EXIT");
@@ -1799,9 +1812,9 @@ Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p
 
 					for (int i = flow_stack_pos; i >= 0; i--) {
 
-						if ((flow_stack[i] & VisualScriptNodeInstance::FLOW_STACK_MASK) == next->get_id()) {
+						if ((flow_stack[i] & VisualScriptNodeInstance::FLOW_STACK_MASK) == next->sequence_index) {
 							flow_stack_pos = i; //roll back and remove bit
-							flow_stack[i] = next->get_id();
+							flow_stack[i] = next->sequence_index;
 							sequence_bits[next->sequence_index] = false;
 							found = true;
 						}
@@ -1829,7 +1842,7 @@ Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p
 					node = next;
 
 					flow_stack_pos++;
-					flow_stack[flow_stack_pos] = node->get_id();
+					flow_stack[flow_stack_pos] = node->sequence_index;
 
 					VSDEBUG("INCREASE FLOW STACK");
 				}
@@ -1844,7 +1857,7 @@ Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p
 					VSDEBUG("FS " + itos(i) + " - " + itos(flow_stack[i]));
 					if (flow_stack[i] & VisualScriptNodeInstance::FLOW_STACK_PUSHED_BIT) {
 
-						node = instances[flow_stack[i] & VisualScriptNodeInstance::FLOW_STACK_MASK];
+						node = sequence_nodes[flow_stack[i] & VisualScriptNodeInstance::FLOW_STACK_MASK];
 						flow_stack_pos = i;
 						found = true;
 						break;
@@ -1907,7 +1920,7 @@ Variant VisualScriptInstance::_call_internal(const StringName &p_method, void *p
 	}
 
 #ifdef DEBUG_ENABLED
-	if (ScriptDebugger::get_singleton()) {
+	if (VisualScriptLanguage::singleton->is_tracking_call_stack()) {
 		VisualScriptLanguage::singleton->exit_function();
 	}
 #endif
@@ -1940,7 +1953,6 @@ Variant VisualScriptInstance::call(const StringName &p_method, const Variant **p
 	total_stack_size += f->node_count * sizeof(bool);
 	total_stack_size += (max_input_args + max_output_args) * sizeof(Variant *); //arguments
 	total_stack_size += f->flow_stack_size * sizeof(int); //flow
-	total_stack_size += f->pass_stack_size * sizeof(int);
 
 	VSDEBUG("STACK SIZE: " + itos(total_stack_size));
 	VSDEBUG("STACK VARIANTS: : " + itos(f->max_stack));
@@ -1948,7 +1960,6 @@ Variant VisualScriptInstance::call(const StringName &p_method, const Variant **p
 	VSDEBUG("MAX INPUT: " + itos(max_input_args));
 	VSDEBUG("MAX OUTPUT: " + itos(max_output_args));
 	VSDEBUG("FLOW STACK SIZE: " + itos(f->flow_stack_size));
-	VSDEBUG("PASS STACK SIZE: " + itos(f->pass_stack_size));
 
 	void *stack = alloca(total_stack_size);
 
@@ -1958,14 +1969,11 @@ Variant VisualScriptInstance::call(const StringName &p_method, const Variant **p
 	Variant **output_args = (Variant **)(input_args + max_input_args);
 	int flow_max = f->flow_stack_size;
 	int *flow_stack = flow_max ? (int *)(output_args + max_output_args) : (int *)NULL;
-	int *pass_stack = flow_stack ? (int *)(flow_stack + flow_max) : (int *)NULL;
 
 	for (int i = 0; i < f->node_count; i++) {
 		sequence_bits[i] = false; //all starts as false
 	}
 
-	zeromem(pass_stack, f->pass_stack_size * sizeof(int));
-
 	Map<int, VisualScriptNodeInstance *>::Element *E = instances.find(f->node);
 	if (!E) {
 		r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
@@ -1976,7 +1984,7 @@ Variant VisualScriptInstance::call(const StringName &p_method, const Variant **p
 	VisualScriptNodeInstance *node = E->get();
 
 	if (flow_stack) {
-		flow_stack[0] = node->get_id();
+		flow_stack[0] = node->sequence_index;
 	}
 
 	VSDEBUG("ARGUMENTS: " + itos(f->argument_count) = " RECEIVED: " + itos(p_argcount));
@@ -2005,7 +2013,7 @@ Variant VisualScriptInstance::call(const StringName &p_method, const Variant **p
 		variant_stack[i] = *p_args[i];
 	}
 
-	return _call_internal(p_method, stack, total_stack_size, node, 0, 0, false, r_error);
+	return _call_internal(p_method, stack, total_stack_size, node, 0, false, r_error);
 }
 
 void VisualScriptInstance::notification(int p_notification) {
@@ -2108,7 +2116,6 @@ void VisualScriptInstance::create(const Ref<VisualScript> &p_script, Object *p_o
 		function.node = E->get().function_id;
 		function.max_stack = 0;
 		function.flow_stack_size = 0;
-		function.pass_stack_size = 0;
 		function.node_count = 0;
 
 		Map<StringName, int> local_var_indices;
@@ -2154,7 +2161,6 @@ void VisualScriptInstance::create(const Ref<VisualScript> &p_script, Object *p_o
 			instance->sequence_output_count = node->get_output_sequence_port_count();
 			instance->sequence_index = function.node_count++;
 			instance->sequence_outputs = NULL;
-			instance->pass_idx = -1;
 
 			if (instance->input_port_count) {
 				instance->input_ports = memnew_arr(int, instance->input_port_count);
@@ -2207,6 +2213,7 @@ void VisualScriptInstance::create(const Ref<VisualScript> &p_script, Object *p_o
 			max_output_args = MAX(max_output_args, instance->output_port_count);
 
 			instances[F->key()] = instance;
+			function.sequence_nodes.push_back(instance);
 		}
 
 		function.trash_pos = function.max_stack++; //create pos for trash
@@ -2231,10 +2238,6 @@ void VisualScriptInstance::create(const Ref<VisualScript> &p_script, Object *p_o
 
 			if (from->get_sequence_output_count() == 0 && to->dependencies.find(from) == -1) {
 				//if the node we are reading from has no output sequence, we must call step() before reading from it.
-				if (from->pass_idx == -1) {
-					from->pass_idx = function.pass_stack_size;
-					function.pass_stack_size++;
-				}
 				to->dependencies.push_back(from);
 			}
 
@@ -2284,8 +2287,22 @@ void VisualScriptInstance::create(const Ref<VisualScript> &p_script, Object *p_o
 			}
 		}
 
+		//fifth pass, flatten dependencies so they can be stepped without walking the graph
+
+		for (int i = 0; i < function.sequence_nodes.size(); i++) {
+
+			VisualScriptNodeInstance *instance = function.sequence_nodes[i];
+			Set<VisualScriptNodeInstance *> visited;
+			_flatten_dependencies(instance, visited, instance->dependency_steps);
+		}
+
 		functions[E->key()] = function;
 	}
+
+	//default values of all functions are known now and won't move anymore
+	for (Map<int, VisualScriptNodeInstance *>::Element *E = instances.front(); E; E = E->next()) {
+		_resolve_input_ports(E->get());
+	}
 }
 
 ScriptLanguage *VisualScriptInstance::get_language() {
@@ -2358,7 +2375,7 @@ Variant VisualScriptFunctionState::_signal_callback(const Variant **p_args, int
 
 	*working_mem = args; //arguments go to working mem.
 
-	Variant ret = instance->_call_internal(function, stack.ptrw(), stack.size(), node, flow_stack_pos, pass, true, r_error);
+	Variant ret = instance->_call_internal(function, stack.ptrw(), stack.size(), node, flow_stack_pos, true, r_error);
 	function = StringName(); //invalidate
 	return ret;
 }
@@ -2395,7 +2412,7 @@ Variant VisualScriptFunctionState::resume(Array p_args) {
 
 	*working_mem = p_args; //arguments go to working mem.
 
-	Variant ret = instance->_call_internal(function, stack.ptrw(), stack.size(), node, flow_stack_pos, pass, true, r_error);
+	Variant ret = instance->_call_internal(function, stack.ptrw(), stack.size(), node, flow_stack_pos, true, r_error);
 	function = StringName(); //invalidate
 	return ret;
 }
@@ -2710,6 +2727,80 @@ int VisualScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, in
 	return 0;
 }
 
+int VisualScriptLanguage::profiling_get_stack_sample(StackInfo *p_info_arr, int p_info_max) {
+
+	if (!_call_stack) {
+		return 0;
+	}
+
+	// Instances can't be freed while holding the lock, so the ones on the copied stack stay valid until it's released.
+	if (lock) {
+		lock->lock();
+	}
+
+	// The main thread doesn't lock to change its call stack. Copy it without following any pointer
+	// but the node id one, which points to the main thread's stack, and retry if it changed meanwhile.
+	int sampled = -1;
+	for (int attempt = 0; attempt < PROFILING_SAMPLE_ATTEMPTS && sampled < 0; attempt++) {
+		uint32_t version = _debug_call_stack_version;
+		atomic_acquire_fence();
+		if (version & 1) {
+			continue;
+		}
+
+		int n = 0;
+		for (int i = _debug_call_stack_pos - 1; i >= 0 && n < p_info_max; i--) {
+			int *current_id = _call_stack[i].current_id;
+			_sampled_call_stack[n].function = _call_stack[i].function;
+			_sampled_call_stack[n].instance = _call_stack[i].instance;
+			_sampled_call_stack[n].current_id = current_id ? *current_id : 0;
+			n++;
+		}
+
+		atomic_acquire_fence();
+		if (_debug_call_stack_version == version) {
+			sampled = n;
+		}
+	}
+
+	int count = 0;
+	for (int i = 0; i < sampled; i++) {
+		const SampledLevel &sl = _sampled_call_stack[i];
+		if (!sl.function || !sl.instance) {
+			continue;
+		}
+		p_info_arr[count].func = *sl.function;
+		p_info_arr[count].file = sl.instance->get_script_ptr()->get_path();
+		p_info_arr[count].line = sl.current_id;
+		count++;
+	}
+
+	if (lock) {
+		lock->unlock();
+	}
+
+	if (sampled < 0) {
+		return -1; // Kept changing, drop the sample rather than guess.
+	}
+
+	return count;
+}
+
+void VisualScriptLanguage::profiling_set_sampling(bool p_enable) {
+
+	if (p_enable && !_call_stack) {
+		_allocate_call_stack(GLOBAL_GET("debug/settings/visual_script/max_call_stack"));
+	}
+	_sampling_call_stack = p_enable;
+}
+
+void VisualScriptLanguage::_allocate_call_stack(int p_max_call_stack) {
+
+	_debug_max_call_stack = p_max_call_stack;
+	_call_stack = memnew_arr(CallLevel, _debug_max_call_stack + 1);
+	_sampled_call_stack = memnew_arr(SampledLevel, _debug_max_call_stack + 1);
+}
+
 VisualScriptLanguage *VisualScriptLanguage::singleton = NULL;
 
 void VisualScriptLanguage::add_register_func(const String &p_name, VisualScriptNodeRegisterFunc p_func) {
@@ -2750,17 +2841,19 @@ VisualScriptLanguage::VisualScriptLanguage() {
 	_debug_parse_err_node = -1;
 	_debug_parse_err_file = "";
 	_debug_call_stack_pos = 0;
+	_debug_call_stack_version = 0;
+	_sampling_call_stack = false;
 	int dmcs = GLOBAL_DEF("debug/settings/visual_script/max_call_stack", 1024);
 	ProjectSettings::get_singleton()->set_custom_property_info("debug/settings/visual_script/max_call_stack", PropertyInfo(Variant::INT, "debug/settings/visual_script/max_call_stack", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater")); //minimum is 1024
 
 	if (ScriptDebugger::get_singleton()) {
 		//debugging enabled!
-		_debug_max_call_stack = dmcs;
-		_call_stack = memnew_arr(CallLevel, _debug_max_call_stack + 1);
+		_allocate_call_stack(dmcs);
 
 	} else {
 		_debug_max_call_stack = 0;
 		_call_stack = NULL;
+		_sampled_call_stack = NULL;
 	}
 }
 
@@ -2771,6 +2864,7 @@ VisualScriptLanguage::~VisualScriptLanguage() {
 
 	if (_call_stack) {
 		memdelete_arr(_call_stack);
+		memdelete_arr(_sampled_call_stack);
 	}
 	singleton = NULL;
 }
@@ -32,6 +32,7 @@
 #define VISUAL_SCRIPT_H
 
 #include "core/os/thread.h"
+#include "core/safe_refcount.h"
 #include "core/script_language.h"
 
 class VisualScriptInstance;
@@ -117,12 +118,28 @@ class VisualScriptNodeInstance {
 	VisualScriptNodeInstance **sequence_outputs;
 	int sequence_output_count;
 	Vector<VisualScriptNodeInstance *> dependencies;
+	Vector<VisualScriptNodeInstance *> dependency_steps; //dependencies flattened in execution order on load, stepped linearly before this node
 	int *input_ports;
 	int input_port_count;
 	int *output_ports;
 	int output_port_count;
 	int working_mem_idx;
-	int pass_idx;
+
+	struct StackInput {
+		int port;
+		int stack_pos;
+	};
+
+	struct DefaultInput {
+		int port;
+		const Variant *value;
+	};
+
+	//input ports resolved once all default values are known, so setting up a step doesn't decode them
+	StackInput *stack_inputs;
+	int stack_input_count;
+	DefaultInput *default_inputs;
+	int default_input_count;
 
 	VisualScriptNode *base;
 
@@ -382,9 +399,9 @@ class VisualScriptInstance : public ScriptInstance {
 		int max_stack;
 		int trash_pos;
 		int flow_stack_size;
-		int pass_stack_size;
 		int node_count;
 		int argument_count;
+		Vector<VisualScriptNodeInstance *> sequence_nodes; //indexed by sequence_index, the flow stack stores these indices
 	};
 
 	Map<StringName, Function> functions;
@@ -394,8 +411,10 @@ class VisualScriptInstance : public ScriptInstance {
 
 	StringName source;
 
-	void _dependency_step(VisualScriptNodeInstance *node, int p_pass, int *pass_stack, const Variant **input_args, Variant **output_args, Variant *variant_stack, Variant::CallError &r_error, String &error_str, VisualScriptNodeInstance **r_error_node);
-	Variant _call_internal(const StringName &p_method, void *p_stack, int p_stack_size, VisualScriptNodeInstance *p_node, int p_flow_stack_pos, int p_pass, bool p_resuming_yield, Variant::CallError &r_error);
+	void _resolve_input_ports(VisualScriptNodeInstance *p_node);
+	void _flatten_dependencies(VisualScriptNodeInstance *p_node, Set<VisualScriptNodeInstance *> &r_visited, Vector<VisualScriptNodeInstance *> &r_steps);
+	_FORCE_INLINE_ void _setup_node_ports(VisualScriptNodeInstance *p_node, Variant *p_variant_stack, const Variant **r_input_args, Variant **r_output_args);
+	Variant _call_internal(const StringName &p_method, void *p_stack, int p_stack_size, VisualScriptNodeInstance *p_node, int p_flow_stack_pos, bool p_resuming_yield, Variant::CallError &r_error);
 
 	//Map<StringName,Function> functions;
 	friend class VisualScriptFunctionState; //for yield
@@ -462,7 +481,6 @@ class VisualScriptFunctionState : public Reference {
 	int variant_stack_size;
 	VisualScriptNodeInstance *node;
 	int flow_stack_pos;
-	int pass;
 
 	Variant _signal_callback(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
 
@@ -492,12 +510,29 @@ class VisualScriptLanguage : public ScriptLanguage {
 		int *current_id;
 	};
 
+	enum {
+		PROFILING_SAMPLE_ATTEMPTS = 16
+	};
+
+	struct SampledLevel {
+
+		const StringName *function;
+		VisualScriptInstance *instance;
+		int current_id;
+	};
+
 	int _debug_parse_err_node;
 	String _debug_parse_err_file;
 	String _debug_error;
 	int _debug_call_stack_pos;
 	int _debug_max_call_stack;
 	CallLevel *_call_stack;
+	// Odd while the main thread changes the call stack, see profiling_get_stack_sample().
+	volatile uint32_t _debug_call_stack_version;
+	SampledLevel *_sampled_call_stack;
+	bool _sampling_call_stack; // Call stack kept for the sampling profiler, even without a debugger.
+
+	void _allocate_call_stack(int p_max_call_stack);
 
 public:
 	StringName notification;
@@ -512,27 +547,37 @@ public:
 	bool debug_break(const String &p_error, bool p_allow_continue = true);
 	bool debug_break_parse(const String &p_file, int p_node, const String &p_error);
 
+	_FORCE_INLINE_ bool is_tracking_call_stack() const { return _sampling_call_stack || ScriptDebugger::get_singleton(); }
+
 	_FORCE_INLINE_ void enter_function(VisualScriptInstance *p_instance, const StringName *p_function, Variant *p_stack, Variant **p_work_mem, int *current_id) {
 
 		if (Thread::get_main_id() != Thread::get_caller_id())
 			return; //no support for other threads than main for now
 
-		if (ScriptDebugger::get_singleton()->get_lines_left() > 0 && ScriptDebugger::get_singleton()->get_depth() >= 0)
-			ScriptDebugger::get_singleton()->set_depth(ScriptDebugger::get_singleton()->get_depth() + 1);
+		ScriptDebugger *debugger = ScriptDebugger::get_singleton();
+		if (debugger && debugger->get_lines_left() > 0 && debugger->get_depth() >= 0)
+			debugger->set_depth(debugger->get_depth() + 1);
 
 		if (_debug_call_stack_pos >= _debug_max_call_stack) {
 			//stack overflow
 			_debug_error = "Stack Overflow (Stack Size: " + itos(_debug_max_call_stack) + ")";
-			ScriptDebugger::get_singleton()->debug(this);
+			if (debugger)
+				debugger->debug(this);
 			return;
 		}
 
+		_debug_call_stack_version++;
+		atomic_release_fence();
+
 		_call_stack[_debug_call_stack_pos].stack = p_stack;
 		_call_stack[_debug_call_stack_pos].instance = p_instance;
 		_call_stack[_debug_call_stack_pos].function = p_function;
 		_call_stack[_debug_call_stack_pos].work_mem = p_work_mem;
 		_call_stack[_debug_call_stack_pos].current_id = current_id;
 		_debug_call_stack_pos++;
+
+		atomic_release_fence();
+		_debug_call_stack_version++;
 	}
 
 	_FORCE_INLINE_ void exit_function() {
@@ -540,17 +585,23 @@ public:
 		if (Thread::get_main_id() != Thread::get_caller_id())
 			return; //no support for other threads than main for now
 
-		if (ScriptDebugger::get_singleton()->get_lines_left() > 0 && ScriptDebugger::get_singleton()->get_depth() >= 0)
-			ScriptDebugger::get_singleton()->set_depth(ScriptDebugger::get_singleton()->get_depth() - 1);
+		ScriptDebugger *debugger = ScriptDebugger::get_singleton();
+		if (debugger && debugger->get_lines_left() > 0 && debugger->get_depth() >= 0)
+			debugger->set_depth(debugger->get_depth() - 1);
 
 		if (_debug_call_stack_pos == 0) {
 
 			_debug_error = "Stack Underflow (Engine Bug)";
-			ScriptDebugger::get_singleton()->debug(this);
+			if (debugger)
+				debugger->debug(this);
 			return;
 		}
 
+		_debug_call_stack_version++;
+		atomic_release_fence();
 		_debug_call_stack_pos--;
+		atomic_release_fence();
+		_debug_call_stack_version++;
 	}
 
 	//////////////////////////////////////
@@ -605,6 +656,8 @@ public:
 
 	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max);
 	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max);
+	virtual int profiling_get_stack_sample(StackInfo *p_info_arr, int p_info_max);
+	virtual void profiling_set_sampling(bool p_enable);
 
 	void add_register_func(const String &p_name, VisualScriptNodeRegisterFunc p_func);
 	void remove_register_func(const String &p_name);
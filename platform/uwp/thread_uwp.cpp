@@ -36,7 +36,10 @@ Thread *ThreadUWP::create_func_uwp(ThreadCreateCallback p_callback, void *p_user
 
 	ThreadUWP *thread = memnew(ThreadUWP);
 
-	std::thread new_thread(p_callback, p_user);
+	std::thread new_thread([p_callback, p_user]() {
+		p_callback(p_user);
+		Thread::thread_exited();
+	});
 	std::swap(thread->thread, new_thread);
 
 	return thread;
@@ -30,6 +30,7 @@
 
 #include "mesh.h"
 
+#include "core/math/batch_math.h"
 #include "core/pair.h"
 #include "scene/resources/concave_polygon_shape.h"
 #include "scene/resources/convex_polygon_shape.h"
@@ -844,16 +845,7 @@ void ArrayMesh::add_surface_from_arrays(PrimitiveType p_primitive, const Array &
 		const Vector3 *vtx = r.ptr();
 
 		// check AABB
-		AABB aabb;
-		for (int i = 0; i < len; i++) {
-
-			if (i == 0)
-				aabb.position = vtx[i];
-			else
-				aabb.expand_to(vtx[i]);
-		}
-
-		s.aabb = aabb;
+		s.aabb = BatchMath::get_bounds(vtx, len);
 		s.is_2d = arr.get_type() == Variant::POOL_VECTOR2_ARRAY;
 		surfaces.push_back(s);
 
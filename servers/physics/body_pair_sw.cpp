@@ -353,6 +353,17 @@ bool BodyPairSW::setup(real_t p_step) {
 	return true;
 }
 
+bool BodyPairSW::can_setup_in_parallel() const {
+
+	//contacts reported to a static or kinematic body, which may be in other islands too
+	if (A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && A->can_report_contacts())
+		return false;
+	if (B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && B->can_report_contacts())
+		return false;
+
+	return true;
+}
+
 void BodyPairSW::solve(real_t p_step) {
 
 	if (!collided)
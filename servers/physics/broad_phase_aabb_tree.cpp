@@ -0,0 +1,726 @@
+/*************************************************************************/
+/*  broad_phase_aabb_tree.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "broad_phase_aabb_tree.h"
+#include "collision_object_sw.h"
+
+#define CULL_STACK_MAX 128
+
+//half the surface area, which is what the insertion heuristic tries to keep low
+static _FORCE_INLINE_ real_t _aabb_cost(const AABB &p_aabb) {
+
+	const Vector3 &s = p_aabb.size;
+	return s.x * s.y + s.y * s.z + s.z * s.x;
+}
+
+/* TREE */
+
+int BroadPhaseAABBTree::Tree::_alloc_node() {
+
+	if (free_list == -1) {
+
+		int new_capacity = node_capacity ? node_capacity * 2 : 16;
+		nodes = (Node *)memrealloc(nodes, sizeof(Node) * new_capacity);
+		for (int i = node_capacity; i < new_capacity; i++) {
+			nodes[i].parent = i + 1 < new_capacity ? i + 1 : -1; //free nodes are linked through parent
+			nodes[i].height = -1;
+		}
+		free_list = node_capacity;
+		node_capacity = new_capacity;
+	}
+
+	int index = free_list;
+	Node &node = nodes[index];
+	free_list = node.parent;
+	node.parent = -1;
+	node.children[0] = -1;
+	node.children[1] = -1;
+	node.height = 0;
+	node.element = 0;
+	node_count++;
+	return index;
+}
+
+void BroadPhaseAABBTree::Tree::_free_node(int p_node) {
+
+	nodes[p_node].parent = free_list;
+	nodes[p_node].height = -1;
+	free_list = p_node;
+	node_count--;
+}
+
+//rotates p_node's taller grandchild up if its children are unbalanced, returns the node now in its place
+int BroadPhaseAABBTree::Tree::_balance(int p_node) {
+
+	Node *a = &nodes[p_node];
+	if (a->is_leaf() || a->height < 2)
+		return p_node;
+
+	int ib = a->children[0];
+	int ic = a->children[1];
+	Node *b = &nodes[ib];
+	Node *c = &nodes[ic];
+
+	int balance = c->height - b->height;
+
+	if (balance > 1) {
+		//rotate c up
+		int i_f = c->children[0];
+		int i_g = c->children[1];
+		Node *f = &nodes[i_f];
+		Node *g = &nodes[i_g];
+
+		c->children[0] = p_node;
+		c->parent = a->parent;
+		a->parent = ic;
+
+		if (c->parent != -1) {
+			Node &p = nodes[c->parent];
+			p.children[p.children[0] == p_node ? 0 : 1] = ic;
+		} else {
+			root = ic;
+		}
+
+		if (f->height > g->height) {
+			c->children[1] = i_f;
+			a->children[1] = i_g;
+			g->parent = p_node;
+			a->aabb = b->aabb.merge(g->aabb);
+			c->aabb = a->aabb.merge(f->aabb);
+			a->height = 1 + MAX(b->height, g->height);
+			c->height = 1 + MAX(a->height, f->height);
+		} else {
+			c->children[1] = i_g;
+			a->children[1] = i_f;
+			f->parent = p_node;
+			a->aabb = b->aabb.merge(f->aabb);
+			c->aabb = a->aabb.merge(g->aabb);
+			a->height = 1 + MAX(b->height, f->height);
+			c->height = 1 + MAX(a->height, g->height);
+		}
+
+		return ic;
+	}
+
+	if (balance < -1) {
+		//rotate b up
+		int id = b->children[0];
+		int ie = b->children[1];
+		Node *d = &nodes[id];
+		Node *e = &nodes[ie];
+
+		b->children[0] = p_node;
+		b->parent = a->parent;
+		a->parent = ib;
+
+		if (b->parent != -1) {
+			Node &p = nodes[b->parent];
+			p.children[p.children[0] == p_node ? 0 : 1] = ib;
+		} else {
+			root = ib;
+		}
+
+		if (d->height > e->height) {
+			b->children[1] = id;
+			a->children[0] = ie;
+			e->parent = p_node;
+			a->aabb = c->aabb.merge(e->aabb);
+			b->aabb = a->aabb.merge(d->aabb);
+			a->height = 1 + MAX(c->height, e->height);
+			b->height = 1 + MAX(a->height, d->height);
+		} else {
+			b->children[1] = ie;
+			a->children[0] = id;
+			d->parent = p_node;
+			a->aabb = c->aabb.merge(d->aabb);
+			b->aabb = a->aabb.merge(e->aabb);
+			a->height = 1 + MAX(c->height, d->height);
+			b->height = 1 + MAX(a->height, e->height);
+		}
+
+		return ib;
+	}
+
+	return p_node;
+}
+
+//walks up from p_node, rebalancing and recomputing bounds and heights
+void BroadPhaseAABBTree::Tree::_refit(int p_node) {
+
+	int index = p_node;
+	while (index != -1) {
+
+		index = _balance(index);
+
+		Node &node = nodes[index];
+		const Node &child_a = nodes[node.children[0]];
+		const Node &child_b = nodes[node.children[1]];
+		node.height = 1 + MAX(child_a.height, child_b.height);
+		node.aabb = child_a.aabb.merge(child_b.aabb);
+
+		index = node.parent;
+	}
+}
+
+int BroadPhaseAABBTree::Tree::insert(const AABB &p_aabb, ID p_element) {
+
+	int leaf = _alloc_node();
+	nodes[leaf].aabb = p_aabb;
+	nodes[leaf].element = p_element;
+
+	if (root == -1) {
+		root = leaf;
+		return leaf;
+	}
+
+	//descend towards the sibling that makes the tree grow the least
+	int index = root;
+	while (!nodes[index].is_leaf()) {
+
+		const Node &node = nodes[index];
+		real_t area = _aabb_cost(node.aabb);
+		real_t combined_area = _aabb_cost(node.aabb.merge(p_aabb));
+
+		//cost of pairing the leaf with this node
+		real_t cost = 2.0 * combined_area;
+		//cost this node's bounds grow by if the leaf goes further down
+		real_t inheritance_cost = 2.0 * (combined_area - area);
+
+		real_t child_cost[2];
+		for (int i = 0; i < 2; i++) {
+			const Node &child = nodes[node.children[i]];
+			real_t merged_area = _aabb_cost(child.aabb.merge(p_aabb));
+			if (child.is_leaf()) {
+				child_cost[i] = merged_area + inheritance_cost;
+			} else {
+				child_cost[i] = merged_area - _aabb_cost(child.aabb) + inheritance_cost;
+			}
+		}
+
+		if (cost < child_cost[0] && cost < child_cost[1])
+			break;
+
+		index = node.children[child_cost[0] < child_cost[1] ? 0 : 1];
+	}
+
+	int sibling = index;
+	int old_parent = nodes[sibling].parent;
+	int new_parent = _alloc_node();
+
+	Node &parent = nodes[new_parent];
+	parent.parent = old_parent;
+	parent.aabb = nodes[sibling].aabb.merge(p_aabb);
+	parent.height = nodes[sibling].height + 1;
+	parent.children[0] = sibling;
+	parent.children[1] = leaf;
+	nodes[sibling].parent = new_parent;
+	nodes[leaf].parent = new_parent;
+
+	if (old_parent != -1) {
+		Node &op = nodes[old_parent];
+		op.children[op.children[0] == sibling ? 0 : 1] = new_parent;
+	} else {
+		root = new_parent;
+	}
+
+	_refit(new_parent);
+
+	return leaf;
+}
+
+void BroadPhaseAABBTree::Tree::remove(int p_leaf) {
+
+	if (p_leaf == root) {
+		root = -1;
+		_free_node(p_leaf);
+		return;
+	}
+
+	int parent = nodes[p_leaf].parent;
+	int grand_parent = nodes[parent].parent;
+	int sibling = nodes[parent].children[nodes[parent].children[0] == p_leaf ? 1 : 0];
+
+	//the sibling takes the parent's place
+	nodes[sibling].parent = grand_parent;
+	if (grand_parent != -1) {
+		Node &gp = nodes[grand_parent];
+		gp.children[gp.children[0] == parent ? 0 : 1] = sibling;
+	} else {
+		root = sibling;
+	}
+
+	_free_node(parent);
+	_free_node(p_leaf);
+
+	if (grand_parent != -1) {
+		_refit(grand_parent);
+	}
+}
+
+BroadPhaseAABBTree::Tree::Tree() {
+
+	nodes = NULL;
+	node_count = 0;
+	node_capacity = 0;
+	root = -1;
+	free_list = -1;
+}
+
+BroadPhaseAABBTree::Tree::~Tree() {
+
+	if (nodes) {
+		memfree(nodes);
+	}
+}
+
+/* PAIRS */
+
+void BroadPhaseAABBTree::_pair_add(ID p_a, ID p_b) {
+
+	Element &a = elements.write[p_a - 1];
+	Element &b = elements.write[p_b - 1];
+
+	//look in the shortest list
+	const Vector<Pair *> &pairs = a.pairs.size() < b.pairs.size() ? a.pairs : b.pairs;
+	for (int i = 0; i < pairs.size(); i++) {
+		const Pair *pair = pairs[i];
+		if ((pair->a == p_a && pair->b == p_b) || (pair->a == p_b && pair->b == p_a))
+			return;
+	}
+
+	//the element that moved goes first, as in the octree, so constraints get their bodies in the same order
+	Pair *pair = memnew(Pair);
+	pair->a = p_a;
+	pair->b = p_b;
+	pair->ud = NULL;
+	pair->colliding = false;
+	a.pairs.push_back(pair);
+	b.pairs.push_back(pair);
+}
+
+void BroadPhaseAABBTree::_pair_remove(Pair *p_pair) {
+
+	Element &a = elements.write[p_pair->a - 1];
+	Element &b = elements.write[p_pair->b - 1];
+
+	if (p_pair->colliding && unpair_callback) {
+		unpair_callback(a.owner, a.subindex, b.owner, b.subindex, p_pair->ud, unpair_userdata);
+	}
+
+	a.pairs.erase(p_pair);
+	b.pairs.erase(p_pair);
+	memdelete(p_pair);
+}
+
+//looks for elements whose fat AABBs overlap this one's and adds them to the pair cache
+void BroadPhaseAABBTree::_find_pairs(ID p_id) {
+
+	const Element &e = elements[p_id - 1];
+	const AABB fat_aabb = _get_tree(e).nodes[e.leaf].aabb;
+
+	int stack[CULL_STACK_MAX];
+
+	//static elements don't pair with each other, so they only look in the dynamic tree
+	int tree_count = e._static ? 1 : 2;
+	for (int t = 0; t < tree_count; t++) {
+
+		const Tree &tree = trees[t];
+		if (tree.root == -1)
+			continue;
+
+		int stack_size = 0;
+		stack[stack_size++] = tree.root;
+
+		while (stack_size) {
+
+			const Node &node = tree.nodes[stack[--stack_size]];
+			if (!node.aabb.intersects_inclusive(fat_aabb))
+				continue;
+
+			if (!node.is_leaf()) {
+				ERR_CONTINUE(stack_size + 2 > CULL_STACK_MAX);
+				stack[stack_size++] = node.children[0];
+				stack[stack_size++] = node.children[1];
+				continue;
+			}
+
+			ID other_id = node.element;
+			if (other_id == p_id)
+				continue;
+
+			const Element &other = elements[other_id - 1];
+			if (other.owner == e.owner)
+				continue;
+
+			if (other.moved && other.refit && other_id > p_id)
+				continue; //will be found when looking for the other element's pairs
+
+			_pair_add(p_id, other_id);
+		}
+	}
+}
+
+//drops pairs whose fat AABBs stopped overlapping and reports pairs whose exact AABBs started or stopped overlapping
+void BroadPhaseAABBTree::_check_pairs(ID p_id) {
+
+	Element &e = elements.write[p_id - 1];
+	const AABB &fat_aabb = _get_tree(e).nodes[e.leaf].aabb;
+
+	for (int i = e.pairs.size() - 1; i >= 0; i--) {
+
+		Pair *pair = e.pairs[i];
+		Element &a = elements.write[pair->a - 1];
+		Element &b = elements.write[pair->b - 1];
+		const Element &other = pair->a == p_id ? b : a;
+
+		if (!fat_aabb.intersects_inclusive(_get_tree(other).nodes[other.leaf].aabb)) {
+			_pair_remove(pair);
+			continue;
+		}
+
+		bool colliding = a.aabb.intersects_inclusive(b.aabb);
+		if (colliding == pair->colliding)
+			continue;
+
+		if (colliding) {
+			if (pair_callback) {
+				pair->ud = pair_callback(a.owner, a.subindex, b.owner, b.subindex, pair_userdata);
+			}
+		} else {
+			if (unpair_callback) {
+				unpair_callback(a.owner, a.subindex, b.owner, b.subindex, pair->ud, unpair_userdata);
+			}
+			pair->ud = NULL;
+		}
+
+		pair->colliding = colliding;
+	}
+}
+
+void BroadPhaseAABBTree::_mark_moved(ID p_id, Element &p_element) {
+
+	if (!p_element.moved) {
+		p_element.moved = true;
+		moved.push_back(p_id);
+	}
+}
+
+/* BROADPHASE */
+
+BroadPhaseSW::ID BroadPhaseAABBTree::create(CollisionObjectSW *p_object, int p_subindex) {
+
+	ID id;
+	if (free_ids.size()) {
+		id = free_ids[free_ids.size() - 1];
+		free_ids.resize(free_ids.size() - 1);
+	} else {
+		elements.push_back(Element());
+		id = elements.size();
+	}
+
+	Element &e = elements.write[id - 1];
+	e.owner = p_object;
+	e.aabb = AABB();
+	e.subindex = p_subindex;
+	e.leaf = -1;
+	e._static = true; //like the octree, elements start static until told otherwise
+	e.moved = false;
+	e.refit = false;
+	e.pairs.clear();
+
+	return id;
+}
+
+void BroadPhaseAABBTree::move(ID p_id, const AABB &p_aabb) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > (ID)elements.size());
+	Element &e = elements.write[p_id - 1];
+	ERR_FAIL_COND(!e.owner);
+
+	if (e.leaf != -1 && e.aabb == p_aabb)
+		return;
+
+	AABB fat_aabb = p_aabb.grow(margin);
+	Tree &tree = _get_tree(e);
+
+	if (e.leaf != -1) {
+
+		//extend the fat AABB in the direction of motion, expecting the element to keep moving
+		Vector3 motion = (p_aabb.position - e.aabb.position) * 4.0;
+		for (int i = 0; i < 3; i++) {
+			if (motion[i] < 0) {
+				fat_aabb.position[i] += motion[i];
+				fat_aabb.size[i] -= motion[i];
+			} else {
+				fat_aabb.size[i] += motion[i];
+			}
+		}
+
+		const AABB &leaf_aabb = tree.nodes[e.leaf].aabb;
+		//keep the leaf unless the element left it, or it became too large for it
+		if (leaf_aabb.encloses(p_aabb) && _aabb_cost(leaf_aabb) < _aabb_cost(fat_aabb) * 4.0) {
+			e.aabb = p_aabb;
+			_mark_moved(p_id, e);
+			return;
+		}
+
+		tree.remove(e.leaf);
+	}
+
+	e.aabb = p_aabb;
+	e.leaf = tree.insert(fat_aabb, p_id);
+	e.refit = true;
+	_mark_moved(p_id, e);
+}
+
+void BroadPhaseAABBTree::set_static(ID p_id, bool p_static) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > (ID)elements.size());
+	Element &e = elements.write[p_id - 1];
+	ERR_FAIL_COND(!e.owner);
+
+	if (e._static == p_static)
+		return;
+
+	if (e.leaf == -1) {
+		e._static = p_static;
+		return;
+	}
+
+	AABB fat_aabb = _get_tree(e).nodes[e.leaf].aabb;
+	_get_tree(e).remove(e.leaf);
+	e._static = p_static;
+	e.leaf = _get_tree(e).insert(fat_aabb, p_id);
+	e.refit = true;
+	_mark_moved(p_id, e);
+
+	if (p_static) {
+		//static elements don't pair with each other
+		for (int i = e.pairs.size() - 1; i >= 0; i--) {
+			Pair *pair = e.pairs[i];
+			ID other_id = pair->a == p_id ? pair->b : pair->a;
+			if (elements[other_id - 1]._static) {
+				_pair_remove(pair);
+			}
+		}
+	}
+}
+
+void BroadPhaseAABBTree::remove(ID p_id) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > (ID)elements.size());
+	Element &e = elements.write[p_id - 1];
+	ERR_FAIL_COND(!e.owner);
+
+	while (e.pairs.size()) {
+		_pair_remove(e.pairs[e.pairs.size() - 1]);
+	}
+
+	if (e.leaf != -1) {
+		_get_tree(e).remove(e.leaf);
+	}
+
+	e.owner = NULL;
+	e.leaf = -1;
+	free_ids.push_back(p_id);
+}
+
+CollisionObjectSW *BroadPhaseAABBTree::get_object(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > (ID)elements.size(), NULL);
+	const Element &e = elements[p_id - 1];
+	ERR_FAIL_COND_V(!e.owner, NULL);
+	return e.owner;
+}
+
+bool BroadPhaseAABBTree::is_static(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > (ID)elements.size(), false);
+	return elements[p_id - 1]._static;
+}
+
+int BroadPhaseAABBTree::get_subindex(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > (ID)elements.size(), -1);
+	return elements[p_id - 1].subindex;
+}
+
+template <class Tester>
+int BroadPhaseAABBTree::_cull(const Tester &p_tester, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) const {
+
+	int stack[CULL_STACK_MAX];
+	int count = 0;
+
+	for (int t = 0; t < 2; t++) {
+
+		const Tree &tree = trees[t];
+		if (tree.root == -1)
+			continue;
+
+		int stack_size = 0;
+		stack[stack_size++] = tree.root;
+
+		while (stack_size) {
+
+			const Node &node = tree.nodes[stack[--stack_size]];
+			if (!p_tester.test(node.aabb))
+				continue;
+
+			if (!node.is_leaf()) {
+				ERR_CONTINUE(stack_size + 2 > CULL_STACK_MAX);
+				stack[stack_size++] = node.children[0];
+				stack[stack_size++] = node.children[1];
+				continue;
+			}
+
+			//leaves are fat, so test the exact AABB too
+			const Element &e = elements[node.element - 1];
+			if (!p_tester.test(e.aabb))
+				continue;
+
+			if (count >= p_max_results)
+				return count;
+
+			p_results[count] = e.owner;
+			if (p_result_indices) {
+				p_result_indices[count] = e.subindex;
+			}
+			count++;
+		}
+	}
+
+	return count;
+}
+
+struct _CullPoint {
+
+	Vector3 point;
+	_FORCE_INLINE_ bool test(const AABB &p_aabb) const { return p_aabb.has_point(point); }
+};
+
+struct _CullSegment {
+
+	Vector3 from;
+	Vector3 to;
+	_FORCE_INLINE_ bool test(const AABB &p_aabb) const { return p_aabb.intersects_segment(from, to); }
+};
+
+struct _CullAABB {
+
+	AABB aabb;
+	_FORCE_INLINE_ bool test(const AABB &p_aabb) const { return p_aabb.intersects_inclusive(aabb); }
+};
+
+int BroadPhaseAABBTree::cull_point(const Vector3 &p_point, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_CullPoint tester;
+	tester.point = p_point;
+	return _cull(tester, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhaseAABBTree::cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_CullSegment tester;
+	tester.from = p_from;
+	tester.to = p_to;
+	return _cull(tester, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhaseAABBTree::cull_aabb(const AABB &p_aabb, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_CullAABB tester;
+	tester.aabb = p_aabb;
+	return _cull(tester, p_results, p_max_results, p_result_indices);
+}
+
+void BroadPhaseAABBTree::set_pair_callback(PairCallback p_pair_callback, void *p_userdata) {
+
+	pair_callback = p_pair_callback;
+	pair_userdata = p_userdata;
+}
+
+void BroadPhaseAABBTree::set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) {
+
+	unpair_callback = p_unpair_callback;
+	unpair_userdata = p_userdata;
+}
+
+void BroadPhaseAABBTree::update() {
+
+	//new pairs first, so the check below sees them
+	for (int i = 0; i < moved.size(); i++) {
+		const Element &e = elements[moved[i] - 1];
+		if (e.owner && e.moved && e.refit) {
+			_find_pairs(moved[i]);
+		}
+	}
+
+	for (int i = 0; i < moved.size(); i++) {
+		const Element &e = elements[moved[i] - 1];
+		if (e.owner && e.moved) {
+			_check_pairs(moved[i]);
+		}
+	}
+
+	for (int i = 0; i < moved.size(); i++) {
+		Element &e = elements.write[moved[i] - 1];
+		e.moved = false;
+		e.refit = false;
+	}
+
+	moved.resize(0);
+}
+
+BroadPhaseSW *BroadPhaseAABBTree::_create() {
+
+	return memnew(BroadPhaseAABBTree);
+}
+
+BroadPhaseAABBTree::BroadPhaseAABBTree() {
+
+	margin = 0.1;
+	pair_callback = NULL;
+	pair_userdata = NULL;
+	unpair_callback = NULL;
+	unpair_userdata = NULL;
+}
+
+BroadPhaseAABBTree::~BroadPhaseAABBTree() {
+
+	for (int i = 0; i < elements.size(); i++) {
+		//pairs are shared by two elements, free them through the first one
+		const Element &e = elements[i];
+		for (int j = 0; j < e.pairs.size(); j++) {
+			if (e.pairs[j]->a == ID(i + 1)) {
+				memdelete(e.pairs[j]);
+			}
+		}
+	}
+}
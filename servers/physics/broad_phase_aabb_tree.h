@@ -0,0 +1,155 @@
+/*************************************************************************/
+/*  broad_phase_aabb_tree.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BROAD_PHASE_AABB_TREE_H
+#define BROAD_PHASE_AABB_TREE_H
+
+#include "broad_phase_sw.h"
+#include "core/vector.h"
+
+/*
+ * Dynamic AABB tree broadphase.
+ *
+ * Static and non static elements are kept in two separate trees, with leaves
+ * holding AABBs fattened by a margin (and by the last motion), so small moves
+ * don't touch the tree at all. Leaves that leave their fat AABB are removed and
+ * inserted again with a surface area heuristic, refitting and rebalancing only
+ * their ancestors.
+ *
+ * Pairs of elements whose fat AABBs overlap are kept in a pair cache, and the
+ * pair/unpair callbacks are called when their exact AABBs start or stop
+ * overlapping. Pairs are looked for in update(), only for elements that moved.
+ */
+
+class BroadPhaseAABBTree : public BroadPhaseSW {
+
+	struct Pair {
+
+		ID a;
+		ID b;
+		void *ud;
+		bool colliding;
+	};
+
+	struct Element {
+
+		CollisionObjectSW *owner;
+		AABB aabb; // exact, as last passed to move()
+		int subindex;
+		int leaf; // -1 until it gets an AABB
+		bool _static;
+		bool moved; // exact AABB changed since last update()
+		bool refit; // fat AABB changed since last update(), so new pairs may appear
+		Vector<Pair *> pairs;
+	};
+
+	struct Node {
+
+		AABB aabb;
+		int parent;
+		int children[2];
+		int height; // 0 for leaves, -1 for free nodes
+		ID element;
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == -1; }
+	};
+
+	struct Tree {
+
+		Node *nodes;
+		int node_count;
+		int node_capacity;
+		int root;
+		int free_list;
+
+		int _alloc_node();
+		void _free_node(int p_node);
+		int _balance(int p_node);
+		void _refit(int p_node);
+
+		int insert(const AABB &p_aabb, ID p_element);
+		void remove(int p_leaf);
+
+		Tree();
+		~Tree();
+	};
+
+	Tree trees[2]; // dynamic, static
+
+	Vector<Element> elements; // indexed by ID - 1
+	Vector<ID> free_ids;
+	Vector<ID> moved;
+
+	real_t margin;
+
+	PairCallback pair_callback;
+	void *pair_userdata;
+	UnpairCallback unpair_callback;
+	void *unpair_userdata;
+
+	_FORCE_INLINE_ Tree &_get_tree(const Element &p_element) { return trees[p_element._static ? 1 : 0]; }
+	_FORCE_INLINE_ const Tree &_get_tree(const Element &p_element) const { return trees[p_element._static ? 1 : 0]; }
+	_FORCE_INLINE_ void _mark_moved(ID p_id, Element &p_element);
+
+	void _pair_add(ID p_a, ID p_b);
+	void _pair_remove(Pair *p_pair);
+	void _find_pairs(ID p_id);
+	void _check_pairs(ID p_id);
+
+	template <class Tester>
+	_FORCE_INLINE_ int _cull(const Tester &p_tester, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) const;
+
+public:
+	// 0 is an invalid ID
+	virtual ID create(CollisionObjectSW *p_object, int p_subindex = 0);
+	virtual void move(ID p_id, const AABB &p_aabb);
+	virtual void set_static(ID p_id, bool p_static);
+	virtual void remove(ID p_id);
+
+	virtual CollisionObjectSW *get_object(ID p_id) const;
+	virtual bool is_static(ID p_id) const;
+	virtual int get_subindex(ID p_id) const;
+
+	virtual int cull_point(const Vector3 &p_point, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_aabb(const AABB &p_aabb, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+
+	virtual void set_pair_callback(PairCallback p_pair_callback, void *p_userdata);
+	virtual void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata);
+
+	virtual void update();
+
+	static BroadPhaseSW *_create();
+
+	BroadPhaseAABBTree();
+	~BroadPhaseAABBTree();
+};
+
+#endif // BROAD_PHASE_AABB_TREE_H
@@ -30,9 +30,11 @@
 
 #include "physics_server_sw.h"
 
+#include "broad_phase_aabb_tree.h"
 #include "broad_phase_basic.h"
 #include "broad_phase_octree.h"
 #include "core/os/os.h"
+#include "core/project_settings.h"
 #include "core/script_language.h"
 #include "joints/cone_twist_joint_sw.h"
 #include "joints/generic_6dof_joint_sw.h"
@@ -665,7 +667,7 @@ uint32_t PhysicsServerSW::body_get_collision_mask(RID p_body) const {
 	return body->get_collision_mask();
 }
 
-void PhysicsServerSW::body_attach_object_instance_id(RID p_body, uint32_t p_id) {
+void PhysicsServerSW::body_attach_object_instance_id(RID p_body, ObjectID p_id) {
 
 	BodySW *body = body_owner.get(p_body);
 	ERR_FAIL_COND(!body);
@@ -673,7 +675,7 @@ void PhysicsServerSW::body_attach_object_instance_id(RID p_body, uint32_t p_id)
 	body->set_instance_id(p_id);
 };
 
-uint32_t PhysicsServerSW::body_get_object_instance_id(RID p_body) const {
+ObjectID PhysicsServerSW::body_get_object_instance_id(RID p_body) const {
 
 	BodySW *body = body_owner.get(p_body);
 	ERR_FAIL_COND_V(!body, 0);
@@ -740,6 +742,30 @@ Variant PhysicsServerSW::body_get_state(RID p_body, BodyState p_state) const {
 	return body->get_state(p_state);
 };
 
+void PhysicsServerSW::bodies_get_state(const RID *p_bodies, int p_count, Transform *r_transforms, Vector3 *r_linear_velocities, Vector3 *r_angular_velocities) const {
+
+	for (int i = 0; i < p_count; i++) {
+
+		BodySW *body = body_owner.get(p_bodies[i]);
+		if (!body) {
+			if (r_transforms)
+				r_transforms[i] = Transform();
+			if (r_linear_velocities)
+				r_linear_velocities[i] = Vector3();
+			if (r_angular_velocities)
+				r_angular_velocities[i] = Vector3();
+			ERR_CONTINUE(!body);
+		}
+
+		if (r_transforms)
+			r_transforms[i] = body->get_transform();
+		if (r_linear_velocities)
+			r_linear_velocities[i] = body->get_linear_velocity();
+		if (r_angular_velocities)
+			r_angular_velocities[i] = body->get_angular_velocity();
+	}
+}
+
 void PhysicsServerSW::body_set_applied_force(RID p_body, const Vector3 &p_force) {
 
 	BodySW *body = body_owner.get(p_body);
@@ -1446,6 +1472,10 @@ void PhysicsServerSW::sync(){
 
 };
 
+void PhysicsServerSW::end_sync() {
+	doing_sync = false;
+}
+
 void PhysicsServerSW::flush_queries() {
 
 #ifndef _3D_DISABLED
@@ -1574,7 +1604,15 @@ void PhysicsServerSW::_shape_col_cbk(const Vector3 &p_point_A, const Vector3 &p_
 PhysicsServerSW *PhysicsServerSW::singleton = NULL;
 PhysicsServerSW::PhysicsServerSW() {
 	singleton = this;
-	BroadPhaseSW::create_func = BroadPhaseOctree::_create;
+
+	// Registered with the other physics settings in register_server_types().
+	int broadphase = GLOBAL_GET("physics/3d/broadphase");
+	if (broadphase == 1) {
+		BroadPhaseSW::create_func = BroadPhaseAABBTree::_create;
+	} else {
+		BroadPhaseSW::create_func = BroadPhaseOctree::_create;
+	}
+
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
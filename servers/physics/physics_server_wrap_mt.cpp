@@ -0,0 +1,539 @@
+/*************************************************************************/
+/*  physics_server_wrap_mt.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "physics_server_wrap_mt.h"
+
+#include "core/os/os.h"
+
+void PhysicsServerWrapMT::thread_flush() {
+}
+
+void PhysicsServerWrapMT::thread_exit() {
+
+	exit = true;
+}
+
+void PhysicsServerWrapMT::thread_step(real_t p_delta, const Vector<RID> &p_readback_bodies, uint64_t p_step) {
+
+	physics_server->step(p_delta);
+
+	// capture the tracked bodies while the main thread is still busy, sync() publishes them
+	readback_back_bodies = p_readback_bodies;
+	readback_back_step = p_step;
+	readback_back.resize(p_readback_bodies.size());
+
+	BodyStateData *w = readback_back.ptrw();
+	for (int i = 0; i < p_readback_bodies.size(); i++) {
+		_capture_body_state(p_readback_bodies[i], w[i]);
+	}
+
+	step_sem->post();
+}
+
+void PhysicsServerWrapMT::_thread_callback(void *_instance) {
+
+	PhysicsServerWrapMT *vsmt = reinterpret_cast<PhysicsServerWrapMT *>(_instance);
+
+	vsmt->thread_loop();
+}
+
+void PhysicsServerWrapMT::thread_loop() {
+
+	server_thread = Thread::get_caller_id();
+
+	physics_server->init();
+
+	exit = false;
+	step_thread_up = true;
+	while (!exit) {
+		// flush commands one by one, until exit is requested
+		command_queue.wait_and_flush_one();
+	}
+
+	command_queue.flush_all(); // flush all
+
+	physics_server->finish();
+}
+
+/* BODY STATE READBACK */
+
+void PhysicsServerWrapMT::_capture_body_state(RID p_body, BodyStateData &r_state) const {
+
+	r_state.transform = physics_server->body_get_state(p_body, BODY_STATE_TRANSFORM);
+	r_state.linear_velocity = physics_server->body_get_state(p_body, BODY_STATE_LINEAR_VELOCITY);
+	r_state.angular_velocity = physics_server->body_get_state(p_body, BODY_STATE_ANGULAR_VELOCITY);
+	r_state.sleeping = physics_server->body_get_state(p_body, BODY_STATE_SLEEPING);
+	r_state.can_sleep = physics_server->body_get_state(p_body, BODY_STATE_CAN_SLEEP);
+}
+
+void PhysicsServerWrapMT::_wait_for_step() {
+
+	if (!step_pending)
+		return;
+
+	step_sem->wait();
+	step_pending = false;
+
+	MutexLock lock(readback_mutex);
+
+	const RID *bodies = readback_back_bodies.ptr();
+	const BodyStateData *states = readback_back.ptr();
+	for (int i = 0; i < readback_back_bodies.size(); i++) {
+
+		Map<RID, BodyReadback>::Element *E = body_readback.find(bodies[i]);
+		if (!E)
+			continue; // freed while stepping
+
+		BodyReadback &rb = E->get();
+		if (!rb.tracked || rb.integrated || rb.changed_step >= readback_back_step)
+			continue; // changed after the step was issued, the captured state is stale
+
+		rb.state = states[i];
+		rb.valid = true;
+	}
+}
+
+bool PhysicsServerWrapMT::_body_readback_get(RID p_body, BodyState p_state, Variant &r_value) const {
+
+	MutexLock lock(readback_mutex);
+
+	Map<RID, BodyReadback>::Element *E = body_readback.find(p_body);
+	if (!E)
+		return false;
+
+	BodyReadback &rb = E->get();
+	rb.tracked = true;
+	if (!rb.valid)
+		return false;
+
+	switch (p_state) {
+		case BODY_STATE_TRANSFORM: r_value = rb.state.transform; break;
+		case BODY_STATE_LINEAR_VELOCITY: r_value = rb.state.linear_velocity; break;
+		case BODY_STATE_ANGULAR_VELOCITY: r_value = rb.state.angular_velocity; break;
+		case BODY_STATE_SLEEPING: r_value = rb.state.sleeping; break;
+		case BODY_STATE_CAN_SLEEP: r_value = rb.state.can_sleep; break;
+		default: return false;
+	}
+
+	return true;
+}
+
+void PhysicsServerWrapMT::_body_readback_changed(RID p_body) {
+
+	if (!create_thread)
+		return;
+
+	MutexLock lock(readback_mutex);
+
+	Map<RID, BodyReadback>::Element *E = body_readback.find(p_body);
+	if (!E)
+		return;
+
+	E->get().valid = false;
+	E->get().changed_step = step_count;
+}
+
+/* BODY API */
+
+RID PhysicsServerWrapMT::body_create(BodyMode p_mode, bool p_init_sleeping) {
+
+	RID rid;
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push_and_ret(physics_server, &PhysicsServer::body_create, p_mode, p_init_sleeping, &rid);
+	} else {
+		rid = physics_server->body_create(p_mode, p_init_sleeping);
+	}
+
+	if (create_thread && rid.is_valid()) {
+		MutexLock lock(readback_mutex);
+		body_readback[rid] = BodyReadback();
+	}
+
+	return rid;
+}
+
+void PhysicsServerWrapMT::body_set_space(RID p_body, RID p_space) {
+
+	_body_readback_changed(p_body);
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(physics_server, &PhysicsServer::body_set_space, p_body, p_space);
+	} else {
+		physics_server->body_set_space(p_body, p_space);
+	}
+}
+
+void PhysicsServerWrapMT::body_set_mode(RID p_body, BodyMode p_mode) {
+
+	_body_readback_changed(p_body);
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(physics_server, &PhysicsServer::body_set_mode, p_body, p_mode);
+	} else {
+		physics_server->body_set_mode(p_body, p_mode);
+	}
+}
+
+void PhysicsServerWrapMT::body_set_state(RID p_body, BodyState p_state, const Variant &p_variant) {
+
+	_body_readback_changed(p_body);
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(physics_server, &PhysicsServer::body_set_state, p_body, p_state, p_variant);
+	} else {
+		physics_server->body_set_state(p_body, p_state, p_variant);
+	}
+}
+
+Variant PhysicsServerWrapMT::body_get_state(RID p_body, BodyState p_state) const {
+
+	if (Thread::get_caller_id() != server_thread) {
+
+		Variant ret;
+		if (create_thread && _body_readback_get(p_body, p_state, ret))
+			return ret;
+
+		command_queue.push_and_ret(physics_server, &PhysicsServer::body_get_state, p_body, p_state, &ret);
+		return ret;
+	} else {
+		return physics_server->body_get_state(p_body, p_state);
+	}
+}
+
+void PhysicsServerWrapMT::bodies_get_state(const RID *p_bodies, int p_count, Transform *r_transforms, Vector3 *r_linear_velocities, Vector3 *r_angular_velocities) const {
+
+	if (Thread::get_caller_id() == server_thread) {
+		physics_server->bodies_get_state(p_bodies, p_count, r_transforms, r_linear_velocities, r_angular_velocities);
+		return;
+	}
+
+	if (!create_thread) {
+		command_queue.push_and_sync(physics_server, &PhysicsServer::bodies_get_state, p_bodies, p_count, r_transforms, r_linear_velocities, r_angular_velocities);
+		return;
+	}
+
+	// Served from the readback buffer, bodies without a published state are read from the server all at once.
+	Vector<int> missing;
+	{
+		MutexLock lock(readback_mutex);
+
+		for (int i = 0; i < p_count; i++) {
+
+			Map<RID, BodyReadback>::Element *E = body_readback.find(p_bodies[i]);
+			if (!E) {
+				missing.push_back(i);
+				continue;
+			}
+
+			BodyReadback &rb = E->get();
+			rb.tracked = true;
+			if (!rb.valid) {
+				missing.push_back(i);
+				continue;
+			}
+
+			if (r_transforms)
+				r_transforms[i] = rb.state.transform;
+			if (r_linear_velocities)
+				r_linear_velocities[i] = rb.state.linear_velocity;
+			if (r_angular_velocities)
+				r_angular_velocities[i] = rb.state.angular_velocity;
+		}
+	}
+
+	if (missing.empty())
+		return;
+
+	if (missing.size() == p_count) {
+		command_queue.push_and_sync(physics_server, &PhysicsServer::bodies_get_state, p_bodies, p_count, r_transforms, r_linear_velocities, r_angular_velocities);
+		return;
+	}
+
+	int missing_count = missing.size();
+	Vector<RID> bodies;
+	bodies.resize(missing_count);
+	Vector<Transform> transforms;
+	transforms.resize(r_transforms ? missing_count : 0);
+	Vector<Vector3> linear_velocities;
+	linear_velocities.resize(r_linear_velocities ? missing_count : 0);
+	Vector<Vector3> angular_velocities;
+	angular_velocities.resize(r_angular_velocities ? missing_count : 0);
+
+	for (int i = 0; i < missing_count; i++) {
+		bodies.write[i] = p_bodies[missing[i]];
+	}
+
+	command_queue.push_and_sync(physics_server, &PhysicsServer::bodies_get_state, (const RID *)bodies.ptr(), missing_count, transforms.ptrw(), linear_velocities.ptrw(), angular_velocities.ptrw());
+
+	for (int i = 0; i < missing_count; i++) {
+		if (r_transforms)
+			r_transforms[missing[i]] = transforms[i];
+		if (r_linear_velocities)
+			r_linear_velocities[missing[i]] = linear_velocities[i];
+		if (r_angular_velocities)
+			r_angular_velocities[missing[i]] = angular_velocities[i];
+	}
+}
+
+void PhysicsServerWrapMT::body_apply_central_impulse(RID p_body, const Vector3 &p_impulse) {
+
+	_body_readback_changed(p_body);
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(physics_server, &PhysicsServer::body_apply_central_impulse, p_body, p_impulse);
+	} else {
+		physics_server->body_apply_central_impulse(p_body, p_impulse);
+	}
+}
+
+void PhysicsServerWrapMT::body_apply_impulse(RID p_body, const Vector3 &p_pos, const Vector3 &p_impulse) {
+
+	_body_readback_changed(p_body);
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(physics_server, &PhysicsServer::body_apply_impulse, p_body, p_pos, p_impulse);
+	} else {
+		physics_server->body_apply_impulse(p_body, p_pos, p_impulse);
+	}
+}
+
+void PhysicsServerWrapMT::body_apply_torque_impulse(RID p_body, const Vector3 &p_impulse) {
+
+	_body_readback_changed(p_body);
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(physics_server, &PhysicsServer::body_apply_torque_impulse, p_body, p_impulse);
+	} else {
+		physics_server->body_apply_torque_impulse(p_body, p_impulse);
+	}
+}
+
+void PhysicsServerWrapMT::body_set_axis_velocity(RID p_body, const Vector3 &p_axis_velocity) {
+
+	_body_readback_changed(p_body);
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(physics_server, &PhysicsServer::body_set_axis_velocity, p_body, p_axis_velocity);
+	} else {
+		physics_server->body_set_axis_velocity(p_body, p_axis_velocity);
+	}
+}
+
+void PhysicsServerWrapMT::body_set_force_integration_callback(RID p_body, Object *p_receiver, const StringName &p_method, const Variant &p_udata) {
+
+	if (create_thread) {
+		// the callback runs from flush_queries() and may write the state, see flush_queries()
+		MutexLock lock(readback_mutex);
+		Map<RID, BodyReadback>::Element *E = body_readback.find(p_body);
+		if (E) {
+			E->get().integrated = p_receiver != NULL;
+			E->get().valid = false;
+			E->get().changed_step = step_count;
+		}
+	}
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(physics_server, &PhysicsServer::body_set_force_integration_callback, p_body, p_receiver, p_method, p_udata);
+	} else {
+		physics_server->body_set_force_integration_callback(p_body, p_receiver, p_method, p_udata);
+	}
+}
+
+PhysicsDirectBodyState *PhysicsServerWrapMT::body_get_direct_state(RID p_body) {
+
+	ERR_FAIL_COND_V(main_thread != Thread::get_caller_id(), NULL);
+
+	_body_readback_changed(p_body); // the direct state can write the body
+	return physics_server->body_get_direct_state(p_body);
+}
+
+/* MISC */
+
+void PhysicsServerWrapMT::free(RID p_rid) {
+
+	// keep the erase and the push ordered against step(), so a step never captures a freed body
+	MutexLock lock(readback_mutex);
+
+	if (create_thread)
+		body_readback.erase(p_rid);
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(physics_server, &PhysicsServer::free, p_rid);
+	} else {
+		physics_server->free(p_rid);
+	}
+}
+
+/* EVENT QUEUING */
+
+void PhysicsServerWrapMT::step(real_t p_step) {
+
+	if (create_thread) {
+
+		_wait_for_step(); // sync() was skipped, do not overlap two steps
+
+		MutexLock lock(readback_mutex);
+
+		step_count++;
+
+		Vector<RID> bodies;
+		for (Map<RID, BodyReadback>::Element *E = body_readback.front(); E; E = E->next()) {
+			if (!E->get().tracked)
+				continue;
+			if (E->get().integrated) {
+				E->get().valid = false; // until flush_queries() has run after this step
+			} else {
+				bodies.push_back(E->key());
+			}
+		}
+
+		step_pending = true;
+		command_queue.push(this, &PhysicsServerWrapMT::thread_step, p_step, bodies, step_count);
+	} else {
+
+		command_queue.flush_all(); //flush all pending from other threads
+		physics_server->step(p_step);
+	}
+}
+
+void PhysicsServerWrapMT::sync() {
+
+	if (create_thread) {
+		_wait_for_step(); //must not wait if a step was not issued
+	}
+	physics_server->sync();
+}
+
+void PhysicsServerWrapMT::flush_queries() {
+
+	if (create_thread) {
+		// sync() only waited for the step, commands queued after it may still be running
+		command_queue.push_and_sync(this, &PhysicsServerWrapMT::thread_flush);
+	}
+
+	physics_server->flush_queries();
+
+	if (!create_thread)
+		return;
+
+	// the queue was flushed and the server thread waits for the next command, so
+	// the force integration callbacks are done writing their bodies
+	MutexLock lock(readback_mutex);
+
+	for (Map<RID, BodyReadback>::Element *E = body_readback.front(); E; E = E->next()) {
+
+		BodyReadback &rb = E->get();
+		if (!rb.tracked || !rb.integrated || rb.changed_step >= step_count)
+			continue; // written since the last step was issued, the change may still be queued
+
+		_capture_body_state(E->key(), rb.state);
+		rb.valid = true;
+	}
+}
+
+void PhysicsServerWrapMT::end_sync() {
+
+	// called before step() is queued, so the direct states are refused from then on
+	physics_server->end_sync();
+}
+
+void PhysicsServerWrapMT::init() {
+
+	if (create_thread) {
+
+		step_sem = Semaphore::create();
+		thread = Thread::create(_thread_callback, this);
+		while (!step_thread_up) {
+			OS::get_singleton()->delay_usec(1000);
+		}
+	} else {
+
+		physics_server->init();
+	}
+}
+
+void PhysicsServerWrapMT::finish() {
+
+	if (thread) {
+
+		_wait_for_step();
+
+		command_queue.push(this, &PhysicsServerWrapMT::thread_exit);
+		Thread::wait_to_finish(thread);
+		memdelete(thread);
+
+		thread = NULL;
+	} else {
+		physics_server->finish();
+	}
+
+	space_free_cached_ids();
+	area_free_cached_ids();
+
+	body_readback.clear();
+
+	if (step_sem)
+		memdelete(step_sem);
+	step_sem = NULL;
+}
+
+PhysicsServerWrapMT::PhysicsServerWrapMT(PhysicsServer *p_contained, bool p_create_thread) :
+		command_queue(p_create_thread) {
+
+	physics_server = p_contained;
+	create_thread = p_create_thread;
+	thread = NULL;
+	step_sem = NULL;
+	step_pending = false;
+	step_thread_up = false;
+	alloc_mutex = Mutex::create();
+	readback_mutex = p_create_thread ? Mutex::create() : NULL;
+	step_count = 0;
+	readback_back_step = 0;
+
+	pool_max_size = GLOBAL_GET("memory/limits/multithreaded_server/rid_pool_prealloc");
+
+	if (!p_create_thread) {
+		server_thread = Thread::get_caller_id();
+	} else {
+		server_thread = 0;
+	}
+
+	main_thread = Thread::get_caller_id();
+}
+
+PhysicsServerWrapMT::~PhysicsServerWrapMT() {
+
+	memdelete(physics_server);
+	memdelete(alloc_mutex);
+	if (readback_mutex)
+		memdelete(readback_mutex);
+	//finish();
+}
@@ -1575,13 +1575,245 @@ Vector3 HeightMapShapeSW::get_support(const Vector3 &p_normal) const {
 	return get_aabb().get_support(p_normal);
 }
 
-bool HeightMapShapeSW::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
+Vector3 HeightMapShapeSW::_get_point(const real_t *p_heights, int p_x, int p_z) const {
+
+	// the grid is centered horizontally
+	return Vector3((p_x - (width - 1) * 0.5) * cell_size, p_heights[p_z * width + p_x], (p_z - (depth - 1) * 0.5) * cell_size);
+}
+
+Vector2 HeightMapShapeSW::_get_grid_pos(const Vector3 &p_point) const {
+
+	return Vector2(p_point.x / cell_size + (width - 1) * 0.5, p_point.z / cell_size + (depth - 1) * 0.5);
+}
+
+// Walks the cells of a grid of unit cells crossed by p_from + p_dir * t, for t between p_t_begin and p_t_end,
+// in order. The visitor gets each cell and the range of t inside it, and returns true to stop.
+template <class V>
+static bool _heightmap_walk_grid(const Vector2 &p_from, const Vector2 &p_dir, real_t p_t_begin, real_t p_t_end, int p_max_steps, V &p_visitor) {
+
+	Vector2 begin = p_from + p_dir * p_t_begin;
+	int x = Math::floor(begin.x);
+	int z = Math::floor(begin.y);
+
+	int step_x = p_dir.x > 0 ? 1 : -1;
+	int step_z = p_dir.y > 0 ? 1 : -1;
+
+	// t at which the next cell boundary is crossed on each axis, and t needed to cross a whole cell
+	real_t t_max_x = 1e20;
+	real_t t_max_z = 1e20;
+	real_t t_delta_x = 1e20;
+	real_t t_delta_z = 1e20;
+
+	if (p_dir.x != 0) {
+		t_max_x = ((x + (step_x > 0 ? 1 : 0)) - p_from.x) / p_dir.x;
+		t_delta_x = 1.0 / Math::abs(p_dir.x);
+	}
+	if (p_dir.y != 0) {
+		t_max_z = ((z + (step_z > 0 ? 1 : 0)) - p_from.y) / p_dir.y;
+		t_delta_z = 1.0 / Math::abs(p_dir.y);
+	}
+
+	real_t t = p_t_begin;
+	for (int i = 0; i < p_max_steps; i++) {
+
+		real_t t_next = MIN(MIN(t_max_x, t_max_z), p_t_end);
+		if (p_visitor.visit(x, z, t, t_next))
+			return true;
+
+		if (t_next >= p_t_end)
+			break;
+
+		if (t_max_x < t_max_z) {
+			x += step_x;
+			t = t_max_x;
+			t_max_x += t_delta_x;
+		} else {
+			z += step_z;
+			t = t_max_z;
+			t_max_z += t_delta_z;
+		}
+	}
 
 	return false;
 }
 
+bool HeightMapShapeSW::_intersect_cell(const real_t *p_heights, int p_x, int p_z, const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
+
+	Vector3 p00 = _get_point(p_heights, p_x, p_z);
+	Vector3 p10 = _get_point(p_heights, p_x + 1, p_z);
+	Vector3 p01 = _get_point(p_heights, p_x, p_z + 1);
+	Vector3 p11 = _get_point(p_heights, p_x + 1, p_z + 1);
+
+	// same split as the triangles reported by cull()
+	Face3 faces[2] = { Face3(p00, p10, p11), Face3(p00, p11, p01) };
+
+	bool collided = false;
+	real_t min_d = 1e20;
+
+	for (int i = 0; i < 2; i++) {
+
+		Vector3 res;
+		if (faces[i].intersects_segment(p_begin, p_end, &res)) {
+
+			real_t d = p_begin.distance_squared_to(res);
+			if (d < min_d) {
+				min_d = d;
+				r_point = res;
+				r_normal = faces[i].get_plane().normal;
+				collided = true;
+			}
+		}
+	}
+
+	return collided;
+}
+
+bool HeightMapShapeSW::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
+
+	if (width < 2 || depth < 2)
+		return false;
+
+	// clip the segment to the bounds of the heightmap
+	Vector3 dir = p_end - p_begin;
+	real_t t_begin = 0;
+	real_t t_end = 1;
+
+	const AABB &aabb = get_aabb();
+	for (int i = 0; i < 3; i++) {
+
+		real_t from = aabb.position[i];
+		real_t to = aabb.position[i] + aabb.size[i];
+
+		if (Math::abs(dir[i]) < CMP_EPSILON) {
+			if (p_begin[i] < from || p_begin[i] > to)
+				return false;
+			continue;
+		}
+
+		real_t t0 = (from - p_begin[i]) / dir[i];
+		real_t t1 = (to - p_begin[i]) / dir[i];
+		if (t0 > t1)
+			SWAP(t0, t1);
+
+		t_begin = MAX(t_begin, t0);
+		t_end = MIN(t_end, t1);
+		if (t_begin > t_end)
+			return false;
+	}
+
+	PoolVector<real_t>::Read r = heights.read();
+
+	// walk the chunks of the first bounds level, and the cells of the chunks the segment may touch
+	struct CellVisitor {
+
+		const HeightMapShapeSW *shape;
+		const real_t *heights;
+		Vector3 begin;
+		Vector3 end;
+		Vector3 point;
+		Vector3 normal;
+
+		_FORCE_INLINE_ bool visit(int p_x, int p_z, real_t p_t_in, real_t p_t_out) {
+
+			p_x = CLAMP(p_x, 0, shape->width - 2);
+			p_z = CLAMP(p_z, 0, shape->depth - 2);
+
+			real_t y_in = begin.y + (end.y - begin.y) * p_t_in;
+			real_t y_out = begin.y + (end.y - begin.y) * p_t_out;
+
+			real_t h00 = heights[p_z * shape->width + p_x];
+			real_t h10 = heights[p_z * shape->width + p_x + 1];
+			real_t h01 = heights[(p_z + 1) * shape->width + p_x];
+			real_t h11 = heights[(p_z + 1) * shape->width + p_x + 1];
+
+			if (MIN(y_in, y_out) > MAX(MAX(h00, h10), MAX(h01, h11)) || MAX(y_in, y_out) < MIN(MIN(h00, h10), MIN(h01, h11)))
+				return false;
+
+			return shape->_intersect_cell(heights, p_x, p_z, begin, end, point, normal);
+		}
+	};
+
+	struct ChunkVisitor {
+
+		const HeightMapShapeSW *shape;
+		const BoundsLevel *level;
+		Vector2 from;
+		Vector2 dir;
+		CellVisitor *cells;
+
+		_FORCE_INLINE_ bool visit(int p_x, int p_z, real_t p_t_in, real_t p_t_out) {
+
+			p_x = CLAMP(p_x, 0, level->width - 1);
+			p_z = CLAMP(p_z, 0, level->depth - 1);
+
+			real_t y_in = cells->begin.y + (cells->end.y - cells->begin.y) * p_t_in;
+			real_t y_out = cells->begin.y + (cells->end.y - cells->begin.y) * p_t_out;
+
+			const Range &range = level->ranges[p_z * level->width + p_x];
+			if (MIN(y_in, y_out) > range.max || MAX(y_in, y_out) < range.min)
+				return false;
+
+			return _heightmap_walk_grid(from, dir, p_t_in, p_t_out, BOUNDS_CHUNK_SIZE * 2 + 2, *cells);
+		}
+	};
+
+	CellVisitor cells;
+	cells.shape = this;
+	cells.heights = r.ptr();
+	cells.begin = p_begin;
+	cells.end = p_end;
+
+	ChunkVisitor chunks;
+	chunks.shape = this;
+	chunks.level = &bounds[0];
+	chunks.from = _get_grid_pos(p_begin);
+	chunks.dir = _get_grid_pos(p_end) - chunks.from;
+	chunks.cells = &cells;
+
+	Vector2 chunk_from = chunks.from / BOUNDS_CHUNK_SIZE;
+	Vector2 chunk_dir = chunks.dir / BOUNDS_CHUNK_SIZE;
+
+	if (!_heightmap_walk_grid(chunk_from, chunk_dir, t_begin, t_end, chunks.level->width + chunks.level->depth + 2, chunks))
+		return false;
+
+	r_point = cells.point;
+	r_normal = cells.normal;
+	return true;
+}
+
 bool HeightMapShapeSW::intersect_point(const Vector3 &p_point) const {
-	return false;
+
+	if (width < 2 || depth < 2)
+		return false;
+
+	Vector2 pos = _get_grid_pos(p_point);
+	if (pos.x < 0 || pos.y < 0 || pos.x > width - 1 || pos.y > depth - 1)
+		return false;
+
+	if (p_point.y < min_height)
+		return false;
+
+	int x = MIN((int)pos.x, width - 2);
+	int z = MIN((int)pos.y, depth - 2);
+	real_t fx = pos.x - x;
+	real_t fz = pos.y - z;
+
+	PoolVector<real_t>::Read r = heights.read();
+	real_t h00 = r[z * width + x];
+	real_t h10 = r[z * width + x + 1];
+	real_t h01 = r[(z + 1) * width + x];
+	real_t h11 = r[(z + 1) * width + x + 1];
+
+	// interpolate in the triangle the point is above, cells are split from (x, z) to (x + 1, z + 1)
+	real_t h;
+	if (fx > fz) {
+		h = h00 + (h10 - h00) * (fx - fz) + (h11 - h00) * fz;
+	} else {
+		h = h00 + (h01 - h00) * (fz - fx) + (h11 - h00) * fx;
+	}
+
+	// the heightmap is solid below its surface
+	return p_point.y <= h;
 }
 
 Vector3 HeightMapShapeSW::get_closest_point_to(const Vector3 &p_point) const {
@@ -1589,7 +1821,102 @@ Vector3 HeightMapShapeSW::get_closest_point_to(const Vector3 &p_point) const {
 	return Vector3();
 }
 
+void HeightMapShapeSW::_cull_cell(int p_x, int p_z, _CullParams *p_params) const {
+
+	Vector3 p00 = _get_point(p_params->heights, p_x, p_z);
+	Vector3 p10 = _get_point(p_params->heights, p_x + 1, p_z);
+	Vector3 p01 = _get_point(p_params->heights, p_x, p_z + 1);
+	Vector3 p11 = _get_point(p_params->heights, p_x + 1, p_z + 1);
+
+	real_t min_y = MIN(MIN(p00.y, p10.y), MIN(p01.y, p11.y));
+	real_t max_y = MAX(MAX(p00.y, p10.y), MAX(p01.y, p11.y));
+	if (max_y < p_params->aabb.position.y || min_y > p_params->aabb.position.y + p_params->aabb.size.y)
+		return;
+
+	FaceShapeSW *face = p_params->face;
+
+	face->vertex[0] = p00;
+	face->vertex[1] = p10;
+	face->vertex[2] = p11;
+	face->normal = Plane(p00, p10, p11).normal;
+	p_params->callback(p_params->userdata, face);
+
+	face->vertex[0] = p00;
+	face->vertex[1] = p11;
+	face->vertex[2] = p01;
+	face->normal = Plane(p00, p11, p01).normal;
+	p_params->callback(p_params->userdata, face);
+}
+
+void HeightMapShapeSW::_cull_bounds(int p_level, int p_x, int p_z, _CullParams *p_params) const {
+
+	// cells covered by this chunk
+	int size = BOUNDS_CHUNK_SIZE << p_level;
+	int from_x = MAX(p_x * size, p_params->from_x);
+	int from_z = MAX(p_z * size, p_params->from_z);
+	int to_x = MIN(p_x * size + size - 1, p_params->to_x);
+	int to_z = MIN(p_z * size + size - 1, p_params->to_z);
+
+	if (from_x > to_x || from_z > to_z)
+		return;
+
+	const BoundsLevel &level = bounds[p_level];
+	const Range &range = level.ranges[p_z * level.width + p_x];
+	if (range.max < p_params->aabb.position.y || range.min > p_params->aabb.position.y + p_params->aabb.size.y)
+		return;
+
+	if (p_level == 0) {
+
+		for (int z = from_z; z <= to_z; z++) {
+			for (int x = from_x; x <= to_x; x++) {
+				_cull_cell(x, z, p_params);
+			}
+		}
+		return;
+	}
+
+	const BoundsLevel &child_level = bounds[p_level - 1];
+	for (int z = p_z * 2; z < MIN(p_z * 2 + 2, child_level.depth); z++) {
+		for (int x = p_x * 2; x < MIN(p_x * 2 + 2, child_level.width); x++) {
+			_cull_bounds(p_level - 1, x, z, p_params);
+		}
+	}
+}
+
 void HeightMapShapeSW::cull(const AABB &p_local_aabb, Callback p_callback, void *p_userdata) const {
+
+	if (width < 2 || depth < 2)
+		return;
+
+	// range of cells under the AABB
+	Vector2 from = _get_grid_pos(p_local_aabb.position);
+	Vector2 to = _get_grid_pos(p_local_aabb.position + p_local_aabb.size);
+
+	_CullParams params;
+	params.from_x = MAX((int)Math::floor(from.x), 0);
+	params.from_z = MAX((int)Math::floor(from.y), 0);
+	params.to_x = MIN((int)Math::floor(to.x), width - 2);
+	params.to_z = MIN((int)Math::floor(to.y), depth - 2);
+
+	if (params.from_x > params.to_x || params.from_z > params.to_z)
+		return;
+
+	PoolVector<real_t>::Read r = heights.read();
+
+	FaceShapeSW face; // use this to send in the callback
+
+	params.aabb = p_local_aabb;
+	params.callback = p_callback;
+	params.userdata = p_userdata;
+	params.heights = r.ptr();
+	params.face = &face;
+
+	int top = bounds.size() - 1;
+	for (int z = 0; z < bounds[top].depth; z++) {
+		for (int x = 0; x < bounds[top].width; x++) {
+			_cull_bounds(top, x, z, &params);
+		}
+	}
 }
 
 Vector3 HeightMapShapeSW::get_moment_of_inertia(real_t p_mass) const {
@@ -1612,23 +1939,77 @@ void HeightMapShapeSW::_setup(PoolVector<real_t> p_heights, int p_width, int p_d
 
 	PoolVector<real_t>::Read r = heights.read();
 
-	AABB aabb;
+	min_height = r[0];
+	max_height = r[0];
+	for (int i = 1; i < width * depth; i++) {
+		min_height = MIN(min_height, r[i]);
+		max_height = MAX(max_height, r[i]);
+	}
 
-	for (int i = 0; i < depth; i++) {
+	// first bounds level, from the heights of the vertices of each chunk
+	bounds.clear();
 
-		for (int j = 0; j < width; j++) {
+	BoundsLevel level;
+	level.width = MAX((width - 2) / BOUNDS_CHUNK_SIZE + 1, 1);
+	level.depth = MAX((depth - 2) / BOUNDS_CHUNK_SIZE + 1, 1);
+	level.ranges.resize(level.width * level.depth);
 
-			real_t h = r[i * width + j];
+	for (int i = 0; i < level.depth; i++) {
+		for (int j = 0; j < level.width; j++) {
 
-			Vector3 pos(j * cell_size, h, i * cell_size);
-			if (i == 0 || j == 0)
-				aabb.position = pos;
-			else
-				aabb.expand_to(pos);
+			Range range;
+			range.min = 1e20;
+			range.max = -1e20;
+
+			int to_z = MIN((i + 1) * BOUNDS_CHUNK_SIZE, depth - 1);
+			int to_x = MIN((j + 1) * BOUNDS_CHUNK_SIZE, width - 1);
+			for (int z = i * BOUNDS_CHUNK_SIZE; z <= to_z; z++) {
+				for (int x = j * BOUNDS_CHUNK_SIZE; x <= to_x; x++) {
+					range.min = MIN(range.min, r[z * width + x]);
+					range.max = MAX(range.max, r[z * width + x]);
+				}
+			}
+
+			level.ranges.write[i * level.width + j] = range;
 		}
 	}
 
-	configure(aabb);
+	bounds.push_back(level);
+
+	// each next level merges 2x2 chunks of the previous one
+	while (bounds[bounds.size() - 1].width > 1 || bounds[bounds.size() - 1].depth > 1) {
+
+		const BoundsLevel &prev = bounds[bounds.size() - 1];
+
+		BoundsLevel next;
+		next.width = (prev.width + 1) / 2;
+		next.depth = (prev.depth + 1) / 2;
+		next.ranges.resize(next.width * next.depth);
+
+		for (int i = 0; i < next.depth; i++) {
+			for (int j = 0; j < next.width; j++) {
+
+				Range range;
+				range.min = 1e20;
+				range.max = -1e20;
+
+				for (int z = i * 2; z < MIN(i * 2 + 2, prev.depth); z++) {
+					for (int x = j * 2; x < MIN(j * 2 + 2, prev.width); x++) {
+						const Range &child = prev.ranges[z * prev.width + x];
+						range.min = MIN(range.min, child.min);
+						range.max = MAX(range.max, child.max);
+					}
+				}
+
+				next.ranges.write[i * next.width + j] = range;
+			}
+		}
+
+		bounds.push_back(next);
+	}
+
+	Vector3 size((width - 1) * cell_size, max_height - min_height, (depth - 1) * cell_size);
+	configure(AABB(Vector3(size.x * -0.5, min_height, size.z * -0.5), size));
 }
 
 void HeightMapShapeSW::set_data(const Variant &p_data) {
@@ -1637,12 +2018,12 @@ void HeightMapShapeSW::set_data(const Variant &p_data) {
 	Dictionary d = p_data;
 	ERR_FAIL_COND(!d.has("width"));
 	ERR_FAIL_COND(!d.has("depth"));
-	ERR_FAIL_COND(!d.has("cell_size"));
 	ERR_FAIL_COND(!d.has("heights"));
 
 	int width = d["width"];
 	int depth = d["depth"];
-	real_t cell_size = d["cell_size"];
+	// HeightMapShape doesn't send a cell size, its cells are always 1 unit wide
+	real_t cell_size = d.has("cell_size") ? real_t(d["cell_size"]) : 1.0;
 	PoolVector<real_t> heights = d["heights"];
 
 	ERR_FAIL_COND(width <= 0);
@@ -1654,7 +2035,14 @@ void HeightMapShapeSW::set_data(const Variant &p_data) {
 
 Variant HeightMapShapeSW::get_data() const {
 
-	ERR_FAIL_V(Variant());
+	Dictionary d;
+	d["width"] = width;
+	d["depth"] = depth;
+	d["cell_size"] = cell_size;
+	d["heights"] = heights;
+	d["min_height"] = min_height;
+	d["max_height"] = max_height;
+	return d;
 }
 
 HeightMapShapeSW::HeightMapShapeSW() {
@@ -1662,4 +2050,6 @@ HeightMapShapeSW::HeightMapShapeSW() {
 	width = 0;
 	depth = 0;
 	cell_size = 0;
+	min_height = 0;
+	max_height = 0;
 }
@@ -372,9 +372,48 @@ struct HeightMapShapeSW : public ConcaveShapeSW {
 	int width;
 	int depth;
 	real_t cell_size;
+	real_t min_height;
+	real_t max_height;
 
-	//void _cull_segment(int p_idx,_SegmentCullParams *p_params) const;
-	//void _cull(int p_idx,_CullParams *p_params) const;
+	enum {
+		BOUNDS_CHUNK_SIZE = 8 // cells per side of the chunks in the first bounds level
+	};
+
+	struct Range {
+
+		real_t min;
+		real_t max;
+	};
+
+	struct BoundsLevel {
+
+		int width; // in chunks
+		int depth;
+		Vector<Range> ranges;
+	};
+
+	// min/max heights of square chunks of cells, each level halving the resolution of the previous one, down to a single chunk
+	Vector<BoundsLevel> bounds;
+
+	struct _CullParams {
+
+		AABB aabb;
+		int from_x;
+		int from_z;
+		int to_x;
+		int to_z;
+		Callback callback;
+		void *userdata;
+		const real_t *heights;
+		FaceShapeSW *face;
+	};
+
+	_FORCE_INLINE_ Vector3 _get_point(const real_t *p_heights, int p_x, int p_z) const;
+	_FORCE_INLINE_ Vector2 _get_grid_pos(const Vector3 &p_point) const;
+
+	void _cull_bounds(int p_level, int p_x, int p_z, _CullParams *p_params) const;
+	void _cull_cell(int p_x, int p_z, _CullParams *p_params) const;
+	bool _intersect_cell(const real_t *p_heights, int p_x, int p_z, const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const;
 
 	void _setup(PoolVector<real_t> p_heights, int p_width, int p_depth, real_t p_cell_size);
 
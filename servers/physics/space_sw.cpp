@@ -31,6 +31,7 @@
 #include "space_sw.h"
 
 #include "collision_solver_sw.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/project_settings.h"
 #include "physics_server_sw.h"
 
@@ -93,9 +94,8 @@ int PhysicsDirectSpaceStateSW::intersect_point(const Vector3 &p_point, ShapeResu
 	return cc;
 }
 
-bool PhysicsDirectSpaceStateSW::intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_ray) {
-
-	ERR_FAIL_COND_V(space->locked, false);
+//narrow phase of a ray against broadphase results, shared by intersect_ray and the batched queries
+static bool _intersect_ray_candidates(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW *const *p_objects, const int *p_shapes, int p_amount, PhysicsDirectSpaceState::RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_ray) {
 
 	Vector3 begin, end;
 	Vector3 normal;
@@ -103,8 +103,6 @@ bool PhysicsDirectSpaceStateSW::intersect_ray(const Vector3 &p_from, const Vecto
 	end = p_to;
 	normal = (end - begin).normalized();
 
-	int amount = space->broadphase->cull_segment(begin, end, space->intersection_query_results, SpaceSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
-
 	//todo, create another array that references results, compute AABBs and check closest point to ray origin, sort, and stop evaluating results when beyond first collision
 
 	bool collided = false;
@@ -113,20 +111,20 @@ bool PhysicsDirectSpaceStateSW::intersect_ray(const Vector3 &p_from, const Vecto
 	const CollisionObjectSW *res_obj;
 	real_t min_d = 1e10;
 
-	for (int i = 0; i < amount; i++) {
+	for (int i = 0; i < p_amount; i++) {
 
-		if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
+		if (!_can_collide_with(p_objects[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
 			continue;
 
-		if (p_pick_ray && !(space->intersection_query_results[i]->is_ray_pickable()))
+		if (p_pick_ray && !(p_objects[i]->is_ray_pickable()))
 			continue;
 
-		if (p_exclude.has(space->intersection_query_results[i]->get_self()))
+		if (p_exclude.has(p_objects[i]->get_self()))
 			continue;
 
-		const CollisionObjectSW *col_obj = space->intersection_query_results[i];
+		const CollisionObjectSW *col_obj = p_objects[i];
 
-		int shape_idx = space->intersection_query_subindex_results[i];
+		int shape_idx = p_shapes[i];
 		Transform inv_xform = col_obj->get_shape_inv_transform(shape_idx) * col_obj->get_inv_transform();
 
 		Vector3 local_from = inv_xform.xform(begin);
@@ -171,12 +169,21 @@ bool PhysicsDirectSpaceStateSW::intersect_ray(const Vector3 &p_from, const Vecto
 	return true;
 }
 
+bool PhysicsDirectSpaceStateSW::intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_ray) {
+
+	ERR_FAIL_COND_V(space->locked, false);
+
+	int amount = space->broadphase->cull_segment(p_from, p_to, space->intersection_query_results, SpaceSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+
+	return _intersect_ray_candidates(p_from, p_to, space->intersection_query_results, space->intersection_query_subindex_results, amount, r_result, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas, p_pick_ray);
+}
+
 int PhysicsDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Transform &p_xform, real_t p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 
 	if (p_result_max <= 0)
 		return 0;
 
-	ShapeSW *shape = static_cast<PhysicsServerSW *>(PhysicsServer::get_singleton())->shape_owner.get(p_shape);
+	ShapeSW *shape = PhysicsServerSW::singleton->shape_owner.get(p_shape);
 	ERR_FAIL_COND_V(!shape, 0);
 
 	AABB aabb = p_xform.xform(shape->get_aabb());
@@ -222,53 +229,45 @@ int PhysicsDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Transfo
 	return cc;
 }
 
-bool PhysicsDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, ShapeRestInfo *r_info) {
-
-	ShapeSW *shape = static_cast<PhysicsServerSW *>(PhysicsServer::get_singleton())->shape_owner.get(p_shape);
-	ERR_FAIL_COND_V(!shape, false);
-
-	AABB aabb = p_xform.xform(shape->get_aabb());
-	aabb = aabb.merge(AABB(aabb.position + p_motion, aabb.size)); //motion
-	aabb = aabb.grow(p_margin);
-
-	int amount = space->broadphase->cull_aabb(aabb, space->intersection_query_results, SpaceSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+//narrow phase of a shape cast against broadphase results, shared by cast_motion and the batched queries
+static bool _cast_motion_candidates(ShapeSW *p_shape, const Transform &p_xform, const Vector3 &p_motion, const AABB &p_aabb, CollisionObjectSW *const *p_objects, const int *p_shapes, int p_amount, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, PhysicsDirectSpaceState::ShapeRestInfo *r_info) {
 
 	real_t best_safe = 1;
 	real_t best_unsafe = 1;
 
 	Transform xform_inv = p_xform.affine_inverse();
 	MotionShapeSW mshape;
-	mshape.shape = shape;
+	mshape.shape = p_shape;
 	mshape.motion = xform_inv.basis.xform(p_motion);
 
 	bool best_first = true;
 
 	Vector3 closest_A, closest_B;
 
-	for (int i = 0; i < amount; i++) {
+	for (int i = 0; i < p_amount; i++) {
 
-		if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
+		if (!_can_collide_with(p_objects[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
 			continue;
 
-		if (p_exclude.has(space->intersection_query_results[i]->get_self()))
+		if (p_exclude.has(p_objects[i]->get_self()))
 			continue; //ignore excluded
 
-		const CollisionObjectSW *col_obj = space->intersection_query_results[i];
-		int shape_idx = space->intersection_query_subindex_results[i];
+		const CollisionObjectSW *col_obj = p_objects[i];
+		int shape_idx = p_shapes[i];
 
 		Vector3 point_A, point_B;
 		Vector3 sep_axis = p_motion.normalized();
 
 		Transform col_obj_xform = col_obj->get_transform() * col_obj->get_shape_transform(shape_idx);
 		//test initial overlap, does it collide if going all the way?
-		if (CollisionSolverSW::solve_distance(&mshape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, point_A, point_B, aabb, &sep_axis)) {
+		if (CollisionSolverSW::solve_distance(&mshape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, point_A, point_B, p_aabb, &sep_axis)) {
 			continue;
 		}
 
 		//test initial overlap
 		sep_axis = p_motion.normalized();
 
-		if (!CollisionSolverSW::solve_distance(shape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, point_A, point_B, aabb, &sep_axis)) {
+		if (!CollisionSolverSW::solve_distance(p_shape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, point_A, point_B, p_aabb, &sep_axis)) {
 			return false;
 		}
 
@@ -287,7 +286,7 @@ bool PhysicsDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform
 
 			Vector3 lA, lB;
 
-			bool collided = !CollisionSolverSW::solve_distance(&mshape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, lA, lB, aabb, &sep);
+			bool collided = !CollisionSolverSW::solve_distance(&mshape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, lA, lB, p_aabb, &sep);
 
 			if (collided) {
 
@@ -328,12 +327,26 @@ bool PhysicsDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform
 	return true;
 }
 
+bool PhysicsDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform &p_xform, const Vector3 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, ShapeRestInfo *r_info) {
+
+	ShapeSW *shape = PhysicsServerSW::singleton->shape_owner.get(p_shape);
+	ERR_FAIL_COND_V(!shape, false);
+
+	AABB aabb = p_xform.xform(shape->get_aabb());
+	aabb = aabb.merge(AABB(aabb.position + p_motion, aabb.size)); //motion
+	aabb = aabb.grow(p_margin);
+
+	int amount = space->broadphase->cull_aabb(aabb, space->intersection_query_results, SpaceSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+
+	return _cast_motion_candidates(shape, p_xform, p_motion, aabb, space->intersection_query_results, space->intersection_query_subindex_results, amount, p_closest_safe, p_closest_unsafe, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas, r_info);
+}
+
 bool PhysicsDirectSpaceStateSW::collide_shape(RID p_shape, const Transform &p_shape_xform, real_t p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 
 	if (p_result_max <= 0)
 		return 0;
 
-	ShapeSW *shape = static_cast<PhysicsServerSW *>(PhysicsServer::get_singleton())->shape_owner.get(p_shape);
+	ShapeSW *shape = PhysicsServerSW::singleton->shape_owner.get(p_shape);
 	ERR_FAIL_COND_V(!shape, 0);
 
 	AABB aabb = p_shape_xform.xform(shape->get_aabb());
@@ -405,7 +418,7 @@ static void _rest_cbk_result(const Vector3 &p_point_A, const Vector3 &p_point_B,
 }
 bool PhysicsDirectSpaceStateSW::rest_info(RID p_shape, const Transform &p_shape_xform, real_t p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 
-	ShapeSW *shape = static_cast<PhysicsServerSW *>(PhysicsServer::get_singleton())->shape_owner.get(p_shape);
+	ShapeSW *shape = PhysicsServerSW::singleton->shape_owner.get(p_shape);
 	ERR_FAIL_COND_V(!shape, 0);
 
 	AABB aabb = p_shape_xform.xform(shape->get_aabb());
@@ -499,6 +512,141 @@ Vector3 PhysicsDirectSpaceStateSW::get_closest_point_to_object_volume(RID p_obje
 	}
 }
 
+void PhysicsDirectSpaceStateSW::_batch_add_culled(int p_query, int p_amount) {
+
+	int from = batch_offsets[p_query];
+	int to = from + p_amount;
+
+	if (batch_objects.size() < to) {
+		batch_objects.resize(next_power_of_2(to));
+		batch_shapes.resize(batch_objects.size());
+	}
+
+	copymem(&batch_objects.ptrw()[from], space->intersection_query_results, p_amount * sizeof(CollisionObjectSW *));
+	copymem(&batch_shapes.ptrw()[from], space->intersection_query_subindex_results, p_amount * sizeof(int));
+	batch_offsets.write[p_query + 1] = to;
+}
+
+void PhysicsDirectSpaceStateSW::_intersect_ray_task(uint32_t p_index, RayBatch *p_batch) {
+
+	int from = batch_offsets[p_index];
+	int amount = batch_offsets[p_index + 1] - from;
+
+	p_batch->hits[p_index] = _intersect_ray_candidates(p_batch->from[p_index], p_batch->to[p_index], batch_objects.ptr() + from, batch_shapes.ptr() + from, amount, p_batch->results[p_index], *p_batch->exclude, p_batch->collision_mask, p_batch->collide_with_bodies, p_batch->collide_with_areas, p_batch->pick_ray);
+}
+
+void PhysicsDirectSpaceStateSW::_cast_motion_task(uint32_t p_index, MotionBatch *p_batch) {
+
+	int from = batch_offsets[p_index];
+	int amount = batch_offsets[p_index + 1] - from;
+
+	const Transform &xform = p_batch->xforms[p_index];
+	const Vector3 &motion = p_batch->motions[p_index];
+
+	AABB aabb = xform.xform(p_batch->shape->get_aabb());
+	aabb = aabb.merge(AABB(aabb.position + motion, aabb.size)); //motion
+	aabb = aabb.grow(p_batch->margin);
+
+	if (!_cast_motion_candidates(p_batch->shape, xform, motion, aabb, batch_objects.ptr() + from, batch_shapes.ptr() + from, amount, p_batch->closest_safe[p_index], p_batch->closest_unsafe[p_index], *p_batch->exclude, p_batch->collision_mask, p_batch->collide_with_bodies, p_batch->collide_with_areas, NULL)) {
+		p_batch->closest_safe[p_index] = 0;
+		p_batch->closest_unsafe[p_index] = 0;
+	}
+}
+
+int PhysicsDirectSpaceStateSW::intersect_rays(const Vector3 *p_from, const Vector3 *p_to, int p_count, RayResult *r_results, bool *r_hits, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_ray) {
+
+	ERR_FAIL_COND_V(space->locked, 0);
+	ERR_FAIL_COND_V(p_count < 0, 0);
+
+	//the broadphase can't be queried from several threads, so cull every ray first and only run the narrow phase in parallel
+	batch_offsets.resize(p_count + 1);
+	batch_offsets.write[0] = 0;
+	for (int i = 0; i < p_count; i++) {
+
+		int amount = space->broadphase->cull_segment(p_from[i], p_to[i], space->intersection_query_results, SpaceSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+		_batch_add_culled(i, amount);
+	}
+
+	RayBatch batch;
+	batch.from = p_from;
+	batch.to = p_to;
+	batch.results = r_results;
+	batch.hits = r_hits;
+	batch.exclude = &p_exclude;
+	batch.collision_mask = p_collision_mask;
+	batch.collide_with_bodies = p_collide_with_bodies;
+	batch.collide_with_areas = p_collide_with_areas;
+	batch.pick_ray = p_pick_ray;
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (pool) {
+		pool->parallel_for(p_count, this, &PhysicsDirectSpaceStateSW::_intersect_ray_task, &batch);
+	} else {
+		for (int i = 0; i < p_count; i++) {
+			_intersect_ray_task(i, &batch);
+		}
+	}
+
+	int hit_count = 0;
+	for (int i = 0; i < p_count; i++) {
+		if (r_hits[i])
+			hit_count++;
+	}
+
+	return hit_count;
+}
+
+void PhysicsDirectSpaceStateSW::cast_motions(const RID &p_shape, const Transform *p_xforms, const Vector3 *p_motions, int p_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	ERR_FAIL_COND(p_count < 0);
+
+	// Casts that can't be done report no motion, like failed ones.
+	for (int i = 0; i < p_count; i++) {
+		r_closest_safe[i] = 0;
+		r_closest_unsafe[i] = 0;
+	}
+
+	ERR_FAIL_COND(space->locked);
+
+	ShapeSW *shape = PhysicsServerSW::singleton->shape_owner.get(p_shape);
+	ERR_FAIL_COND(!shape);
+
+	AABB shape_aabb = shape->get_aabb();
+
+	batch_offsets.resize(p_count + 1);
+	batch_offsets.write[0] = 0;
+	for (int i = 0; i < p_count; i++) {
+
+		AABB aabb = p_xforms[i].xform(shape_aabb);
+		aabb = aabb.merge(AABB(aabb.position + p_motions[i], aabb.size)); //motion
+		aabb = aabb.grow(p_margin);
+
+		int amount = space->broadphase->cull_aabb(aabb, space->intersection_query_results, SpaceSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+		_batch_add_culled(i, amount);
+	}
+
+	MotionBatch batch;
+	batch.shape = shape;
+	batch.xforms = p_xforms;
+	batch.motions = p_motions;
+	batch.margin = p_margin;
+	batch.closest_safe = r_closest_safe;
+	batch.closest_unsafe = r_closest_unsafe;
+	batch.exclude = &p_exclude;
+	batch.collision_mask = p_collision_mask;
+	batch.collide_with_bodies = p_collide_with_bodies;
+	batch.collide_with_areas = p_collide_with_areas;
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (pool) {
+		pool->parallel_for(p_count, this, &PhysicsDirectSpaceStateSW::_cast_motion_task, &batch);
+	} else {
+		for (int i = 0; i < p_count; i++) {
+			_cast_motion_task(i, &batch);
+		}
+	}
+}
+
 PhysicsDirectSpaceStateSW::PhysicsDirectSpaceStateSW() {
 
 	space = NULL;
@@ -1143,6 +1291,9 @@ void SpaceSW::setup() {
 		inertia_update_list.first()->self()->update_inertias();
 		inertia_update_list.remove(inertia_update_list.first());
 	}
+
+	//pair objects moved since the last step, for broadphases that defer pairing to update()
+	broadphase->update();
 }
 
 void SpaceSW::update() {
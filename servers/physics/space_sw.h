@@ -45,6 +45,40 @@ class PhysicsDirectSpaceStateSW : public PhysicsDirectSpaceState {
 
 	GDCLASS(PhysicsDirectSpaceStateSW, PhysicsDirectSpaceState);
 
+	//broadphase results of every query in a batch, query i owns [offsets[i], offsets[i + 1])
+	Vector<CollisionObjectSW *> batch_objects;
+	Vector<int> batch_shapes;
+	Vector<int> batch_offsets;
+
+	struct RayBatch {
+		const Vector3 *from;
+		const Vector3 *to;
+		RayResult *results;
+		bool *hits;
+		const Set<RID> *exclude;
+		uint32_t collision_mask;
+		bool collide_with_bodies;
+		bool collide_with_areas;
+		bool pick_ray;
+	};
+
+	struct MotionBatch {
+		ShapeSW *shape;
+		const Transform *xforms;
+		const Vector3 *motions;
+		real_t margin;
+		real_t *closest_safe;
+		real_t *closest_unsafe;
+		const Set<RID> *exclude;
+		uint32_t collision_mask;
+		bool collide_with_bodies;
+		bool collide_with_areas;
+	};
+
+	void _batch_add_culled(int p_query, int p_amount);
+	void _intersect_ray_task(uint32_t p_index, RayBatch *p_batch);
+	void _cast_motion_task(uint32_t p_index, MotionBatch *p_batch);
+
 public:
 	SpaceSW *space;
 
@@ -56,6 +90,9 @@ public:
 	virtual bool rest_info(RID p_shape, const Transform &p_shape_xform, real_t p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false);
 	virtual Vector3 get_closest_point_to_object_volume(RID p_object, const Vector3 p_point) const;
 
+	virtual int intersect_rays(const Vector3 *p_from, const Vector3 *p_to, int p_count, RayResult *r_results, bool *r_hits, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false, bool p_pick_ray = false);
+	virtual void cast_motions(const RID &p_shape, const Transform *p_xforms, const Vector3 *p_motions, int p_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false);
+
 	PhysicsDirectSpaceStateSW();
 };
 
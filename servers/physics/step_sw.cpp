@@ -32,6 +32,7 @@
 #include "joints_sw.h"
 
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 
 void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island) {
 
@@ -59,12 +60,14 @@ void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **
 	}
 }
 
-void StepSW::_setup_island(ConstraintSW *p_island, real_t p_delta) {
+void StepSW::_setup_island(ConstraintSW *p_island, real_t p_delta, bool p_parallel) {
 
 	ConstraintSW *ci = p_island;
 	while (ci) {
-		ci->setup(p_delta);
-		//todo remove from island if process fails
+		if (ci->can_setup_in_parallel() == p_parallel) {
+			ci->setup(p_delta);
+			//todo remove from island if process fails
+		}
 		ci = ci->get_island_next();
 	}
 }
@@ -144,6 +147,17 @@ void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
 	}
 }
 
+void StepSW::_setup_island_task(uint32_t p_index, ConstraintSW **p_islands) {
+
+	_setup_island(p_islands[p_index], delta, true);
+}
+
+void StepSW::_solve_island_task(uint32_t p_index, ConstraintSW **p_islands) {
+
+	//iterating each island separatedly improves cache efficiency
+	_solve_island(p_islands[p_index], iterations, delta);
+}
+
 void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	p_space->lock(); // can't access space during this
@@ -230,12 +244,39 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
+	// Islands don't share bodies that can move, so they are set up and solved on worker threads.
+	// Constraints that write outside their island are set up afterwards in island order, so results
+	// don't depend on the thread count.
+
+	int constraint_island_count = 0;
+	for (ConstraintSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+		constraint_island_count++;
+	}
+
+	constraint_islands.resize(constraint_island_count); // kept between steps, to reuse the allocation
+	ConstraintSW **islands = constraint_islands.ptrw();
 	{
-		ConstraintSW *ci = constraint_island_list;
-		while (ci) {
+		int i = 0;
+		for (ConstraintSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			islands[i++] = ci;
+		}
+	}
 
-			_setup_island(ci, p_delta);
-			ci = ci->get_island_list_next();
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	delta = p_delta;
+	iterations = p_iterations;
+
+	{
+		if (pool && !p_space->is_debugging_contacts()) {
+			pool->parallel_for(constraint_island_count, this, &StepSW::_setup_island_task, islands);
+		} else {
+			for (int i = 0; i < constraint_island_count; i++) {
+				_setup_island_task(i, islands);
+			}
+		}
+
+		for (int i = 0; i < constraint_island_count; i++) {
+			_setup_island(islands[i], p_delta, false);
 		}
 	}
 
@@ -248,11 +289,12 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	/* SOLVE CONSTRAINT ISLANDS */
 
 	{
-		ConstraintSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
+		if (pool) {
+			pool->parallel_for(constraint_island_count, this, &StepSW::_solve_island_task, islands);
+		} else {
+			for (int i = 0; i < constraint_island_count; i++) {
+				_solve_island_task(i, islands);
+			}
 		}
 	}
 
@@ -296,4 +338,6 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 StepSW::StepSW() {
 
 	_step = 1;
+	delta = 0;
+	iterations = 0;
 }
@@ -37,11 +37,18 @@ class StepSW {
 
 	uint64_t _step;
 
+	Vector<ConstraintSW *> constraint_islands;
+	real_t delta;
+	int iterations;
+
 	void _populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island);
-	void _setup_island(ConstraintSW *p_island, real_t p_delta);
+	void _setup_island(ConstraintSW *p_island, real_t p_delta, bool p_parallel);
 	void _solve_island(ConstraintSW *p_island, int p_iterations, real_t p_delta);
 	void _check_suspend(BodySW *p_island, real_t p_delta);
 
+	void _setup_island_task(uint32_t p_index, ConstraintSW **p_islands);
+	void _solve_island_task(uint32_t p_index, ConstraintSW **p_islands);
+
 public:
 	void step(SpaceSW *p_space, real_t p_delta, int p_iterations);
 	StepSW();
@@ -455,6 +455,17 @@ bool BodyPair2DSW::setup(real_t p_step) {
 	return do_process;
 }
 
+bool BodyPair2DSW::can_setup_in_parallel() const {
+
+	//contacts reported to a static or kinematic body, which may be in other islands too
+	if (A->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && A->can_report_contacts())
+		return false;
+	if (B->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && B->can_report_contacts())
+		return false;
+
+	return true;
+}
+
 void BodyPair2DSW::solve(real_t p_step) {
 
 	if (!collided)
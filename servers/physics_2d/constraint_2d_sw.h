@@ -74,6 +74,9 @@ public:
 	virtual bool setup(real_t p_step) = 0;
 	virtual void solve(real_t p_step) = 0;
 
+	// False if setup() writes to objects outside its island, so it must not run in parallel with other islands.
+	virtual bool can_setup_in_parallel() const { return true; }
+
 	virtual ~Constraint2DSW() {}
 };
 
@@ -32,6 +32,7 @@
 
 #include "collision_solver_2d_sw.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/pair.h"
 #include "physics_2d_server_sw.h"
 _FORCE_INLINE_ static bool _can_collide_with(CollisionObject2DSW *p_object, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
@@ -113,9 +114,8 @@ int Physics2DDirectSpaceStateSW::intersect_point_on_canvas(const Vector2 &p_poin
 	return _intersect_point_impl(p_point, r_results, p_result_max, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas, p_pick_point, true, p_canvas_instance_id);
 }
 
-bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
-
-	ERR_FAIL_COND_V(space->locked, false);
+//narrow phase of a ray against broadphase results, shared by intersect_ray and the batched queries
+static bool _intersect_ray_candidates(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW *const *p_objects, const int *p_shapes, int p_amount, Physics2DDirectSpaceState::RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 
 	Vector2 begin, end;
 	Vector2 normal;
@@ -123,8 +123,6 @@ bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vec
 	end = p_to;
 	normal = (end - begin).normalized();
 
-	int amount = space->broadphase->cull_segment(begin, end, space->intersection_query_results, Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
-
 	//todo, create another array that references results, compute AABBs and check closest point to ray origin, sort, and stop evaluating results when beyond first collision
 
 	bool collided = false;
@@ -133,17 +131,17 @@ bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vec
 	const CollisionObject2DSW *res_obj;
 	real_t min_d = 1e10;
 
-	for (int i = 0; i < amount; i++) {
+	for (int i = 0; i < p_amount; i++) {
 
-		if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
+		if (!_can_collide_with(p_objects[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
 			continue;
 
-		if (p_exclude.has(space->intersection_query_results[i]->get_self()))
+		if (p_exclude.has(p_objects[i]->get_self()))
 			continue;
 
-		const CollisionObject2DSW *col_obj = space->intersection_query_results[i];
+		const CollisionObject2DSW *col_obj = p_objects[i];
 
-		int shape_idx = space->intersection_query_subindex_results[i];
+		int shape_idx = p_shapes[i];
 		Transform2D inv_xform = col_obj->get_shape_inv_transform(shape_idx) * col_obj->get_inv_transform();
 
 		Vector2 local_from = inv_xform.xform(begin);
@@ -184,6 +182,8 @@ bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vec
 	r_result.collider_id = res_obj->get_instance_id();
 	if (r_result.collider_id != 0)
 		r_result.collider = ObjectDB::get_instance(r_result.collider_id);
+	else
+		r_result.collider = NULL;
 	r_result.normal = res_normal;
 	r_result.metadata = res_obj->get_shape_metadata(res_shape);
 	r_result.position = res_point;
@@ -193,6 +193,15 @@ bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vec
 	return true;
 }
 
+bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	ERR_FAIL_COND_V(space->locked, false);
+
+	int amount = space->broadphase->cull_segment(p_from, p_to, space->intersection_query_results, Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+
+	return _intersect_ray_candidates(p_from, p_to, space->intersection_query_results, space->intersection_query_subindex_results, amount, r_result, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas);
+}
+
 int Physics2DDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 
 	if (p_result_max <= 0)
@@ -238,39 +247,31 @@ int Physics2DDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Trans
 	return cc;
 }
 
-bool Physics2DDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
-
-	Shape2DSW *shape = Physics2DServerSW::singletonsw->shape_owner.get(p_shape);
-	ERR_FAIL_COND_V(!shape, false);
-
-	Rect2 aabb = p_xform.xform(shape->get_aabb());
-	aabb = aabb.merge(Rect2(aabb.position + p_motion, aabb.size)); //motion
-	aabb = aabb.grow(p_margin);
-
-	int amount = space->broadphase->cull_aabb(aabb, space->intersection_query_results, Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+//narrow phase of a shape cast against broadphase results, shared by cast_motion and the batched queries
+static bool _cast_motion_candidates(Shape2DSW *p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, CollisionObject2DSW *const *p_objects, const int *p_shapes, int p_amount, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 
 	real_t best_safe = 1;
 	real_t best_unsafe = 1;
 
-	for (int i = 0; i < amount; i++) {
+	for (int i = 0; i < p_amount; i++) {
 
-		if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
+		if (!_can_collide_with(p_objects[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
 			continue;
 
-		if (p_exclude.has(space->intersection_query_results[i]->get_self()))
+		if (p_exclude.has(p_objects[i]->get_self()))
 			continue; //ignore excluded
 
-		const CollisionObject2DSW *col_obj = space->intersection_query_results[i];
-		int shape_idx = space->intersection_query_subindex_results[i];
+		const CollisionObject2DSW *col_obj = p_objects[i];
+		int shape_idx = p_shapes[i];
 
 		Transform2D col_obj_xform = col_obj->get_transform() * col_obj->get_shape_transform(shape_idx);
 		//test initial overlap, does it collide if going all the way?
-		if (!CollisionSolver2DSW::solve(shape, p_xform, p_motion, col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), NULL, NULL, NULL, p_margin)) {
+		if (!CollisionSolver2DSW::solve(p_shape, p_xform, p_motion, col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), NULL, NULL, NULL, p_margin)) {
 			continue;
 		}
 
 		//test initial overlap
-		if (CollisionSolver2DSW::solve(shape, p_xform, Vector2(), col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), NULL, NULL, NULL, p_margin)) {
+		if (CollisionSolver2DSW::solve(p_shape, p_xform, Vector2(), col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), NULL, NULL, NULL, p_margin)) {
 
 			return false;
 		}
@@ -285,7 +286,7 @@ bool Physics2DDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transfor
 			real_t ofs = (low + hi) * 0.5;
 
 			Vector2 sep = mnormal; //important optimization for this to work fast enough
-			bool collided = CollisionSolver2DSW::solve(shape, p_xform, p_motion * ofs, col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), NULL, NULL, &sep, p_margin);
+			bool collided = CollisionSolver2DSW::solve(p_shape, p_xform, p_motion * ofs, col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), NULL, NULL, &sep, p_margin);
 
 			if (collided) {
 
@@ -308,6 +309,20 @@ bool Physics2DDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transfor
 	return true;
 }
 
+bool Physics2DDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	Shape2DSW *shape = Physics2DServerSW::singletonsw->shape_owner.get(p_shape);
+	ERR_FAIL_COND_V(!shape, false);
+
+	Rect2 aabb = p_xform.xform(shape->get_aabb());
+	aabb = aabb.merge(Rect2(aabb.position + p_motion, aabb.size)); //motion
+	aabb = aabb.grow(p_margin);
+
+	int amount = space->broadphase->cull_aabb(aabb, space->intersection_query_results, Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+
+	return _cast_motion_candidates(shape, p_xform, p_motion, p_margin, space->intersection_query_results, space->intersection_query_subindex_results, amount, p_closest_safe, p_closest_unsafe, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas);
+}
+
 bool Physics2DDirectSpaceStateSW::collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 
 	if (p_result_max <= 0)
@@ -462,6 +477,133 @@ bool Physics2DDirectSpaceStateSW::rest_info(RID p_shape, const Transform2D &p_sh
 	return true;
 }
 
+void Physics2DDirectSpaceStateSW::_batch_add_culled(int p_query, int p_amount) {
+
+	int from = batch_offsets[p_query];
+	int to = from + p_amount;
+
+	if (batch_objects.size() < to) {
+		batch_objects.resize(next_power_of_2(to));
+		batch_shapes.resize(batch_objects.size());
+	}
+
+	copymem(&batch_objects.ptrw()[from], space->intersection_query_results, p_amount * sizeof(CollisionObject2DSW *));
+	copymem(&batch_shapes.ptrw()[from], space->intersection_query_subindex_results, p_amount * sizeof(int));
+	batch_offsets.write[p_query + 1] = to;
+}
+
+void Physics2DDirectSpaceStateSW::_intersect_ray_task(uint32_t p_index, RayBatch *p_batch) {
+
+	int from = batch_offsets[p_index];
+	int amount = batch_offsets[p_index + 1] - from;
+
+	p_batch->hits[p_index] = _intersect_ray_candidates(p_batch->from[p_index], p_batch->to[p_index], batch_objects.ptr() + from, batch_shapes.ptr() + from, amount, p_batch->results[p_index], *p_batch->exclude, p_batch->collision_mask, p_batch->collide_with_bodies, p_batch->collide_with_areas);
+}
+
+void Physics2DDirectSpaceStateSW::_cast_motion_task(uint32_t p_index, MotionBatch *p_batch) {
+
+	int from = batch_offsets[p_index];
+	int amount = batch_offsets[p_index + 1] - from;
+
+	if (!_cast_motion_candidates(p_batch->shape, p_batch->xforms[p_index], p_batch->motions[p_index], p_batch->margin, batch_objects.ptr() + from, batch_shapes.ptr() + from, amount, p_batch->closest_safe[p_index], p_batch->closest_unsafe[p_index], *p_batch->exclude, p_batch->collision_mask, p_batch->collide_with_bodies, p_batch->collide_with_areas)) {
+		p_batch->closest_safe[p_index] = 0;
+		p_batch->closest_unsafe[p_index] = 0;
+	}
+}
+
+int Physics2DDirectSpaceStateSW::intersect_rays(const Vector2 *p_from, const Vector2 *p_to, int p_count, RayResult *r_results, bool *r_hits, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	ERR_FAIL_COND_V(space->locked, 0);
+	ERR_FAIL_COND_V(p_count < 0, 0);
+
+	//the broadphase can't be queried from several threads, so cull every ray first and only run the narrow phase in parallel
+	batch_offsets.resize(p_count + 1);
+	batch_offsets.write[0] = 0;
+	for (int i = 0; i < p_count; i++) {
+
+		int amount = space->broadphase->cull_segment(p_from[i], p_to[i], space->intersection_query_results, Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+		_batch_add_culled(i, amount);
+	}
+
+	RayBatch batch;
+	batch.from = p_from;
+	batch.to = p_to;
+	batch.results = r_results;
+	batch.hits = r_hits;
+	batch.exclude = &p_exclude;
+	batch.collision_mask = p_collision_mask;
+	batch.collide_with_bodies = p_collide_with_bodies;
+	batch.collide_with_areas = p_collide_with_areas;
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (pool) {
+		pool->parallel_for(p_count, this, &Physics2DDirectSpaceStateSW::_intersect_ray_task, &batch);
+	} else {
+		for (int i = 0; i < p_count; i++) {
+			_intersect_ray_task(i, &batch);
+		}
+	}
+
+	int hit_count = 0;
+	for (int i = 0; i < p_count; i++) {
+		if (r_hits[i])
+			hit_count++;
+	}
+
+	return hit_count;
+}
+
+void Physics2DDirectSpaceStateSW::cast_motions(const RID &p_shape, const Transform2D *p_xforms, const Vector2 *p_motions, int p_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	ERR_FAIL_COND(p_count < 0);
+
+	// Casts that can't be done report no motion, like failed ones.
+	for (int i = 0; i < p_count; i++) {
+		r_closest_safe[i] = 0;
+		r_closest_unsafe[i] = 0;
+	}
+
+	ERR_FAIL_COND(space->locked);
+
+	Shape2DSW *shape = Physics2DServerSW::singletonsw->shape_owner.get(p_shape);
+	ERR_FAIL_COND(!shape);
+
+	Rect2 shape_aabb = shape->get_aabb();
+
+	batch_offsets.resize(p_count + 1);
+	batch_offsets.write[0] = 0;
+	for (int i = 0; i < p_count; i++) {
+
+		Rect2 aabb = p_xforms[i].xform(shape_aabb);
+		aabb = aabb.merge(Rect2(aabb.position + p_motions[i], aabb.size)); //motion
+		aabb = aabb.grow(p_margin);
+
+		int amount = space->broadphase->cull_aabb(aabb, space->intersection_query_results, Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+		_batch_add_culled(i, amount);
+	}
+
+	MotionBatch batch;
+	batch.shape = shape;
+	batch.xforms = p_xforms;
+	batch.motions = p_motions;
+	batch.margin = p_margin;
+	batch.closest_safe = r_closest_safe;
+	batch.closest_unsafe = r_closest_unsafe;
+	batch.exclude = &p_exclude;
+	batch.collision_mask = p_collision_mask;
+	batch.collide_with_bodies = p_collide_with_bodies;
+	batch.collide_with_areas = p_collide_with_areas;
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (pool) {
+		pool->parallel_for(p_count, this, &Physics2DDirectSpaceStateSW::_cast_motion_task, &batch);
+	} else {
+		for (int i = 0; i < p_count; i++) {
+			_cast_motion_task(i, &batch);
+		}
+	}
+}
+
 Physics2DDirectSpaceStateSW::Physics2DDirectSpaceStateSW() {
 
 	space = NULL;
@@ -47,6 +47,39 @@ class Physics2DDirectSpaceStateSW : public Physics2DDirectSpaceState {
 
 	int _intersect_point_impl(const Vector2 &p_point, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_point, bool p_filter_by_canvas = false, ObjectID p_canvas_instance_id = 0);
 
+	//broadphase results of every query in a batch, query i owns [offsets[i], offsets[i + 1])
+	Vector<CollisionObject2DSW *> batch_objects;
+	Vector<int> batch_shapes;
+	Vector<int> batch_offsets;
+
+	struct RayBatch {
+		const Vector2 *from;
+		const Vector2 *to;
+		RayResult *results;
+		bool *hits;
+		const Set<RID> *exclude;
+		uint32_t collision_mask;
+		bool collide_with_bodies;
+		bool collide_with_areas;
+	};
+
+	struct MotionBatch {
+		Shape2DSW *shape;
+		const Transform2D *xforms;
+		const Vector2 *motions;
+		real_t margin;
+		real_t *closest_safe;
+		real_t *closest_unsafe;
+		const Set<RID> *exclude;
+		uint32_t collision_mask;
+		bool collide_with_bodies;
+		bool collide_with_areas;
+	};
+
+	void _batch_add_culled(int p_query, int p_amount);
+	void _intersect_ray_task(uint32_t p_index, RayBatch *p_batch);
+	void _cast_motion_task(uint32_t p_index, MotionBatch *p_batch);
+
 public:
 	Space2DSW *space;
 
@@ -58,6 +91,9 @@ public:
 	virtual bool collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false);
 	virtual bool rest_info(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false);
 
+	virtual int intersect_rays(const Vector2 *p_from, const Vector2 *p_to, int p_count, RayResult *r_results, bool *r_hits, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false);
+	virtual void cast_motions(const RID &p_shape, const Transform2D *p_xforms, const Vector2 *p_motions, int p_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false);
+
 	Physics2DDirectSpaceStateSW();
 };
 
@@ -30,6 +30,7 @@
 
 #include "step_2d_sw.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 
 void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
 
@@ -57,29 +58,28 @@ void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constrain
 	}
 }
 
-bool Step2DSW::_setup_island(Constraint2DSW *p_island, real_t p_delta) {
+Constraint2DSW *Step2DSW::_setup_island(Constraint2DSW *p_island, real_t p_delta, bool p_parallel) {
 
+	Constraint2DSW *root = p_island;
 	Constraint2DSW *ci = p_island;
 	Constraint2DSW *prev_ci = NULL;
-	bool removed_root = false;
 	while (ci) {
-		bool process = ci->setup(p_delta);
+		Constraint2DSW *next = ci->get_island_next();
 
-		if (!process) {
+		if (ci->can_setup_in_parallel() == p_parallel && !ci->setup(p_delta)) {
 			//remove from island if process fails
 			if (prev_ci) {
-				prev_ci->set_island_next(ci->get_island_next());
+				prev_ci->set_island_next(next);
 			} else {
-				removed_root = true;
-				prev_ci = ci;
+				root = next;
 			}
 		} else {
 			prev_ci = ci;
 		}
-		ci = ci->get_island_next();
+		ci = next;
 	}
 
-	return removed_root;
+	return root;
 }
 
 void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta) {
@@ -131,6 +131,16 @@ void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 	}
 }
 
+void Step2DSW::_setup_island_task(uint32_t p_index, Constraint2DSW **p_islands) {
+
+	p_islands[p_index] = _setup_island(p_islands[p_index], delta, true);
+}
+
+void Step2DSW::_solve_island_task(uint32_t p_index, Constraint2DSW **p_islands) {
+
+	_solve_island(p_islands[p_index], iterations, delta);
+}
+
 void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	p_space->lock(); // can't access space during this
@@ -217,41 +227,40 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		Constraint2DSW *prev_ci = NULL;
-		while (ci) {
+	// Islands don't share bodies that can move, so they are set up and solved on worker threads.
+	// Constraints that write outside their island are set up afterwards in island order, so results
+	// don't depend on the thread count. Islands left without constraints are set to NULL.
 
-			if (_setup_island(ci, p_delta)) {
-
-				//removed the root from the island graph because it is not to be processed
+	int constraint_island_count = 0;
+	for (Constraint2DSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+		constraint_island_count++;
+	}
 
-				Constraint2DSW *next = ci->get_island_next();
+	constraint_islands.resize(constraint_island_count); // kept between steps, to reuse the allocation
+	Constraint2DSW **islands = constraint_islands.ptrw();
+	{
+		int i = 0;
+		for (Constraint2DSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			islands[i++] = ci;
+		}
+	}
 
-				if (next) {
-					//root from list being deleted no longer exists, replace by next
-					next->set_island_list_next(ci->get_island_list_next());
-					if (prev_ci) {
-						prev_ci->set_island_list_next(next);
-					} else {
-						constraint_island_list = next;
-					}
-					prev_ci = next;
-				} else {
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
 
-					//list is empty, just skip
-					if (prev_ci) {
-						prev_ci->set_island_list_next(ci->get_island_list_next());
+	delta = p_delta;
+	iterations = p_iterations;
 
-					} else {
-						constraint_island_list = ci->get_island_list_next();
-					}
-				}
-			} else {
-				prev_ci = ci;
+	{
+		if (pool && !p_space->is_debugging_contacts()) {
+			pool->parallel_for(constraint_island_count, this, &Step2DSW::_setup_island_task, islands);
+		} else {
+			for (int i = 0; i < constraint_island_count; i++) {
+				_setup_island_task(i, islands);
 			}
+		}
 
-			ci = ci->get_island_list_next();
+		for (int i = 0; i < constraint_island_count; i++) {
+			islands[i] = _setup_island(islands[i], p_delta, false);
 		}
 	}
 
@@ -264,11 +273,12 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	/* SOLVE CONSTRAINT ISLANDS */
 
 	{
-		Constraint2DSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
+		if (pool) {
+			pool->parallel_for(constraint_island_count, this, &Step2DSW::_solve_island_task, islands);
+		} else {
+			for (int i = 0; i < constraint_island_count; i++) {
+				_solve_island_task(i, islands);
+			}
 		}
 	}
 
@@ -313,4 +323,6 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 Step2DSW::Step2DSW() {
 
 	_step = 1;
+	delta = 0;
+	iterations = 0;
 }
@@ -37,11 +37,18 @@ class Step2DSW {
 
 	uint64_t _step;
 
+	Vector<Constraint2DSW *> constraint_islands;
+	real_t delta;
+	int iterations;
+
 	void _populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island);
-	bool _setup_island(Constraint2DSW *p_island, real_t p_delta);
+	Constraint2DSW *_setup_island(Constraint2DSW *p_island, real_t p_delta, bool p_parallel);
 	void _solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta);
 	void _check_suspend(Body2DSW *p_island, real_t p_delta);
 
+	void _setup_island_task(uint32_t p_index, Constraint2DSW **p_islands);
+	void _solve_island_task(uint32_t p_index, Constraint2DSW **p_islands);
+
 public:
 	void step(Space2DSW *p_space, real_t p_delta, int p_iterations);
 	Step2DSW();
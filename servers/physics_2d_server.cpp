@@ -409,6 +409,132 @@ Dictionary Physics2DDirectSpaceState::_get_rest_info(const Ref<Physics2DShapeQue
 	return r;
 }
 
+Dictionary Physics2DDirectSpaceState::_intersect_rays(const PoolVector2Array &p_from, const PoolVector2Array &p_to, const Vector<RID> &p_exclude, uint32_t p_layers, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	ERR_FAIL_COND_V(p_from.size() != p_to.size(), Dictionary());
+
+	Set<RID> exclude;
+	for (int i = 0; i < p_exclude.size(); i++)
+		exclude.insert(p_exclude[i]);
+
+	int count = p_from.size();
+	Vector<RayResult> results;
+	results.resize(count);
+	Vector<bool> hits;
+	hits.resize(count);
+
+	{
+		PoolVector2Array::Read from = p_from.read();
+		PoolVector2Array::Read to = p_to.read();
+		intersect_rays(from.ptr(), to.ptr(), count, results.ptrw(), hits.ptrw(), exclude, p_layers, p_collide_with_bodies, p_collide_with_areas);
+	}
+
+	PoolVector2Array positions;
+	positions.resize(count);
+	PoolVector2Array normals;
+	normals.resize(count);
+	PoolIntArray shapes;
+	shapes.resize(count);
+	Array colliders;
+	colliders.resize(count);
+
+	{
+		PoolVector2Array::Write pw = positions.write();
+		PoolVector2Array::Write nw = normals.write();
+		PoolIntArray::Write sw = shapes.write();
+
+		for (int i = 0; i < count; i++) {
+
+			if (hits[i]) {
+				pw[i] = results[i].position;
+				nw[i] = results[i].normal;
+				sw[i] = results[i].shape;
+				colliders[i] = results[i].collider;
+			} else {
+				pw[i] = Vector2();
+				nw[i] = Vector2();
+				sw[i] = -1;
+			}
+		}
+	}
+
+	Dictionary d;
+	d["position"] = positions;
+	d["normal"] = normals;
+	d["shape"] = shapes;
+	d["collider"] = colliders;
+
+	return d;
+}
+
+PoolRealArray Physics2DDirectSpaceState::_cast_motions(const Ref<Physics2DShapeQueryParameters> &p_shape_query, const PoolVector2Array &p_origins, const PoolVector2Array &p_motions) {
+
+	ERR_FAIL_COND_V(!p_shape_query.is_valid(), PoolRealArray());
+	ERR_FAIL_COND_V(p_origins.size() != p_motions.size(), PoolRealArray());
+
+	int count = p_origins.size();
+	Vector<Transform2D> xforms;
+	xforms.resize(count);
+	Vector<float> closest_safe;
+	closest_safe.resize(count);
+	Vector<float> closest_unsafe;
+	closest_unsafe.resize(count);
+	for (int i = 0; i < count; i++) {
+		closest_safe.write[i] = 0;
+		closest_unsafe.write[i] = 0;
+	}
+
+	{
+		PoolVector2Array::Read origins = p_origins.read();
+		for (int i = 0; i < count; i++) {
+			Transform2D xform = p_shape_query->transform;
+			xform.set_origin(origins[i]);
+			xforms.write[i] = xform;
+		}
+	}
+
+	{
+		PoolVector2Array::Read motions = p_motions.read();
+		cast_motions(p_shape_query->shape, xforms.ptr(), motions.ptr(), count, p_shape_query->margin, closest_safe.ptrw(), closest_unsafe.ptrw(), p_shape_query->exclude, p_shape_query->collision_mask, p_shape_query->collide_with_bodies, p_shape_query->collide_with_areas);
+	}
+
+	PoolRealArray ret;
+	ret.resize(count * 2);
+	{
+		PoolRealArray::Write w = ret.write();
+		for (int i = 0; i < count; i++) {
+			w[i * 2 + 0] = closest_safe[i];
+			w[i * 2 + 1] = closest_unsafe[i];
+		}
+	}
+
+	return ret;
+}
+
+int Physics2DDirectSpaceState::intersect_rays(const Vector2 *p_from, const Vector2 *p_to, int p_count, RayResult *r_results, bool *r_hits, const Set<RID> &p_exclude, uint32_t p_collision_layer, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	int hit_count = 0;
+	for (int i = 0; i < p_count; i++) {
+
+		r_hits[i] = intersect_ray(p_from[i], p_to[i], r_results[i], p_exclude, p_collision_layer, p_collide_with_bodies, p_collide_with_areas);
+		if (r_hits[i])
+			hit_count++;
+	}
+
+	return hit_count;
+}
+
+void Physics2DDirectSpaceState::cast_motions(const RID &p_shape, const Transform2D *p_xforms, const Vector2 *p_motions, int p_count, float p_margin, float *r_closest_safe, float *r_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_layer, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		if (!cast_motion(p_shape, p_xforms[i], p_motions[i], p_margin, r_closest_safe[i], r_closest_unsafe[i], p_exclude, p_collision_layer, p_collide_with_bodies, p_collide_with_areas)) {
+			r_closest_safe[i] = 0;
+			r_closest_unsafe[i] = 0;
+		}
+	}
+}
+
 Physics2DDirectSpaceState::Physics2DDirectSpaceState() {
 }
 
@@ -421,6 +547,8 @@ void Physics2DDirectSpaceState::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("cast_motion", "shape"), &Physics2DDirectSpaceState::_cast_motion);
 	ClassDB::bind_method(D_METHOD("collide_shape", "shape", "max_results"), &Physics2DDirectSpaceState::_collide_shape, DEFVAL(32));
 	ClassDB::bind_method(D_METHOD("get_rest_info", "shape"), &Physics2DDirectSpaceState::_get_rest_info);
+	ClassDB::bind_method(D_METHOD("intersect_rays", "from", "to", "exclude", "collision_layer", "collide_with_bodies", "collide_with_areas"), &Physics2DDirectSpaceState::_intersect_rays, DEFVAL(Array()), DEFVAL(0x7FFFFFFF), DEFVAL(true), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("cast_motions", "shape", "origins", "motions"), &Physics2DDirectSpaceState::_cast_motions);
 }
 
 int Physics2DShapeQueryResult::get_result_count() const {
@@ -356,6 +356,130 @@ Dictionary PhysicsDirectSpaceState::_get_rest_info(const Ref<PhysicsShapeQueryPa
 	return r;
 }
 
+Dictionary PhysicsDirectSpaceState::_intersect_rays(const PoolVector3Array &p_from, const PoolVector3Array &p_to, const Vector<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	ERR_FAIL_COND_V(p_from.size() != p_to.size(), Dictionary());
+
+	Set<RID> exclude;
+	for (int i = 0; i < p_exclude.size(); i++)
+		exclude.insert(p_exclude[i]);
+
+	int count = p_from.size();
+	Vector<RayResult> results;
+	results.resize(count);
+	Vector<bool> hits;
+	hits.resize(count);
+
+	{
+		PoolVector3Array::Read from = p_from.read();
+		PoolVector3Array::Read to = p_to.read();
+		intersect_rays(from.ptr(), to.ptr(), count, results.ptrw(), hits.ptrw(), exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas);
+	}
+
+	PoolVector3Array positions;
+	positions.resize(count);
+	PoolVector3Array normals;
+	normals.resize(count);
+	PoolIntArray shapes;
+	shapes.resize(count);
+	Array colliders;
+	colliders.resize(count);
+
+	{
+		PoolVector3Array::Write pw = positions.write();
+		PoolVector3Array::Write nw = normals.write();
+		PoolIntArray::Write sw = shapes.write();
+
+		for (int i = 0; i < count; i++) {
+
+			if (hits[i]) {
+				pw[i] = results[i].position;
+				nw[i] = results[i].normal;
+				sw[i] = results[i].shape;
+				colliders[i] = results[i].collider;
+			} else {
+				pw[i] = Vector3();
+				nw[i] = Vector3();
+				sw[i] = -1;
+			}
+		}
+	}
+
+	Dictionary d;
+	d["position"] = positions;
+	d["normal"] = normals;
+	d["shape"] = shapes;
+	d["collider"] = colliders;
+
+	return d;
+}
+
+PoolRealArray PhysicsDirectSpaceState::_cast_motions(const Ref<PhysicsShapeQueryParameters> &p_shape_query, const PoolVector3Array &p_origins, const PoolVector3Array &p_motions) {
+
+	ERR_FAIL_COND_V(!p_shape_query.is_valid(), PoolRealArray());
+	ERR_FAIL_COND_V(p_origins.size() != p_motions.size(), PoolRealArray());
+
+	int count = p_origins.size();
+	Vector<Transform> xforms;
+	xforms.resize(count);
+	Vector<float> closest_safe;
+	closest_safe.resize(count);
+	Vector<float> closest_unsafe;
+	closest_unsafe.resize(count);
+	for (int i = 0; i < count; i++) {
+		closest_safe.write[i] = 0;
+		closest_unsafe.write[i] = 0;
+	}
+
+	{
+		PoolVector3Array::Read origins = p_origins.read();
+		for (int i = 0; i < count; i++) {
+			xforms.write[i] = Transform(p_shape_query->transform.basis, origins[i]);
+		}
+	}
+
+	{
+		PoolVector3Array::Read motions = p_motions.read();
+		cast_motions(p_shape_query->shape, xforms.ptr(), motions.ptr(), count, p_shape_query->margin, closest_safe.ptrw(), closest_unsafe.ptrw(), p_shape_query->exclude, p_shape_query->collision_mask, p_shape_query->collide_with_bodies, p_shape_query->collide_with_areas);
+	}
+
+	PoolRealArray ret;
+	ret.resize(count * 2);
+	{
+		PoolRealArray::Write w = ret.write();
+		for (int i = 0; i < count; i++) {
+			w[i * 2 + 0] = closest_safe[i];
+			w[i * 2 + 1] = closest_unsafe[i];
+		}
+	}
+
+	return ret;
+}
+
+int PhysicsDirectSpaceState::intersect_rays(const Vector3 *p_from, const Vector3 *p_to, int p_count, RayResult *r_results, bool *r_hits, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_ray) {
+
+	int hit_count = 0;
+	for (int i = 0; i < p_count; i++) {
+
+		r_hits[i] = intersect_ray(p_from[i], p_to[i], r_results[i], p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas, p_pick_ray);
+		if (r_hits[i])
+			hit_count++;
+	}
+
+	return hit_count;
+}
+
+void PhysicsDirectSpaceState::cast_motions(const RID &p_shape, const Transform *p_xforms, const Vector3 *p_motions, int p_count, float p_margin, float *r_closest_safe, float *r_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		if (!cast_motion(p_shape, p_xforms[i], p_motions[i], p_margin, r_closest_safe[i], r_closest_unsafe[i], p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
+			r_closest_safe[i] = 0;
+			r_closest_unsafe[i] = 0;
+		}
+	}
+}
+
 PhysicsDirectSpaceState::PhysicsDirectSpaceState() {
 }
 
@@ -366,6 +490,8 @@ void PhysicsDirectSpaceState::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("cast_motion", "shape", "motion"), &PhysicsDirectSpaceState::_cast_motion);
 	ClassDB::bind_method(D_METHOD("collide_shape", "shape", "max_results"), &PhysicsDirectSpaceState::_collide_shape, DEFVAL(32));
 	ClassDB::bind_method(D_METHOD("get_rest_info", "shape"), &PhysicsDirectSpaceState::_get_rest_info);
+	ClassDB::bind_method(D_METHOD("intersect_rays", "from", "to", "exclude", "collision_mask", "collide_with_bodies", "collide_with_areas"), &PhysicsDirectSpaceState::_intersect_rays, DEFVAL(Array()), DEFVAL(0x7FFFFFFF), DEFVAL(true), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("cast_motions", "shape", "origins", "motions"), &PhysicsDirectSpaceState::_cast_motions);
 }
 
 int PhysicsShapeQueryResult::get_result_count() const {
@@ -403,6 +529,19 @@ void PhysicsShapeQueryResult::_bind_methods() {
 
 ///////////////////////////////////////
 
+void PhysicsServer::bodies_get_state(const RID *p_bodies, int p_count, Transform *r_transforms, Vector3 *r_linear_velocities, Vector3 *r_angular_velocities) const {
+
+	for (int i = 0; i < p_count; i++) {
+
+		if (r_transforms)
+			r_transforms[i] = body_get_state(p_bodies[i], BODY_STATE_TRANSFORM);
+		if (r_linear_velocities)
+			r_linear_velocities[i] = body_get_state(p_bodies[i], BODY_STATE_LINEAR_VELOCITY);
+		if (r_angular_velocities)
+			r_angular_velocities[i] = body_get_state(p_bodies[i], BODY_STATE_ANGULAR_VELOCITY);
+	}
+}
+
 void PhysicsServer::_bind_methods() {
 
 #ifndef _3D_DISABLED
@@ -725,7 +864,6 @@ void PhysicsServer::_bind_methods() {
 
 PhysicsServer::PhysicsServer() {
 
-	ERR_FAIL_COND(singleton != NULL);
 	singleton = this;
 }
 
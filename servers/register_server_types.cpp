@@ -57,6 +57,7 @@
 #include "camera/camera_feed.h"
 #include "camera_server.h"
 #include "physics/physics_server_sw.h"
+#include "physics/physics_server_wrap_mt.h"
 #include "physics_2d/physics_2d_server_sw.h"
 #include "physics_2d/physics_2d_server_wrap_mt.h"
 #include "physics_2d_server.h"
@@ -89,7 +90,7 @@ static void _debugger_get_resource_usage(List<ScriptDebuggerRemote::ResourceUsag
 ShaderTypes *shader_types = NULL;
 
 PhysicsServer *_createGodotPhysicsCallback() {
-	return memnew(PhysicsServerSW);
+	return PhysicsServerWrapMT::init_server<PhysicsServerSW>();
 }
 
 Physics2DServer *_createGodotPhysics2DCallback() {
@@ -200,6 +201,9 @@ void register_server_types() {
 
 	PhysicsServerManager::register_server("GodotPhysics", &_createGodotPhysicsCallback);
 	PhysicsServerManager::set_default_server("GodotPhysics");
+
+	GLOBAL_DEF("physics/3d/broadphase", 0);
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/broadphase", PropertyInfo(Variant::INT, "physics/3d/broadphase", PROPERTY_HINT_ENUM, "Octree,AABB Tree"));
 }
 
 void unregister_server_types() {
@@ -30,6 +30,7 @@
 
 #include "visual_server.h"
 
+#include "core/math/batch_math.h"
 #include "core/method_bind_ext.gen.inc"
 #include "core/project_settings.h"
 
@@ -417,9 +418,6 @@ Error VisualServer::_surface_set_data(Array p_arrays, uint32_t p_format, uint32_
 					PoolVector<Vector3>::Read read = array.read();
 					const Vector3 *src = read.ptr();
 
-					// setting vertices means regenerating the AABB
-					AABB aabb;
-
 					if (p_format & ARRAY_COMPRESS_VERTEX) {
 
 						for (int i = 0; i < p_vertex_array_len; i++) {
@@ -427,14 +425,6 @@ Error VisualServer::_surface_set_data(Array p_arrays, uint32_t p_format, uint32_
 							uint16_t vector[4] = { Math::make_half_float(src[i].x), Math::make_half_float(src[i].y), Math::make_half_float(src[i].z), Math::make_half_float(1.0) };
 
 							copymem(&vw[p_offsets[ai] + i * p_stride], vector, sizeof(uint16_t) * 4);
-
-							if (i == 0) {
-
-								aabb = AABB(src[i], SMALL_VEC3);
-							} else {
-
-								aabb.expand_to(src[i]);
-							}
 						}
 
 					} else {
@@ -443,17 +433,15 @@ Error VisualServer::_surface_set_data(Array p_arrays, uint32_t p_format, uint32_
 							float vector[3] = { src[i].x, src[i].y, src[i].z };
 
 							copymem(&vw[p_offsets[ai] + i * p_stride], vector, sizeof(float) * 3);
-
-							if (i == 0) {
-
-								aabb = AABB(src[i], SMALL_VEC3);
-							} else {
-
-								aabb.expand_to(src[i]);
-							}
 						}
 					}
 
+					// setting vertices means regenerating the AABB
+					AABB aabb = BatchMath::get_bounds(src, p_vertex_array_len);
+					if (p_vertex_array_len > 0) {
+						aabb.expand_to(src[0] + SMALL_VEC3);
+					}
+
 					r_aabb = aabb;
 				}
 